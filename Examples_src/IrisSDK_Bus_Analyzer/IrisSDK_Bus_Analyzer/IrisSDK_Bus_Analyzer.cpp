@@ -0,0 +1,51 @@
+/*
+ * Decodes a capture of the RS485 line to an Orca into Modbus frames and prints a report of errors, timing and bus utilisation.
+ *
+ * Usage: IrisSDK_Bus_Analyzer <capture> [--baud <bps>] [--timeout <us>] [--quiet]
+ *
+ * The capture is either a BusRecorder recording (.irbr) or a text capture with one line per group of bytes:
+ *   <time in us> [tx|rx] <hex byte> [<hex byte> ...]
+ * --baud sets the baud rate at the start of the capture (default 19200); a handshake in the capture changes it.
+ * --timeout sets how long a request waits for a response in a capture without timeout markers (default 50000 us).
+ * --quiet prints only the report, not every exchange.
+ */
+#include "library_linker.h"
+#include "modbus_client/bus_analyzer.h"
+#include "orca600_api/reg_names.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char* argv[]) {
+    const char* path = 0;
+    uint32_t baud_rate_bps = 19200;
+    double timeout_us = 50000;
+    bool quiet = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--baud") == 0 && i + 1 < argc) baud_rate_bps = strtoul(argv[++i], 0, 10);
+        else if (strcmp(argv[i], "--timeout") == 0 && i + 1 < argc) timeout_us = atof(argv[++i]);
+        else if (strcmp(argv[i], "--quiet") == 0) quiet = true;
+        else path = argv[i];
+    }
+    if (!path || !baud_rate_bps) {
+        printf("Usage: %s <capture.irbr | capture.txt> [--baud <bps>] [--timeout <us>] [--quiet]\n", argv[0]);
+        return 1;
+    }
+
+    BusAnalyzer analyzer(reg_names, sizeof(reg_names) / sizeof(reg_names[0]), baud_rate_bps);
+    analyzer.set_response_timeout_us(timeout_us);
+    if (!quiet) analyzer.set_frame_log(stdout);
+
+    size_t length = strlen(path);
+    bool loaded;
+    if (length > 5 && strcmp(path + length - 5, ".irbr") == 0) loaded = analyzer.load_recording(path);
+    else loaded = analyzer.load_text_capture(path);
+    if (!loaded) {
+        printf("Could not read %s\n", path);
+        return 1;
+    }
+
+    analyzer.print_report(stdout);
+    return 0;
+}
@@ -23,6 +23,9 @@
 
 #include "library_linker.h"
 #include "modbus_client/device_applications/actuator.h"
+#include "modbus_client/device_applications/actuator_command_queue.h"
+#include "modbus_client/device_applications/actuator_snapshot.h"
+#include "modbus_client/device_applications/actuator_bring_up.h"
 #include <iostream>
 #include <conio.h>
 #include <thread>
@@ -30,6 +33,7 @@ using namespace std;
 
 //Define Keyboad inputs to console
 #define KEY_UP      72
+#define KEY_DOWN    80
 
 #define NUM_MOTORS 2
 Actuator motors[NUM_MOTORS]{
@@ -37,12 +41,17 @@ Actuator motors[NUM_MOTORS]{
 , {0, "Orca B", 1}
 };
 
+ActuatorCommandQueue commands[NUM_MOTORS];  //commands posted from the console thread, applied by the comms thread
+ActuatorSnapshot feedback[NUM_MOTORS];      //feedback published by the comms thread, read by the console thread
+
 int port_number[NUM_MOTORS];
 
 void motor_comms() {
     while (1) {
         for (int i = 0; i < NUM_MOTORS; i++) {
+            commands[i].drain(motors[i]);
             motors[i].run_in();
+            feedback[i].publish(motors[i]);
             motors[i].run_out();
         }
     }
@@ -78,21 +87,40 @@ int main()
     }
     cout << "Using ports " + String(port_number[0]) + "and " + String(port_number[1]) << endl;
 
-    //establish hi speed modbus stream 
+    //establish hi speed modbus stream with both motors at once
     for (int i = 0; i < NUM_MOTORS; i++) {
         motors[i].set_new_comport(port_number[i]);
-        motors[i].init();
+    }
+    ActuatorBringUp bring_up(motors, NUM_MOTORS);
+    bring_up.start(5000000);    //allow 5 seconds for both motors to connect
+    while (!bring_up.run());
+    for (int i = 0; i < NUM_MOTORS; i++) {
+        if (bring_up.get_status(i) == ActuatorBringUp::ready) {
+            cout << motors[i].get_name() << " connected after " << bring_up.get_ready_time_us(i) / 1000 << " ms" << endl;
+        }
+        else {
+            cout << motors[i].get_name() << " failed to connect, reached handshake step " << bring_up.get_furthest_step(i) << endl;
+        }
     }
     thread mthread(motor_comms); //process motor communications in seperate thread
     cout << "Press Up Arrow to simultaneously trigger motion id 0 on both motors" << endl;
+    cout << "Press Down Arrow to print the position and force of both motors" << endl;
     int c;  //check for keyboard inputs into console
     while (1) {
         c = 0;
         switch ((c = _getch())) {
         case KEY_UP:
             for (int i = 0; i < NUM_MOTORS; i++) {
-                motors[i].set_mode(Actuator::KinematicMode);
-                motors[i].trigger_kinematic_motion(0);
+                commands[i].post_set_mode(Actuator::KinematicMode);
+                commands[i].post_write_register(KIN_SW_TRIGGER, 0);    //trigger motion id 0
+            }
+            break;
+        case KEY_DOWN:
+            for (int i = 0; i < NUM_MOTORS; i++) {
+                ActuatorFeedback f;
+                if (feedback[i].read(f)) {
+                    cout << motors[i].get_name() << ": " << f.position_um << " um, " << f.force_mN << " mN" << endl;
+                }
             }
             break;
         default:
@@ -45,6 +45,7 @@ bool is_moving = false;
 uint64_t start_time = 0;
 int32_t last_position = 0;
 uint64_t last_kin_status_update = 0;
+uint32_t data_cursor = 0;   //updates of the motor logged so far, see Actuator::new_data(uint32_t&)
 
 //timer is used to allow smooth communications.
 void motor_comms() {
@@ -59,7 +60,7 @@ void motor_comms() {
             motor.update_read_stream(2, SHAFT_SPEED_MMPS);
         }
         is_moving = (motor.get_orca_reg_content(KINEMATIC_STATUS) & MOTION_ACTIVE);
-        if ((motor.get_orca_reg_content(MODE_OF_OPERATION) == Actuator::KinematicMode) && motor.new_data() && is_moving) {
+        if ((motor.get_orca_reg_content(MODE_OF_OPERATION) == Actuator::KinematicMode) && motor.new_data(data_cursor) && is_moving) {
             if (was_moving != is_moving) {
                 std::string message = std::string()
                     + "==New Motion Triggered==\n"
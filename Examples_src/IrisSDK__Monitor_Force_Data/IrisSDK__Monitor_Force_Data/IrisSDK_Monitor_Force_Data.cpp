@@ -1,19 +1,17 @@
 #include "library_linker.h"
 #include "modbus_client/device_applications/actuator.h"
+#include "modbus_client/device_applications/actuator_sample_history.h"
 #include <iostream>
 
 Actuator motor{90, "Orca Motor", 1};	//replace port number with your RS422 cable to the orca series motor's com port number
 
 //!< custom communication settings for baud rate and interframe delay to allow faster communication than modbus protocol
 Actuator::ConnectionConfig connection_config;
+ActuatorSampleHistory<> history;    //every force sample received from the motor
+ActuatorSampleHistory<>::Cursor cycle_cursor;   //the first sample of the current cycle
 bool was_connected = false;     //has high speed communication been established
-int num_data_for_average = 0;
-int force_average_buffer[200];
-int force_average = 0;
 int cycle_count = 0;
 bool motion_triggered = false;
-uint32_t start_time = 0;
-uint32_t data_gather_period = 20; //gather force data every 20 milliseconds 
 
 void first_connection() {
     //set up a kinematic profile that will chain three motions and then stop until triggered.
@@ -27,26 +25,27 @@ void first_connection() {
 void check_for_complete_cycle() {
     motor.update_read_stream(1, KINEMATIC_STATUS);  //read stream kinematic status, this will allow us to keep track of the state of the kinematic motion while also getting motor data
     if (motor.get_orca_reg_content(KINEMATIC_STATUS) & 0x8000) {    //this bit will be true while the motion is active
-        if ((uint32_t)(GetTickCount() - start_time) > data_gather_period) {
-            start_time = GetTickCount();
-            force_average_buffer[num_data_for_average] = motor.get_force_mN();
-            num_data_for_average++;
-        }
         motion_triggered = false;
     }
     else if (!motion_triggered){
         motor.write_register(KIN_SW_TRIGGER, 0);   //this will trigger the next cycle
-        for (int i = 0; i < num_data_for_average; i++) {
-            force_average += force_average_buffer[i];
+        //average every sample recorded since the start of the cycle
+        ActuatorSample samples[64];
+        int64_t force_sum = 0;
+        int num_samples = 0;
+        int n;
+        while ((n = history.read(cycle_cursor, samples, 64)) > 0) {
+            for (int i = 0; i < n; i++) force_sum += samples[i].force_mN;
+            num_samples += n;
         }
-        if (num_data_for_average > 0) {
-            force_average = force_average / num_data_for_average;
+        if (num_samples > 0) {
+            std::cout << "cycle_count: " << cycle_count << " Force Avg (N) " << force_sum / num_samples / 1000. << " over " << num_samples << " samples";
+            if (cycle_cursor.overruns) std::cout << " (" << cycle_cursor.overruns << " lost)";
+            std::cout << std::endl;
         }
-        std::cout << "cycle_count: " << cycle_count << " Force Avg (N) " << force_average/1000. << std::endl;
         cycle_count++;
-        num_data_for_average = 0;
+        cycle_cursor.overruns = 0;
         motion_triggered = true;
-        start_time = GetTickCount();
     }
 
 }
@@ -76,6 +75,7 @@ int main() {
 
         //send and receive to the motor
         motor.run_in();
+        history.record(motor);
         motor.run_out();
     }
 }
\ No newline at end of file
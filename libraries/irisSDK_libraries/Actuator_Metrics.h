@@ -0,0 +1,134 @@
+/**
+ * @file  Actuator_Metrics.h
+ * @brief Publishes the health of an Actuator and its serial link to a Metrics_Registry.
+
+	Copyright 2022 Iris Dynamics Ltd
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+
+	For questions or feedback on this file, please email <support@irisdynamics.com>.
+ */
+
+#pragma once
+
+#include "Metrics_Registry.h"
+#include "../modbus_client/device_applications/actuator.h"
+
+/**
+ *	@class	Actuator_Metrics
+ *	@brief	Copies an Actuator's values and link counters into metrics labelled with the actuator's name.
+ *
+ *	update() reads the Actuator, so it must be called from the thread running the Actuator, typically right after run_in().
+ *	It only performs atomic stores, so an exporter on another thread can render the registry at any time.
+ *
+ *	The ModbusClient diagnostic counters are 16 bit and wrap; they are published as 64 bit counters by accumulating their differences.
+ */
+class Actuator_Metrics {
+public:
+
+	/**
+	 *	@param	registry	registry to add this actuator's metrics to
+	 *	@param	_motor		the actuator to observe
+	 *	@param	name		value of the "actuator" label
+	 */
+	Actuator_Metrics(Metrics_Registry& registry, Actuator& _motor, const std::string& name) :
+		motor(_motor),
+		labels{ { "actuator", name } },
+		connected			(registry.gauge("orca_connected", "1 when the handshake has completed and the actuator is streaming", labels)),
+		mode				(registry.gauge("orca_mode", "Mode of operation reported by the actuator", labels)),
+		errors				(registry.gauge("orca_errors", "Active error bits reported by the actuator", labels)),
+		temperature			(registry.gauge("orca_temperature_celsius", "Stator temperature", labels)),
+		voltage				(registry.gauge("orca_voltage_volts", "Supply voltage", labels)),
+		power				(registry.gauge("orca_power_watts", "Power consumption", labels)),
+		force				(registry.gauge("orca_force_newtons", "Force sensed by the actuator", labels)),
+		position			(registry.gauge("orca_position_meters", "Shaft position from the zero position", labels)),
+		stream_rate			(registry.gauge("orca_stream_rate_hertz", "Stream frames completed per second", labels)),
+		stream_depth		(registry.gauge("orca_stream_queue_depth", "Stream frames allowed on the message queue", labels)),
+		command_age			(registry.gauge("orca_command_age_seconds", "Average age of streamed commands when sent", labels)),
+		frames				(registry.counter("orca_frames_total", "Transactions claimed from the message queue, valid or not", labels)),
+		round_trip			(registry.histogram("orca_round_trip_seconds", "Time from start of transmission until the response was received or abandoned",
+								{ 0.0005, 0.001, 0.002, 0.004, 0.008, 0.016, 0.032, 0.064 }, labels))
+	{
+		add_link_counter(registry, ModbusClient::message_sent_count,				"orca_link_messages_sent_total",	"Requests transmitted");
+		add_link_counter(registry, ModbusClient::return_bus_message_count,			"orca_link_messages_valid_total",	"Valid responses received");
+		add_link_counter(registry, ModbusClient::bytes_out_count,					"orca_link_bytes_sent_total",		"Bytes transmitted");
+		add_link_counter(registry, ModbusClient::bytes_in_count,					"orca_link_bytes_received_total",	"Bytes received");
+		add_link_counter(registry, ModbusClient::return_server_exception_error_count, "orca_link_exceptions_total",	"Exception responses received");
+		add_link_counter(registry, ModbusClient::unexpected_responder,				"orca_link_unexpected_responder_total", "Responses from the wrong address");
+		add_link_counter(registry, ModbusClient::crc_error_count,					"orca_link_crc_errors_total",		"Responses failing the CRC check");
+		add_link_counter(registry, ModbusClient::return_server_no_response_count,	"orca_link_response_timeouts_total", "Requests with no response");
+		add_link_counter(registry, ModbusClient::unexpected_interchar,				"orca_link_interchar_timeouts_total", "Responses cut short by an interchar timeout");
+		last_claimed = motor.get_claimed_frame_count();
+	}
+
+	/**
+	 *	@brief	Publish the actuator's current values. Call from the actuator's thread, after run_in().
+	 */
+	void update() {
+		connected.set(motor.is_connected() ? 1 : 0);
+		mode.set(motor.get_mode_of_operation());
+		errors.set(motor.get_errors());
+		temperature.set(motor.get_temperature_C());
+		voltage.set(motor.get_voltage_mV() / 1000.0);
+		power.set(motor.get_power_W());
+		force.set(motor.get_force_mN() / 1000.0);
+		position.set(motor.get_position_um() / 1000000.0);
+		stream_rate.set(motor.get_stream_rate_hz());
+		stream_depth.set(motor.get_stream_depth());
+		command_age.set(motor.get_command_age_us() / 1000000.0);
+
+		uint32_t claimed = motor.get_claimed_frame_count();
+		if (claimed != last_claimed) {
+			frames.inc(claimed - last_claimed);
+			round_trip.observe(motor.get_last_round_trip_us() / 1000000.0);		// update() runs at least once per claim when called after each run_in()
+			last_claimed = claimed;
+		}
+
+		for (Link_Counter& link : link_counters) {
+			uint16_t value = motor.modbus_client.diag_counters[link.index];
+			link.counter.inc(uint16_t(value - link.last));
+			link.last = value;
+		}
+	}
+
+private:
+
+	struct Link_Counter {
+		int index;
+		Metric_Counter& counter;
+		uint16_t last;
+	};
+
+	Actuator& motor;
+	Metrics_Registry::Labels labels;
+
+	Metric_Gauge& connected;
+	Metric_Gauge& mode;
+	Metric_Gauge& errors;
+	Metric_Gauge& temperature;
+	Metric_Gauge& voltage;
+	Metric_Gauge& power;
+	Metric_Gauge& force;
+	Metric_Gauge& position;
+	Metric_Gauge& stream_rate;
+	Metric_Gauge& stream_depth;
+	Metric_Gauge& command_age;
+	Metric_Counter& frames;
+	Metric_Histogram& round_trip;
+
+	uint32_t last_claimed = 0;
+	std::vector<Link_Counter> link_counters;
+
+	void add_link_counter(Metrics_Registry& registry, int index, const char* name, const char* help) {
+		link_counters.push_back(Link_Counter{ index, registry.counter(name, help, labels), motor.modbus_client.diag_counters[index] });
+	}
+};
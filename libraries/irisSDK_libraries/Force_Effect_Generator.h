@@ -44,6 +44,8 @@ public:
 
     bool is_running = false;
 
+    uint32_t data_cursor = 0;   // updates of the actuator seen by this generator, see Actuator::new_data(uint32_t&)
+
     
 
         Force_Effect_Generator(Actuator& _motor) :
@@ -56,7 +58,7 @@ public:
             if (!is_running) force_value = 0;
             else {
                 // Update spring effect, speed, and damping effect object values when the actuator object has new data
-                if (motor.new_data()) {
+                if (motor.new_data(data_cursor)) {
 
                     // Update spring effect object with actuator position in millimeters
                     spring_effect.update(motor.get_position_um() / 1000.);
@@ -41,9 +41,6 @@ class Force_Effect_Panel {
     //DampingEffect damping_effect;
     //Derivative speed{0.02};
 
-    // Actuator Object
-    Actuator * motor;
-    
     // GUI_Page to handle displaying/hiding elements in panel
     GUI_Page * panel_elements;
 
@@ -0,0 +1,218 @@
+/**
+ * @file  Metrics_Exporter.h
+ * @brief Makes a Metrics_Registry available for scraping, through a text file or a loopback HTTP endpoint.
+
+	Copyright 2022 Iris Dynamics Ltd
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+
+	For questions or feedback on this file, please email <support@irisdynamics.com>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include "Metrics_Registry.h"
+
+/**
+ *	@brief	Write the registry to a file for a textfile collector (eg. node_exporter's --collector.textfile.directory).
+ *			The file is written under a temporary name and renamed so a scrape never reads a partial file.
+ *	@return	false if the file could not be written
+ */
+inline bool write_metrics_file(Metrics_Registry& registry, const std::string& path) {
+	std::string temp_path = path + ".tmp";
+	FILE* file = fopen(temp_path.c_str(), "wb");
+	if (!file) return false;
+	std::string text = registry.render();
+	bool written = fwrite(text.data(), 1, text.size(), file) == text.size();
+	written = (fclose(file) == 0) && written;
+	if (!written) return false;
+#ifdef _WIN32
+	std::remove(path.c_str());		// rename doesn't replace an existing file on Windows
+#endif
+	return std::rename(temp_path.c_str(), path.c_str()) == 0;
+}
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN		// keeps windows.h from including winsock.h, which conflicts with winsock2.h
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+/**
+ *	@class	Metrics_Http_Server
+ *	@brief	Serves GET /metrics on 127.0.0.1 from its own thread.
+ *
+ *	Only the loopback interface is bound; expose it further with a reverse proxy if needed.
+ *	Requests are handled one at a time, which is plenty for a scraper.
+ *	On Windows this header must be included before windows.h, or the project must define WIN32_LEAN_AND_MEAN, since
+ *	windows.h otherwise includes the old winsock.h, which can't be used together with winsock2.h.
+ */
+class Metrics_Http_Server {
+public:
+	Metrics_Http_Server(Metrics_Registry& _registry) :
+		registry(_registry)
+	{}
+
+	~Metrics_Http_Server() {
+		stop();
+	}
+
+	/**
+	 *	@brief	Start listening
+	 *	@param	port	TCP port, or 0 to let the system choose one (see get_port())
+	 *	@return	false if the port could not be bound
+	 */
+	bool start(uint16_t port) {
+		stop();
+#ifdef _WIN32
+		WSADATA wsa_data;
+		if (WSAStartup(MAKEWORD(2, 2), &wsa_data) != 0) return false;
+		winsock_started = true;
+#endif
+		listen_socket = socket(AF_INET, SOCK_STREAM, 0);
+		if (listen_socket == NO_SOCKET) {
+			stop();
+			return false;
+		}
+
+		int one = 1;
+		setsockopt(listen_socket, SOL_SOCKET, SO_REUSEADDR, (const char*)&one, sizeof(one));
+
+		sockaddr_in addr = {};
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		addr.sin_port = htons(port);
+		socklen_t length = sizeof(addr);
+		if (bind(listen_socket, (sockaddr*)&addr, sizeof(addr)) != 0
+			|| listen(listen_socket, 4) != 0
+			|| getsockname(listen_socket, (sockaddr*)&addr, &length) != 0) {
+			stop();
+			return false;
+		}
+		bound_port = ntohs(addr.sin_port);
+
+		running = true;
+		server_thread = std::thread(&Metrics_Http_Server::serve, this);
+		return true;
+	}
+
+	/**
+	 *	@brief	Stop listening and wait for the server thread to finish
+	 */
+	void stop() {
+		running = false;
+		if (server_thread.joinable()) server_thread.join();
+		close_socket(listen_socket);
+		listen_socket = NO_SOCKET;
+#ifdef _WIN32
+		if (winsock_started) WSACleanup();
+		winsock_started = false;
+#endif
+	}
+
+	uint16_t get_port() { return bound_port; }
+
+private:
+#ifdef _WIN32
+	typedef SOCKET Socket;
+	static const Socket NO_SOCKET = INVALID_SOCKET;
+	bool winsock_started = false;
+#else
+	typedef int Socket;
+	static const Socket NO_SOCKET = -1;
+#endif
+
+	Metrics_Registry& registry;
+	Socket listen_socket = NO_SOCKET;
+	uint16_t bound_port = 0;
+	std::atomic<bool> running{ false };
+	std::thread server_thread;
+
+	static void close_socket(Socket socket) {
+		if (socket == NO_SOCKET) return;
+#ifdef _WIN32
+		closesocket(socket);
+#else
+		close(socket);
+#endif
+	}
+
+	/// @return true if the socket has something to read within the timeout
+	static bool wait_readable(Socket socket, int timeout_ms) {
+#ifdef _WIN32
+		WSAPOLLFD ready = { socket, POLLIN, 0 };
+		return WSAPoll(&ready, 1, timeout_ms) > 0;
+#else
+		pollfd ready = { socket, POLLIN, 0 };
+		return poll(&ready, 1, timeout_ms) > 0;
+#endif
+	}
+
+	void serve() {
+		while (running) {
+			if (!wait_readable(listen_socket, 100)) continue;		// wake regularly to check for stop()
+			Socket client = accept(listen_socket, 0, 0);
+			if (client == NO_SOCKET) continue;
+			respond(client);
+			close_socket(client);
+		}
+	}
+
+	void respond(Socket client) {
+		char request[1024];
+		size_t received = 0;
+		// read until the end of the request headers, or give up after a short wait
+		while (received < sizeof(request) - 1) {
+			if (!wait_readable(client, 1000)) break;
+			int n = recv(client, request + received, int(sizeof(request) - 1 - received), 0);
+			if (n <= 0) break;
+			received += n;
+			request[received] = 0;
+			if (strstr(request, "\r\n\r\n")) break;
+		}
+		request[received] = 0;
+
+		std::string status, body, type;
+		if (strncmp(request, "GET /metrics ", 13) == 0 || strncmp(request, "GET /metrics?", 13) == 0) {
+			status = "200 OK";
+			type = "text/plain; version=0.0.4";
+			body = registry.render();
+		}
+		else {
+			status = "404 Not Found";
+			type = "text/plain";
+			body = "Not found. Metrics are at /metrics\n";
+		}
+		std::string response = "HTTP/1.1 " + status + "\r\nContent-Type: " + type
+			+ "\r\nContent-Length: " + std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+
+		size_t sent = 0;
+		while (sent < response.size()) {
+			int n = send(client, response.data() + sent, int(response.size() - sent), 0);
+			if (n <= 0) break;
+			sent += n;
+		}
+	}
+};
@@ -0,0 +1,223 @@
+/**
+ * @file  Metrics_Registry.h
+ * @brief Counters, gauges and histograms with label sets, rendered in the Prometheus text exposition format.
+
+	Copyright 2022 Iris Dynamics Ltd
+	Licensed under the Apache License, Version 2.0 (the "License");
+	you may not use this file except in compliance with the License.
+	You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+	Unless required by applicable law or agreed to in writing, software
+	distributed under the License is distributed on an "AS IS" BASIS,
+	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	See the License for the specific language governing permissions and
+	limitations under the License.
+
+	For questions or feedback on this file, please email <support@irisdynamics.com>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <stdint.h>
+
+/**
+ *	@class	Metric_Counter
+ *	@brief	A value which only increases. Updates are single relaxed atomic operations.
+ */
+class Metric_Counter {
+public:
+	void inc(uint64_t amount = 1) { value.fetch_add(amount, std::memory_order_relaxed); }
+	uint64_t get() { return value.load(std::memory_order_relaxed); }
+private:
+	std::atomic<uint64_t> value{ 0 };
+};
+
+/**
+ *	@class	Metric_Gauge
+ *	@brief	A value which may go up or down. Updates are single relaxed atomic stores.
+ */
+class Metric_Gauge {
+public:
+	void set(double _value) { value.store(_value, std::memory_order_relaxed); }
+	double get() { return value.load(std::memory_order_relaxed); }
+private:
+	std::atomic<double> value{ 0 };
+};
+
+/**
+ *	@class	Metric_Histogram
+ *	@brief	Counts observations into fixed buckets. observe() is lock-free; it scans the bucket bounds and does two atomic adds.
+ */
+class Metric_Histogram {
+public:
+	/**
+	 *	@param	_bounds	upper bound of each bucket, in increasing order. A +Inf bucket is always added.
+	 */
+	Metric_Histogram(const std::vector<double>& _bounds) :
+		bounds(_bounds),
+		counts(_bounds.size() + 1)
+	{}
+
+	void observe(double value) {
+		size_t i = 0;
+		while (i < bounds.size() && value > bounds[i]) i++;
+		counts[i].fetch_add(1, std::memory_order_relaxed);
+		double old_sum = sum.load(std::memory_order_relaxed);
+		while (!sum.compare_exchange_weak(old_sum, old_sum + value, std::memory_order_relaxed)) {}
+	}
+
+	const std::vector<double>& get_bounds() { return bounds; }
+	uint64_t get_bucket_count(size_t i) { return counts[i].load(std::memory_order_relaxed); }
+	double get_sum() { return sum.load(std::memory_order_relaxed); }
+
+private:
+	const std::vector<double> bounds;
+	std::deque<std::atomic<uint64_t>> counts;
+	std::atomic<double> sum{ 0 };
+};
+
+/**
+ *	@class	Metrics_Registry
+ *	@brief	Owns every metric and renders them for scraping.
+ *
+ *	Registration takes a lock and allocates, so it should be done at startup. The returned references stay valid for
+ *	the life of the registry and may be updated from any thread without locks, eg. from the communication thread.
+ *	render() may be called from any thread, eg. an exporter's thread.
+ */
+class Metrics_Registry {
+public:
+
+	typedef std::vector<std::pair<std::string, std::string>> Labels;
+
+	/**
+	 *	@brief	Register a counter. By convention the name ends in _total.
+	 *	@param	labels	label names and values identifying this series, eg. {{"actuator", "Orca A"}}
+	 */
+	Metric_Counter& counter(const std::string& name, const std::string& help, const Labels& labels = Labels()) {
+		std::lock_guard<std::mutex> lock(mutex);
+		counters.emplace_back();
+		add_series(name, help, "counter", labels, COUNTER, counters.size() - 1);
+		return counters.back();
+	}
+
+	Metric_Gauge& gauge(const std::string& name, const std::string& help, const Labels& labels = Labels()) {
+		std::lock_guard<std::mutex> lock(mutex);
+		gauges.emplace_back();
+		add_series(name, help, "gauge", labels, GAUGE, gauges.size() - 1);
+		return gauges.back();
+	}
+
+	Metric_Histogram& histogram(const std::string& name, const std::string& help, const std::vector<double>& bounds, const Labels& labels = Labels()) {
+		std::lock_guard<std::mutex> lock(mutex);
+		histograms.emplace_back(bounds);
+		add_series(name, help, "histogram", labels, HISTOGRAM, histograms.size() - 1);
+		return histograms.back();
+	}
+
+	/**
+	 *	@brief	Returns every metric in the Prometheus text exposition format (version 0.0.4)
+	 */
+	std::string render() {
+		std::lock_guard<std::mutex> lock(mutex);
+		std::ostringstream out;
+		out.precision(15);
+		for (Family& family : families) {
+			out << "# HELP " << family.name << " " << family.help << "\n";
+			out << "# TYPE " << family.name << " " << family.type << "\n";
+			for (Series& series : family.series) {
+				switch (series.kind) {
+				case COUNTER:
+					out << family.name << braces(series.labels) << " " << counters[series.index].get() << "\n";
+					break;
+				case GAUGE:
+					out << family.name << braces(series.labels) << " " << gauges[series.index].get() << "\n";
+					break;
+				case HISTOGRAM: {
+					Metric_Histogram& h = histograms[series.index];
+					uint64_t cumulative = 0;
+					for (size_t i = 0; i <= h.get_bounds().size(); i++) {
+						cumulative += h.get_bucket_count(i);
+						std::ostringstream le;
+						le.precision(15);
+						if (i < h.get_bounds().size()) le << h.get_bounds()[i];
+						else le << "+Inf";
+						out << family.name << "_bucket" << braces(join(series.labels, "le=\"" + le.str() + "\"")) << " " << cumulative << "\n";
+					}
+					out << family.name << "_sum" << braces(series.labels) << " " << h.get_sum() << "\n";
+					out << family.name << "_count" << braces(series.labels) << " " << cumulative << "\n";
+					break;
+				}
+				}
+			}
+		}
+		return out.str();
+	}
+
+private:
+
+	enum KIND { COUNTER, GAUGE, HISTOGRAM };
+
+	struct Series {
+		std::string labels;		// rendered label pairs without braces
+		KIND kind;
+		size_t index;
+	};
+
+	struct Family {
+		std::string name;
+		std::string help;
+		std::string type;
+		std::vector<Series> series;
+	};
+
+	std::mutex mutex;
+	std::vector<Family> families;
+	std::deque<Metric_Counter> counters;		// deques keep references valid as metrics are added
+	std::deque<Metric_Gauge> gauges;
+	std::deque<Metric_Histogram> histograms;
+
+	void add_series(const std::string& name, const std::string& help, const char* type, const Labels& labels, KIND kind, size_t index) {
+		Family* family = 0;
+		for (Family& f : families) {
+			if (f.name == name) family = &f;
+		}
+		if (!family) {
+			families.push_back(Family{ name, help, type, {} });
+			family = &families.back();
+		}
+		family->series.push_back(Series{ render_labels(labels), kind, index });
+	}
+
+	static std::string render_labels(const Labels& labels) {
+		std::string out;
+		for (const std::pair<std::string, std::string>& label : labels) {
+			std::string value;
+			for (char c : label.second) {
+				if (c == '\\' || c == '"') { value += '\\'; value += c; }
+				else if (c == '\n') value += "\\n";
+				else value += c;
+			}
+			out = join(out, label.first + "=\"" + value + "\"");
+		}
+		return out;
+	}
+
+	static std::string join(const std::string& a, const std::string& b) {
+		if (a.empty()) return b;
+		if (b.empty()) return a;
+		return a + "," + b;
+	}
+
+	static std::string braces(const std::string& labels) {
+		return labels.empty() ? "" : "{" + labels + "}";
+	}
+};
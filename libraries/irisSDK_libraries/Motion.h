@@ -212,9 +212,15 @@ class Derivative {
     Derivative(float a) : alpha(a) {}
     
     void update(float new_information) {
-      uint32_t time_now = micros();
-      float derivative_now = 1000000. * (float)(new_information - previous_information) / (float)(time_now - previous_time);
-      previous_time = time_now; 
+      update(new_information, micros());
+    }
+
+    // Use the time the information was sampled rather than when it was read. Call once per new sample,
+    // eg. if (motor.new_data()) update(motor.get_position_um(), micros() - motor.get_sample_age_us());
+    void update(float new_information, uint32_t sample_time_us) {
+      if (sample_time_us == previous_time) return;
+      float derivative_now = 1000000. * (float)(new_information - previous_information) / (float)(int32_t)(sample_time_us - previous_time);
+      previous_time = sample_time_us; 
       previous_information = new_information;
       filtered  = filtered * (1-alpha) + derivative_now * alpha;
     }
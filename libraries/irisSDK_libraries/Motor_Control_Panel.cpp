@@ -27,9 +27,10 @@
 /**
 	@brief function initializes a new GUI_Page object to handle hiding/displaying Motor_Plot elements before calling setup() to initialize all plot elements.
 */
-void Motor_Control::add(Actuator* _motor, int32_t* _f_target, int32_t* _p_target, uint16_t _anchor_row, uint16_t _anchor_col) {
+void Motor_Control::add(Actuator* _motor, ActuatorCommandQueue* _commands, int32_t* _f_target, int32_t* _p_target, uint16_t _anchor_row, uint16_t _anchor_col) {
 	ctrl_elements = new GUI_Page(); // Init new GUI_Page object
 	motor = _motor; // Init Actuator object
+	commands = _commands; // Init queue the commands are posted to
 	force_target = _f_target;
 	position_target = _p_target;
 	setup(_anchor_row, _anchor_col); // Initialize Motor_control flex elements
@@ -39,9 +40,10 @@ void Motor_Control::add(Actuator* _motor, int32_t* _f_target, int32_t* _p_target
 /**
 	@brief function is the same as above but takes a GUI_Page pointer as an argument instead of initializing a new one before calling setup() to initialize all plot elements.
 */
-void Motor_Control::add(GUI_Page* _ctrl_elements, Actuator* _motor, int32_t* _f_target, int32_t* _p_target, uint16_t _anchor_row, uint16_t _anchor_col) {
+void Motor_Control::add(GUI_Page* _ctrl_elements, Actuator* _motor, ActuatorCommandQueue* _commands, int32_t* _f_target, int32_t* _p_target, uint16_t _anchor_row, uint16_t _anchor_col) {
 	ctrl_elements = _ctrl_elements; // Init GUI_Page object
 	motor = _motor; // Init Actuator object
+	commands = _commands; // Init queue the commands are posted to
 	force_target = _f_target;
 	position_target = _p_target;
 	setup(_anchor_row, _anchor_col); // Initialize Motor_control flex elements
@@ -76,7 +78,7 @@ void Motor_Control::show() {
 	force_button.disable(false);
 	target_force.disable(true);
 	target_position.disable(true);
-	motor->set_mode(Actuator::SleepMode);
+	commands->post_set_mode(Actuator::SleepMode);
 }
 
 
@@ -98,19 +100,19 @@ void Motor_Control::run() {
 
 	// Handle toggling on of buttons `zero position`, `clear errors`, and `get latched errors`
 	if (zero_position.pressed()) {
-		motor->zero_position();
+		commands->post_zero_position();
 		target_position.update(0);
 	}
 	if (clear_errors.pressed()) {
-		motor->clear_errors();
+		commands->post_clear_errors();
 	}
 
 	if (enable_button.toggled()) {
 		if (enable_button.get()) {
-			motor->enable();
+			commands->post_enable();
 		}
 		else {
-			motor->disable();
+			commands->post_disable();
 		}
 	}
 
@@ -123,7 +125,7 @@ void Motor_Control::run() {
 		force_button.disable(false);
 		target_force.disable(true);
 		target_position.disable(true);
-		motor->set_mode(Actuator::SleepMode);
+		commands->post_set_mode(Actuator::SleepMode);
 	}
 
 	if (position_button.pressed()) {
@@ -133,7 +135,7 @@ void Motor_Control::run() {
 			sleep_button.disable(false);
 			position_button.disable(true);
 			force_button.disable(false);
-			motor->set_mode(Actuator::PositionMode);
+			commands->post_set_mode(Actuator::PositionMode);
 			target_force.disable(true);
 			target_position.disable(false);
 			target_position.update(motor->get_position_um());
@@ -152,7 +154,7 @@ void Motor_Control::run() {
 			force_button.disable(true);
 			target_force.disable(false);
 			target_position.disable(true);
-			motor->set_mode(Actuator::ForceMode);
+			commands->post_set_mode(Actuator::ForceMode);
 			target_force.update(0);
 		}
 		else {
@@ -160,14 +162,16 @@ void Motor_Control::run() {
 		}
 	}
 
-	if (!motor->is_connected()) {
+	bool connected = motor->is_connected();
+	if (!connected) {
 		sleep_button.disable(true);
 		position_button.disable(false);
 		force_button.disable(false);
 		target_force.disable(true);
 		target_position.disable(true);
-		motor->set_mode(Actuator::SleepMode);
+		if (was_connected) commands->post_set_mode(Actuator::SleepMode);		// once, rather than filling the queue every run
 	}
+	was_connected = connected;
 
 	*force_target = target_force.get();
 	*position_target = target_position.get();
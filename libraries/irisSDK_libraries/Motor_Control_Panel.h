@@ -28,13 +28,21 @@
 #include "../ic4_library/iriscontrols4.h"
 #include "../ic4_library/ic_app.h"
 #include "../modbus_client/device_applications/actuator.h"
+#include "../modbus_client/device_applications/actuator_command_queue.h"
 #include "device_config.h"
 #include <string>
 
 
+/**
+	@brief Buttons and sliders controlling one motor. The panel runs on the GUI thread, so it never calls the Actuator's setters:
+	mode changes, enabling, zeroing and clearing errors are posted to an ActuatorCommandQueue which the thread running the
+	Actuator drains each cycle.
+*/
 class Motor_Control {
 
 	Actuator* motor;
+	ActuatorCommandQueue* commands;		// drained by the thread running motor
+	bool was_connected = false;
 	
 	// GUI_Page object to handle hiding/displaying all panel elements
 	GUI_Page* ctrl_elements;
@@ -52,7 +60,7 @@ public:
     void show();
 	void hide();
 	void run();
-	void add(Actuator* _motor, int32_t* _f_target, int32_t* _p_target, uint16_t _anchor_row, uint16_t _anchor_col);
-	void add(GUI_Page* _ctrl_elements, Actuator* _motor, int32_t* _f_target, int32_t* _p_target,  uint16_t _anchor_row, uint16_t _anchor_col);
+	void add(Actuator* _motor, ActuatorCommandQueue* _commands, int32_t* _f_target, int32_t* _p_target, uint16_t _anchor_row, uint16_t _anchor_col);
+	void add(GUI_Page* _ctrl_elements, Actuator* _motor, ActuatorCommandQueue* _commands, int32_t* _f_target, int32_t* _p_target,  uint16_t _anchor_row, uint16_t _anchor_col);
 
 };
\ No newline at end of file
@@ -165,15 +165,20 @@ void Motor_Plot::run() {
         break;
 
     case reading:
-        logfile.write("Index\tValue");
-        motor->read_holding_registers_fn(1, 0, ORCA_REG_SIZE);
+        logfile.write("Index\tName\tValue\tUnits");
+        for (int i = 0; i < ORCA_REG_SIZE; i += MAX_NUM_READ_REG) {     // a single read is limited to MAX_NUM_READ_REG registers
+            motor->read_registers(i, ORCA_REG_SIZE - i < MAX_NUM_READ_REG ? ORCA_REG_SIZE - i : MAX_NUM_READ_REG);
+        }
         log_state = writing;
         break;
     case writing:
         for (int i = 0; i < ORCA_REG_SIZE; i++) {
-            //write_string = (String(i).concat("\t").concat(String(motor->get_orca_reg_content(i))));
-            //write_string = String(32);
-            logfile.write((String(i).concat("\t").concat(String(motor->get_orca_reg_content(i)))).c_str());
+            const Orca600RegDescriptor* descriptor = orca600_reg_descriptor(i);
+            if (!descriptor || descriptor->upper_half) continue;       // unnamed, or logged with its lower half
+            std::string line = String(i).concat("\t").concat(descriptor->name);
+            if (descriptor->length > 2) line.concat("[").concat(String(i - descriptor->address)).concat("]");
+            line.concat("\t").concat(String(motor->get_orca_reg_value(i))).concat("\t").concat(descriptor->units);
+            logfile.write(line.c_str());
             IC4_virtual->flush();
         }
 
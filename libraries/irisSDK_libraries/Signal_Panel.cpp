@@ -139,7 +139,7 @@ void Signal_Panel::run() {
 	// If slider value changed, update displayed panel fields
 	if(slider_change()) update_panel_fields(signal_slider.get());
 
-	// If pause button was pressed, put motor into sleep mode
+	// If pause button was pressed, stop generating the signal
 	if( pause_signal_btn.pressed() ){
 		pause();
 	}
@@ -0,0 +1,739 @@
+/**
+ * @file bus_analyzer.h
+ *
+ * @brief  Decodes a timestamped capture of a Modbus RTU line into frames and reports errors, timing and bus utilisation
+ *
+ * @version 2.2.0
+
+    @copyright Copyright 2022 Iris Dynamics Ltd
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+    For questions or feedback on this file, please email <support@irisdynamics.com>.
+ */
+
+#ifndef BUS_ANALYZER_H_
+#define BUS_ANALYZER_H_
+
+#include <algorithm>
+#include <map>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "bus_recorder.h"
+#include "function_code_parameters.h"
+#include "mb_crc.h"
+
+/**
+ * @class BusAnalyzer
+ * @brief Offline protocol analyzer for a single client, single server RTU line.
+ *
+ * Bytes are fed in capture order with their time and, when known, their direction. They are cut into frames at
+ * direction changes and at silences longer than 3.5 characters. Without a direction, frames are also cut at the
+ * lengths the client's applications expect, and a frame is taken to be the response to the pending request when its
+ * address and function code match. Requests are paired with their responses and checked for CRC errors, exceptions,
+ * timeouts, wrong responders and unexpected lengths.
+ *
+ * Function codes 65 (change connection status) and 100, 104, 105 (Actuator stream frames) are decoded as well as the
+ * standard codes. A valid change connection status response switches the assumed baud rate to the one the server realized,
+ * as the client does, so wire times stay accurate after the handshake.
+ *
+ * Usage:
+ *  BusAnalyzer analyzer(reg_names, sizeof(reg_names) / sizeof(reg_names[0]));
+ *  analyzer.set_frame_log(stdout);
+ *  analyzer.load_recording("incident.irbr");
+ *  analyzer.print_report(stdout);
+ */
+class BusAnalyzer {
+
+public:
+
+	enum DIRECTION {
+		TX,			// client to server
+		RX,			// server to client
+		UNKNOWN
+	};
+
+	enum EXCHANGE_STATUS {
+		ok,
+		response_timeout,
+		crc_error,
+		exception,
+		wrong_responder,
+		bad_length,
+		truncated,			// response ended by an interchar timeout
+		request_crc_error,
+		broadcast,			// no response expected
+		NUM_STATUS
+	};
+
+	/**
+	 * @param _register_names	names indexed by register address, eg. orca600_api reg_names. Empty names are shown as numbers.
+	 * @param _num_register_names	number of entries in _register_names
+	 * @param baud_rate_bps		baud rate at the start of the capture; the Modbus default until a handshake changes it
+	 */
+	BusAnalyzer(const char* const* _register_names, int _num_register_names, uint32_t baud_rate_bps = 19200) :
+		register_names(_register_names),
+		num_register_names(_num_register_names),
+		baud_bps(baud_rate_bps),
+		initial_baud_bps(baud_rate_bps)
+	{}
+
+	/**
+	 * @brief Print each exchange to this file as it is decoded. 0 to print nothing.
+	 */
+	void set_frame_log(FILE* file) {
+		frame_log = file;
+	}
+
+	/**
+	 * @brief Requests with no response after this long are considered timed out when the capture has no timeout markers
+	 */
+	void set_response_timeout_us(double timeout_us) {
+		response_timeout_us = timeout_us;
+	}
+
+	/**
+	 * @brief Add one captured byte
+	 * @param time_us capture time of the byte, non-decreasing
+	 * @param direction TX, RX or UNKNOWN
+	 * @param frame_start true if the capture marks this byte as the start of a frame
+	 */
+	void add_byte(double time_us, uint8_t data, int direction, bool frame_start = false) {
+		if (!started) {
+			first_us = time_us;
+			started = true;
+		}
+		last_us = std::max(last_us, time_us);
+		expire_pending(time_us);
+
+		if (!current.bytes.empty()) {
+			bool split = frame_start
+				|| (direction != UNKNOWN && current.direction != UNKNOWN && direction != current.direction)
+				|| time_us - current.end_us > 3.5 * char_us();
+			if (split) close_frame();
+		}
+		if (current.bytes.empty()) {
+			current.start_us = time_us;
+			current.direction = direction;
+			current.baud_bps = baud_bps;
+			current.truncated = false;
+		}
+		current.bytes.push_back(data);
+		current.end_us = time_us;
+
+		if (direction == UNKNOWN) {
+			int length = expected_length(current);
+			if (length > 0 && (int)current.bytes.size() >= length) close_frame();
+		}
+	}
+
+	/**
+	 * @brief The capture marks the pending request as having received no response
+	 */
+	void add_response_timeout(double time_us) {
+		close_frame();
+		if (has_pending) finish_exchange(0, false);
+	}
+
+	/**
+	 * @brief The capture marks the response being received as ended by an interchar timeout
+	 */
+	void add_interchar_timeout(double time_us) {
+		current.truncated = true;
+		close_frame();
+	}
+
+	/**
+	 * @brief Decode whatever is left at the end of the capture
+	 */
+	void finish() {
+		close_frame();
+		if (has_pending) finish_exchange(0, false);
+	}
+
+	/**
+	 * @brief Analyze a BusRecorder recording. Times are converted using the recorded cycles per microsecond.
+	 * @return false if the file is missing or isn't a recording
+	 */
+	bool load_recording(const char* path) {
+		FILE* file = fopen(path, "rb");
+		if (!file) return false;
+		uint8_t header[BUS_RECORDING_HEADER_SIZE];
+		bool valid = fread(header, 1, sizeof(header), file) == sizeof(header)
+			&& memcmp(header, BUS_RECORDING_MAGIC, 4) == 0
+			&& BusRecorder::get_u16(header + 4) == BUS_RECORDING_VERSION
+			&& BusRecorder::get_u16(header + 6) == BUS_RECORDING_EVENT_SIZE;
+		if (valid) {
+			double cycles_per_us = BusRecorder::get_u32(header + 8);
+			if (cycles_per_us == 0) cycles_per_us = 1;
+			uint8_t in[BUS_RECORDING_EVENT_SIZE];
+			bool first = true;
+			uint32_t previous = 0;
+			uint64_t elapsed = 0;		// system cycles wrap, so accumulate differences
+			while (fread(in, 1, sizeof(in), file) == sizeof(in)) {
+				uint32_t cycles = BusRecorder::get_u32(in);
+				if (!first) elapsed += uint32_t(cycles - previous);
+				previous = cycles;
+				first = false;
+				double time_us = elapsed / cycles_per_us;
+				uint8_t flags = in[5];
+				if (flags & BusTap::RESPONSE_TIMEOUT) add_response_timeout(time_us);
+				else if (flags & BusTap::INTERCHAR_TIMEOUT) add_interchar_timeout(time_us);
+				else add_byte(time_us, in[4], (flags & BusTap::RX) ? RX : TX, (flags & BusTap::FRAME_START) != 0);
+			}
+			finish();
+		}
+		fclose(file);
+		return valid;
+	}
+
+	/**
+	 * @brief Analyze a text capture, eg. from a pty or serial tap. Each line holds a time in microseconds,
+	 * an optional direction and one or more hex bytes captured at that time:
+	 *  "1520.5 tx 01 64 1C 00 00 03 E8 xx xx"
+	 *  "1521.0 C4"
+	 * A line holding a time and "timeout" marks a response timeout. Blank lines and lines starting with # are ignored.
+	 * Without a direction, requests and responses are told apart by their contents.
+	 * @return false if the file is missing
+	 */
+	bool load_text_capture(const char* path) {
+		FILE* file = fopen(path, "r");
+		if (!file) return false;
+		char line[4096];
+		while (fgets(line, sizeof(line), file)) {
+			char* token = strtok(line, " \t\r\n,");
+			if (!token || token[0] == '#') continue;
+			double time_us = atof(token);
+			int direction = UNKNOWN;
+			while ((token = strtok(0, " \t\r\n,")) != 0) {
+				if (strcmp(token, "tx") == 0 || strcmp(token, "TX") == 0) direction = TX;
+				else if (strcmp(token, "rx") == 0 || strcmp(token, "RX") == 0) direction = RX;
+				else if (strcmp(token, "timeout") == 0) add_response_timeout(time_us);
+				else add_byte(time_us, uint8_t(strtoul(token, 0, 16)), direction);
+			}
+		}
+		finish();
+		fclose(file);
+		return true;
+	}
+
+	/**
+	 * @brief Print the summary of everything analyzed so far
+	 */
+	void print_report(FILE* out) {
+		double duration_us = last_us - first_us;
+		fprintf(out, "\n==== Bus report ====\n");
+		fprintf(out, "Capture:          %.6f s, %llu bytes, %u exchanges\n", duration_us / 1e6, (unsigned long long)total_bytes, total_exchanges);
+		fprintf(out, "Baud:             %u bps at start", (unsigned)initial_baud_bps);
+		for (size_t i = 0; i < baud_changes.size(); i++) {
+			fprintf(out, ", %u bps from %.6f s", (unsigned)baud_changes[i].second, (baud_changes[i].first - first_us) / 1e6);
+		}
+		fprintf(out, "\n");
+		if (duration_us > 0) {
+			fprintf(out, "Utilisation:      %.1f %% (%.6f s of wire time)\n", 100 * busy_us / duration_us, busy_us / 1e6);
+		}
+		if (stream_frames > 1 && last_stream_us > first_stream_us) {
+			double span_us = last_stream_us - first_stream_us;
+			fprintf(out, "Stream:           %u frames (fn 100/104/105), %.1f Hz, %.1f %% utilisation while streaming\n",
+				stream_frames, (stream_frames - 1) * 1e6 / span_us, 100 * stream_busy_us / span_us);
+		}
+
+		fprintf(out, "\n%-28s %8s %8s %8s %8s %8s %8s %12s %12s\n",
+			"function code", "count", "ok", "timeout", "crc", "except", "other", "turn avg us", "turn max us");
+		for (std::map<int, FunctionStats>::iterator it = function_stats.begin(); it != function_stats.end(); it++) {
+			FunctionStats& s = it->second;
+			char name[40];
+			snprintf(name, sizeof(name), "%3d %s", it->first, function_name(uint8_t(it->first)));
+			uint32_t other = s.count - s.by_status[ok] - s.by_status[response_timeout] - s.by_status[crc_error] - s.by_status[exception];
+			fprintf(out, "%-28s %8u %8u %8u %8u %8u %8u %12.1f %12.1f\n", name, s.count, s.by_status[ok], s.by_status[response_timeout],
+				s.by_status[crc_error], s.by_status[exception], other,
+				s.turnarounds ? s.turnaround_sum_us / s.turnarounds : 0.0, s.turnaround_max_us);
+		}
+
+		fprintf(out, "\n%-28s %10s %10s %10s %10s %10s\n", "(us)", "min", "mean", "median", "p99", "max");
+		print_distribution(out, "turnaround", turnarounds_us);
+		print_distribution(out, "idle gap before request", idle_gaps_us);
+		print_distribution(out, "exchange period", periods_us);
+
+		fprintf(out, "\nErrors:\n");
+		const char* status_names[NUM_STATUS] = { "ok", "response timeouts", "CRC errors", "exceptions", "wrong responder",
+			"unexpected length", "interchar timeouts", "request CRC errors", "broadcasts" };
+		for (int i = response_timeout; i < NUM_STATUS; i++) {
+			if (i == broadcast) continue;
+			fprintf(out, "  %-28s %u\n", status_names[i], status_counts[i]);
+		}
+		for (std::map<int, uint32_t>::iterator it = exception_codes.begin(); it != exception_codes.end(); it++) {
+			char name[48];
+			snprintf(name, sizeof(name), "exception %d %s", it->first, exception_name(uint8_t(it->first)));
+			fprintf(out, "    %-26s %u\n", name, it->second);
+		}
+		fprintf(out, "  %-28s %u\n", "responses with no request", orphan_responses);
+	}
+
+	uint32_t get_exchange_count() { return total_exchanges; }
+	uint32_t get_status_count(int status) { return status < NUM_STATUS ? status_counts[status] : 0; }
+	uint32_t get_stream_frame_count() { return stream_frames; }
+	double get_busy_us() { return busy_us; }
+
+private:
+
+	struct Frame {
+		std::vector<uint8_t> bytes;
+		double start_us = 0;
+		double end_us = 0;
+		int direction = UNKNOWN;
+		uint32_t baud_bps = 0;
+		bool truncated = false;
+	};
+
+	struct FunctionStats {
+		uint32_t count = 0;
+		uint32_t by_status[NUM_STATUS] = { 0 };
+		uint32_t turnarounds = 0;
+		double turnaround_sum_us = 0;
+		double turnaround_max_us = 0;
+	};
+
+	const char* const* register_names;
+	int num_register_names;
+	uint32_t baud_bps;
+	uint32_t initial_baud_bps;
+	FILE* frame_log = 0;
+	double response_timeout_us = 50000;
+
+	Frame current;
+	Frame pending;
+	bool has_pending = false;
+
+	bool started = false;
+	double first_us = 0;
+	double last_us = 0;
+	double last_frame_end_us = -1;			// wire end of the previous frame
+	double last_request_start_us = -1;
+	double busy_us = 0;
+	uint64_t total_bytes = 0;
+	uint32_t total_exchanges = 0;
+	uint32_t orphan_responses = 0;
+	uint32_t status_counts[NUM_STATUS] = { 0 };
+	std::map<int, FunctionStats> function_stats;
+	std::map<int, uint32_t> exception_codes;
+	std::vector<double> turnarounds_us;
+	std::vector<double> idle_gaps_us;
+	std::vector<double> periods_us;
+	std::vector<std::pair<double, uint32_t>> baud_changes;
+
+	uint32_t stream_frames = 0;
+	double first_stream_us = 0;
+	double last_stream_us = 0;
+	double stream_busy_us = 0;
+
+	/// @brief duration of one character at the current baud; 11 bits with the parity bit
+	double char_us() {
+		return 11e6 / baud_bps;
+	}
+
+	/// @brief time the frame's last bit left the wire. Captured times may all be the time the frame was written.
+	static double wire_end_us(const Frame& frame) {
+		return std::max(frame.end_us, frame.start_us + frame.bytes.size() * 11e6 / frame.baud_bps);
+	}
+
+	static uint16_t get_u16(const uint8_t* data) {
+		return (uint16_t(data[0]) << 8) | data[1];
+	}
+
+	static int32_t get_i32(const uint8_t* data) {
+		return int32_t((uint32_t(data[0]) << 24) | (uint32_t(data[1]) << 16) | (uint32_t(data[2]) << 8) | data[3]);
+	}
+
+	static bool crc_valid(std::vector<uint8_t>& bytes) {
+		if (bytes.size() < 4) return false;
+		uint16_t crc = ModbusCRC::generate(&bytes[0], int(bytes.size()) - 2);
+		return bytes[bytes.size() - 2] == uint8_t(crc >> 8) && bytes[bytes.size() - 1] == uint8_t(crc);
+	}
+
+	/**
+	 * @brief true if a frame with no direction is the response to the pending request
+	 */
+	bool is_response(const Frame& frame) {
+		if (frame.direction != UNKNOWN) return frame.direction == RX;
+		if (!has_pending || frame.bytes.size() < 2) return has_pending;
+		uint8_t fn = pending.bytes[1];
+		return frame.bytes[0] == pending.bytes[0] && (frame.bytes[1] == fn || frame.bytes[1] == (fn | 0x80));
+	}
+
+	/**
+	 * @brief Length of a complete frame, known from its first bytes, or -1 if it can't be known yet
+	 */
+	int expected_length(const Frame& frame) {
+		if (frame.bytes.size() < 2) return -1;
+		if (is_response(frame)) {
+			if (frame.bytes[1] & 0x80) return 5;
+			return response_length(pending.bytes);
+		}
+		return request_length(frame.bytes);
+	}
+
+	/**
+	 * @brief Request lengths, as formatted by ModbusClientApplication, IrisClientApplication and Actuator
+	 */
+	static int request_length(const std::vector<uint8_t>& bytes) {
+		if (bytes.size() < 2) return -1;
+		switch (bytes[1]) {
+		case 0x01: case 0x02: case 0x03: case 0x04: case 0x05: case 0x06:
+			return 8;
+		case 0x07: case 0x0B: case 0x0C: case 0x11:
+			return 4;
+		case 0x0F: case 0x10:
+			return bytes.size() > 6 ? 9 + bytes[6] : -1;
+		case 0x16:
+			return 10;
+		case 0x17:
+			return bytes.size() > 10 ? 13 + bytes[10] : -1;
+		case 65:
+			return 12;
+		case 100:
+			return 9;
+		case 104:
+			return 7;
+		case 105:
+			return 11;
+		default:
+			return -1;		// eg. diagnostics, whose data is echoed
+		}
+	}
+
+	/**
+	 * @brief Response lengths for a request, matching the reception lengths the client expects
+	 */
+	static int response_length(const std::vector<uint8_t>& request) {
+		if (request.size() < 2) return -1;
+		const uint8_t* data = request.size() >= 6 ? &request[2] : 0;
+		switch (request[1]) {
+		case 0x01: case 0x02: {
+			if (!data) return -1;
+			uint16_t num = get_u16(data + 2);
+			return 5 + (num + 7) / 8;
+		}
+		case 0x03: case 0x04:
+			return data ? 5 + 2 * get_u16(data + 2) : -1;
+		case 0x05: case 0x06: case 0x0F: case 0x10:
+		case 0x0B:
+			return WRITE_OR_GET_COUNTER_RESPONSE_LEN;
+		case 0x07:
+			return READ_EXCEPTION_STATUS_LEN;
+		case 0x08:
+			return int(request.size());
+		case 0x16:
+			return int(request.size());
+		case 0x17:
+			return data ? 5 + 2 * get_u16(data + 2) : -1;
+		case 65:
+			return CHANGE_CONNECTION_STATUS_RESPONSE_LEN;
+		case 100:
+			return MOTOR_COMMAND_RESPONSE_LEN;
+		case 104:
+			return MOTOR_READ_RESPONSE_LEN;
+		case 105:
+			return MOTOR_WRITE_RESPONSE_LEN;
+		default:
+			return -1;
+		}
+	}
+
+	static const char* function_name(uint8_t fn) {
+		switch (fn) {
+		case 0x01: return "read_coils";
+		case 0x02: return "read_discrete_inputs";
+		case 0x03: return "read_holding_registers";
+		case 0x04: return "read_input_registers";
+		case 0x05: return "write_single_coil";
+		case 0x06: return "write_single_register";
+		case 0x07: return "read_exception_status";
+		case 0x08: return "diagnostics";
+		case 0x0B: return "get_comm_event_counter";
+		case 0x0C: return "get_comm_event_log";
+		case 0x0F: return "write_multiple_coils";
+		case 0x10: return "write_multiple_registers";
+		case 0x11: return "report_server_id";
+		case 0x16: return "mask_write_register";
+		case 0x17: return "read_write_multiple_regs";
+		case 65:   return "change_connection_status";
+		case 100:  return "motor_command";
+		case 104:  return "motor_read";
+		case 105:  return "motor_write";
+		default:   return "unknown";
+		}
+	}
+
+	static const char* exception_name(uint8_t code) {
+		switch (code) {
+		case 1: return "(illegal function)";
+		case 2: return "(illegal data address)";
+		case 3: return "(illegal data value)";
+		case 4: return "(server device failure)";
+		case 5: return "(acknowledge)";
+		case 6: return "(server device busy)";
+		default: return "";
+		}
+	}
+
+	/**
+	 * @brief Writes a register's name, or its address if it has none
+	 */
+	void register_name(char* out, size_t size, uint16_t address) {
+		const char* name = 0;
+		if (address < num_register_names && register_names && register_names[address][0]) name = register_names[address];
+		else if (address == 65532) name = "MB_BAUD_HIGH";
+		else if (address == 65533) name = "MB_BAUD_LOW";
+		else if (address == 65534) name = "MB_DELAY";
+		else if (address == 65535) name = "MB_SERVER_ID";
+		if (name) snprintf(out, size, "%s", name);
+		else snprintf(out, size, "reg %u", (unsigned)address);
+	}
+
+	/**
+	 * @brief One line describing a request
+	 */
+	void describe_request(char* out, size_t size, const std::vector<uint8_t>& bytes) {
+		char reg[48];
+		const uint8_t* data = &bytes[2];
+		int num_data = int(bytes.size()) - 4;
+		uint8_t fn = bytes[1];
+		int n = snprintf(out, size, "a%-3u %-24s", (unsigned)bytes[0], function_name(fn));
+		out += n; size -= n;
+		switch (fn) {
+		case 0x03: case 0x04:
+			if (num_data < 4) break;
+			register_name(reg, sizeof(reg), get_u16(data));
+			snprintf(out, size, " %s x%u", reg, (unsigned)get_u16(data + 2));
+			break;
+		case 0x06:
+			if (num_data < 4) break;
+			register_name(reg, sizeof(reg), get_u16(data));
+			snprintf(out, size, " %s = %u", reg, (unsigned)get_u16(data + 2));
+			break;
+		case 0x10:
+			if (num_data < 4) break;
+			register_name(reg, sizeof(reg), get_u16(data));
+			snprintf(out, size, " %s x%u", reg, (unsigned)get_u16(data + 2));
+			break;
+		case 65:
+			if (num_data < 8) break;
+			snprintf(out, size, " %s %u bps delay %u us", get_u16(data) ? "connect" : "disconnect",
+				(unsigned)uint32_t(get_i32(data + 2)), (unsigned)get_u16(data + 6));
+			break;
+		case 100:
+			if (num_data < 5) break;
+			switch (data[0]) {
+			case 28:	snprintf(out, size, " force %d mN", (int)get_i32(data + 1));		break;	// FORCE_CMD
+			case 30:	snprintf(out, size, " position %d um", (int)get_i32(data + 1));	break;	// POS_CMD
+			case 32:	snprintf(out, size, " kinematic");								break;	// KIN_CMD
+			case 34:	snprintf(out, size, " haptic");									break;	// HAP_CMD
+			default:	snprintf(out, size, " sleep (code %u)", (unsigned)data[0]);		break;
+			}
+			break;
+		case 104:
+			if (num_data < 3) break;
+			register_name(reg, sizeof(reg), get_u16(data));
+			snprintf(out, size, " %s width %u", reg, (unsigned)data[2]);
+			break;
+		case 105:
+			if (num_data < 7) break;
+			register_name(reg, sizeof(reg), get_u16(data));
+			snprintf(out, size, " %s width %u = %d", reg, (unsigned)data[2], (int)get_i32(data + 3));
+			break;
+		default:
+			break;
+		}
+	}
+
+	/**
+	 * @brief One line describing a valid response's contents
+	 * Only a response to the request's own function code, long enough for every value described, is described; a
+	 * read response's byte count is trusted only as far as the bytes the frame carries.
+	 */
+	void describe_response(char* out, size_t size, const std::vector<uint8_t>& request, const std::vector<uint8_t>& response) {
+		out[0] = 0;
+		if (request.size() < 2 || response.size() < 2 || response[1] != request[1]) return;
+		int minimum_length;
+		switch (response[1]) {
+		case 0x03: case 0x04:	minimum_length = 5;										break;
+		case 65:				minimum_length = CHANGE_CONNECTION_STATUS_RESPONSE_LEN;	break;
+		case 100:				minimum_length = MOTOR_COMMAND_RESPONSE_LEN;			break;
+		case 104:				minimum_length = MOTOR_READ_RESPONSE_LEN;				break;
+		case 105:				minimum_length = MOTOR_WRITE_RESPONSE_LEN;				break;
+		default:				return;
+		}
+		if ((int)response.size() < minimum_length) return;
+
+		const uint8_t* data = &response[2];
+		switch (response[1]) {
+		case 0x03: case 0x04: {
+			int count = std::min<int>(response[2] / 2, int(response.size() - 5) / 2);
+			int n = 0;
+			for (int i = 0; i < count && i < 4 && n < (int)size; i++) n += snprintf(out + n, size - n, " %u", (unsigned)get_u16(data + 1 + 2 * i));
+			if (count > 4 && n < (int)size) snprintf(out + n, size - n, " ...");
+			break;
+		}
+		case 65:
+			snprintf(out, size, " realized %u bps delay %u us", (unsigned)uint32_t(get_i32(data + 2)), (unsigned)get_u16(data + 6));
+			break;
+		case 100:
+			snprintf(out, size, " pos %d um force %d mN errors 0x%04X", (int)get_i32(data), (int)get_i32(data + 4), (unsigned)get_u16(data + 13));
+			break;
+		case 104:
+			snprintf(out, size, " value %d mode %u pos %d um force %d mN errors 0x%04X", (int)get_i32(data), (unsigned)data[4],
+				(int)get_i32(data + 5), (int)get_i32(data + 9), (unsigned)get_u16(data + 18));
+			break;
+		case 105:
+			snprintf(out, size, " mode %u pos %d um force %d mN errors 0x%04X", (unsigned)data[0],
+				(int)get_i32(data + 1), (int)get_i32(data + 5), (unsigned)get_u16(data + 14));
+			break;
+		default:
+			break;
+		}
+	}
+
+	/**
+	 * @brief Without timeout markers, a request is abandoned once the response timeout has passed
+	 */
+	void expire_pending(double time_us) {
+		if (has_pending && current.bytes.empty() && time_us - wire_end_us(pending) > response_timeout_us) {
+			finish_exchange(0, false);
+		}
+	}
+
+	/**
+	 * @brief Classify the frame being collected as a request or response
+	 */
+	void close_frame() {
+		if (current.bytes.empty()) return;
+		Frame frame;
+		std::swap(frame, current);
+
+		double wire_us = frame.bytes.size() * 11e6 / frame.baud_bps;
+		busy_us += wire_us;
+		total_bytes += frame.bytes.size();
+		if (stream_frames) stream_busy_us += wire_us;
+
+		if (is_response(frame)) {
+			if (!has_pending) {
+				orphan_responses++;
+				if (frame_log) fprintf(frame_log, "%14.1f  response with no request, %u bytes\n", frame.start_us - first_us, (unsigned)frame.bytes.size());
+			}
+			else {
+				finish_exchange(&frame, true);
+			}
+		}
+		else {
+			if (has_pending) finish_exchange(0, false);
+			if (last_frame_end_us >= 0) idle_gaps_us.push_back(std::max(0.0, frame.start_us - last_frame_end_us));
+			if (last_request_start_us >= 0) periods_us.push_back(frame.start_us - last_request_start_us);
+			last_request_start_us = frame.start_us;
+			pending = frame;
+			has_pending = true;
+		}
+		last_frame_end_us = wire_end_us(frame);
+	}
+
+	/**
+	 * @brief Check the pending request against its response, or lack of one, and record the result
+	 */
+	void finish_exchange(Frame* response, bool has_response) {
+		has_pending = false;
+		Frame& request = pending;
+		if (request.bytes.size() < 2) return;
+		uint8_t fn = request.bytes[1];
+
+		int status = ok;
+		double turnaround_us = -1;
+		if (!crc_valid(request.bytes)) status = request_crc_error;
+		else if (!has_response) status = request.bytes[0] == 0 ? broadcast : response_timeout;
+		else {
+			double request_end_us = wire_end_us(request);
+			if (request_end_us > response->start_us) request_end_us = request.end_us;	// the capture's clock is coarser than the wire
+			turnaround_us = std::max(0.0, response->start_us - request_end_us);
+			int length = response_length(request.bytes);
+			std::vector<uint8_t>& rx = response->bytes;
+			if (rx.size() >= 1 && rx[0] != request.bytes[0]) status = wrong_responder;
+			else if (response->truncated && length != -1) status = truncated;
+			else if (!crc_valid(rx)) status = crc_error;
+			else if (rx[1] == (fn | 0x80)) {
+				status = exception;
+				exception_codes[rx[2]]++;
+			}
+			else if (length != -1 && (int)rx.size() != length) status = bad_length;
+		}
+
+		total_exchanges++;
+		status_counts[status]++;
+		FunctionStats& stats = function_stats[fn];
+		stats.count++;
+		stats.by_status[status]++;
+		if (turnaround_us >= 0) {
+			turnarounds_us.push_back(turnaround_us);
+			stats.turnarounds++;
+			stats.turnaround_sum_us += turnaround_us;
+			stats.turnaround_max_us = std::max(stats.turnaround_max_us, turnaround_us);
+		}
+
+		if (status == ok && (fn == 100 || fn == 104 || fn == 105)) {
+			if (!stream_frames) first_stream_us = request.start_us;
+			last_stream_us = request.start_us;
+			stream_frames++;
+		}
+
+		if (frame_log) {
+			char description[160];
+			describe_request(description, sizeof(description), request.bytes);
+			const char* status_names[NUM_STATUS] = { "ok", "TIMEOUT", "CRC ERROR", "EXCEPTION", "WRONG RESPONDER",
+				"BAD LENGTH", "TRUNCATED", "REQUEST CRC ERROR", "broadcast" };
+			fprintf(frame_log, "%14.1f  %-60s -> %s", request.start_us - first_us, description, status_names[status]);
+			if (has_response) {
+				fprintf(frame_log, " %uB turnaround %.1f us", (unsigned)response->bytes.size(), turnaround_us);
+				if (status == exception) fprintf(frame_log, " code %u %s", (unsigned)response->bytes[2], exception_name(response->bytes[2]));
+				if (status == ok) {
+					char contents[160];
+					describe_response(contents, sizeof(contents), request.bytes, response->bytes);
+					fprintf(frame_log, "%s", contents);
+				}
+			}
+			fprintf(frame_log, "\n");
+		}
+
+		// the client switches to the server's realized baud rate when the handshake completes
+		if (status == ok && fn == 65 && response->bytes.size() >= 8) {
+			uint32_t realized = uint32_t(get_i32(&response->bytes[4]));
+			if (realized && realized != baud_bps) {
+				baud_bps = realized;
+				baud_changes.push_back(std::make_pair(response->end_us, realized));
+			}
+		}
+	}
+
+	static void print_distribution(FILE* out, const char* name, std::vector<double>& values) {
+		if (values.empty()) {
+			fprintf(out, "%-28s %10s\n", name, "-");
+			return;
+		}
+		std::vector<double> sorted(values);
+		std::sort(sorted.begin(), sorted.end());
+		double sum = 0;
+		for (size_t i = 0; i < sorted.size(); i++) sum += sorted[i];
+		fprintf(out, "%-28s %10.1f %10.1f %10.1f %10.1f %10.1f\n", name, sorted.front(), sum / sorted.size(),
+			sorted[sorted.size() / 2], sorted[std::min(sorted.size() - 1, sorted.size() * 99 / 100)], sorted.back());
+	}
+};
+
+#endif
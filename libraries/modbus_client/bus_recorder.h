@@ -0,0 +1,195 @@
+/**
+ * @file bus_recorder.h
+ *
+ * @brief  Records the byte level traffic of a ModbusClient to a compact binary file
+ *
+ * @version 2.2.0
+
+    @copyright Copyright 2022 Iris Dynamics Ltd
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+    For questions or feedback on this file, please email <support@irisdynamics.com>.
+ */
+
+#ifndef BUS_RECORDER_H_
+#define BUS_RECORDER_H_
+
+#include <atomic>
+#include <stdio.h>
+#include <string.h>
+#include "bus_tap.h"
+
+/**
+ * Recording file layout, all values little endian:
+ *  header (16 bytes): "IRBR", u16 version, u16 event size, u32 cycles per microsecond, u32 reserved
+ *  events (6 bytes each): u32 system cycles, u8 data, u8 BusTap::EVENT_FLAGS
+ */
+#define BUS_RECORDING_MAGIC		"IRBR"
+#define BUS_RECORDING_VERSION	1
+#define BUS_RECORDING_HEADER_SIZE	16
+#define BUS_RECORDING_EVENT_SIZE	6
+
+/**
+ * @brief One recorded bus event
+ */
+struct BusEvent {
+	uint32_t cycles;
+	uint8_t data;
+	uint8_t flags;
+};
+
+/**
+ * @class BusRecorder
+ * @brief A BusTap which stores events in a preallocated ring, to be written to a file by flush().
+ *
+ * on_bus_event() is called by the thread running the client and never allocates, blocks or touches the file.
+ * flush() may be called from that thread between cycles or from one other thread, eg. a logging thread.
+ * If flush() falls behind and the ring fills, new events are dropped and counted.
+ *
+ * Usage:
+ *  recorder.open("incident.irbr");
+ *  actuator.modbus_client.set_bus_tap(&recorder);
+ *  ... periodically recorder.flush();
+ */
+class BusRecorder : public BusTap {
+
+public:
+
+	static const uint32_t RING_SIZE = 16384;		// events; must be a power of 2
+
+	BusRecorder(uint32_t cycles_per_us) :
+		my_cycles_per_us(cycles_per_us)
+	{}
+
+	~BusRecorder() {
+		close();
+	}
+
+	/**
+	 * @brief Create the recording file and write its header. Events recorded before this are discarded.
+	 * @return false if the file couldn't be created
+	 */
+	bool open(const char* path) {
+		close();
+		file = fopen(path, "wb");
+		if (!file) return false;
+
+		uint8_t header[BUS_RECORDING_HEADER_SIZE] = { 0 };
+		memcpy(header, BUS_RECORDING_MAGIC, 4);
+		put_u16(header + 4, BUS_RECORDING_VERSION);
+		put_u16(header + 6, BUS_RECORDING_EVENT_SIZE);
+		put_u32(header + 8, my_cycles_per_us);
+		fwrite(header, 1, sizeof(header), file);
+
+		read_index.store(write_index.load(std::memory_order_acquire), std::memory_order_release);
+		recording.store(true, std::memory_order_release);
+		return true;
+	}
+
+	/**
+	 * @brief Stop recording, write out any events still in the ring and close the file
+	 */
+	void close() {
+		recording.store(false, std::memory_order_release);
+		if (file) {
+			flush();
+			fclose(file);
+			file = 0;
+		}
+	}
+
+	bool is_recording() {
+		return recording.load(std::memory_order_relaxed);
+	}
+
+	void on_bus_event(uint8_t data, uint8_t flags, uint32_t cycles) override {
+		if (!recording.load(std::memory_order_relaxed)) return;
+		uint32_t head = write_index.load(std::memory_order_relaxed);
+		if (head - read_index.load(std::memory_order_acquire) >= RING_SIZE) {
+			dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		BusEvent& event = ring[head & (RING_SIZE - 1)];
+		event.cycles = cycles;
+		event.data = data;
+		event.flags = flags;
+		write_index.store(head + 1, std::memory_order_release);
+	}
+
+	/**
+	 * @brief Write all events recorded so far to the file
+	 * @return the number of events written
+	 */
+	int flush() {
+		if (!file) return 0;
+		uint8_t block[256 * BUS_RECORDING_EVENT_SIZE];
+		int written = 0;
+		for (;;) {
+			uint32_t tail = read_index.load(std::memory_order_relaxed);
+			uint32_t head = write_index.load(std::memory_order_acquire);
+			uint32_t n = head - tail;
+			if (n == 0) break;
+			if (n > 256) n = 256;
+			for (uint32_t i = 0; i < n; i++) {
+				BusEvent& event = ring[(tail + i) & (RING_SIZE - 1)];
+				uint8_t* out = block + i * BUS_RECORDING_EVENT_SIZE;
+				put_u32(out, event.cycles);
+				out[4] = event.data;
+				out[5] = event.flags;
+			}
+			read_index.store(tail + n, std::memory_order_release);
+			fwrite(block, BUS_RECORDING_EVENT_SIZE, n, file);
+			written += n;
+		}
+		fflush(file);
+		return written;
+	}
+
+	/// @brief Number of events lost because the ring was full
+	uint32_t get_dropped_count() {
+		return dropped.load(std::memory_order_relaxed);
+	}
+
+	static void put_u16(uint8_t* out, uint16_t value) {
+		out[0] = uint8_t(value);
+		out[1] = uint8_t(value >> 8);
+	}
+
+	static void put_u32(uint8_t* out, uint32_t value) {
+		out[0] = uint8_t(value);
+		out[1] = uint8_t(value >> 8);
+		out[2] = uint8_t(value >> 16);
+		out[3] = uint8_t(value >> 24);
+	}
+
+	static uint16_t get_u16(const uint8_t* in) {
+		return uint16_t(in[0] | (in[1] << 8));
+	}
+
+	static uint32_t get_u32(const uint8_t* in) {
+		return uint32_t(in[0]) | (uint32_t(in[1]) << 8) | (uint32_t(in[2]) << 16) | (uint32_t(in[3]) << 24);
+	}
+
+private:
+
+	const uint32_t my_cycles_per_us;
+	FILE* file = 0;
+
+	BusEvent ring[RING_SIZE];
+	std::atomic<uint32_t> write_index{ 0 };
+	std::atomic<uint32_t> read_index{ 0 };
+	std::atomic<uint32_t> dropped{ 0 };
+	std::atomic<bool> recording{ false };
+};
+
+#endif
@@ -0,0 +1,57 @@
+/**
+ * @file bus_tap.h
+ *
+ * @brief  Interface for observing every byte a ModbusClient sends and receives
+ *
+ * @version 2.2.0
+
+    @copyright Copyright 2022 Iris Dynamics Ltd
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+    For questions or feedback on this file, please email <support@irisdynamics.com>.
+ */
+
+#ifndef BUS_TAP_H_
+#define BUS_TAP_H_
+
+#include "types.h"
+
+/**
+ * @class BusTap
+ * @brief Receives the byte level traffic of a ModbusClient, in order, from the thread or interrupt running the client.
+ * Implementations must be quick and must not allocate, as they are called once per byte.
+ */
+class BusTap {
+public:
+	virtual ~BusTap() {}
+
+	/**
+	 * @brief Flags describing each bus event
+	 */
+	enum EVENT_FLAGS {
+		RX                = 1 << 0,		// byte was received; otherwise it was sent
+		FRAME_START       = 1 << 1,		// first byte of a frame
+		FRAME_END         = 1 << 2,		// last byte of a frame, or a marker ending a frame that won't complete
+		RESPONSE_TIMEOUT  = 1 << 3,		// marker: no response arrived in time. Carries no data.
+		INTERCHAR_TIMEOUT = 1 << 4,		// marker: the response ended with a gap between characters, an error unless its length was unknown. Carries no data.
+	};
+
+	/**
+	 * @param data the byte sent or received, or 0 for a marker
+	 * @param flags combination of EVENT_FLAGS
+	 * @param cycles the client's system time of the event
+	 */
+	virtual void on_bus_event(uint8_t data, uint8_t flags, uint32_t cycles) = 0;
+};
+
+#endif
@@ -0,0 +1,219 @@
+/**
+ * @file deadline_watchdog.h
+ *
+ * @brief  Tracks communication loop deadlines and chooses how far to degrade the stream when they are missed
+ *
+ * @version 2.2.0
+
+    @copyright Copyright 2022 Iris Dynamics Ltd
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+    For questions or feedback on this file, please email <support@irisdynamics.com>.
+ */
+
+#ifndef DEADLINE_WATCHDOG_H_
+#define DEADLINE_WATCHDOG_H_
+
+#include <stdint.h>
+
+/**
+ * @class DeadlineWatchdog
+ * @brief Walks a degradation ladder down while the host loop misses its deadline, and back up once it keeps up again.
+ *
+ * The watchdog is fed one tick per loop iteration. An iteration misses its deadline when the time since the previous
+ * tick exceeds the configured deadline. Ticks are grouped into windows; a window is overloaded when more than
+ * degrade_miss_fraction of its iterations missed, and has headroom when no more than recover_miss_fraction did.
+ * The level steps down after degrade_windows consecutive overloaded windows and steps up after recover_windows
+ * consecutive windows with headroom, so it climbs back more cautiously than it falls.
+ *
+ * What each level means is up to the application; see Actuator::set_cycle_deadline_us() for the Actuator's ladder.
+ * Every transition is counted, and the most recent ones are kept with their time and the miss fraction that caused them.
+ */
+class DeadlineWatchdog {
+
+public:
+
+	/**
+	 * @brief Tuning parameters for the watchdog
+	 */
+	struct Config {
+		uint32_t deadline_us            = 0;		//!< longest acceptable loop period; 0 disables the watchdog
+		uint16_t window_ticks           = 32;		//!< loop iterations in each evaluation window
+		float    degrade_miss_fraction  = 0.25;		//!< a window with more misses than this is overloaded
+		float    recover_miss_fraction  = 0.02;		//!< a window with no more misses than this has headroom
+		uint8_t  degrade_windows        = 2;		//!< consecutive overloaded windows before stepping down
+		uint8_t  recover_windows        = 8;		//!< consecutive windows with headroom before stepping up
+	};
+
+	/**
+	 * @brief One change of level
+	 */
+	struct Transition {
+		uint32_t cycles;			//!< client system time of the change
+		uint8_t  from;
+		uint8_t  to;
+		uint16_t miss_permille;		//!< misses per thousand iterations in the window that caused it
+	};
+
+	static const int HISTORY_SIZE = 16;
+
+	/**
+	 * @param cycles_per_us client system cycles per microsecond
+	 * @param _max_level deepest level of the ladder; level 0 is normal operation
+	 */
+	DeadlineWatchdog(uint32_t cycles_per_us, uint8_t _max_level) :
+		my_cycles_per_us(cycles_per_us),
+		max_level(_max_level)
+	{}
+
+	/**
+	 * @brief Apply a new configuration and return to level 0
+	 */
+	void set_config(Config _config) {
+		if (_config.window_ticks < 1) _config.window_ticks = 1;
+		if (_config.degrade_windows < 1) _config.degrade_windows = 1;
+		if (_config.recover_windows < 1) _config.recover_windows = 1;
+		config = _config;
+		reset();
+	}
+
+	Config get_config() { return config; }
+
+	bool is_enabled() { return config.deadline_us != 0; }
+
+	/**
+	 * @brief Return to level 0 and forget the current window. Counters and history are kept.
+	 */
+	void reset() {
+		level = 0;
+		have_last_tick = false;
+		window_count = 0;
+		window_misses = 0;
+		overloaded_windows = 0;
+		headroom_windows = 0;
+	}
+
+	/**
+	 * @brief Should be called once per loop iteration
+	 * @return true if the level changed
+	 */
+	bool tick(uint32_t now_cycles) {
+		if (!is_enabled()) return false;
+
+		if (!have_last_tick) {
+			last_tick_cycles = now_cycles;
+			have_last_tick = true;
+			return false;
+		}
+		uint32_t period = now_cycles - last_tick_cycles;
+		last_tick_cycles = now_cycles;
+
+		ticks++;
+		window_count++;
+		if (period > config.deadline_us * my_cycles_per_us) {
+			misses++;
+			window_misses++;
+		}
+		if (window_count < config.window_ticks) return false;
+
+		float miss_fraction = (float)window_misses / window_count;
+		uint16_t miss_permille = (uint16_t)(1000 * window_misses / window_count);
+		window_count = 0;
+		window_misses = 0;
+
+		if (miss_fraction > config.degrade_miss_fraction) {
+			headroom_windows = 0;
+			if (++overloaded_windows >= config.degrade_windows && level < max_level) {
+				overloaded_windows = 0;
+				change_level(level + 1, now_cycles, miss_permille);
+				return true;
+			}
+		}
+		else if (miss_fraction <= config.recover_miss_fraction) {
+			overloaded_windows = 0;
+			if (++headroom_windows >= config.recover_windows && level > 0) {
+				headroom_windows = 0;
+				change_level(level - 1, now_cycles, miss_permille);
+				return true;
+			}
+		}
+		else {
+			// neither overloaded nor comfortably within the deadline; hold the level
+			overloaded_windows = 0;
+			headroom_windows = 0;
+		}
+		return false;
+	}
+
+	/// @brief current level; 0 is normal operation and larger levels are more degraded
+	uint8_t get_level() { return level; }
+
+	/// @brief loop iterations seen since construction
+	uint32_t get_tick_count() { return ticks; }
+
+	/// @brief loop iterations which missed their deadline since construction
+	uint32_t get_miss_count() { return misses; }
+
+	/// @brief times the level has changed since construction
+	uint32_t get_transition_count() { return transitions; }
+
+	/// @brief times the given level has been entered since construction
+	uint32_t get_entry_count(uint8_t _level) { return _level < MAX_LEVELS ? entries[_level] : 0; }
+
+	/**
+	 * @brief A recent transition
+	 * @param age 0 for the most recent, up to HISTORY_SIZE - 1
+	 * @return false if there haven't been that many transitions
+	 */
+	bool get_transition(int age, Transition& transition) {
+		if (age < 0 || age >= HISTORY_SIZE || (uint32_t)age >= transitions) return false;
+		transition = history[(transitions - 1 - age) % HISTORY_SIZE];
+		return true;
+	}
+
+private:
+
+	static const int MAX_LEVELS = 8;
+
+	Config config;
+	const uint32_t my_cycles_per_us;
+	const uint8_t max_level;
+
+	uint8_t level = 0;
+	bool have_last_tick = false;
+	uint32_t last_tick_cycles = 0;
+
+	uint16_t window_count = 0;
+	uint16_t window_misses = 0;
+	uint8_t overloaded_windows = 0;
+	uint8_t headroom_windows = 0;
+
+	uint32_t ticks = 0;
+	uint32_t misses = 0;
+	uint32_t transitions = 0;
+	uint32_t entries[MAX_LEVELS] = { 0 };
+	Transition history[HISTORY_SIZE];
+
+	void change_level(uint8_t next, uint32_t now_cycles, uint16_t miss_permille) {
+		Transition& t = history[transitions % HISTORY_SIZE];
+		t.cycles = now_cycles;
+		t.from = level;
+		t.to = next;
+		t.miss_permille = miss_permille;
+		transitions++;
+		if (next < MAX_LEVELS) entries[next]++;
+		level = next;
+	}
+};
+
+#endif
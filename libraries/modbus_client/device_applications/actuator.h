@@ -25,6 +25,13 @@
 
 
 #include "../iris_client_application.h"
+#include "../queue_depth_controller.h"
+#include "../sample_clock.h"
+#include "../deadline_watchdog.h"
+#include "../register_cache.h"
+#include "../response_decoder.h"
+#include "../register_notifier.h"
+#include "../register_image_store.h"
 
 #include "actuator_config.h"
 
@@ -33,7 +40,7 @@
    @class Actuator
    @brief Object that abstracts the communications between the client and a Orca motor server.
  */
-class Actuator : public IrisClientApplication {
+class Actuator : public IrisClientApplication, public TransmitBinder {
 
 public:
 
@@ -63,6 +70,15 @@ public:
 
 #elif defined(QT_WINDOWS)
 	qt_ModbusClient modbus_client;
+#elif defined(TRANSPORT_CLIENT)
+	transport_ModbusClient modbus_client;
+
+	/**
+	 * @brief Set the transport the client communicates through. Must be called before init().
+	 */
+	void set_transport(ByteTransport* transport) {
+		modbus_client.set_transport(transport);
+	}
 #endif
 
     const uint32_t my_cycle_per_us;					//!< client device clock cycles per microsecond
@@ -76,8 +92,18 @@ public:
 	):
 		IrisClientApplication(modbus_client, name, cycle_per_us),
 		modbus_client(channel, cycle_per_us),
-		my_cycle_per_us(cycle_per_us)
-	{}
+		my_cycle_per_us(cycle_per_us),
+		orca_reg_contents(cycle_per_us),
+		stream_depth(cycle_per_us),
+		sample_clock(cycle_per_us),
+		deadline_watchdog(cycle_per_us, SafeMode)
+	{
+		modbus_client.set_transmit_binder(this);
+		MB_TRACE_NAME_TRACK(modbus_client.get_trace_track(), name);
+	}
+
+	/// @brief the local copy of the motor's memory map; see REGISTER_TRACKING in mb_config.h
+	typedef RegisterCache<ORCA_REG_SIZE, REGISTER_TRACKING> OrcaRegisterCache;
 
 	/**
 	*@brief Sets the type of command that will be sent on high speed stream (ie when enable() has been used, this sets the type of message sent from enqueue motor frame)
@@ -112,16 +138,28 @@ public:
 		Osc1	= 1	<< 7
 	}HapticEffect;
 
+	/**
+	 * @brief Steps of the stream degradation ladder walked by the cycle deadline watchdog, see set_cycle_deadline_us()
+	 */
+	typedef enum {
+		FullStream			= 0,	// stream as configured
+		ShedReadStream		= 1,	// read stream frames drop their optional register and are sent as motor command frames, in kinematic and haptic mode
+		HalfRateStream		= 2,	// and a stream frame is only sent at every second opportunity
+		QuarterRateStream	= 3,	// and at every fourth opportunity
+		SafeMode			= 4		// and the actuator is put to sleep. It stays asleep when the ladder climbs back up.
+	} DegradationLevel;
+
 
 
 
 	/**
 	* @brief Write to the orca control register to change the mode of operation of the motor
 	* note some modes require a constant stream to stay in that mode (eg. force, position)
+	* @return 1 if the mode change was added to the message queue, 0 if it wasn't
 	*/
-	void set_mode(MotorMode orca_mode) {
-		write_register(CTRL_REG_3, (uint8_t)orca_mode);
+	int set_mode(MotorMode orca_mode) {
 		comms_mode = orca_mode;
+		return write_register(CTRL_REG_3, (uint8_t)orca_mode);
 	}
 	/**
 	* @brief the communication mode determines which commands are sent by enqueue_motor_frame
@@ -155,6 +193,7 @@ public:
 		motor_write_data = register_value;
 		motor_write_addr = register_address;
 		motor_write_width = width;
+		write_stream_cycles = modbus_client.get_system_cycles();
 
 	}
 
@@ -175,6 +214,7 @@ public:
 	void set_force_mN(int32_t force) {
 		force_command = force;
 		stream_timeout_start = modbus_client.get_system_cycles();
+		setpoint_cycles = stream_timeout_start;
 	}
 
 	/**
@@ -185,6 +225,7 @@ public:
 	void set_position_um(int32_t position) {
 		position_command = position;
 		stream_timeout_start = modbus_client.get_system_cycles();
+		setpoint_cycles = stream_timeout_start;
 	}
 
 	/**
@@ -193,7 +234,7 @@ public:
 	* @return uint32_t - force in milli-Newtons
 	*/
 	int32_t get_force_mN() {
-		return uint32_t(orca_reg_contents[FORCE_REG_H_OFFSET] << 16) | orca_reg_contents[FORCE_REG_OFFSET];
+		return get_orca_reg_value(FORCE_REG_OFFSET);
 	}
 
 	/**
@@ -202,7 +243,7 @@ public:
 	* @return uint32_t - position in micrometers
 	*/
 	int32_t get_position_um() {
-		return (orca_reg_contents[POS_REG_H_OFFSET] << 16) | orca_reg_contents[POS_REG_OFFSET];
+		return get_orca_reg_value(POS_REG_OFFSET);
 	}
 
 
@@ -215,6 +256,9 @@ public:
 	/**
 	 * @brief returns true when new data has been received from an actuator since the last time this function was called
 	 * 
+	 * This clears a flag shared by every caller, including the handshake, so only one consumer sees each update.
+	 * Consumers which share an Actuator should each keep a cursor for new_data(uint32_t&) instead.
+	 *
 	 * @return boolean - returns true when new data has been received from the motor. 
 	 */
 	bool new_data() override {
@@ -223,6 +267,83 @@ public:
 		return return_value;
 	}
 
+	/**
+	 * @brief returns true when a valid response has been decoded since the cursor was last brought up to date
+	 *
+	 * Each consumer keeps its own cursor, starting at 0, so consumers don't hide updates from one another.
+	 *
+	 * @param cursor the consumer's cursor, brought up to date by this call
+	 * @return boolean - returns true when new data has been received since the previous call with this cursor
+	 */
+	bool new_data(uint32_t& cursor) {
+#if REGISTER_TRACKING
+		return register_notifier.poll(cursor) != 0;
+#else
+		bool updated = cursor != update_count;
+		cursor = update_count;
+		return updated;
+#endif
+	}
+
+	/**
+	 * @brief returns the number of valid responses decoded; the value new_data(uint32_t&) cursors are brought up to
+	 */
+	uint32_t get_update_count() {
+#if REGISTER_TRACKING
+		return register_notifier.get_update_count();
+#else
+		return update_count;
+#endif
+	}
+
+#if REGISTER_TRACKING
+	/**
+	 * @brief Call the listener from run_in() after each valid response which changes any of the given registers
+	 *
+	 * @param registers registers of interest, or 0 to be called after every valid response
+	 * @param count number of registers
+	 * @return false if there is no room for the listener or its registers; see RegisterNotifier
+	 */
+	bool subscribe(RegisterListener* listener, const uint16_t* registers = 0, int count = 0) {
+		return register_notifier.subscribe(listener, registers, count);
+	}
+
+	/**
+	 * @brief Stop calling the listener
+	 */
+	void unsubscribe(RegisterListener* listener) {
+		register_notifier.unsubscribe(listener);
+	}
+#endif
+
+	/**
+	 * @brief Keep the parameter and tuning registers in a store, keyed by the actuator's serial number and firmware commit ID.
+	 * While the store holds a valid image for the actuator, synchronizing the memory map only reads the identity and error
+	 * registers and a few tuning registers from it. If those tuning registers match the image the rest is restored from it;
+	 * otherwise the image is erased, every register is read and the image is saved again once connected.
+	 * An image is erased when any of its registers is written. 0, the default, reads every register from the actuator.
+	 *
+	 * @param store must outlive the actuator, or be replaced first
+	 */
+	void set_memory_map_store(RegisterImageStore* store) {
+		memory_map_store = store;
+	}
+
+	/**
+	 * @brief returns the number of synchronizations that restored the memory map from the store
+	 */
+	uint32_t get_memory_map_restore_count() {
+		return memory_map_restore_counter;
+	}
+
+	/**
+	 * @brief returns the number of synchronizations that found no valid image in the store, or one which didn't match the
+	 * actuator, and read every register
+	 */
+	uint32_t get_memory_map_miss_count() {
+		return memory_map_miss_counter;
+	}
+
 	/**
 	* @brief Set the maximum time required between calls to set_force or set_position, in force or position mode respectively, before timing out and returning to sleep mode. 
 	* 
@@ -237,6 +358,7 @@ public:
 	*/
 	void init(){
 		disconnect();	// dc is expected to return us to a good init state
+		modbus_client.set_transmit_binder(this);
 		modbus_client.init(UART_BAUD_RATE);
 	}
 
@@ -258,6 +380,136 @@ public:
 		return failed_msg_counter;
 	}
 
+	/**
+	 * @brief returns the number of transactions claimed from the message queue, valid or not. Increases once per run_in() at most.
+	 */
+	uint32_t get_claimed_frame_count() {
+		return claimed_frame_counter;
+	}
+
+	/**
+	 * @brief returns the number of valid stream responses decoded, ie. the number of position and force samples received
+	 */
+	uint32_t get_stream_sample_count() {
+		return stream_sample_counter;
+	}
+
+	/**
+	 * @brief returns the time from the start of transmission until the response was received or abandoned, for the last claimed transaction
+	 *
+	 * @return uint32_t - round trip time in microseconds
+	 */
+	uint32_t get_last_round_trip_us() {
+		return last_round_trip_cycles / my_cycle_per_us;
+	}
+
+	/**
+	 * @brief returns the client system time at which transmission of the last claimed transaction started
+	 */
+	uint32_t get_last_sent_cycles() {
+		return last_sent_cycles;
+	}
+
+	/**
+	 * @brief returns the time since the actuator sampled the most recently decoded data, eg. get_position_um() and get_force_mN()
+	 *
+	 * The sample instant is estimated from the request and response timestamps of the frame which carried the data; see SampleClock.
+	 * To stamp a sample in another timebase, subtract this from that timebase's current time, eg. micros() - get_sample_age_us().
+	 *
+	 * @return uint32_t - age in microseconds, or 0 before any data has been received
+	 */
+	uint32_t get_sample_age_us() {
+		if (!sample_clock.has_sample()) return 0;
+		return sample_clock.get_sample_age_us(modbus_client.get_system_cycles());
+	}
+
+	/**
+	 * @brief returns the client system time at which the actuator sampled the most recently decoded data
+	 */
+	uint32_t get_sample_cycles() {
+		return sample_clock.get_sample_cycles();
+	}
+
+	/**
+	 * @brief returns the uncertainty of the sample instant, ie. the sample was taken within this many microseconds of the estimate
+	 */
+	uint32_t get_sample_uncertainty_us() {
+		return sample_clock.get_uncertainty_us();
+	}
+
+
+	/**
+	 * @brief Set the longest acceptable time between run_out() calls. 0, the default, disables the deadline watchdog.
+	 *
+	 * While the host keeps missing this deadline, the stream is degraded one DegradationLevel at a time, ending in SafeMode.
+	 * It is restored one level at a time once the deadline is being met again.
+	 * Entering SafeMode sets the sleep mode; the application must choose its mode again after recovering.
+	 */
+	void set_cycle_deadline_us(uint32_t deadline_us) {
+		DeadlineWatchdog::Config config = deadline_watchdog.get_config();
+		config.deadline_us = deadline_us;
+		deadline_watchdog.set_config(config);
+	}
+
+	/**
+	 * @brief Configure how quickly the deadline watchdog degrades and restores the stream
+	 */
+	void set_deadline_watchdog_config(DeadlineWatchdog::Config config) {
+		deadline_watchdog.set_config(config);
+	}
+
+	/**
+	 * @brief returns the current step of the stream degradation ladder
+	 */
+	DegradationLevel get_degradation_level() {
+		return (DegradationLevel)deadline_watchdog.get_level();
+	}
+
+	/**
+	 * @brief returns the deadline watchdog, for its miss and transition counts and its recent transitions
+	 */
+	DeadlineWatchdog& get_deadline_watchdog() {
+		return deadline_watchdog;
+	}
+
+	/**
+	 * @brief Configure how the number of stream frames allowed on the message queue is chosen
+	 */
+	void set_stream_depth_config(QueueDepthController::Config config) {
+		stream_depth.set_config(config);
+	}
+
+	/**
+	 * @brief Enable or disable runtime selection of the stream queue depth. When disabled, fixed_depth frames are allowed on the queue.
+	 */
+	void set_adaptive_stream_depth(bool enable, uint8_t fixed_depth = 2) {
+		stream_depth.set_adaptive(enable, fixed_depth);
+	}
+
+	/**
+	 * @brief returns the number of messages currently allowed on the queue before a new stream frame is held back
+	 */
+	uint8_t get_stream_depth() {
+		return stream_depth.get_depth();
+	}
+
+	/**
+	 * @brief returns the rate at which stream frames were completed over the last measurement window
+	 *
+	 * @return float - frames per second
+	 */
+	float get_stream_rate_hz() {
+		return stream_depth.get_frame_rate_hz();
+	}
+
+	/**
+	 * @brief returns the average age of the commands carried by stream frames when they were sent, over the last measurement window
+	 *
+	 * @return uint32_t - age in microseconds
+	 */
+	uint32_t get_command_age_us() {
+		return stream_depth.get_command_age_us();
+	}
 
 	/**
 	 * @brief handle the motor frame transmissions cadence
@@ -267,10 +519,20 @@ public:
 	 */
 	void run_out() {
 
+		stream_depth.loop_tick(modbus_client.get_system_cycles());
+		if (deadline_watchdog.tick(modbus_client.get_system_cycles()) && deadline_watchdog.get_level() == SafeMode && connection_state == connected) {
+			set_mode(SleepMode);
+		}
+
+		if (memory_map_save_pending && connection_state == connected) {
+			save_memory_map_image();
+		}
+
 		// This object can queue messages on the UART with the either the handshake or the connected run loop
 		if ( is_enabled() ) {
 			if (connection_state != connected) {
 				modbus_handshake();
+				stream_depth.reset();		// measurements from a previous connection don't apply to the next
 			}
 			else {
 				enqueue_motor_frame();
@@ -292,18 +554,29 @@ public:
 	 */
 	void run_in() {
 
-
+#ifdef TRANSPORT_CLIENT
+		modbus_client.uart_isr();		// no receive interrupt; poll the transport
+#endif
 		modbus_client.run_in();
 
 		if ( modbus_client.is_response_ready() ) {
 			response = modbus_client.dequeue_transaction();
+			MB_TRACE(modbus_client.get_trace_track(), dequeued, response->get_ID(), 0);
 			new_data_flag = true;		// communicate to other layers that new data was received
+			claimed_frame_counter++;
+			track_link_quality(response);
+			last_round_trip_cycles = response->get_round_trip_cycles();
+			last_sent_cycles = response->get_sent_cycles();
+
+			if (is_stream_function_code(response->get_tx_function_code())) {
+				stream_depth.frame_completed(response);
+			}
 
 			if ( !response->is_reception_valid() ) {
 				cur_consec_failed_msgs++;
 				failed_msg_counter++;
 				if(connection_state == connected && cur_consec_failed_msgs >= connection_config.max_consec_failed_msgs){
-					disconnect();
+					lose_connection();
 				}
 			}
 
@@ -312,84 +585,78 @@ public:
 
 				cur_consec_failed_msgs = 0;
 				success_msg_counter++;
+				sample_clock.update(response, get_baud_rate_bps());
+				uint32_t rx_cycles = response->get_rx_last_cycles();
+#if REGISTER_TRACKING
+				uint32_t sequence_before = orca_reg_contents.get_sequence();
+#endif
 
-				switch (response->get_rx_function_code()) {
+				// fields whose destination depends on the request
+				if (response->get_rx_function_code() == response->get_tx_function_code()) {
+					const uint8_t* rx_data = response->get_rx_data();
+					int rx_length = ResponseDecoder::get_rx_data_length(response);
+
+					switch (response->get_rx_function_code()) {
+
+					case read_holding_registers:{
+						// add the received data to the local copy of the memory map
+						u16 register_start_address 		= (response->get_tx_data()[0] << 8) + response->get_tx_data()[1];
+						u16 num_registers 				= (response->get_tx_data()[2] << 8) + response->get_tx_data()[3];
+						int byte_count 					= rx_length > 0 ? rx_data[0] : 0;
+						if (byte_count > rx_length - 1) byte_count = rx_length - 1;
+						ResponseDecoder::decode_registers(rx_data + 1, byte_count, register_start_address, num_registers, orca_reg_contents, rx_cycles);
+						if (memory_map_store && connection_state == synchronization) {
+							if (register_start_address == SERIAL_NUMBER_LOW) load_memory_map_image();
+							else if (memory_map_image_loaded && register_start_address == MEMORY_MAP_CHECK_START) check_memory_map_image();
+						}
+						break;
+					}
 
-				case read_holding_registers:{
-					// add the received data to the local copy of the memory map
-					u16 register_start_address 		= (response->get_tx_data()[0] << 8) + response->get_tx_data()[1];
-					u16 num_registers 				= (response->get_tx_data()[2] << 8) + response->get_tx_data()[3];
-					for ( int i = 0; i < num_registers; i++ ) {
-						u16 register_data 			= (response->get_rx_data()[1 + i*2] << 8) + response->get_rx_data()[2 + i*2];
-						orca_reg_contents[register_start_address + i] = register_data;
+					case write_single_register:
+					case write_multiple_registers: {
+						u16 register_start_address 		= (response->get_tx_data()[0] << 8) + response->get_tx_data()[1];
+						u16 num_registers 				= response->get_rx_function_code() == write_single_register ? 1
+														: (response->get_tx_data()[2] << 8) + response->get_tx_data()[3];
+						memory_map_image_written(register_start_address, num_registers);
+						break;
 					}
-					break;
-				}
-				case write_single_register:
-					// nothing to do
-					break;
-
-				case motor_command:
-					orca_reg_contents[POS_REG_H_OFFSET] 	= (response->get_rx_data()[ 0] << 8) | response->get_rx_data()[ 1];
-					orca_reg_contents[POS_REG_OFFSET]  		= (response->get_rx_data()[ 2] << 8) | response->get_rx_data()[ 3];
-					orca_reg_contents[FORCE_REG_H_OFFSET] 	= (response->get_rx_data()[ 4] << 8) | response->get_rx_data()[ 5];
-					orca_reg_contents[FORCE_REG_OFFSET] 	= (response->get_rx_data()[ 6] << 8) | response->get_rx_data()[ 7];
-					orca_reg_contents[POWER_REG_OFFSET] 	= (response->get_rx_data()[ 8] << 8) | response->get_rx_data()[ 9];
-					orca_reg_contents[TEMP_REG_OFFSET] 		= (response->get_rx_data()[10]);
-					orca_reg_contents[VOLTAGE_REG_OFFSET] 	= (response->get_rx_data()[11] << 8) | response->get_rx_data()[12];
-					orca_reg_contents[ERROR_REG_OFFSET] 	= (response->get_rx_data()[13] << 8) | response->get_rx_data()[14];
-					break;
-				
-				case motor_read: {
-					u16 register_start_address = (response->get_tx_data()[0] << 8) + response->get_tx_data()[1];
-					u8 width = response->get_tx_data()[2];
-					u16 register_data = (response->get_rx_data()[2] << 8) + response->get_rx_data()[3];
-					orca_reg_contents[register_start_address] = register_data;
-					if (width > 1) {
-						register_data = (response->get_rx_data()[0] << 8) + response->get_rx_data()[1];
-						orca_reg_contents[register_start_address + 1] = register_data;
+
+					case motor_read: {
+						// the register read by the stream, upper half first when two registers wide
+						u16 register_start_address = (response->get_tx_data()[0] << 8) + response->get_tx_data()[1];
+						u8 width = response->get_tx_data()[2];
+						ResponseField fields[2] = {
+							{ 2, 2, register_start_address },
+							{ 0, 2, u16(register_start_address + 1) }
+						};
+						ResponseDecoder::decode_fields(rx_data, rx_length, fields, width > 1 ? 2 : 1, orca_reg_contents, rx_cycles);
+						break;
+					}
+
+					case motor_write: {
+						// the register written by the stream, two registers when width is 2
+						u16 register_start_address = (response->get_tx_data()[0] << 8) + response->get_tx_data()[1];
+						u8 width = response->get_tx_data()[2];
+						memory_map_image_written(register_start_address, width > 1 ? 2 : 1);
+						break;
+					}
+
+					default:
+						// todo: warn about un-implemented function codes being received
+						break;
 					}
-					orca_reg_contents[MODE_OF_OPERATION] = response->get_rx_data()[4];
-					orca_reg_contents[POS_REG_H_OFFSET] = (response->get_rx_data()[5] << 8) | response->get_rx_data()[6];
-					orca_reg_contents[POS_REG_OFFSET] = (response->get_rx_data()[7] << 8) | response->get_rx_data()[8];
-					orca_reg_contents[FORCE_REG_H_OFFSET] = (response->get_rx_data()[9] << 8) | response->get_rx_data()[10];
-					orca_reg_contents[FORCE_REG_OFFSET] = (response->get_rx_data()[11] << 8) | response->get_rx_data()[12];
-					orca_reg_contents[POWER_REG_OFFSET] = (response->get_rx_data()[13] << 8) | response->get_rx_data()[14];
-					orca_reg_contents[TEMP_REG_OFFSET] = (response->get_rx_data()[15]);
-					orca_reg_contents[VOLTAGE_REG_OFFSET] = (response->get_rx_data()[16] << 8) | response->get_rx_data()[17];
-					orca_reg_contents[ERROR_REG_OFFSET] = (response->get_rx_data()[18] << 8) | response->get_rx_data()[19];
-				}
-					break; 
-				case motor_write:
-					orca_reg_contents[MODE_OF_OPERATION] = response->get_rx_data()[0];
-					orca_reg_contents[POS_REG_H_OFFSET] = (response->get_rx_data()[1] << 8) | response->get_rx_data()[2];
-					orca_reg_contents[POS_REG_OFFSET] = (response->get_rx_data()[3] << 8) | response->get_rx_data()[4];
-					orca_reg_contents[FORCE_REG_H_OFFSET] = (response->get_rx_data()[5] << 8) | response->get_rx_data()[6];
-					orca_reg_contents[FORCE_REG_OFFSET] = (response->get_rx_data()[7] << 8) | response->get_rx_data()[8];
-					orca_reg_contents[POWER_REG_OFFSET] = (response->get_rx_data()[9] << 8) | response->get_rx_data()[10];
-					orca_reg_contents[TEMP_REG_OFFSET] = (response->get_rx_data()[11]);
-					orca_reg_contents[VOLTAGE_REG_OFFSET] = (response->get_rx_data()[12] << 8) | response->get_rx_data()[13];
-					orca_reg_contents[ERROR_REG_OFFSET] = (response->get_rx_data()[14] << 8) | response->get_rx_data()[15];
-					break;
-
-				case read_coils                   :
-				case read_discrete_inputs         :
-				case read_input_registers         :
-				case write_single_coil            :
-				case read_exception_status        :
-				case diagnostics                  :
-				case get_comm_event_counter       :
-				case get_comm_event_log           :
-				case write_multiple_coils         :
-				case write_multiple_registers     :
-				case report_server_id             :
-				case mask_write_register          :
-				case read_write_multiple_registers:
-				default:
-					// todo: warn about un-implemented function codes being received
-					break;
 				}
+
+				// fixed fields of stream responses; stored last so the feedback wins over a streamed read of the same register
+				if (StreamDecoder::decode(response, orca_reg_contents, rx_cycles)) stream_sample_counter++;
+
+#if REGISTER_TRACKING
+				register_notifier.notify(orca_reg_contents, sequence_before);
+#else
+				update_count++;
+#endif
 			}
+			MB_TRACE(modbus_client.get_trace_track(), decoded, response->get_ID(), 0);
 		}
 	}
 
@@ -468,12 +735,7 @@ public:
 	* @return uint32_t - actuator serial number
 	*/
 	uint32_t get_serial_number() {
-
-		uint16_t sn_high = orca_reg_contents[SERIAL_NUMBER_HIGH];
-		uint16_t sn_low  = orca_reg_contents[SERIAL_NUMBER_LOW];
-
-		uint32_t serial_number = (sn_high * (1<<16)) + sn_low;
-		return serial_number;
+		return uint32_t(get_orca_reg_value(SERIAL_NUMBER_LOW));
 	}
 
 	/**
@@ -523,17 +785,19 @@ public:
 
 	/**
 	 * @brief Set the zero position of the motor to be the current position 
+	 * @return 1 if the request was added to the message queue, 0 if it wasn't
 	 */
-	void zero_position(){
-		write_register(ZERO_POS_REG_OFFSET, ZERO_POS_MASK);
+	int zero_position(){
+		return write_register(ZERO_POS_REG_OFFSET, ZERO_POS_MASK);
 	}
 
 	/**
 	 * @brief clear all errors stored on the motor
 	 * note: errors that are still found will appear again
+	 * @return 1 if the request was added to the message queue, 0 if it wasn't
 	 */
-	void clear_errors(){
-		write_register(CLEAR_ERROR_REG_OFFSET, CLEAR_ERROR_MASK);
+	int clear_errors(){
+		return write_register(CLEAR_ERROR_REG_OFFSET, CLEAR_ERROR_MASK);
 	}
 
 	/**
@@ -705,9 +969,10 @@ public:
 	 * @brief Request for a specific register in the local copy to be updated from the motor's memory map
 	 * 
 	 * @param reg_address register address
+	 * @return 1 if the request was added to the message queue, 0 if it wasn't
 	 */
-	void read_register(uint16_t reg_address){    
-		read_holding_registers_fn(connection_config.server_address, reg_address, 1);
+	int read_register(uint16_t reg_address){    
+		return read_holding_registers_fn(connection_config.server_address, reg_address, 1);
 	}
 	
 	/**
@@ -715,9 +980,10 @@ public:
 	 *
 	 * @param reg_address register address from the orca's memory map
 	 * @param num_registers number of sequential registers to read
+	 * @return 1 if the request was added to the message queue, 0 if it wasn't
 	 */
-	void read_registers(uint16_t reg_address, uint16_t num_registers) {
-		read_holding_registers_fn(connection_config.server_address, reg_address, num_registers);
+	int read_registers(uint16_t reg_address, uint16_t num_registers) {
+		return read_holding_registers_fn(connection_config.server_address, reg_address, num_registers);
 	}
 
 	/**
@@ -725,9 +991,10 @@ public:
 	 * 
 	 * @param reg_address register address
 	 * @param reg_data data to be added to the register
+	 * @return 1 if the request was added to the message queue, 0 if it wasn't
 	 */
-	void write_register(uint16_t reg_address, uint16_t reg_data){    
-		write_single_register_fn(connection_config.server_address, reg_address, reg_data);
+	int write_register(uint16_t reg_address, uint16_t reg_data){    
+		return write_single_register_fn(connection_config.server_address, reg_address, reg_data);
 	}
 
 	/**
@@ -741,13 +1008,14 @@ public:
 		write_multiple_registers_fn(connection_config.server_address, reg_address, num_registers, reg_data);
 	}
 
-	void write_registers(uint16_t reg_address, uint16_t num_registers, uint16_t* reg_data) {
-		uint8_t data[126];
+	int write_registers(uint16_t reg_address, uint16_t num_registers, uint16_t* reg_data) {
+		if (num_registers > MAX_NUM_WRITE_REG) return 0;
+		uint8_t data[MAX_NUM_WRITE_REG * 2];
 		for (int i = 0; i < num_registers; i++) {
 			data[i*2] = reg_data[i] >> 8;
 			data[i * 2 + 1] = reg_data[i];
 		}
-		write_multiple_registers_fn(connection_config.server_address, reg_address, num_registers, data);
+		return write_multiple_registers_fn(connection_config.server_address, reg_address, num_registers, data);
 	}
 
 	/**
@@ -760,18 +1028,160 @@ public:
 		return orca_reg_contents[offset];
 	}
 
+	/**
+	* @brief Return the value of the given register from the controller's copy of the motor's memory map, assembled as its descriptor says.
+	* 32 bit registers are combined with their upper half and signed registers are sign extended.
+	* Either half of a 32 bit register may be given. Unnamed registers and words within blocks are returned as unsigned 16 bit values.
+	*
+	* @param offset the register that will be read
+	* @return int32_t - register value. Unsigned 32 bit values should be cast back to uint32_t.
+	*/
+	int32_t get_orca_reg_value(uint16_t offset) {
+		const Orca600RegDescriptor* descriptor = orca600_reg_descriptor(offset);
+		if (!descriptor || descriptor->length > 2) return orca_reg_contents[offset];		// unnamed, or a word within a block such as KIN_MOTION_n
+		if (descriptor->upper_half) descriptor = orca600_reg_descriptor(offset - 1);
+		return orca600_reg_value(descriptor, orca_reg_contents[descriptor->address], orca_reg_contents[descriptor->address + 1]);
+	}
+
+#if REGISTER_TRACKING
+	/**
+	* @brief Time since the given register was last received from the motor, whether or not its value changed
+	*/
+	uint32_t get_orca_reg_age_us(uint16_t offset) {
+		return orca_reg_contents.get_age_us(offset, modbus_client.get_system_cycles());
+	}
+
+	/**
+	* @brief True if the given register has never been received from the motor, or was last received more than max_age_us ago
+	*/
+	bool is_orca_reg_stale(uint16_t offset, uint32_t max_age_us) {
+		return orca_reg_contents.is_stale(offset, max_age_us, modbus_client.get_system_cycles());
+	}
+
+#endif
+
+	/**
+	* @brief The local copy of the motor's memory map. With REGISTER_TRACKING it also has the time and sequence number of
+	* each register's last change; use get_sequence() and get_changed_since() to find the registers that changed since a previous cycle.
+	*/
+	const OrcaRegisterCache& get_register_cache() {
+		return orca_reg_contents;
+	}
+
+	// motor feedback common to all stream responses, starting at the given data offset
+#define ORCA_FEEDBACK_FIELDS(base) \
+		{ base +  0, 2, POS_REG_H_OFFSET }, \
+		{ base +  2, 2, POS_REG_OFFSET }, \
+		{ base +  4, 2, FORCE_REG_H_OFFSET }, \
+		{ base +  6, 2, FORCE_REG_OFFSET }, \
+		{ base +  8, 2, POWER_REG_OFFSET }, \
+		{ base + 10, 1, TEMP_REG_OFFSET }, \
+		{ base + 11, 2, VOLTAGE_REG_OFFSET }, \
+		{ base + 13, 2, ERROR_REG_OFFSET }
+
+	/**
+	* @brief Where the fixed fields of each stream response are stored in the local copy of the memory map.
+	* A template only so the arrays can be defined in this header and still be template arguments of StaticResponseLayout.
+	*/
+	template <int = 0>
+	struct StreamResponseFields {
+		static constexpr ResponseField motor_command[] = {
+			ORCA_FEEDBACK_FIELDS(0)
+		};
+		static constexpr ResponseField motor_read[] = {		// bytes 0 to 3 hold the register read, see run_in()
+			{ 4, 1, MODE_OF_OPERATION },
+			ORCA_FEEDBACK_FIELDS(5)
+		};
+		static constexpr ResponseField motor_write[] = {
+			{ 0, 1, MODE_OF_OPERATION },
+			ORCA_FEEDBACK_FIELDS(1)
+		};
+	};
+#undef ORCA_FEEDBACK_FIELDS
+
+	/**
+	* @brief Store the fixed fields of a stream response as run_in() does, eg. for decoding captured responses
+	* @return false if the response isn't a complete stream response answering its request
+	*/
+	template <class Store>
+	static bool decode_stream_response(Transaction* response, Store& store, uint32_t cycles) {
+		return StreamDecoder::decode(response, store, cycles);
+	}
+
+	static const int RESPONSE_LAYOUT_COUNT = 3;
+
+	/**
+	* @brief The stream response fields as a table for a ResponseDecoder, eg. for tools reading layouts at run time.
+	* The fields of a motor_read response holding the register read are not included.
+	*/
+	static const ResponseLayout* get_response_layouts() {
+		typedef StreamResponseFields<> Fields;
+		static const ResponseLayout layouts[RESPONSE_LAYOUT_COUNT] = {
+			{ motor_command,	MOTOR_COMMAND_RESPONSE_LEN - 4,	Fields::motor_command,	sizeof(Fields::motor_command) / sizeof(ResponseField) },
+			{ motor_read,		MOTOR_READ_RESPONSE_LEN - 4,	Fields::motor_read,		sizeof(Fields::motor_read) / sizeof(ResponseField) },
+			{ motor_write,		MOTOR_WRITE_RESPONSE_LEN - 4,	Fields::motor_write,	sizeof(Fields::motor_write) / sizeof(ResponseField) },
+		};
+		return layouts;
+	}
+
+#if REGISTER_TRACKING
+
+	/**
+	* @brief Stage a register value to be written by the next flush_staged_registers(). The local copy is not changed until the register is read back.
+	*/
+	void stage_register(uint16_t reg_address, uint16_t reg_data) {
+		orca_reg_contents.stage(reg_address, reg_data);
+	}
+
+	/**
+	* @brief Write every staged register, combining consecutive registers into single write requests
+	* @return the number of requests added to the message queue. Registers which could not be queued stay staged.
+	*/
+	int flush_staged_registers() {
+		int requests = 0;
+		uint16_t run_start, length;
+		uint16_t address = 0;
+		while ((length = orca_reg_contents.next_dirty_run(address, MAX_NUM_WRITE_REG, run_start)) != 0) {
+			int queued;
+			if (length == 1) {
+				queued = write_single_register_fn(connection_config.server_address, run_start, orca_reg_contents.get_staged(run_start));
+			}
+			else {
+				uint16_t data[MAX_NUM_WRITE_REG];
+				for (int i = 0; i < length; i++) data[i] = orca_reg_contents.get_staged(run_start + i);
+				queued = write_registers(run_start, length, data);
+			}
+			if (!queued) break;		// the queue is full; try the rest on the next flush
+			orca_reg_contents.clear_dirty(run_start, length);
+			requests++;
+			address = run_start + length;
+		}
+		return requests;
+	}
+#endif
+
 private:
 
-	uint16_t orca_reg_contents[ORCA_REG_SIZE];
+	OrcaRegisterCache orca_reg_contents;				// local copy of the motor's memory map
+#if REGISTER_TRACKING
+	RegisterNotifier<ORCA_REG_SIZE> register_notifier;	// tells consumers about each response decoded into orca_reg_contents
+#else
+	uint32_t update_count = 0;							// valid responses decoded
+#endif
 
 	StreamMode stream_mode = MotorCommand;
 	MotorMode comms_mode = SleepMode;
 
 	uint32_t stream_timeout_start;
 	uint32_t stream_timeout_cycles = 100000 * my_cycle_per_us;
+	uint32_t setpoint_cycles = 0;		// system time at which the force or position setpoint was last updated
+	uint32_t write_stream_cycles = 0;	// system time at which the write stream target was last updated
 
 	volatile bool new_data_flag = false;
 
+	// Chooses the number of stream frames allowed on the message queue
+	QueueDepthController stream_depth;
+
 	// Used to hold the last commanded force and position commands from the user of this object
 	int32_t force_command;
 	int32_t position_command;
@@ -787,11 +1197,27 @@ private:
 
 	// These counters are used to find the success and failure rate of the comms
 	int32_t success_msg_counter = 0, failed_msg_counter = 0;
+	uint32_t claimed_frame_counter = 0;
+	uint32_t stream_sample_counter = 0;
+	uint32_t last_round_trip_cycles = 0;
+	uint32_t last_sent_cycles = 0;
+
+	SampleClock sample_clock;		// when the actuator sampled the data in the last valid response
+
+	// Degrades the stream while run_out() misses its deadline
+	DeadlineWatchdog deadline_watchdog;
+	uint8_t stream_opportunities = 0;	// counts enqueue opportunities at reduced stream rates
 
 	/**
 	 * @brief Requests the actuator synchronize its memory map with the controller
 	 */
 	void synchronize_memory_map() override {
+		if (memory_map_store) {
+			// the rest is restored from the store or read once the identity arrives, see load_memory_map_image()
+			enqueue_identity_request();
+			read_registers(ERROR_0				, ADC_DATA_COLLISION-ERROR_0	) ;
+			return;
+		}
 		read_registers(PARAM_REG_START     	, PARAM_REG_SIZE     			) ;
 		read_registers(ERROR_0				, ADC_DATA_COLLISION-ERROR_0	) ;
 		//read_registers(STATOR_CAL_REG_START	, STATOR_CAL_REG_SIZE			) ;
@@ -804,42 +1230,202 @@ private:
 	 * @brief Resets the memory map array to zeros
 	 */
 	void desynchronize_memory_map() override {
-		for(int i=0; i < ORCA_REG_SIZE; i++){
-			orca_reg_contents[i] = 0;
+		orca_reg_contents.clear();
+		memory_map_save_pending = false;
+		memory_map_image_loaded = false;
+	}
+
+	// Persistent copy of the mostly static registers, see set_memory_map_store()
+	RegisterImageStore* memory_map_store = 0;
+	bool memory_map_save_pending = false;
+	bool memory_map_image_erased = false;		// the image was erased since it was last loaded or saved
+	bool memory_map_image_loaded = false;		// memory_map_image holds the stored image, waiting for check_memory_map_image()
+	uint32_t memory_map_restore_counter = 0;
+	uint32_t memory_map_miss_counter = 0;
+
+	static const int MEMORY_MAP_IMAGE_RANGES = 2;
+	static const int MEMORY_MAP_IMAGE_SIZE = PARAM_REG_SIZE + TUNING_REG_SIZE;
+	uint16_t memory_map_image[MEMORY_MAP_IMAGE_SIZE];
+
+	// registers read from the actuator and compared with a stored image before it is used: the controller gains and user limits
+	static const uint16_t MEMORY_MAP_CHECK_START = PC_PGAIN;
+	static const uint16_t MEMORY_MAP_CHECK_SIZE = SAFETY_DGAIN - PC_PGAIN + 1;
+
+	/**
+	 * @brief The register ranges kept in the store: those synchronize_memory_map() reads apart from the errors
+	 */
+	static const RegisterRange* memory_map_image_ranges() {
+		static const RegisterRange ranges[MEMORY_MAP_IMAGE_RANGES] = {
+			{ PARAM_REG_START,	PARAM_REG_SIZE },
+			{ TUNING_REG_START,	TUNING_REG_SIZE }
+		};
+		return ranges;
+	}
+
+	/**
+	 * @brief Erases the stored image once one of its registers is written, as it no longer matches the actuator.
+	 * A write stream repeats its write with every frame, so the store is only asked once per image.
+	 */
+	void memory_map_image_written(uint16_t start, uint16_t count) {
+		if (!memory_map_store || memory_map_image_erased || !overlaps_memory_map_image(start, count)) return;
+		uint64_t identity;
+		if (get_server_identity(identity)) {
+			memory_map_store->erase(identity);
+			memory_map_image_erased = true;
+		}
+	}
+
+	static bool overlaps_memory_map_image(uint16_t start, uint16_t count) {
+		const RegisterRange* ranges = memory_map_image_ranges();
+		for (int i = 0; i < MEMORY_MAP_IMAGE_RANGES; i++) {
+			if (start < ranges[i].start + ranges[i].count && ranges[i].start < start + count) return true;
+		}
+		return false;
+	}
+
+	/**
+	 * @brief Called with the identity read while synchronizing. Loads the actuator's stored image and queues a read of the
+	 * registers it is checked against, or queues reads of the image's registers if there is none. Either holds the
+	 * handshake in synchronization until the reads are received.
+	 */
+	void load_memory_map_image() {
+		memory_map_image_erased = false;
+		uint64_t identity;
+		if (get_server_identity(identity) && memory_map_store->load(identity, memory_map_image_ranges(), MEMORY_MAP_IMAGE_RANGES, memory_map_image)) {
+			memory_map_image_loaded = true;
+			read_registers(MEMORY_MAP_CHECK_START, MEMORY_MAP_CHECK_SIZE);
+			return;
+		}
+		read_memory_map_image();
+	}
+
+	/**
+	 * @brief Called with the check registers read after loading an image. Restores the memory map from the image if they
+	 * match it; otherwise the image is stale, eg. the actuator was tuned by another controller, so it is erased and read.
+	 * Restored registers keep the time they were last received, as they weren't received now.
+	 */
+	void check_memory_map_image() {
+		memory_map_image_loaded = false;
+		const RegisterRange* ranges = memory_map_image_ranges();
+		bool matches = true;
+		int k = 0;
+		for (int i = 0; i < MEMORY_MAP_IMAGE_RANGES; i++) {
+			for (int j = 0; j < ranges[i].count; j++, k++) {
+				uint16_t address = ranges[i].start + j;
+				if (address < MEMORY_MAP_CHECK_START || address >= MEMORY_MAP_CHECK_START + MEMORY_MAP_CHECK_SIZE) continue;
+				if (!orca_reg_contents.has_value(address) || orca_reg_contents[address] != memory_map_image[k]) matches = false;
+			}
+		}
+
+		if (matches) {
+			k = 0;
+			for (int i = 0; i < MEMORY_MAP_IMAGE_RANGES; i++) {
+				for (int j = 0; j < ranges[i].count; j++) orca_reg_contents.restore(ranges[i].start + j, memory_map_image[k++]);
+			}
+			memory_map_restore_counter++;
+			return;
+		}
+		uint64_t identity;
+		if (get_server_identity(identity)) memory_map_store->erase(identity);
+		read_memory_map_image();
+	}
+
+	/**
+	 * @brief Queues reads of the image's registers, and saves them as the image once they have all been received
+	 */
+	void read_memory_map_image() {
+		const RegisterRange* ranges = memory_map_image_ranges();
+		for (int i = 0; i < MEMORY_MAP_IMAGE_RANGES; i++) read_registers(ranges[i].start, ranges[i].count);
+		memory_map_miss_counter++;
+		memory_map_save_pending = true;
+	}
+
+	/**
+	 * @brief Saves the image's registers once they have all been received
+	 */
+	void save_memory_map_image() {
+		memory_map_save_pending = false;
+		const RegisterRange* ranges = memory_map_image_ranges();
+		uint16_t values[MEMORY_MAP_IMAGE_SIZE];
+		int k = 0;
+		for (int i = 0; i < MEMORY_MAP_IMAGE_RANGES; i++) {
+			for (int j = 0; j < ranges[i].count; j++) {
+				uint16_t address = ranges[i].start + j;
+				if (!orca_reg_contents.has_value(address)) return;
+				values[k++] = orca_reg_contents[address];
+			}
+		}
+		uint64_t identity;
+		if (get_server_identity(identity)) {
+			memory_map_store->save(identity, ranges, MEMORY_MAP_IMAGE_RANGES, values);
+			memory_map_image_erased = false;
 		}
 	}
+
+	/**
+	 * @brief Requests the registers which identify the actuator, for a fast resume
+	 */
+	int enqueue_identity_request() override {
+		return read_holding_registers_fn(connection_config.server_address, SERIAL_NUMBER_LOW, COMMIT_ID_HI - SERIAL_NUMBER_LOW + 1);
+	}
+
+	/**
+	 * @brief The actuator's serial number and firmware commit ID, as last received
+	 */
+	bool get_server_identity(uint64_t& identity) override {
+		if (!orca_reg_contents.has_value(SERIAL_NUMBER_LOW) || !orca_reg_contents.has_value(COMMIT_ID_HI)) return false;
+		identity = (uint64_t(orca_reg_contents[COMMIT_ID_HI]) << 48)
+				 | (uint64_t(orca_reg_contents[COMMIT_ID_LO]) << 32)
+				 | (uint32_t(orca_reg_contents[SERIAL_NUMBER_HIGH]) << 16)
+				 | orca_reg_contents[SERIAL_NUMBER_LOW];
+		return true;
+	}
 #define KIN_CMD 32 // Number that indicates a kinematic type motor frame. Not an actual register like POS_CMD and FORCE_CMD
 #define HAP_CMD 34
-	void motor_stream_command() {
+	/**
+	 * @brief Determine the command code and value of the next motor command frame from the current mode and setpoints
+	 * @return false if the force or position stream timed out, in which case the mode returns to sleep and no command should be sent
+	 */
+	bool get_motor_command(uint8_t& command_code, int32_t& register_value) {
 		switch (comms_mode) {
-			;
-		case ForceMode: {
+		case ForceMode:
 			if (uint32_t(modbus_client.get_system_cycles() - stream_timeout_start) > stream_timeout_cycles) {		//return to sleep mode if stream timed out
 				comms_mode = SleepMode;
+				return false;
 			}
-			else {
-				motor_command_fn(connection_config.server_address, FORCE_CMD, force_command);
-			}
+			command_code = FORCE_CMD;
+			register_value = force_command;
 			break;
-		}
 		case PositionMode:
 			if (uint32_t(modbus_client.get_system_cycles() - stream_timeout_start) > stream_timeout_cycles) {   //return to sleep mode if stream timed out
 				comms_mode = SleepMode;
+				return false;
 			}
-			else {
-				motor_command_fn(connection_config.server_address, POS_CMD, position_command);
-			}
+			command_code = POS_CMD;
+			register_value = position_command;
 			break;
 		case KinematicMode:
-			motor_command_fn(connection_config.server_address, KIN_CMD, 0);
+			command_code = KIN_CMD;
+			register_value = 0;
 			break;
 		case HapticMode:
-			motor_command_fn(connection_config.server_address, HAP_CMD, 0);
+			command_code = HAP_CMD;
+			register_value = 0;
 			break;
 		default:
-			motor_command_fn(connection_config.server_address, 0, 0); //any register address other than force or position register_adresses will induce sleep mode and provided register_value will be ignored
+			command_code = 0;		//any register address other than force or position register_adresses will induce sleep mode and provided register_value will be ignored
+			register_value = 0;
 			break;
 		}
+		return true;
+	}
+
+	void motor_stream_command() {
+		uint8_t command_code;
+		int32_t register_value;
+		if (get_motor_command(command_code, register_value)) {
+			motor_command_fn(connection_config.server_address, command_code, register_value);
+		}
 	}
 
 	void motor_stream_read() {
@@ -851,16 +1437,28 @@ private:
 	}
 
 	/**
-	 * @brief enqueue a motor message if the queue is empty
+	 * @brief enqueue a motor message if the queue holds fewer messages than the stream depth allows
 	 */
 	void enqueue_motor_frame() {
-		if(modbus_client.get_queue_size() >= 2) return;
+		if (!stream_depth.may_enqueue(modbus_client.get_queue_size())) return;
+
+		uint8_t level = deadline_watchdog.get_level();
+		if (level >= HalfRateStream) {
+			uint8_t divisor = level == HalfRateStream ? 2 : 4;
+			if (++stream_opportunities < divisor) return;
+			stream_opportunities = 0;
+		}
+
+		MB_TRACE(modbus_client.get_trace_track(), enqueue_begin, ModbusTrace::NO_FRAME, 0);
 		switch (stream_mode) {
 		case MotorCommand:
 			motor_stream_command();
 			break;
 		case MotorRead:
-			motor_stream_read();
+			// a motor command frame returns the same feedback as a read frame, except the read stream register and the mode;
+			// only kinematic and haptic commands carry no setpoint, so force and position streams keep reading
+			if (level >= ShedReadStream && (comms_mode == KinematicMode || comms_mode == HapticMode)) motor_stream_command();
+			else motor_stream_read();
 			break;
 		case MotorWrite:
 			motor_stream_write();
@@ -877,11 +1475,11 @@ private:
 	int get_app_reception_length(uint8_t fn_code){
 		switch(fn_code){
 		case motor_command:
-			return 19;
+			return MOTOR_COMMAND_RESPONSE_LEN;
 		case motor_read:
-			return 24;
+			return MOTOR_READ_RESPONSE_LEN;
 		case motor_write:
-			return 20;
+			return MOTOR_WRITE_RESPONSE_LEN;
 		default:
 			return -1;
 		}
@@ -896,6 +1494,23 @@ private:
 		motor_write = 105
 	};
 
+	// stores the fixed fields of stream responses in orca_reg_contents
+	typedef StaticResponseDecoder<
+		StaticResponseLayout<motor_command, MOTOR_COMMAND_RESPONSE_LEN - 4, StreamResponseFields<>::motor_command,
+			sizeof(StreamResponseFields<>::motor_command) / sizeof(ResponseField)>,
+		StaticResponseLayout<motor_read, MOTOR_READ_RESPONSE_LEN - 4, StreamResponseFields<>::motor_read,
+			sizeof(StreamResponseFields<>::motor_read) / sizeof(ResponseField)>,
+		StaticResponseLayout<motor_write, MOTOR_WRITE_RESPONSE_LEN - 4, StreamResponseFields<>::motor_write,
+			sizeof(StreamResponseFields<>::motor_write) / sizeof(ResponseField)>
+	> StreamDecoder;
+
+	/**
+	 * @brief true for the function codes sent by enqueue_motor_frame
+	 */
+	bool is_stream_function_code(uint8_t fn_code) {
+		return fn_code == motor_command || fn_code == motor_read || fn_code == motor_write;
+	}
+
 	/**
       @brief Format a motor command request, function code 0x64, and add the request to the buffer queue
 
@@ -904,53 +1519,107 @@ private:
       @param register_value The value to write to the register
 	 */
 	int motor_command_fn(uint8_t device_address, uint8_t command_code, int32_t register_value) {
-		uint8_t data_bytes[5] = { 
-				uint8_t(command_code),
-				uint8_t(register_value >> 24),
-				uint8_t(register_value >> 16),
-				uint8_t(register_value >> 8),
-				uint8_t(register_value)
-		};
+		uint8_t data_bytes[5];
+		format_motor_command(data_bytes, command_code, register_value);
 		my_temp_transaction.load_transmission_data(device_address, motor_command, data_bytes, 5, get_app_reception_length(motor_command));
+		my_temp_transaction.mark_late_bound();
 		int check = modbus_client.enqueue_transaction(my_temp_transaction);
 		my_temp_transaction.reset_transaction();
 		return check;
 	}
 
 	int motor_read_fn(uint8_t device_address, uint8_t width, uint16_t register_address) {
-		uint8_t data_bytes[3] = {
-				uint8_t(register_address>>8), 
-				uint8_t(register_address),
-				uint8_t(width)
-		};
-
+		uint8_t data_bytes[3];
+		format_motor_read(data_bytes, width, register_address);
 		my_temp_transaction.load_transmission_data(device_address, motor_read, data_bytes, 3, get_app_reception_length(motor_read));
+		my_temp_transaction.mark_late_bound();
 		int check = modbus_client.enqueue_transaction(my_temp_transaction);
 		my_temp_transaction.reset_transaction();
 		return check;
 	}
 
 	int motor_write_fn(uint8_t device_address, uint8_t width, uint16_t register_address, uint32_t register_value) {
-		uint8_t data_bytes[7] = {
-				uint8_t(register_address >> 8),
-				uint8_t(register_address),
-				uint8_t(width),
-				uint8_t(register_value >> 24),
-				uint8_t(register_value >> 16),
-				uint8_t(register_value >> 8),
-				uint8_t(register_value)
-		};
-
+		uint8_t data_bytes[7];
+		format_motor_write(data_bytes, width, register_address, register_value);
 		my_temp_transaction.load_transmission_data(device_address, motor_write, data_bytes, 7, get_app_reception_length(motor_write));
+		my_temp_transaction.mark_late_bound();
 		int check = modbus_client.enqueue_transaction(my_temp_transaction);
 		my_temp_transaction.reset_transaction();
 		return check;
 	}
 
+	void format_motor_command(uint8_t* data_bytes, uint8_t command_code, int32_t register_value) {
+		data_bytes[0] = uint8_t(command_code);
+		data_bytes[1] = uint8_t(register_value >> 24);
+		data_bytes[2] = uint8_t(register_value >> 16);
+		data_bytes[3] = uint8_t(register_value >> 8);
+		data_bytes[4] = uint8_t(register_value);
+	}
+
+	void format_motor_read(uint8_t* data_bytes, uint8_t width, uint16_t register_address) {
+		data_bytes[0] = uint8_t(register_address >> 8);
+		data_bytes[1] = uint8_t(register_address);
+		data_bytes[2] = uint8_t(width);
+	}
+
+	void format_motor_write(uint8_t* data_bytes, uint8_t width, uint16_t register_address, uint32_t register_value) {
+		data_bytes[0] = uint8_t(register_address >> 8);
+		data_bytes[1] = uint8_t(register_address);
+		data_bytes[2] = uint8_t(width);
+		data_bytes[3] = uint8_t(register_value >> 24);
+		data_bytes[4] = uint8_t(register_value >> 16);
+		data_bytes[5] = uint8_t(register_value >> 8);
+		data_bytes[6] = uint8_t(register_value);
+	}
+
+	/**
+	 * @brief Rebuilds a stream frame from the latest setpoints as its transmission starts
+	 *
+	 * Stream frames are enqueued as late bound placeholders. Without this, a frame carries the setpoint that was current
+	 * when it was enqueued, which may be one or more frame times old by the time it is sent.
+	 * Every motor command, read and write frame is rebuilt by its own function code, even one enqueued before the
+	 * stream mode changed, so it carries the current setpoints of that function code rather than those it was enqueued with.
+	 */
+	void bind_transmission(Transaction* transaction, uint32_t now_cycles) override {
+		uint32_t setpoint_age = 0;
+		switch (transaction->get_tx_function_code()) {
+		case motor_command: {
+			uint8_t data_bytes[5];
+			uint8_t command_code = 0;
+			int32_t register_value = 0;
+			get_motor_command(command_code, register_value);	// a timed out stream is sent as a sleep command
+			format_motor_command(data_bytes, command_code, register_value);
+			transaction->rebind_transmission_data(data_bytes, 5);
+			if (command_code == FORCE_CMD || command_code == POS_CMD) setpoint_age = now_cycles - setpoint_cycles;
+			break;
+		}
+		case motor_read: {
+			uint8_t data_bytes[3];
+			format_motor_read(data_bytes, motor_read_width, motor_read_addr);
+			transaction->rebind_transmission_data(data_bytes, 3);
+			break;
+		}
+		case motor_write: {
+			uint8_t data_bytes[7];
+			format_motor_write(data_bytes, motor_write_width, motor_write_addr, motor_write_data);
+			transaction->rebind_transmission_data(data_bytes, 7);
+			setpoint_age = now_cycles - write_stream_cycles;
+			break;
+		}
+		default:
+			break;
+		}
+		transaction->set_setpoint_age_cycles(setpoint_age);
+	}
+
 
 	////////////////////////////////////////////////////////////////////
 };
 
+template <int N> constexpr ResponseField Actuator::StreamResponseFields<N>::motor_command[];
+template <int N> constexpr ResponseField Actuator::StreamResponseFields<N>::motor_read[];
+template <int N> constexpr ResponseField Actuator::StreamResponseFields<N>::motor_write[];
+
 #ifdef IRIS_ZYNQ_7000
 extern Actuator actuator[6];
 #else
@@ -0,0 +1,186 @@
+/**
+ * @file actuator_bring_up.h
+ *
+ * @brief  Brings up several Actuators at once, each on its own port, and reports when all are ready or which failed
+ *
+ * @version 2.2.0
+
+    @copyright Copyright 2022 Iris Dynamics Ltd
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+    For questions or feedback on this file, please email <support@irisdynamics.com>.
+ */
+
+#ifndef ACTUATOR_BRING_UP_H_
+#define ACTUATOR_BRING_UP_H_
+
+#include "actuator.h"
+
+/**
+ * @class ActuatorBringUp
+ * @brief Drives the handshakes and initial memory map synchronizations of several Actuators together, with one deadline.
+ *
+ * Each Actuator's handshake only advances when its run_in() and run_out() are called, so waiting for one actuator to
+ * connect before starting the next makes startup time grow with the number of actuators. run() services every actuator
+ * in turn, so their pauses, discovery pings, synchronization reads and negotiations overlap, and startup takes about as
+ * long as the slowest actuator alone.
+ *
+ * An actuator is ready once it is connected, which includes its memory map synchronization. The bring-up is settled
+ * when every actuator is ready or the timeout has passed; actuators which weren't ready by then are reported as failed,
+ * with the furthest handshake step they reached, and don't hold up the others. They stay enabled, so they can still
+ * connect later if the application keeps calling their run_in() and run_out().
+ *
+ *  ActuatorBringUp bring_up(motors, NUM_MOTORS);
+ *  bring_up.start(5000000);
+ *  while (!bring_up.run()) {}
+ *  if (!bring_up.all_ready()) ... bring_up.get_status(i) ...
+ */
+class ActuatorBringUp {
+
+public:
+
+	static const int MAX_ACTUATORS = 64;
+
+	enum Status {
+		idle,			// start() not called yet
+		pending,		// handshake in progress
+		ready,			// connected with its memory map synchronized
+		failed			// not connected before the timeout
+	};
+
+	/**
+	 * @param _actuators actuators to bring up; only the first MAX_ACTUATORS are used
+	 * @param _count number of actuators
+	 */
+	ActuatorBringUp(Actuator* _actuators, int _count) :
+		actuators(_actuators),
+		count(_count > MAX_ACTUATORS ? MAX_ACTUATORS : _count)
+	{
+		for (int i = 0; i < MAX_ACTUATORS; i++) status[i] = idle;
+	}
+
+	/**
+	 * @brief Initialize and enable every actuator which isn't already connected, and start the deadline
+	 * @param timeout_us time allowed for every actuator to become ready
+	 * @param selection bit i selects the actuator at index i; actuators which aren't selected are left alone and stay idle
+	 */
+	void start(uint32_t timeout_us, uint64_t selection = ~uint64_t(0)) {
+		timeout_cycles = timeout_us * actuators[0].get_cycles_per_us();
+		start_cycles = now();
+		settled = false;
+		for (int i = 0; i < count; i++) {
+			furthest_step[i] = Actuator::disconnected;
+			ready_us[i] = 0;
+			if (!((selection >> i) & 1)) {
+				status[i] = idle;
+				continue;
+			}
+			if (actuators[i].is_connected()) {
+				status[i] = ready;
+				continue;
+			}
+			status[i] = pending;
+			actuators[i].init();
+			actuators[i].enable();
+		}
+		update();
+	}
+
+	/**
+	 * @brief Service every actuator once, then update their status. Should be called repeatedly until it returns true.
+	 * @return true once the bring-up has settled: every actuator is ready or the timeout has passed
+	 */
+	bool run() {
+		for (int i = 0; i < count; i++) {
+			actuators[i].run_in();
+			actuators[i].run_out();
+		}
+		return update();
+	}
+
+	/// @brief true once every actuator is ready or the timeout has passed
+	bool is_settled() { return settled; }
+
+	/// @brief true if every actuator is ready
+	bool all_ready() { return get_ready_count() == count; }
+
+	Status get_status(int index) { return index >= 0 && index < count ? status[index] : idle; }
+
+	/**
+	 * @brief The furthest handshake step an actuator reached, eg. Actuator::discovery for a server which never answered a ping
+	 */
+	Actuator::ConnectionStatus get_furthest_step(int index) {
+		return index >= 0 && index < count ? furthest_step[index] : Actuator::disconnected;
+	}
+
+	/// @brief time from start() until the actuator became ready, or 0 if it hasn't
+	uint32_t get_ready_time_us(int index) { return index >= 0 && index < count ? ready_us[index] : 0; }
+
+	/// @brief time since start()
+	uint32_t get_elapsed_us() { return (now() - start_cycles) / actuators[0].get_cycles_per_us(); }
+
+	int get_ready_count() {
+		int ready_count = 0;
+		for (int i = 0; i < count; i++) if (status[i] == ready) ready_count++;
+		return ready_count;
+	}
+
+	int get_failed_count() {
+		int failed_count = 0;
+		for (int i = 0; i < count; i++) if (status[i] == failed) failed_count++;
+		return failed_count;
+	}
+
+private:
+
+	Actuator* actuators;
+	const int count;
+
+	Status status[MAX_ACTUATORS];
+	Actuator::ConnectionStatus furthest_step[MAX_ACTUATORS];
+	uint32_t ready_us[MAX_ACTUATORS];
+
+	uint32_t start_cycles = 0;
+	uint32_t timeout_cycles = 0;
+	bool settled = false;
+
+	uint32_t now() { return actuators[0].modbus_client.get_system_cycles(); }
+
+	bool update() {
+		if (settled) return true;
+		bool timed_out = (uint32_t)(now() - start_cycles) >= timeout_cycles;
+		int outstanding = 0;
+
+		for (int i = 0; i < count; i++) {
+			if (status[i] != pending) continue;
+
+			Actuator::ConnectionStatus step = actuators[i].connection_state;
+			if (step > furthest_step[i] && step != Actuator::resuming) furthest_step[i] = step;
+
+			if (actuators[i].is_connected()) {
+				status[i] = ready;
+				ready_us[i] = get_elapsed_us();
+			}
+			else if (timed_out) {
+				status[i] = failed;
+			}
+			else {
+				outstanding++;
+			}
+		}
+		settled = outstanding == 0;
+		return settled;
+	}
+};
+
+#endif
@@ -0,0 +1,277 @@
+/**
+ * @file actuator_command_queue.h
+ *
+ * @brief  Lock-free command ingress for an Actuator driven from a dedicated communication thread
+ *
+ * @version 2.2.0
+
+    @copyright Copyright 2022 Iris Dynamics Ltd
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+    For questions or feedback on this file, please email <support@irisdynamics.com>.
+ */
+
+#ifndef ACTUATOR_COMMAND_QUEUE_H_
+#define ACTUATOR_COMMAND_QUEUE_H_
+
+#include <atomic>
+#include "actuator.h"
+
+/**
+ * @class ActuatorCommandQueue
+ * @brief Lets any number of threads post commands to an Actuator which is only ever touched by one communication thread.
+ *
+ * Setpoints (force, position, and the read and write stream targets) are posted to single slot mailboxes.
+ * A newer setpoint replaces an older one that hasn't been drained, so only the latest value reaches the Actuator.
+ * Register operations and mode changes are posted to a bounded ring and are applied in the order they were posted.
+ * No call blocks or takes a lock.
+ *
+ * The communication thread calls drain() once per cycle, before Actuator::run_out().
+ * Mode changes and register operations are applied before the setpoints of the same drain. If the Actuator's message
+ * queue can't take an operation, drain() stops there and leaves the setpoints for a later drain, so a setpoint is never
+ * applied ahead of an operation posted before it.
+ */
+class ActuatorCommandQueue {
+
+public:
+
+	static const int QUEUE_SIZE = 64;			// register operations that may be waiting; must be a power of 2
+	static const int MAX_OP_REGISTERS = 16;		// registers carried by a single write_registers operation
+
+	ActuatorCommandQueue() {
+		for (int i = 0; i < QUEUE_SIZE; i++) {
+			cells[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////// Any thread: setpoints //////
+///////////////////////////////////////////////////////////
+
+	/// @brief Equivalent to Actuator::set_force_mN(). Replaces any force not yet drained.
+	void post_force_mN(int32_t force) {
+		force_mailbox.store(PENDING | (uint32_t)force, std::memory_order_release);
+	}
+
+	/// @brief Equivalent to Actuator::set_position_um(). Replaces any position not yet drained.
+	void post_position_um(int32_t position) {
+		position_mailbox.store(PENDING | (uint32_t)position, std::memory_order_release);
+	}
+
+	/// @brief Equivalent to Actuator::update_write_stream(). Replaces any write stream target not yet drained.
+	void post_write_stream(uint8_t width, uint16_t register_address, uint32_t register_value) {
+		write_stream_mailbox.store(PENDING | (uint64_t(width) << 48) | (uint64_t(register_address) << 32) | register_value, std::memory_order_release);
+	}
+
+	/// @brief Equivalent to Actuator::update_read_stream(). Replaces any read stream target not yet drained.
+	void post_read_stream(uint8_t width, uint16_t register_address) {
+		read_stream_mailbox.store(PENDING | (uint64_t(width) << 16) | register_address, std::memory_order_release);
+	}
+
+	/// @brief Equivalent to Actuator::set_stream_mode(). Replaces any stream mode not yet drained.
+	void post_stream_mode(Actuator::StreamMode mode) {
+		stream_mode_mailbox.store(PENDING | (uint32_t)mode, std::memory_order_release);
+	}
+
+/////////////////////////////////////////////////////////////
+/////////////////////// Any thread: ordered operations /////
+///////////////////////////////////////////////////////////
+
+	/**
+	 * @brief Equivalent to Actuator::set_mode()
+	 * @return false if the queue is full and the operation was dropped
+	 */
+	bool post_set_mode(Actuator::MotorMode mode) {
+		return post(op_set_mode, (uint16_t)mode, 0, 0);
+	}
+
+	/// @brief Equivalent to Actuator::enable(). Returns false if the queue is full.
+	bool post_enable() {
+		return post(op_enable, 1, 0, 0);
+	}
+
+	/// @brief Equivalent to Actuator::disable(). Returns false if the queue is full.
+	bool post_disable() {
+		return post(op_enable, 0, 0, 0);
+	}
+
+	/// @brief Equivalent to Actuator::zero_position(). Returns false if the queue is full.
+	bool post_zero_position() {
+		return post_write_register(ZERO_POS_REG_OFFSET, ZERO_POS_MASK);
+	}
+
+	/// @brief Equivalent to Actuator::clear_errors(). Returns false if the queue is full.
+	bool post_clear_errors() {
+		return post_write_register(CLEAR_ERROR_REG_OFFSET, CLEAR_ERROR_MASK);
+	}
+
+	/// @brief Equivalent to Actuator::write_register(). Returns false if the queue is full.
+	bool post_write_register(uint16_t reg_address, uint16_t reg_data) {
+		return post(op_write_registers, reg_address, 1, &reg_data);
+	}
+
+	/// @brief Equivalent to Actuator::write_registers(). Returns false if the queue is full or num_registers exceeds MAX_OP_REGISTERS.
+	bool post_write_registers(uint16_t reg_address, uint16_t num_registers, uint16_t* reg_data) {
+		if (num_registers == 0 || num_registers > MAX_OP_REGISTERS) return false;
+		return post(op_write_registers, reg_address, num_registers, reg_data);
+	}
+
+	/// @brief Equivalent to Actuator::read_registers(). Returns false if the queue is full or num_registers exceeds MAX_NUM_READ_REG.
+	bool post_read_registers(uint16_t reg_address, uint16_t num_registers) {
+		if (num_registers == 0 || num_registers > MAX_NUM_READ_REG) return false;
+		return post(op_read_registers, reg_address, num_registers, 0);
+	}
+
+	/// @brief Number of operations dropped because the queue was full
+	uint32_t get_dropped_count() {
+		return dropped.load(std::memory_order_relaxed);
+	}
+
+/////////////////////////////////////////////////////////////
+//////////////////////////// Communication thread only /////
+///////////////////////////////////////////////////////////
+
+	/**
+	 * @brief Apply everything posted since the last drain to the actuator
+	 * @param max_operations limit on the register operations applied by this call, so a burst doesn't crowd out the stream.
+	 * Operations beyond the limit stay queued for the next drain, as do those the actuator's message queue has no room for.
+	 * While an operation waits for room the setpoints wait too, so they are never applied ahead of it. Operations held back
+	 * by max_operations don't hold the setpoints, so a setpoint can then overtake operations posted before it.
+	 * @return the number of register operations applied
+	 */
+	int drain(Actuator& actuator, int max_operations = QUEUE_SIZE) {
+
+		int applied = 0;
+		while (applied < max_operations) {
+			Cell& cell = cells[read_position & (QUEUE_SIZE - 1)];
+			if (cell.sequence.load(std::memory_order_acquire) != read_position + 1) break;	// next cell not yet published
+
+			// the actuator's message queue is full: retry this operation next drain, and keep the setpoints until then so
+			// none reaches the actuator ahead of an operation posted before it
+			if (!apply(actuator, cell.op)) return applied;
+			cell.sequence.store(read_position + QUEUE_SIZE, std::memory_order_release);
+			read_position++;
+			applied++;
+		}
+
+		uint64_t value;
+		if ((value = stream_mode_mailbox.exchange(0, std::memory_order_acquire)) & PENDING) {
+			actuator.set_stream_mode((Actuator::StreamMode)(uint32_t)value);
+		}
+		if ((value = force_mailbox.exchange(0, std::memory_order_acquire)) & PENDING) {
+			actuator.set_force_mN((int32_t)(uint32_t)value);
+		}
+		if ((value = position_mailbox.exchange(0, std::memory_order_acquire)) & PENDING) {
+			actuator.set_position_um((int32_t)(uint32_t)value);
+		}
+		if ((value = write_stream_mailbox.exchange(0, std::memory_order_acquire)) & PENDING) {
+			actuator.update_write_stream(uint8_t(value >> 48), uint16_t(value >> 32), uint32_t(value));
+		}
+		if ((value = read_stream_mailbox.exchange(0, std::memory_order_acquire)) & PENDING) {
+			actuator.update_read_stream(uint8_t(value >> 16), uint16_t(value));
+		}
+		return applied;
+	}
+
+private:
+
+	static const uint64_t PENDING = uint64_t(1) << 63;	// set in a mailbox holding a value not yet drained
+
+	enum OP_TYPE {
+		op_set_mode,
+		op_enable,
+		op_write_registers,
+		op_read_registers
+	};
+
+	struct Operation {
+		uint8_t type;
+		uint16_t address;
+		uint16_t num_registers;
+		uint16_t data[MAX_OP_REGISTERS];
+	};
+
+	/**
+	 * A cell's sequence equals its position when free for that position, and position + 1 once published
+	 */
+	struct Cell {
+		std::atomic<uint32_t> sequence;
+		Operation op;
+	};
+
+	Cell cells[QUEUE_SIZE];
+	std::atomic<uint32_t> write_position{ 0 };
+	uint32_t read_position = 0;
+	std::atomic<uint32_t> dropped{ 0 };
+
+	std::atomic<uint64_t> force_mailbox{ 0 };
+	std::atomic<uint64_t> position_mailbox{ 0 };
+	std::atomic<uint64_t> write_stream_mailbox{ 0 };
+	std::atomic<uint64_t> read_stream_mailbox{ 0 };
+	std::atomic<uint64_t> stream_mode_mailbox{ 0 };
+
+	/**
+	 * @brief Claim a cell with a compare and swap on the write position, fill it, then publish it
+	 */
+	bool post(OP_TYPE type, uint16_t address, uint16_t num_registers, uint16_t* data) {
+
+		uint32_t position = write_position.load(std::memory_order_relaxed);
+		Cell* cell;
+		for (;;) {
+			cell = &cells[position & (QUEUE_SIZE - 1)];
+			int32_t difference = (int32_t)(cell->sequence.load(std::memory_order_acquire) - position);
+			if (difference == 0) {
+				if (write_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+			}
+			else if (difference < 0) {
+				dropped.fetch_add(1, std::memory_order_relaxed);	// the consumer hasn't freed this cell yet: full
+				return false;
+			}
+			else {
+				position = write_position.load(std::memory_order_relaxed);
+			}
+		}
+
+		cell->op.type = type;
+		cell->op.address = address;
+		cell->op.num_registers = num_registers;
+		for (int i = 0; data && i < num_registers; i++) cell->op.data[i] = data[i];
+		cell->sequence.store(position + 1, std::memory_order_release);
+		return true;
+	}
+
+	/**
+	 * @brief Pass an operation to the actuator
+	 * @return false if the actuator's message queue had no room for it
+	 */
+	bool apply(Actuator& actuator, Operation& op) {
+		switch (op.type) {
+		case op_set_mode:
+			return actuator.set_mode((Actuator::MotorMode)op.address);
+		case op_enable:
+			if (op.address) actuator.enable();
+			else actuator.disable();
+			return true;
+		case op_write_registers:
+			if (op.num_registers == 1) return actuator.write_register(op.address, op.data[0]);
+			return actuator.write_registers(op.address, op.num_registers, op.data);
+		case op_read_registers:
+			if (op.num_registers == 1) return actuator.read_register(op.address);
+			return actuator.read_registers(op.address, op.num_registers);
+		default:
+			return true;
+		}
+	}
+};
+
+#endif
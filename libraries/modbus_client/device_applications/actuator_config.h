@@ -31,6 +31,8 @@
 #include "../device_drivers/windows/windows_modbus_client.h"
 #elif defined(QT_WINDOWS)
 #include "qt_modbus_client.h"
+#elif defined(TRANSPORT_CLIENT)
+#include "../device_drivers/transport/transport_modbus_client.h"
 #endif
 
 
@@ -0,0 +1,363 @@
+/**
+ * @file actuator_cycle_executor.h
+ *
+ * @brief  Runs one communication thread per port, aligned to a shared control cycle
+ *
+ * @version 2.2.0
+
+    @copyright Copyright 2022 Iris Dynamics Ltd
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+    For questions or feedback on this file, please email <support@irisdynamics.com>.
+ */
+
+#ifndef ACTUATOR_CYCLE_EXECUTOR_H_
+#define ACTUATOR_CYCLE_EXECUTOR_H_
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "actuator_snapshot.h"
+
+#if defined(__linux__)
+#include <pthread.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#endif
+
+/**
+ * @brief One port's feedback for a cycle
+ */
+struct CycleSample {
+	ActuatorFeedback feedback;		//!< response_count and watched_values are not filled
+	bool     fresh;					//!< the feedback came from a frame sent during this cycle; false if it is older, eg. the port timed out
+	uint32_t sent_cycles;			//!< client system time the frame carrying this cycle's commands started to be sent, if fresh
+};
+
+/**
+ * @brief Timing of one cycle
+ */
+struct CycleReport {
+	uint32_t cycle;
+	uint32_t release_cycles;		//!< client system time the ports were released to send their commands
+	uint32_t collect_us;			//!< from the release until the last port's sample arrived
+	uint32_t sample_skew_us;		//!< spread of the fresh samples' sample instants
+	uint32_t command_skew_us;		//!< spread of the times the fresh frames, which carried the previous cycle's commands, started to be sent
+	int      fresh_count;			//!< ports with a fresh sample
+	bool     overrun;				//!< the previous cycle ran past this cycle's start, which was moved to the end of the previous one
+};
+
+/**
+ * @class CycleController
+ * @brief The application's control law, called once per cycle with every port's sample
+ */
+class CycleController {
+public:
+	virtual ~CycleController() {}
+
+	/**
+	 * @brief Called from one of the port threads while every other port thread waits, so any actuator may be read or
+	 * commanded, eg. with update_write_stream() or set_force_mN(). The commands are sent when the ports are released.
+	 * Must return well within the cycle period.
+	 * @param samples one per actuator, in the order given to the executor
+	 */
+	virtual void on_cycle(Actuator* actuators, const CycleSample* samples, int count, uint32_t cycle) = 0;
+};
+
+/**
+ * @class ActuatorCycleExecutor
+ * @brief Exchanges one stream frame per cycle with every actuator, each on its own thread, in lockstep.
+ *
+ * Each cycle, every port thread waits for the shared release time, then sends its stream frame, which binds the commands
+ * set by the previous on_cycle() as it is transmitted. The thread services its actuator until the response to that frame
+ * has been decoded, then arrives at the cycle barrier. The last port to arrive calls the controller with every port's
+ * sample and schedules the next release, so the controller always sees samples taken by the same exchange on every port.
+ *
+ * A port whose response doesn't arrive within the sample timeout arrives with a stale sample. A disconnected port keeps
+ * servicing its handshake until every connected port has arrived, so it doesn't hold the cycle back.
+ *
+ * Threads sleep until shortly before each release, then spin so the frames leave together; they also spin at the barrier,
+ * yielding to other threads. Pin them to separate cores with set_core() where the system allows. The actuators' run_in() and run_out() must not be called elsewhere while the executor runs.
+ *
+ *  ActuatorCycleExecutor executor(motors, 2);
+ *  executor.set_core(0, 2);
+ *  executor.set_core(1, 3);
+ *  executor.start(&linker, 1000);
+ *  ... executor.get_last_report(report) ...
+ *  executor.stop();
+ */
+class ActuatorCycleExecutor {
+
+public:
+
+	static const int MAX_PORTS = 16;
+	static const uint32_t START_LEAD_US = 2000;		// time allowed for the threads to start before the first release
+	static const uint32_t SPIN_US = 200;			// the port threads spin rather than sleep this close to a release
+
+	/**
+	 * @param _actuators one actuator per port
+	 * @param _count number of ports; only the first MAX_PORTS are used
+	 */
+	ActuatorCycleExecutor(Actuator* _actuators, int _count) :
+		actuators(_actuators),
+		count(_count > MAX_PORTS ? MAX_PORTS : _count)
+	{
+		for (int i = 0; i < MAX_PORTS; i++) cores[i] = -1;
+	}
+
+	~ActuatorCycleExecutor() {
+		stop();
+	}
+
+	/**
+	 * @brief Pin a port's thread to a core when the executor starts; -1, the default, leaves it unpinned
+	 */
+	void set_core(int port, int core) {
+		if (port >= 0 && port < MAX_PORTS) cores[port] = core;
+	}
+
+	/**
+	 * @brief Time a port may take to get a fresh sample after the release before it arrives with a stale one
+	 */
+	void set_sample_timeout_us(uint32_t timeout_us) { sample_timeout_us = timeout_us; }
+
+	/**
+	 * @brief Start the port threads
+	 * @param _controller called once per cycle; must outlive the executor's run
+	 * @param _period_us time between releases, or 0 to start each cycle as soon as the previous one completes
+	 * @return false if already running, or a thread couldn't be pinned to its core; no threads are left running then
+	 */
+	bool start(CycleController* _controller, uint32_t _period_us = 0) {
+		if (running || count <= 0) return false;
+		controller = _controller;
+		period_us = _period_us;
+		cycle = 0;
+		arrived.store(0, std::memory_order_relaxed);
+		generation.store(0, std::memory_order_relaxed);
+		count_connected_ports();
+		completed_cycles = 0;
+		stale_samples = 0;
+		overruns = 0;
+		max_sample_skew_us = 0;
+		max_command_skew_us = 0;
+		release_cycles = now() + START_LEAD_US * cycles_per_us();
+
+		running = true;
+		bool pinned = true;
+		for (int i = 0; i < count; i++) {
+			threads[i] = std::thread(&ActuatorCycleExecutor::port_thread, this, i);
+			if (cores[i] >= 0 && !pin(threads[i], cores[i])) pinned = false;
+		}
+		if (!pinned) stop();
+		return pinned;
+	}
+
+	/**
+	 * @brief Stop the port threads and wait for them to finish; the actuators may then be run by the application again
+	 */
+	void stop() {
+		running = false;
+		for (int i = 0; i < count; i++) {
+			if (threads[i].joinable()) threads[i].join();
+		}
+	}
+
+	bool is_running() { return running; }
+
+	/**
+	 * @brief Copy the report of the most recent cycle, from any thread
+	 * @return false if no cycle has completed yet
+	 */
+	bool get_last_report(CycleReport& report) const {
+		if (!last_report.get_write_count()) return false;
+		return last_report.read(report);
+	}
+
+	/// @brief number of cycles completed
+	uint32_t get_cycle_count() const { return completed_cycles.load(std::memory_order_relaxed); }
+
+	/// @brief samples which weren't fresh, over all ports and cycles
+	uint32_t get_stale_sample_count() const { return stale_samples.load(std::memory_order_relaxed); }
+
+	/// @brief cycles which started late because the previous one ran past their start
+	uint32_t get_overrun_count() const { return overruns.load(std::memory_order_relaxed); }
+
+	/// @brief largest skews seen since start()
+	uint32_t get_max_sample_skew_us() const { return max_sample_skew_us.load(std::memory_order_relaxed); }
+	uint32_t get_max_command_skew_us() const { return max_command_skew_us.load(std::memory_order_relaxed); }
+
+private:
+
+	Actuator* actuators;
+	const int count;
+	int cores[MAX_PORTS];
+	std::thread threads[MAX_PORTS];
+
+	CycleController* controller = 0;
+	uint32_t period_us = 0;
+	uint32_t sample_timeout_us = 10000;
+	std::atomic<bool> running{ false };
+
+	// the barrier; everything below it is written only by the port completing the cycle, while the others wait
+	std::atomic<int> arrived{ 0 };
+	std::atomic<uint32_t> generation{ 0 };
+	std::atomic<int> pending_connected{ 0 };		// connected ports yet to arrive this cycle
+
+	CycleSample samples[MAX_PORTS];
+	uint32_t cycle = 0;
+	uint32_t release_cycles = 0;
+	bool overrun = false;
+
+	Seqlock<CycleReport> last_report;
+	std::atomic<uint32_t> completed_cycles{ 0 };
+	std::atomic<uint32_t> stale_samples{ 0 };
+	std::atomic<uint32_t> overruns{ 0 };
+	std::atomic<uint32_t> max_sample_skew_us{ 0 };
+	std::atomic<uint32_t> max_command_skew_us{ 0 };
+
+	// every actuator is on the same host, so any of their clocks gives the shared timebase
+	uint32_t now() { return actuators[0].modbus_client.get_system_cycles(); }
+	uint32_t cycles_per_us() { return actuators[0].get_cycles_per_us(); }
+
+	void port_thread(int port) {
+		Actuator& actuator = actuators[port];
+		uint32_t seen_generation = 0;
+
+		while (running) {
+			// the release time was published with the generation; send the commands together at it
+			uint32_t release = release_cycles;
+			wait_until(release);
+			collect(actuator, port, release);
+
+			seen_generation = generation.load(std::memory_order_acquire);
+			if (arrived.fetch_add(1, std::memory_order_acq_rel) == count - 1) {
+				complete_cycle();
+				arrived.store(0, std::memory_order_relaxed);
+				generation.fetch_add(1, std::memory_order_release);
+			}
+			else {
+				while (running && generation.load(std::memory_order_acquire) == seen_generation) std::this_thread::yield();
+			}
+		}
+	}
+
+	/**
+	 * @brief Sleep until shortly before the time, so waiting ports leave the cores to the others, then spin up to it
+	 */
+	void wait_until(uint32_t time_cycles) {
+		uint32_t spin_cycles = SPIN_US * cycles_per_us();
+		while (running) {
+			int32_t remaining = int32_t(time_cycles - now());
+			if (remaining <= 0) return;
+			if (uint32_t(remaining) > spin_cycles) std::this_thread::sleep_for(std::chrono::microseconds((remaining - spin_cycles) / cycles_per_us()));
+			else std::this_thread::yield();
+		}
+	}
+
+	/**
+	 * @brief Count the ports the next cycle waits for; called while no port thread is collecting
+	 */
+	void count_connected_ports() {
+		int connected = 0;
+		for (int i = 0; i < count; i++) if (actuators[i].is_connected()) connected++;
+		pending_connected.store(connected, std::memory_order_relaxed);
+	}
+
+	/**
+	 * @brief Send the port's frame and service the actuator until its response arrives, or it times out
+	 */
+	void collect(Actuator& actuator, int port, uint32_t release) {
+		bool counted = actuator.is_connected();
+		uint32_t timeout_cycles = sample_timeout_us * cycles_per_us();
+		uint32_t samples_before = actuator.get_stream_sample_count();
+		bool fresh = false;
+
+		while (running) {
+			actuator.run_in();
+			// a sample from a frame sent before the release, eg. one still in flight at the barrier, doesn't count
+			fresh = actuator.is_connected() && actuator.get_stream_sample_count() != samples_before
+				&& int32_t(actuator.get_last_sent_cycles() - release) >= 0;
+			if (fresh || uint32_t(now() - release) >= timeout_cycles) break;
+			if (counted && !actuator.is_connected()) {
+				pending_connected.fetch_sub(1, std::memory_order_acq_rel);
+				counted = false;
+			}
+			actuator.run_out();
+			if (!counted && pending_connected.load(std::memory_order_acquire) <= 0) break;
+			std::this_thread::yield();
+		}
+		if (counted) pending_connected.fetch_sub(1, std::memory_order_acq_rel);
+
+		CycleSample& sample = samples[port];
+		ActuatorSnapshot::capture(actuator, sample.feedback);
+		sample.fresh = fresh;
+		sample.sent_cycles = fresh ? actuator.get_last_sent_cycles() : 0;
+	}
+
+	/**
+	 * @brief Run by the last port to arrive: report the cycle, call the controller and schedule the next release
+	 */
+	void complete_cycle() {
+		uint32_t arrival_cycles = now();
+		CycleReport report = {};
+		report.cycle = cycle;
+		report.release_cycles = release_cycles;
+		report.collect_us = (arrival_cycles - release_cycles) / cycles_per_us();
+		report.overrun = overrun;
+
+		uint32_t first_sample = 0, last_sample = 0, first_sent = 0, last_sent = 0;
+		for (int i = 0; i < count; i++) {
+			const CycleSample& sample = samples[i];
+			if (!sample.fresh) continue;
+			if (!report.fresh_count || int32_t(sample.feedback.sample_cycles - first_sample) < 0) first_sample = sample.feedback.sample_cycles;
+			if (!report.fresh_count || int32_t(sample.feedback.sample_cycles - last_sample) > 0) last_sample = sample.feedback.sample_cycles;
+			if (!report.fresh_count || int32_t(sample.sent_cycles - first_sent) < 0) first_sent = sample.sent_cycles;
+			if (!report.fresh_count || int32_t(sample.sent_cycles - last_sent) > 0) last_sent = sample.sent_cycles;
+			report.fresh_count++;
+		}
+		report.sample_skew_us = (last_sample - first_sample) / cycles_per_us();
+		report.command_skew_us = (last_sent - first_sent) / cycles_per_us();
+
+		stale_samples.fetch_add(count - report.fresh_count, std::memory_order_relaxed);
+		if (report.sample_skew_us > max_sample_skew_us.load(std::memory_order_relaxed)) max_sample_skew_us.store(report.sample_skew_us, std::memory_order_relaxed);
+		if (report.command_skew_us > max_command_skew_us.load(std::memory_order_relaxed)) max_command_skew_us.store(report.command_skew_us, std::memory_order_relaxed);
+		last_report.write(report);
+
+		if (controller) controller->on_cycle(actuators, samples, count, cycle);
+
+		count_connected_ports();
+
+		cycle++;
+		completed_cycles.store(cycle, std::memory_order_relaxed);
+		uint32_t next = release_cycles + period_us * cycles_per_us();
+		overrun = period_us && int32_t(now() - next) > 0;
+		if (!period_us || overrun) next = now();
+		if (overrun) overruns.fetch_add(1, std::memory_order_relaxed);
+		release_cycles = next;
+	}
+
+	static bool pin(std::thread& thread, int core) {
+#if defined(__linux__)
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		CPU_SET(core, &set);
+		return pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set) == 0;
+#elif defined(_WIN32)
+		return SetThreadAffinityMask((HANDLE)thread.native_handle(), DWORD_PTR(1) << core) != 0;
+#else
+		return false;		// no portable way to pin a thread, eg. on macOS
+#endif
+	}
+};
+
+#endif
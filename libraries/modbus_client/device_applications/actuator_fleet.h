@@ -0,0 +1,335 @@
+/**
+ * @file actuator_fleet.h
+ *
+ * @brief  Discovers Actuators across many ports, keeps them in a registry by serial number and operates on groups of them
+ *
+ * @version 2.2.0
+
+    @copyright Copyright 2022 Iris Dynamics Ltd
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+    For questions or feedback on this file, please email <support@irisdynamics.com>.
+ */
+
+#ifndef ACTUATOR_FLEET_H_
+#define ACTUATOR_FLEET_H_
+
+#include "actuator_bring_up.h"
+#include "actuator_profile.h"
+
+/**
+ * @class ActuatorFleet
+ * @brief A registry of the Actuators found on a set of ports, addressed by serial number, with group operations.
+ *
+ * The fleet is given one Actuator per port, each already bound to its port, and a list of server addresses to try.
+ * Discovery brings up every port together with ActuatorBringUp, trying each candidate address in turn on the ports
+ * where no actuator has answered yet. The first address that completes a handshake on a port is kept, and the actuator
+ * is registered under the serial number read while synchronizing its memory map. Each Actuator owns its port's client
+ * and negotiates the port's baud rate with its server, so one actuator is kept per port even on a multidrop line.
+ *
+ * Group operations take a Group, a bit per actuator index, from all() or group(). Requests are queued on every port in
+ * the group before any is serviced, and run() services the ports in turn, so the group is operated on in parallel.
+ * get_health() sums the connection state, errors and traffic of the whole fleet.
+ *
+ *  ActuatorFleet fleet(motors, NUM_PORTS);
+ *  fleet.start_discovery();
+ *  while (!fleet.run()) {}
+ *  Actuator* left = fleet.find(1234);
+ *  fleet.set_mode(fleet.all(), Actuator::SleepMode);
+ */
+class ActuatorFleet {
+
+public:
+
+	static const int MAX_MEMBERS = ActuatorBringUp::MAX_ACTUATORS;
+	static const int MAX_ADDRESSES = 8;
+
+	typedef uint64_t Group;		// bit i selects the actuator at index i
+
+	/**
+	 * @brief The state of the fleet, with the traffic since the previous get_health()
+	 */
+	struct Health {
+		int      members;				//!< actuators discovered
+		int      connected;				//!< discovered actuators which are connected now
+		int      with_errors;			//!< connected actuators reporting active errors
+		int      uploads_pending;		//!< profile uploads not yet settled
+		uint32_t frames;				//!< transactions claimed by every actuator
+		uint32_t failed_frames;			//!< of which failed
+		float    frames_per_second;
+		float    failure_rate;			//!< failed_frames / frames
+		uint32_t max_round_trip_us;		//!< longest last round trip of any connected actuator
+	};
+
+	/**
+	 * @param _actuators one actuator per port, bound to its port; only the first MAX_MEMBERS are used
+	 * @param _count number of ports
+	 */
+	ActuatorFleet(Actuator* _actuators, int _count) :
+		actuators(_actuators),
+		count(_count > MAX_MEMBERS ? MAX_MEMBERS : _count),
+		bring_up(_actuators, _count)
+	{
+		for (int i = 0; i < MAX_MEMBERS; i++) {
+			found[i] = false;
+			serial_numbers[i] = 0;
+			address_index[i] = 0;
+			uploads[i] = 0;
+			last_claimed[i] = 0;
+			last_failed[i] = 0;
+		}
+		addresses[0] = 1;
+		address_count = 1;
+		last_health_cycles = now();
+	}
+
+	~ActuatorFleet() {
+		for (int i = 0; i < MAX_MEMBERS; i++) delete uploads[i];
+	}
+
+	/**
+	 * @brief Set the server addresses discovery tries on each port, in order. The default is address 1 only.
+	 */
+	void set_candidate_addresses(const uint8_t* _addresses, int _count) {
+		address_count = 0;
+		for (int i = 0; i < _count && address_count < MAX_ADDRESSES; i++) {
+			if (_addresses[i] >= 1 && _addresses[i] <= 247) addresses[address_count++] = _addresses[i];
+		}
+		if (!address_count) addresses[address_count++] = 1;
+	}
+
+	/**
+	 * @brief Start discovering the actuator on every port which doesn't have one yet
+	 * @param timeout_per_address_us time allowed for a handshake at each candidate address
+	 */
+	void start_discovery(uint32_t timeout_per_address_us = 2000000) {
+		discovery_timeout_us = timeout_per_address_us;
+		uint64_t selection = 0;
+		for (int i = 0; i < count; i++) {
+			if (found[i]) continue;
+			address_index[i] = 0;
+			use_address(i, addresses[0]);
+			selection |= uint64_t(1) << i;
+		}
+		discovering = selection != 0;
+		if (discovering) bring_up.start(discovery_timeout_us, selection);
+	}
+
+	/**
+	 * @brief Service every actuator once, then advance discovery and profile uploads. Should be called repeatedly.
+	 * @return true when discovery has finished and no profile upload is pending
+	 */
+	bool run() {
+		if (discovering) {
+			if (bring_up.run()) next_discovery_round();
+		}
+		else {
+			for (int i = 0; i < count; i++) {
+				actuators[i].run_in();
+				actuators[i].run_out();
+			}
+		}
+		int pending = 0;
+		for (int i = 0; i < count; i++) {
+			if (uploads[i] && !uploads[i]->update()) pending++;
+		}
+		return !discovering && pending == 0;
+	}
+
+	bool is_discovering() { return discovering; }
+
+	/// @brief number of ports given to the fleet; actuator indices run from 0 to this
+	int get_port_count() { return count; }
+
+	/// @brief number of actuators discovered
+	int get_member_count() {
+		int members = 0;
+		for (int i = 0; i < count; i++) if (found[i]) members++;
+		return members;
+	}
+
+	/// @brief true if an actuator was discovered on the port
+	bool is_member(int index) { return index >= 0 && index < count && found[index]; }
+
+	Actuator& get_actuator(int index) { return actuators[index]; }
+
+	/// @brief serial number of the actuator discovered on the port, or 0
+	uint32_t get_serial_number(int index) { return is_member(index) ? serial_numbers[index] : 0; }
+
+	/// @brief server address the actuator on the port answered at, or 0 if none was discovered
+	uint8_t get_server_address(int index) { return is_member(index) ? actuators[index].connection_config.server_address : 0; }
+
+	/// @brief index of the actuator with the serial number, or -1 if it hasn't been discovered
+	int find_index(uint32_t serial_number) {
+		for (int i = 0; i < count; i++) if (found[i] && serial_numbers[i] == serial_number) return i;
+		return -1;
+	}
+
+	/// @brief the actuator with the serial number, or 0 if it hasn't been discovered
+	Actuator* find(uint32_t serial_number) {
+		int index = find_index(serial_number);
+		return index < 0 ? 0 : &actuators[index];
+	}
+
+	/// @brief every discovered actuator
+	Group all() {
+		Group members = 0;
+		for (int i = 0; i < count; i++) if (found[i]) members |= Group(1) << i;
+		return members;
+	}
+
+	/// @brief the discovered actuators with the given serial numbers
+	Group group(const uint32_t* serials, int serial_count) {
+		Group members = 0;
+		for (int i = 0; i < serial_count; i++) {
+			int index = find_index(serials[i]);
+			if (index >= 0) members |= Group(1) << index;
+		}
+		return members;
+	}
+
+	/**
+	 * @brief Set the mode of every connected actuator in the group
+	 * @return the number of actuators the request was queued for
+	 */
+	int set_mode(Group members, Actuator::MotorMode mode) {
+		int queued = 0;
+		for (int i = 0; i < count; i++) if (is_selected(members, i)) queued += actuators[i].set_mode(mode);
+		return queued;
+	}
+
+	/**
+	 * @brief Clear the errors of every connected actuator in the group, see Actuator::clear_errors()
+	 * @return the number of actuators the request was queued for
+	 */
+	int clear_errors(Group members) {
+		int queued = 0;
+		for (int i = 0; i < count; i++) if (is_selected(members, i)) queued += actuators[i].clear_errors();
+		return queued;
+	}
+
+	/**
+	 * @brief Zero the position of every connected actuator in the group, see Actuator::zero_position()
+	 * @return the number of actuators the request was queued for
+	 */
+	int zero_position(Group members) {
+		int queued = 0;
+		for (int i = 0; i < count; i++) if (is_selected(members, i)) queued += actuators[i].zero_position();
+		return queued;
+	}
+
+	/**
+	 * @brief Write and verify a profile on every connected actuator in the group; run() drives the uploads
+	 * @param profile must not change until the uploads settle
+	 * @return the number of uploads started
+	 */
+	int apply_profile(Group members, const RegisterProfile& profile, uint32_t timeout_us = 250000) {
+		int started = 0;
+		for (int i = 0; i < count; i++) {
+			if (!is_selected(members, i)) continue;
+			if (!uploads[i]) uploads[i] = new ActuatorProfileUpload(actuators[i]);
+			if (uploads[i]->apply(profile, timeout_us)) started++;
+		}
+		return started;
+	}
+
+	/// @brief the last profile upload to the actuator, or 0 if none was started
+	ActuatorProfileUpload* get_upload(int index) { return index >= 0 && index < count ? uploads[index] : 0; }
+
+	/**
+	 * @brief Sum the state of the fleet, and the traffic since the previous call
+	 */
+	Health get_health() {
+		Health health = {};
+		uint32_t now_cycles = now();
+		for (int i = 0; i < count; i++) {
+			uint32_t claimed = actuators[i].get_claimed_frame_count();
+			uint16_t failed = uint16_t(actuators[i].get_num_failed_msgs());
+			health.frames += claimed - last_claimed[i];
+			health.failed_frames += uint16_t(failed - last_failed[i]);
+			last_claimed[i] = claimed;
+			last_failed[i] = failed;
+
+			if (uploads[i] && !uploads[i]->is_settled()) health.uploads_pending++;
+			if (!found[i]) continue;
+			health.members++;
+			if (!actuators[i].is_connected()) continue;
+			health.connected++;
+			if (actuators[i].get_errors()) health.with_errors++;
+			if (actuators[i].get_last_round_trip_us() > health.max_round_trip_us) health.max_round_trip_us = actuators[i].get_last_round_trip_us();
+		}
+		float seconds = float(now_cycles - last_health_cycles) / actuators[0].get_cycles_per_us() / 1e6f;
+		last_health_cycles = now_cycles;
+		health.frames_per_second = seconds > 0 ? health.frames / seconds : 0;
+		health.failure_rate = health.frames ? float(health.failed_frames) / health.frames : 0;
+		return health;
+	}
+
+private:
+
+	Actuator* actuators;
+	const int count;
+	ActuatorBringUp bring_up;
+
+	uint8_t addresses[MAX_ADDRESSES];
+	int address_count;
+
+	bool discovering = false;
+	uint32_t discovery_timeout_us = 0;
+	bool found[MAX_MEMBERS];
+	uint32_t serial_numbers[MAX_MEMBERS];
+	uint8_t address_index[MAX_MEMBERS];		// candidate address being tried on each port
+
+	ActuatorProfileUpload* uploads[MAX_MEMBERS];
+
+	uint32_t last_claimed[MAX_MEMBERS];
+	uint16_t last_failed[MAX_MEMBERS];
+	uint32_t last_health_cycles;
+
+	uint32_t now() { return actuators[0].modbus_client.get_system_cycles(); }
+
+	bool is_selected(Group members, int index) {
+		return ((members >> index) & 1) && found[index] && actuators[index].is_connected();
+	}
+
+	void use_address(int index, uint8_t address) {
+		IrisClientApplication::ConnectionConfig config = actuators[index].connection_config;
+		config.server_address = address;
+		actuators[index].disable();
+		actuators[index].set_connection_config(config);
+	}
+
+	/**
+	 * @brief Register the ports whose actuator connected, and move the others on to their next candidate address
+	 */
+	void next_discovery_round() {
+		uint64_t selection = 0;
+		for (int i = 0; i < count; i++) {
+			if (found[i] || bring_up.get_status(i) == ActuatorBringUp::idle) continue;
+			if (bring_up.get_status(i) == ActuatorBringUp::ready) {
+				found[i] = true;
+				serial_numbers[i] = actuators[i].get_serial_number();
+				continue;
+			}
+			actuators[i].disable();
+			if (++address_index[i] < address_count) {
+				use_address(i, addresses[address_index[i]]);
+				selection |= uint64_t(1) << i;
+			}
+		}
+		discovering = selection != 0;
+		if (discovering) bring_up.start(discovery_timeout_us, selection);
+	}
+};
+
+#endif
@@ -0,0 +1,309 @@
+/**
+ * @file actuator_profile.h
+ *
+ * @brief  Writes a profile of register values to an Actuator in as few requests as possible and verifies it by reading it back
+ *
+ * @version 2.2.0
+
+    @copyright Copyright 2022 Iris Dynamics Ltd
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+    For questions or feedback on this file, please email <support@irisdynamics.com>.
+ */
+
+#ifndef ACTUATOR_PROFILE_H_
+#define ACTUATOR_PROFILE_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "actuator.h"
+#include "../register_profile.h"
+
+#if !REGISTER_TRACKING
+#error "actuator_profile.h checks read backs by their receive times; define REGISTER_TRACKING as 1 in mb_config.h"
+#endif
+
+/**
+ * @class ActuatorProfileUpload
+ * @brief Applies a RegisterProfile to a connected Actuator and reports each register which didn't read back as written.
+ *
+ * apply() queues one write_multiple_registers request per run of consecutive profile registers, then the
+ * read_holding_registers requests planned by RegisterProfile::plan_reads(). The queue is first in first out, so the reads
+ * see the written values without waiting for the write responses. Requests which don't fit in the queue are queued as
+ * room frees up. The upload settles once every read has been claimed, or at the timeout; the registers which were not
+ * read back or hold another value are then listed as differences.
+ *
+ *  RegisterProfile profile;
+ *  ActuatorProfileUpload::load(profile, "station_a.txt");
+ *  ActuatorProfileUpload upload(motor);
+ *  upload.apply(profile);
+ *  while (!upload.run()) {}
+ *  for (int i = 0; i < upload.get_difference_count(); i++) ... upload.get_difference(i) ...
+ */
+class ActuatorProfileUpload {
+
+public:
+
+	enum Status {
+		idle,			// nothing applied or verified yet
+		writing,		// queueing the write requests
+		reading,		// queueing the read requests or waiting for their responses
+		verified,		// every verified register read back as written
+		mismatched,		// at least one register read back with another value, or wasn't read back
+		timed_out,		// the reads didn't all complete before the timeout; unread registers are listed as differences
+		disconnected	// the actuator wasn't connected, or lost its connection
+	};
+
+	/**
+	 * @brief A verified register which didn't read back as written
+	 */
+	struct Difference {
+		uint16_t address;
+		uint16_t expected;		//!< value in the profile
+		uint16_t actual;		//!< value read back; meaningless if read_back is false
+		bool     read_back;		//!< false if the register's read failed or timed out
+	};
+
+	ActuatorProfileUpload(Actuator& _actuator) :
+		actuator(_actuator)
+	{}
+
+	/**
+	 * @brief Start writing the profile and reading it back
+	 * @param _profile must not change until the upload settles
+	 * @param timeout_us time allowed for every request to complete
+	 * @return false if the actuator isn't connected
+	 */
+	bool apply(const RegisterProfile& _profile, uint32_t timeout_us = 250000) {
+		return start(_profile, timeout_us, writing);
+	}
+
+	/**
+	 * @brief Start reading the profile's registers back without writing them, to find how the actuator differs from it
+	 * @return false if the actuator isn't connected
+	 */
+	bool verify(const RegisterProfile& _profile, uint32_t timeout_us = 250000) {
+		return start(_profile, timeout_us, reading);
+	}
+
+	/**
+	 * @brief Service the actuator once, then update the upload. Should be called repeatedly until it returns true.
+	 * Applications which already call the actuator's run_in() and run_out() should call update() instead.
+	 * @return true once the upload has settled
+	 */
+	bool run() {
+		actuator.run_in();
+		bool done = update();
+		actuator.run_out();
+		return done;
+	}
+
+	/**
+	 * @brief Queue the requests there is room for and check whether the reads have completed
+	 * @return true once the upload has settled
+	 */
+	bool update() {
+		if (is_settled()) return true;
+		if (!actuator.is_connected()) {
+			status = disconnected;
+			settle_cycles = now();
+			return true;
+		}
+
+		if (status == writing) {
+			while (next_write < write_count) {
+				uint16_t data[MAX_NUM_WRITE_REG];
+				for (int i = 0; i < writes[next_write].count; i++) data[i] = profile->get_value(write_entry + i);
+				if (!actuator.write_registers(writes[next_write].start, writes[next_write].count, data)) break;		// the queue is full
+				write_entry += writes[next_write].count;
+				next_write++;
+			}
+			if (next_write < write_count) return check_timeout();
+			status = reading;
+			reads_start_cycles = now();
+		}
+
+		while (next_read < read_count) {
+			if (!actuator.read_registers(reads[next_read].start, reads[next_read].count)) break;
+			next_read++;
+			// the last read is answered once every transaction queued so far has been claimed
+			reads_done_claim_count = actuator.get_claimed_frame_count() + actuator.modbus_client.get_queue_size();
+		}
+		if (next_read == read_count && int32_t(actuator.get_claimed_frame_count() - reads_done_claim_count) >= 0) {
+			compare(false);
+			return true;
+		}
+		return check_timeout();
+	}
+
+	Status get_status() { return status; }
+
+	/// @brief true once the upload has verified, found differences, timed out or lost the connection
+	bool is_settled() { return status != writing && status != reading; }
+
+	/// @brief number of verified registers which didn't read back as written; valid once settled
+	int get_difference_count() { return difference_count; }
+
+	const Difference& get_difference(int index) { return differences[index]; }
+
+	/// @brief write requests the profile needs
+	int get_write_frame_count() { return write_count; }
+
+	/// @brief read requests the profile needs
+	int get_read_frame_count() { return read_count; }
+
+	/// @brief time from apply() or verify() until the upload settled, or until now if it hasn't
+	uint32_t get_elapsed_us() {
+		return ((is_settled() ? settle_cycles : now()) - start_cycles) / actuator.get_cycles_per_us();
+	}
+
+	/**
+	 * @brief Load a profile from a text file. Each line holds a register, given by its name or its address, and a value,
+	 * decimal or hex with a 0x prefix. Named 32 bit registers set both halves. "noverify" after the value writes the
+	 * register without reading it back, eg. for a command register which clears itself. "name" followed by a word names
+	 * the profile. Blank lines and anything after a # are ignored.
+	 *  name station_a
+	 *  PC_PGAIN        200
+	 *  USER_MAX_FORCE  30000
+	 *  130             0x10     # CC_IGAIN
+	 *  CTRL_REG_1      1024     noverify
+	 *
+	 * @return 0 on success, -1 if the file couldn't be opened, or the number of the first line which names an unknown or
+	 * read only register, holds a malformed value or doesn't fit in the profile. The profile is cleared first.
+	 */
+	static int load(RegisterProfile& profile, const char* path) {
+		FILE* file = fopen(path, "r");
+		if (!file) return -1;
+		profile.clear();
+		char line[256];
+		int line_number = 0, error_line = 0;
+		while (!error_line && fgets(line, sizeof(line), file)) {
+			line_number++;
+			char* comment = strchr(line, '#');
+			if (comment) *comment = 0;
+			char* tokens[3];
+			int token_count = 0;
+			for (char* token = strtok(line, " \t\r\n"); token; token = strtok(0, " \t\r\n")) {
+				if (token_count == 3) { token_count++; break; }
+				tokens[token_count++] = token;
+			}
+			if (token_count == 0) continue;
+			if (strcmp(tokens[0], "name") == 0 && token_count == 2) {
+				profile.set_name(tokens[1]);
+				continue;
+			}
+			if (token_count < 2 || token_count > 3 || (token_count == 3 && strcmp(tokens[2], "noverify"))) {
+				error_line = line_number;
+				continue;
+			}
+			if (!load_line(profile, tokens[0], tokens[1], token_count == 2)) error_line = line_number;
+		}
+		fclose(file);
+		return error_line;
+	}
+
+private:
+
+	Actuator& actuator;
+	const RegisterProfile* profile = 0;
+
+	Status status = idle;
+	uint32_t start_cycles = 0;
+	uint32_t settle_cycles = 0;
+	uint32_t timeout_cycles = 0;
+
+	RegisterRange writes[RegisterProfile::MAX_ENTRIES];
+	int write_count = 0;
+	int next_write = 0;
+	int write_entry = 0;		// profile index of the first register of the next write
+
+	RegisterRange reads[RegisterProfile::MAX_ENTRIES];
+	int read_count = 0;
+	int next_read = 0;
+	uint32_t reads_start_cycles = 0;
+	uint32_t reads_done_claim_count = 0;
+
+	Difference differences[RegisterProfile::MAX_ENTRIES];
+	int difference_count = 0;
+
+	uint32_t now() { return actuator.modbus_client.get_system_cycles(); }
+
+	bool start(const RegisterProfile& _profile, uint32_t timeout_us, Status first) {
+		profile = &_profile;
+		start_cycles = now();
+		timeout_cycles = timeout_us * actuator.get_cycles_per_us();
+		write_count = first == writing ? profile->plan_writes(writes, RegisterProfile::MAX_ENTRIES) : 0;
+		read_count = profile->plan_reads(reads, RegisterProfile::MAX_ENTRIES);
+		next_write = 0;
+		write_entry = 0;
+		next_read = 0;
+		reads_start_cycles = start_cycles;
+		reads_done_claim_count = actuator.get_claimed_frame_count();
+		difference_count = 0;
+		status = first;
+		if (!actuator.is_connected()) {
+			status = disconnected;
+			settle_cycles = start_cycles;
+			return false;
+		}
+		return true;
+	}
+
+	bool check_timeout() {
+		if ((uint32_t)(now() - start_cycles) < timeout_cycles) return false;
+		compare(true);
+		return true;
+	}
+
+	/**
+	 * @brief List the verified registers which weren't read back after the reads started, or hold another value
+	 */
+	void compare(bool timed_out) {
+		const Actuator::OrcaRegisterCache& cache = actuator.get_register_cache();
+		difference_count = 0;
+		for (int i = 0; i < profile->get_count(); i++) {
+			if (!profile->is_verified(i)) continue;
+			uint16_t address = profile->get_address(i);
+			bool read_back = cache.has_value(address) && int32_t(cache.get_updated_cycles(address) - reads_start_cycles) >= 0;
+			if (read_back && cache.get(address) == profile->get_value(i)) continue;
+			differences[difference_count++] = { address, profile->get_value(i), cache.get(address), read_back };
+		}
+		settle_cycles = now();
+		status = timed_out ? ActuatorProfileUpload::timed_out : difference_count ? mismatched : verified;
+	}
+
+	static bool load_line(RegisterProfile& profile, const char* reg, const char* value_text, bool verify) {
+		char* end;
+		long long value = strtoll(value_text, &end, 0);
+		if (*end) return false;
+
+		long address = strtol(reg, &end, 0);
+		bool wide = false;
+		if (*end) {
+			const Orca600RegDescriptor* descriptor = orca600_reg_descriptor(reg);
+			if (!descriptor || descriptor->access == Orca600RegDescriptor::RO) return false;
+			address = descriptor->address;
+			wide = descriptor->bits == 32 && !descriptor->upper_half;
+		}
+		if (address < 0 || address >= ORCA_REG_SIZE) return false;
+
+		if (wide) {
+			if (value < INT32_MIN || value > UINT32_MAX) return false;
+			return profile.set32(uint16_t(address), uint32_t(value), verify);
+		}
+		if (value < INT16_MIN || value > UINT16_MAX) return false;
+		return profile.set(uint16_t(address), uint16_t(value), verify);
+	}
+};
+
+#endif
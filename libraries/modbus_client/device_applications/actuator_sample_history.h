@@ -0,0 +1,147 @@
+/**
+ * @file actuator_sample_history.h
+ *
+ * @brief  Records every stream sample an Actuator decodes so consumers on other threads can read them at their own pace
+ *
+ * @version 2.2.0
+
+    @copyright Copyright 2022 Iris Dynamics Ltd
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+    For questions or feedback on this file, please email <support@irisdynamics.com>.
+ */
+
+#ifndef ACTUATOR_SAMPLE_HISTORY_H_
+#define ACTUATOR_SAMPLE_HISTORY_H_
+
+#include "../sample_ring.h"
+#include "actuator.h"
+
+/**
+ * @brief The feedback of one stream response
+ */
+struct ActuatorSample {
+	uint32_t sample_cycles;		//!< client system time the actuator sampled this data, see Actuator::get_sample_cycles()
+	int32_t  position_um;
+	int32_t  force_mN;
+	uint16_t power_W;
+	uint16_t errors;
+	uint8_t  temperature_C;
+};
+
+/**
+ * @class ActuatorSampleHistory
+ * @brief Keeps the last CAPACITY stream samples of an Actuator, for plots, loggers and analytics which can't keep up with every cycle.
+ *
+ * The communication thread calls record() after each Actuator::run_in(); it adds one sample per stream response decoded
+ * and never waits. Each consumer keeps its own Cursor and reads ranges by sequence with read(), or finds where a time range
+ * starts with seek(). Samples replaced before a consumer reads them are counted in its cursor's overruns, and record()
+ * counts responses it couldn't record because run_in() decoded more than one since the last call.
+ *
+ * @tparam CAPACITY samples kept; must be a power of 2
+ */
+template <uint32_t CAPACITY = 1024>
+class ActuatorSampleHistory {
+
+public:
+
+	typedef typename SampleRing<ActuatorSample, CAPACITY>::Cursor Cursor;
+
+/////////////////////////////////////////////////////////////
+//////////////////////////// Communication thread only /////
+///////////////////////////////////////////////////////////
+
+	/**
+	 * @brief Record the actuator's feedback if a stream response has been decoded since the last call
+	 * Should be called after Actuator::run_in(), on the same thread.
+	 * @return true if a sample was recorded
+	 */
+	bool record(Actuator& actuator) {
+		uint32_t count = actuator.get_stream_sample_count();
+		uint32_t decoded = started ? count - last_count : (count ? 1 : 0);
+		last_count = count;
+		started = true;
+		if (!decoded) return false;
+		if (decoded > 1) missed.fetch_add(decoded - 1, std::memory_order_relaxed);		// only the latest is still in the register cache
+
+		ActuatorSample sample = {};
+		sample.sample_cycles	= actuator.get_sample_cycles();
+		sample.position_um		= actuator.get_position_um();
+		sample.force_mN			= actuator.get_force_mN();
+		sample.power_W			= actuator.get_power_W();
+		sample.errors			= actuator.get_errors();
+		sample.temperature_C	= actuator.get_temperature_C();
+		ring.push(sample);
+		return true;
+	}
+
+/////////////////////////////////////////////////////////////
+///////////////////////////////////////////// Any thread ///
+///////////////////////////////////////////////////////////
+
+	/**
+	 * @brief Copy the samples from the cursor onwards, oldest first, and advance the cursor past them
+	 * @param sequences if not 0, filled with each sample's sequence
+	 * @return the number of samples copied, at most max_count
+	 */
+	int read(Cursor& cursor, ActuatorSample* samples, int max_count, uint32_t* sequences = 0) const {
+		return ring.read(cursor, samples, max_count, sequences);
+	}
+
+	/// @brief Copy a single sample by sequence. Returns false if it hasn't been recorded or has been replaced.
+	bool get(uint32_t sequence, ActuatorSample& sample) const {
+		return ring.get(sequence, sample);
+	}
+
+	/**
+	 * @brief Position a cursor at the first sample held which was taken at or after the given client system time
+	 * Samples are recorded in the order they were taken, so the search is a bisection over the samples held.
+	 * @return false if every sample held was taken earlier, in which case the cursor is placed after the newest
+	 */
+	bool seek(Cursor& cursor, uint32_t cycles) const {
+		uint32_t low = ring.get_oldest_sequence();
+		uint32_t high = ring.get_newest_sequence() + 1;		// first sequence known to be at or after cycles
+		while (low < high) {
+			uint32_t middle = low + (high - low) / 2;
+			ActuatorSample sample;
+			// a sample replaced during the search is older than any still held
+			if (!ring.get(middle, sample) || int32_t(sample.sample_cycles - cycles) < 0) low = middle + 1;
+			else high = middle;
+		}
+		cursor.next = high;
+		return high <= ring.get_newest_sequence();
+	}
+
+	/// @brief Position a cursor at the oldest sample held
+	void rewind(Cursor& cursor) const { ring.rewind(cursor); }
+
+	/// @brief Position a cursor so that it only reads samples recorded from now on
+	void skip_to_end(Cursor& cursor) const { ring.skip_to_end(cursor); }
+
+	/// @brief sequence of the most recently recorded sample, or 0 if none has been
+	uint32_t get_newest_sequence() const { return ring.get_newest_sequence(); }
+
+	/// @brief stream responses decoded between two calls to record() other than the last, which were not recorded
+	uint32_t get_missed_count() const { return missed.load(std::memory_order_relaxed); }
+
+private:
+
+	SampleRing<ActuatorSample, CAPACITY> ring;
+	std::atomic<uint32_t> missed{ 0 };
+
+	// communication thread only
+	uint32_t last_count = 0;
+	bool started = false;
+};
+
+#endif
@@ -0,0 +1,151 @@
+/**
+ * @file actuator_snapshot.h
+ *
+ * @brief  Coherent copies of an Actuator's feedback for threads other than its communication thread
+ *
+ * @version 2.2.0
+
+    @copyright Copyright 2022 Iris Dynamics Ltd
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+    For questions or feedback on this file, please email <support@irisdynamics.com>.
+ */
+
+#ifndef ACTUATOR_SNAPSHOT_H_
+#define ACTUATOR_SNAPSHOT_H_
+
+#include "../seqlock.h"
+#include "actuator.h"
+
+/**
+ * @brief The feedback carried by one response, with 32 bit values already joined
+ */
+struct ActuatorFeedback {
+	int32_t  position_um;
+	int32_t  force_mN;
+	uint16_t power_W;
+	uint16_t voltage_mV;
+	uint16_t errors;
+	uint16_t mode_of_operation;
+	uint8_t  temperature_C;
+	bool     connected;
+	uint32_t sample_cycles;				//!< client system time the actuator sampled this data, see Actuator::get_sample_cycles()
+	uint32_t response_count;			//!< valid responses decoded before this snapshot was taken, counting this one
+	uint16_t watched_values[8];			//!< registers chosen by ActuatorSnapshot::watch(), as received up to this response
+};
+
+/**
+ * @class ActuatorSnapshot
+ * @brief Publishes the Actuator's feedback from its communication thread so other threads can read it without tearing.
+ *
+ * The Actuator's getters read its register cache directly, so a thread other than the one calling run_in() may see a
+ * 32 bit value such as the position with one half from one response and the other half from the next.
+ * Instead, the communication thread calls publish() after each run_in(); when a valid response was decoded it copies the
+ * feedback into a Seqlock. Any thread then calls read() to get every field as decoded from the same response.
+ * publish() never waits for readers, and a reader only retries while a publish overlaps its copy.
+ *
+ * Registers other than the feedback, eg. the register targeted by Actuator::update_read_stream(), can be added with watch()
+ * before the communication thread starts.
+ */
+class ActuatorSnapshot {
+
+public:
+
+	static const int MAX_WATCHED = sizeof(ActuatorFeedback::watched_values) / sizeof(uint16_t);
+
+	/**
+	 * @brief Include a register in each snapshot, in ActuatorFeedback::watched_values. Not thread safe; call before publishing starts.
+	 * @return the index of the register in watched_values, or -1 if MAX_WATCHED registers are already watched
+	 */
+	int watch(uint16_t register_address) {
+		if (watched_count >= MAX_WATCHED) return -1;
+		watched[watched_count] = register_address;
+		return watched_count++;
+	}
+
+/////////////////////////////////////////////////////////////
+//////////////////////////// Communication thread only /////
+///////////////////////////////////////////////////////////
+
+	/**
+	 * @brief Copy the actuator's feedback if a valid response has been decoded since the last publish
+	 * Should be called after Actuator::run_in(), on the same thread.
+	 * @return true if a new snapshot was published
+	 */
+	bool publish(Actuator& actuator) {
+		uint16_t responses = actuator.get_num_successful_msgs();
+		bool connected = actuator.is_connected();
+		if (responses == last_responses && connected == last_connected) return false;
+
+		response_count += uint16_t(responses - last_responses);
+		last_responses = responses;
+		last_connected = connected;
+
+		ActuatorFeedback feedback = {};
+		capture(actuator, feedback);
+		feedback.response_count		= response_count;
+		for (int i = 0; i < watched_count; i++) {
+			feedback.watched_values[i] = actuator.get_orca_reg_content(watched[i]);
+		}
+		snapshot.write(feedback);
+		return true;
+	}
+
+	/**
+	 * @brief Copy the actuator's feedback, except response_count and watched_values. Must be called on the thread running
+	 * the actuator, or while that thread is stopped.
+	 */
+	static void capture(Actuator& actuator, ActuatorFeedback& feedback) {
+		feedback.position_um		= actuator.get_position_um();
+		feedback.force_mN			= actuator.get_force_mN();
+		feedback.power_W			= actuator.get_power_W();
+		feedback.voltage_mV			= actuator.get_voltage_mV();
+		feedback.errors				= actuator.get_errors();
+		feedback.mode_of_operation	= actuator.get_mode_of_operation();
+		feedback.temperature_C		= actuator.get_temperature_C();
+		feedback.connected			= actuator.is_connected();
+		feedback.sample_cycles		= actuator.get_sample_cycles();
+	}
+
+/////////////////////////////////////////////////////////////
+///////////////////////////////////////////// Any thread ///
+///////////////////////////////////////////////////////////
+
+	/**
+	 * @brief Copy the latest published feedback
+	 * @return false if nothing has been published yet, or publishing kept overlapping the copy; feedback is then unchanged
+	 */
+	bool read(ActuatorFeedback& feedback) const {
+		if (!snapshot.get_write_count()) return false;
+		return snapshot.read(feedback);
+	}
+
+	/// @brief number of snapshots published; a reader can compare this with a previous count to see if there is newer feedback
+	uint32_t get_publish_count() const {
+		return snapshot.get_write_count();
+	}
+
+private:
+
+	Seqlock<ActuatorFeedback> snapshot;
+
+	uint16_t watched[MAX_WATCHED] = { 0 };
+	int watched_count = 0;
+
+	// communication thread only
+	uint16_t last_responses = 0;
+	bool last_connected = false;
+	uint32_t response_count = 0;
+};
+
+#endif
@@ -0,0 +1,494 @@
+/**
+ * @file actuator_triggers.h
+ *
+ * @brief  Declared conditions on an Actuator's registers, evaluated as each response is decoded
+ *
+ * @version 2.2.0
+
+    @copyright Copyright 2022 Iris Dynamics Ltd
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+    For questions or feedback on this file, please email <support@irisdynamics.com>.
+ */
+
+#ifndef ACTUATOR_TRIGGERS_H_
+#define ACTUATOR_TRIGGERS_H_
+
+#include "actuator_sample_history.h"
+
+#if !REGISTER_TRACKING
+#error "actuator_triggers.h listens for register changes; define REGISTER_TRACKING as 1 in mb_config.h"
+#endif
+
+/**
+ * @brief A condition on one register, or on a 32 bit value held in two
+ *
+ * Level conditions (above, below, bits_set, rate_above) fire when they are met, once they have held for dwell_us, and
+ * clear when they no longer hold; above, below and rate_above clear only once the value is hysteresis past the threshold.
+ * A condition which stops being met during its dwell time starts over; a rate, measured once per rate window, starts over
+ * only once it is hysteresis below the threshold.
+ * Edge conditions (rising_bits, falling_bits) fire on each response which changes a bit of the mask the given way.
+ */
+struct TriggerCondition {
+
+	enum Kind {
+		above,			// value at or above threshold
+		below,			// value at or below threshold
+		bits_set,		// any bit of mask set, eg. the error bits which matter to the application
+		rising_bits,	// a bit of mask changes from 0 to 1
+		falling_bits,	// a bit of mask changes from 1 to 0
+		rate_above		// the value changes by threshold or more per second, in either direction, measured over rate_window_us
+	};
+
+	static const uint16_t NO_ADDRESS = 0xFFFF;
+
+	Kind     kind;
+	uint16_t address;			//!< register, or the lower half of a 32 bit value
+	bool     wide;				//!< the value is 32 bits, upper half at address + 1
+	bool     is_signed;
+	int32_t  threshold;			//!< for above, below and rate_above
+	int32_t  hysteresis;		//!< for above, below and rate_above
+	uint16_t mask;				//!< for the bit conditions
+	uint32_t dwell_us;			//!< time a level condition must hold before it fires
+	uint32_t rate_window_us;	//!< shortest time a rate is measured over
+	uint32_t pre_us;			//!< history kept before the event, see ActuatorTriggers::read_window()
+	uint32_t post_us;			//!< history kept after the event
+	bool     report_clear;		//!< also report level conditions clearing
+
+	/**
+	 * @brief A condition of the given kind on a register, with its width and signedness from the Orca600 register descriptors
+	 * @param register_name eg. "SHAFT_POS_UM" or "ERROR_0"; an unknown name gives a condition ActuatorTriggers::add() rejects
+	 */
+	static TriggerCondition on(const char* register_name, Kind kind) {
+		const Orca600RegDescriptor* descriptor = orca600_reg_descriptor(register_name);
+		return on(descriptor ? descriptor->address : NO_ADDRESS, kind);
+	}
+
+	static TriggerCondition on(uint16_t address, Kind kind) {
+		TriggerCondition condition = {};
+		condition.kind = kind;
+		condition.address = address;
+		condition.rate_window_us = 10000;
+		const Orca600RegDescriptor* descriptor = orca600_reg_descriptor(address);
+		if (descriptor) {
+			condition.wide = descriptor->bits == 32 && !descriptor->upper_half;
+			condition.is_signed = descriptor->is_signed;
+		}
+		return condition;
+	}
+
+	static TriggerCondition level(const char* register_name, Kind kind, int32_t threshold, int32_t hysteresis, uint32_t dwell_us) {
+		TriggerCondition condition = on(register_name, kind);
+		condition.threshold = threshold;
+		condition.hysteresis = hysteresis;
+		condition.dwell_us = dwell_us;
+		return condition;
+	}
+
+	static TriggerCondition bits(const char* register_name, Kind kind, uint16_t mask, uint32_t dwell_us = 0) {
+		TriggerCondition condition = on(register_name, kind);
+		condition.mask = mask;
+		condition.dwell_us = dwell_us;
+		return condition;
+	}
+};
+
+/**
+ * @brief A condition firing or clearing
+ */
+struct TriggerEvent {
+	uint16_t trigger;				//!< ID returned by ActuatorTriggers::add()
+	bool     active;				//!< true when the condition fired, false when it cleared
+	int32_t  value;					//!< value of the register when the event happened
+	int32_t  previous;				//!< value of the register when its trigger was previously evaluated
+	int32_t  rate;					//!< change per second, for rate_above
+	uint32_t cycles;				//!< client system time of the event
+	uint32_t window_start_cycles;	//!< cycles less the condition's pre_us
+	uint32_t window_end_cycles;		//!< cycles plus the condition's post_us
+};
+
+/**
+ * @class TriggerHandler
+ * @brief Receives trigger events from the thread running the actuator. Implementations must be quick, as they are called
+ * from run_in().
+ */
+class TriggerHandler {
+public:
+	virtual ~TriggerHandler() {}
+	virtual void on_trigger(const TriggerEvent& event) = 0;
+};
+
+/**
+ * @class ActuatorTriggers
+ * @brief Evaluates declared conditions on an Actuator's registers as its responses are decoded, instead of the
+ * application polling getters and comparing by hand.
+ *
+ * The triggers listen to the Actuator's RegisterNotifier and are indexed by register, so a response only evaluates the
+ * triggers on the registers it changed. Level conditions waiting out their dwell time, and rate conditions, whose value
+ * may stop changing while its rate still has to be measured, are also kept on a watch list evaluated with every response.
+ *
+ * Events are given to the trigger's handler, if any, and kept in a ring any thread can read with read_events().
+ * read_window() copies the samples around an event from an ActuatorSampleHistory recorded on the same actuator.
+ * Triggers are added and removed on the thread running the actuator, or before it starts.
+ *
+ *  ActuatorTriggers triggers(motor);
+ *  triggers.add(TriggerCondition::level("FORCE", TriggerCondition::above, 30000, 2000, 50000), &overload_handler);
+ *  triggers.add(TriggerCondition::bits("ERROR_0", TriggerCondition::rising_bits, 0xFFFF));
+ */
+class ActuatorTriggers : public RegisterListener {
+
+public:
+
+	static const int MAX_TRIGGERS = 256;
+	static const uint32_t EVENT_CAPACITY = 64;
+
+	typedef SampleRing<TriggerEvent, EVENT_CAPACITY>::Cursor Cursor;
+
+	ActuatorTriggers(Actuator& _actuator) :
+		actuator(_actuator),
+		cache(_actuator.get_register_cache())
+	{
+		for (int i = 0; i < ORCA_REG_SIZE; i++) heads[i] = NONE;
+		subscribed = actuator.subscribe(this);
+	}
+
+	~ActuatorTriggers() {
+		actuator.unsubscribe(this);
+	}
+
+	/// @brief false if the actuator had no room for another register listener, in which case no trigger is evaluated
+	bool is_subscribed() { return subscribed; }
+
+	/**
+	 * @brief Start evaluating a condition
+	 * @param handler called with each of the trigger's events, or 0
+	 * @return the trigger's ID, or -1 if the condition's register is outside the memory map or MAX_TRIGGERS are in use
+	 */
+	int add(const TriggerCondition& condition, TriggerHandler* handler = 0) {
+		if (condition.address >= ORCA_REG_SIZE - (condition.wide ? 1 : 0)) return -1;
+		int id = 0;
+		while (id < MAX_TRIGGERS && triggers[id].used) id++;
+		if (id == MAX_TRIGGERS) return -1;
+
+		Trigger& trigger = triggers[id];
+		trigger = Trigger();
+		trigger.condition = condition;
+		trigger.handler = handler;
+		trigger.used = true;
+		link(id, condition.address);
+		if (condition.wide) link(id, condition.address + 1);
+		if (condition.kind == TriggerCondition::rate_above) watch(id);
+		start_from_cache(trigger);
+		return id;
+	}
+
+	/**
+	 * @brief Stop evaluating a trigger; its ID may be given to the next trigger added
+	 */
+	void remove(int id) {
+		if (!is_used(id)) return;
+		Trigger& trigger = triggers[id];
+		unlink(id, trigger.condition.address);
+		if (trigger.condition.wide) unlink(id, trigger.condition.address + 1);
+		unwatch(id);
+		trigger.used = false;
+	}
+
+	/**
+	 * @brief Pause or resume a trigger. A paused trigger forgets its state, so it is evaluated afresh when resumed.
+	 */
+	void set_enabled(int id, bool enabled) {
+		if (!is_used(id) || triggers[id].enabled == enabled) return;
+		Trigger& trigger = triggers[id];
+		trigger.enabled = enabled;
+		trigger.state = idle;
+		start_from_cache(trigger);
+		if (trigger.condition.kind == TriggerCondition::rate_above && enabled) watch(id);
+		else unwatch(id);
+	}
+
+	/// @brief true while a level trigger has fired and not cleared
+	bool is_active(int id) { return is_used(id) && triggers[id].state == active; }
+
+	/// @brief times the trigger has fired since it was added
+	uint32_t get_fire_count(int id) { return is_used(id) ? triggers[id].fire_count : 0; }
+
+	/// @brief trigger evaluations since construction, for gauging the cost of the triggers
+	uint32_t get_evaluation_count() { return evaluations; }
+
+/////////////////////////////////////////////////////////////
+///////////////////////////////////////////// Any thread ///
+///////////////////////////////////////////////////////////
+
+	/**
+	 * @brief Copy the events from the cursor onwards, oldest first, and advance the cursor past them
+	 * @return the number of events copied, at most max_count
+	 */
+	int read_events(Cursor& cursor, TriggerEvent* events_out, int max_count) const {
+		return events.read(cursor, events_out, max_count);
+	}
+
+	/**
+	 * @brief Copy the samples taken within an event's window, from the oldest still held if the window's start was replaced
+	 * @return the number of samples copied, at most max_count, or -1 if no sample after the window has been recorded yet
+	 */
+	template <uint32_t CAPACITY>
+	static int read_window(const ActuatorSampleHistory<CAPACITY>& history, const TriggerEvent& event, ActuatorSample* samples, int max_count) {
+		ActuatorSample newest;
+		if (!history.get(history.get_newest_sequence(), newest) || int32_t(newest.sample_cycles - event.window_end_cycles) <= 0) return -1;
+
+		typename ActuatorSampleHistory<CAPACITY>::Cursor cursor;
+		history.seek(cursor, event.window_start_cycles);
+		int count = 0;
+		ActuatorSample sample;
+		while (count < max_count && history.read(cursor, &sample, 1) == 1) {
+			if (int32_t(sample.sample_cycles - event.window_end_cycles) > 0) break;
+			samples[count++] = sample;
+		}
+		return count;
+	}
+
+/////////////////////////////////////////////////////////////
+//////////////////////////// Communication thread only /////
+///////////////////////////////////////////////////////////
+
+	/**
+	 * @brief Evaluate the triggers on the changed registers, then the watched triggers
+	 */
+	void on_registers_changed(const uint16_t* registers, int count, uint32_t update) override {
+		uint32_t now = actuator.modbus_client.get_system_cycles();
+		for (int i = 0; i < count; i++) {
+			for (uint16_t node = heads[registers[i]]; node != NONE; node = nodes[node].next) {
+				evaluate(nodes[node].trigger, update, now);
+			}
+		}
+		// backwards, since a trigger which stops waiting is replaced by the last one on the list
+		for (int i = watch_count - 1; i >= 0; i--) {
+			evaluate(watching[i], update, now);
+		}
+	}
+
+private:
+
+	static const uint16_t NONE = 0xFFFF;
+
+	enum State {
+		idle,
+		pending,		// met, waiting out the dwell time
+		active
+	};
+
+	struct Trigger {
+		TriggerCondition condition;
+		TriggerHandler* handler = 0;
+		bool     used = false;
+		bool     enabled = true;
+		State    state = idle;
+		bool     has_previous = false;
+		int32_t  previous = 0;
+		uint32_t pending_cycles = 0;		// when the condition was met
+		bool     has_reference = false;		// value and time a rate is measured from
+		int32_t  reference = 0;
+		uint32_t reference_cycles = 0;
+		int32_t  rate = 0;
+		uint32_t evaluated_update = 0;
+		int16_t  watch_slot = -1;
+		uint32_t fire_count = 0;
+	};
+
+	struct Node {
+		uint16_t trigger;
+		uint16_t next;			// next node on the same register
+	};
+
+	Actuator& actuator;
+	const Actuator::OrcaRegisterCache& cache;
+	bool subscribed = false;
+
+	Trigger triggers[MAX_TRIGGERS];
+	uint16_t heads[ORCA_REG_SIZE];				// first node of the triggers on each register
+	Node nodes[MAX_TRIGGERS * 2];				// a trigger uses nodes 2 * ID, and 2 * ID + 1 for the upper half of a 32 bit value
+	uint16_t watching[MAX_TRIGGERS];
+	int watch_count = 0;
+	uint32_t evaluations = 0;
+
+	SampleRing<TriggerEvent, EVENT_CAPACITY> events;
+
+	bool is_used(int id) { return id >= 0 && id < MAX_TRIGGERS && triggers[id].used; }
+
+	void link(int id, uint16_t address) {
+		uint16_t node = uint16_t(id * 2 + (address == triggers[id].condition.address ? 0 : 1));
+		nodes[node].trigger = uint16_t(id);
+		nodes[node].next = heads[address];
+		heads[address] = node;
+	}
+
+	void unlink(int id, uint16_t address) {
+		for (uint16_t* link = &heads[address]; *link != NONE; link = &nodes[*link].next) {
+			if (nodes[*link].trigger == id) {
+				*link = nodes[*link].next;
+				return;
+			}
+		}
+	}
+
+	void watch(int id) {
+		if (triggers[id].watch_slot >= 0) return;
+		triggers[id].watch_slot = int16_t(watch_count);
+		watching[watch_count++] = uint16_t(id);
+	}
+
+	void unwatch(int id) {
+		int slot = triggers[id].watch_slot;
+		if (slot < 0) return;
+		uint16_t last = watching[--watch_count];
+		watching[slot] = last;
+		triggers[last].watch_slot = int16_t(slot);
+		triggers[id].watch_slot = -1;
+	}
+
+	int32_t read_value(const TriggerCondition& condition) {
+		uint32_t raw = cache.get(condition.address);
+		if (condition.wide) raw |= uint32_t(cache.get(condition.address + 1)) << 16;
+		if (!condition.is_signed) return int32_t(raw);
+		return condition.wide ? int32_t(raw) : int32_t(int16_t(raw));
+	}
+
+	void evaluate(uint16_t id, uint32_t update, uint32_t now) {
+		Trigger& trigger = triggers[id];
+		const TriggerCondition& condition = trigger.condition;
+		if (!trigger.enabled || trigger.evaluated_update == update) return;
+		if (!cache.has_value(condition.address) || (condition.wide && !cache.has_value(condition.address + 1))) return;
+		trigger.evaluated_update = update;
+		evaluations++;
+
+		int32_t value = read_value(condition);
+		bool met = false, cleared = false;
+		switch (condition.kind) {
+		case TriggerCondition::above:
+			met = value >= condition.threshold;
+			cleared = int64_t(value) < int64_t(condition.threshold) - condition.hysteresis;
+			break;
+		case TriggerCondition::below:
+			met = value <= condition.threshold;
+			cleared = int64_t(value) > int64_t(condition.threshold) + condition.hysteresis;
+			break;
+		case TriggerCondition::bits_set:
+			met = (value & condition.mask) != 0;
+			cleared = !met;
+			break;
+		case TriggerCondition::rising_bits:
+		case TriggerCondition::falling_bits: {
+			uint16_t changed = uint16_t(trigger.has_previous ? (value ^ trigger.previous) & condition.mask : 0);
+			if (changed & uint16_t(condition.kind == TriggerCondition::rising_bits ? value : trigger.previous)) emit(trigger, id, true, value, now);
+			remember(trigger, value);
+			return;
+		}
+		case TriggerCondition::rate_above: {
+			uint32_t received = cache.get_updated_cycles(condition.address);
+			if (!trigger.has_reference) {
+				trigger.has_reference = true;
+				trigger.reference = value;
+				trigger.reference_cycles = received;
+				remember(trigger, value);
+				return;
+			}
+			uint32_t elapsed = received - trigger.reference_cycles;
+			if (elapsed < condition.rate_window_us * actuator.get_cycles_per_us() || !elapsed) {
+				remember(trigger, value);
+				return;
+			}
+			int64_t rate = (int64_t(value) - trigger.reference) * 1000000 * actuator.get_cycles_per_us() / elapsed;
+			trigger.rate = int32_t(rate > INT32_MAX ? INT32_MAX : rate < -INT32_MAX ? -INT32_MAX : rate);
+			trigger.reference = value;
+			trigger.reference_cycles = received;
+			int64_t magnitude = rate < 0 ? -rate : rate;
+			met = magnitude >= condition.threshold;
+			cleared = magnitude < int64_t(condition.threshold) - condition.hysteresis;
+			break;
+		}
+		}
+
+		switch (trigger.state) {
+		case idle:
+			if (!met) break;
+			if (condition.dwell_us) {
+				trigger.state = pending;
+				trigger.pending_cycles = now;
+				watch(id);
+				break;
+			}
+			fire(trigger, id, value, now);
+			break;
+		case pending:
+			if (condition.kind == TriggerCondition::rate_above ? cleared : !met) {
+				// the dwell restarts once the condition holds again; a rate, only measured once per window, has to clear
+				trigger.state = idle;
+				if (condition.kind != TriggerCondition::rate_above) unwatch(id);
+			}
+			else if (now - trigger.pending_cycles >= condition.dwell_us * actuator.get_cycles_per_us()) {
+				fire(trigger, id, value, now);
+			}
+			break;
+		case active:
+			if (!cleared) break;
+			trigger.state = idle;
+			if (condition.report_clear) emit(trigger, id, false, value, now);
+			break;
+		}
+		remember(trigger, value);
+	}
+
+	void fire(Trigger& trigger, uint16_t id, int32_t value, uint32_t now) {
+		trigger.state = active;
+		if (trigger.condition.kind != TriggerCondition::rate_above) unwatch(id);
+		emit(trigger, id, true, value, now);
+	}
+
+	void emit(Trigger& trigger, uint16_t id, bool fired, int32_t value, uint32_t now) {
+		if (fired) trigger.fire_count++;
+		TriggerEvent event;
+		event.trigger = id;
+		event.active = fired;
+		event.value = value;
+		event.previous = trigger.previous;
+		event.rate = trigger.rate;
+		event.cycles = now;
+		event.window_start_cycles = now - trigger.condition.pre_us * actuator.get_cycles_per_us();
+		event.window_end_cycles = now + trigger.condition.post_us * actuator.get_cycles_per_us();
+		events.push(event);
+		if (trigger.handler) trigger.handler->on_trigger(event);
+	}
+
+	/**
+	 * @brief Take the register's cached value as the one edges and rates are measured from, so that the first change
+	 * after a trigger is added is seen as one
+	 */
+	void start_from_cache(Trigger& trigger) {
+		const TriggerCondition& condition = trigger.condition;
+		trigger.has_previous = false;
+		trigger.has_reference = false;
+		if (!cache.has_value(condition.address) || (condition.wide && !cache.has_value(condition.address + 1))) return;
+		remember(trigger, read_value(condition));
+		trigger.has_reference = true;
+		trigger.reference = trigger.previous;
+		trigger.reference_cycles = cache.get_updated_cycles(condition.address);
+	}
+
+	static void remember(Trigger& trigger, int32_t value) {
+		trigger.previous = value;
+		trigger.has_previous = true;
+	}
+};
+
+#endif
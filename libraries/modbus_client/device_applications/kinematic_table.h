@@ -0,0 +1,307 @@
+/**
+ * @file kinematic_table.h
+ *
+ * @brief  A whole kinematic program for an Actuator, validated offline and uploaded in packed writes verified by readback
+ *
+ * @version 2.2.0
+
+    @copyright Copyright 2022 Iris Dynamics Ltd
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+    For questions or feedback on this file, please email <support@irisdynamics.com>.
+ */
+
+#ifndef KINEMATIC_TABLE_H_
+#define KINEMATIC_TABLE_H_
+
+#include "actuator_profile.h"
+
+/**
+ * @class KinematicTable
+ * @brief The motions of a kinematic program, laid out as Actuator::set_kinematic_motion() writes them.
+ *
+ * Each motion ID owns six registers from KIN_MOTION_0 + 6 * ID: the target position and the time to reach it, both
+ * 32 bit low half first, the delay before the next motion, and a word packing auto_next, type and next_id.
+ * A motion with auto_next set starts its next_id motion when it completes, so the motions form chains.
+ *
+ * validate() checks every motion against the given limits and the chains as a graph: a link to a motion which isn't
+ * defined is dangling, and chains which return to an earlier motion loop forever, which is reported unless allowed.
+ * to_profile() turns the table into a RegisterProfile; consecutive motion IDs share write and read requests, so a full
+ * table of 32 motions is written in two requests and read back in two.
+ */
+class KinematicTable {
+
+public:
+
+	static const int MAX_MOTIONS = 32;
+	static const int REGISTERS_PER_MOTION = 6;
+
+	/**
+	 * @brief One motion, as given to Actuator::set_kinematic_motion()
+	 */
+	struct Motion {
+		int32_t position_um;
+		int32_t time_ms;		//!< time to reach the position
+		int16_t delay_ms;		//!< delay before the next motion starts
+		uint8_t type;			//!< 0 minimizes power, 1 maximizes smoothness
+		bool    auto_next;		//!< start next_id once this motion completes
+		uint8_t next_id;
+	};
+
+	/**
+	 * @brief Ranges the motions are checked against
+	 */
+	struct Limits {
+		int32_t  min_position_um    = 0;
+		int32_t  max_position_um    = INT32_MAX;	//!< eg. the actuator's stroke
+		int32_t  min_time_ms        = 1;
+		int32_t  max_time_ms        = INT32_MAX;
+		int16_t  min_delay_ms       = 0;
+		uint32_t max_speed_um_per_ms = 0;			//!< fastest average speed from one chained motion's position to the next; 0 doesn't check
+		bool     allow_cycles       = false;		//!< chains which loop forever are reported but aren't errors
+	};
+
+	enum IssueKind {
+		position_out_of_range,
+		time_out_of_range,
+		delay_out_of_range,
+		bad_type,
+		dangling_link,			// auto_next links to a motion which isn't defined
+		chain_cycle,			// following auto_next from the motion returns to it
+		too_fast,				// reaching the motion from the one chained before it exceeds max_speed_um_per_ms
+		home_undefined			// the home motion isn't defined
+	};
+
+	struct Issue {
+		IssueKind kind;
+		uint8_t   id;			//!< motion with the issue; for a cycle, its lowest ID
+		uint8_t   other_id;		//!< the linked motion for dangling_link and too_fast, otherwise id
+		bool      error;		//!< false for cycles which are allowed
+	};
+
+	static const int MAX_ISSUES = MAX_MOTIONS * 4;
+
+	KinematicTable() { clear(); }
+
+	/**
+	 * @brief Remove every motion and the home motion
+	 */
+	void clear() {
+		for (int i = 0; i < MAX_MOTIONS; i++) defined[i] = false;
+		home_id = -1;
+		issue_count = 0;
+	}
+
+	/**
+	 * @brief Define a motion, with the parameters of Actuator::set_kinematic_motion()
+	 * @param next_id motion started after this one when auto_next is set; -1 for ID + 1
+	 * @return false if the ID is out of range
+	 */
+	bool set(int ID, int32_t position, int32_t time, int16_t delay, int8_t type, int8_t auto_next, int8_t next_id = -1) {
+		if (ID < 0 || ID >= MAX_MOTIONS) return false;
+		if (next_id == -1) next_id = ID + 1;
+		motions[ID] = { position, time, delay, uint8_t(type), auto_next != 0, uint8_t(next_id) };
+		defined[ID] = true;
+		return true;
+	}
+
+	void remove(int ID) { if (ID >= 0 && ID < MAX_MOTIONS) defined[ID] = false; }
+
+	bool is_defined(int ID) const { return ID >= 0 && ID < MAX_MOTIONS && defined[ID]; }
+
+	const Motion& get(int ID) const { return motions[ID]; }
+
+	/**
+	 * @brief Set the motion started when kinematic mode is entered, written to KIN_HOME_ID; -1 leaves KIN_HOME_ID unwritten
+	 */
+	void set_home(int ID) { home_id = ID; }
+
+	/**
+	 * @brief Check every motion and chain
+	 * @return the number of errors found; get_issue() also lists allowed cycles
+	 */
+	int validate(const Limits& limits) {
+		issue_count = 0;
+		for (int id = 0; id < MAX_MOTIONS; id++) {
+			if (!defined[id]) continue;
+			const Motion& m = motions[id];
+			if (m.position_um < limits.min_position_um || m.position_um > limits.max_position_um) add_issue(position_out_of_range, id, id);
+			if (m.time_ms < limits.min_time_ms || m.time_ms > limits.max_time_ms) add_issue(time_out_of_range, id, id);
+			if (m.delay_ms < limits.min_delay_ms) add_issue(delay_out_of_range, id, id);
+			if (m.type > 1) add_issue(bad_type, id, id);
+			if (!m.auto_next) continue;
+			if (!is_defined(m.next_id)) {
+				add_issue(dangling_link, id, m.next_id);
+				continue;
+			}
+			const Motion& next = motions[m.next_id];
+			int64_t distance = int64_t(next.position_um) - m.position_um;
+			if (distance < 0) distance = -distance;
+			if (limits.max_speed_um_per_ms && next.time_ms > 0 && distance > int64_t(limits.max_speed_um_per_ms) * next.time_ms) {
+				add_issue(too_fast, m.next_id, id);
+			}
+		}
+		if (home_id >= 0 && !is_defined(home_id)) add_issue(home_undefined, uint8_t(home_id), uint8_t(home_id));
+		find_cycles(limits.allow_cycles);
+
+		int errors = 0;
+		for (int i = 0; i < issue_count; i++) if (issues[i].error) errors++;
+		return errors;
+	}
+
+	/// @brief validate against the default limits
+	int validate() { return validate(Limits()); }
+
+	/// @brief issues found by the last validate()
+	int get_issue_count() const { return issue_count; }
+	const Issue& get_issue(int index) const { return issues[index]; }
+
+	/**
+	 * @brief Time from starting the motion until its chain completes, including delays between chained motions.
+	 * For a chain which loops, the time until it first returns to a motion it already ran.
+	 */
+	uint32_t get_chain_time_ms(int ID) const {
+		bool visited[MAX_MOTIONS] = { false };
+		uint32_t total = 0;
+		while (is_defined(ID) && !visited[ID]) {
+			visited[ID] = true;
+			total += motions[ID].time_ms;
+			if (!motions[ID].auto_next) break;
+			total += motions[ID].delay_ms;
+			ID = motions[ID].next_id;
+		}
+		return total;
+	}
+
+	/**
+	 * @brief Add the registers of every defined motion, and KIN_HOME_ID if a home motion is set, to a profile
+	 * @return false if the profile is full
+	 */
+	bool to_profile(RegisterProfile& profile) const {
+		bool fits = true;
+		for (int id = 0; id < MAX_MOTIONS; id++) {
+			if (!defined[id]) continue;
+			const Motion& m = motions[id];
+			uint16_t address = get_motion_address(id);
+			fits = profile.set32(address, uint32_t(m.position_um)) && fits;
+			fits = profile.set32(address + 2, uint32_t(m.time_ms)) && fits;
+			fits = profile.set(address + 4, uint16_t(m.delay_ms)) && fits;
+			fits = profile.set(address + 5, uint16_t(uint8_t((m.type << 1) | (m.next_id << 3) | (m.auto_next ? 1 : 0)))) && fits;
+		}
+		if (home_id >= 0) fits = profile.set(KIN_HOME_ID, uint16_t(home_id)) && fits;
+		return fits;
+	}
+
+	static uint16_t get_motion_address(int ID) { return KIN_MOTION_0 + REGISTERS_PER_MOTION * ID; }
+
+	/// @brief the motion ID whose registers include the address, or -1 if none do
+	static int get_motion_id(uint16_t address) {
+		if (address < KIN_MOTION_0 || address >= KIN_MOTION_0 + REGISTERS_PER_MOTION * MAX_MOTIONS) return -1;
+		return (address - KIN_MOTION_0) / REGISTERS_PER_MOTION;
+	}
+
+private:
+
+	Motion motions[MAX_MOTIONS];
+	bool defined[MAX_MOTIONS];
+	int home_id;
+
+	Issue issues[MAX_ISSUES];
+	int issue_count;
+
+	void add_issue(IssueKind kind, uint8_t id, uint8_t other_id, bool error = true) {
+		if (issue_count < MAX_ISSUES) issues[issue_count++] = { kind, id, other_id, error };
+	}
+
+	/**
+	 * @brief Each motion links to at most one other, so following the links from every motion in turn finds each cycle
+	 * once; a walk which reaches a motion visited by an earlier walk can't find a new cycle.
+	 */
+	void find_cycles(bool allow_cycles) {
+		int8_t walk[MAX_MOTIONS];		// the walk which first visited each motion, or -1
+		for (int i = 0; i < MAX_MOTIONS; i++) walk[i] = -1;
+		for (int start = 0; start < MAX_MOTIONS; start++) {
+			int id = start;
+			while (is_defined(id) && walk[id] == -1) {
+				walk[id] = start;
+				if (!motions[id].auto_next) break;
+				id = motions[id].next_id;
+			}
+			if (!is_defined(id) || walk[id] != start || !motions[id].auto_next) continue;
+			// id is on a cycle found by this walk; report it by its lowest ID
+			int lowest = id;
+			for (int member = motions[id].next_id; member != id; member = motions[member].next_id) {
+				if (member < lowest) lowest = member;
+			}
+			add_issue(chain_cycle, uint8_t(lowest), uint8_t(lowest), !allow_cycles);
+		}
+	}
+};
+
+/**
+ * @class KinematicTableUpload
+ * @brief Validates a KinematicTable, then uploads it to an Actuator and verifies it through an ActuatorProfileUpload
+ *
+ *  KinematicTableUpload upload(motor);
+ *  if (!upload.start(table, limits)) ... table.get_issue(i) ...
+ *  while (!upload.run()) {}
+ *  upload.get_status(), upload.get_elapsed_us(), upload.get_profile_upload().get_difference(i) ...
+ */
+class KinematicTableUpload {
+
+public:
+
+	KinematicTableUpload(Actuator& actuator) :
+		upload(actuator)
+	{}
+
+	/**
+	 * @brief Validate the table and, if it has no errors, start writing it and reading it back
+	 * @return false if the table has errors, doesn't fit in a profile, or the actuator isn't connected
+	 */
+	bool start(KinematicTable& table, const KinematicTable::Limits& limits = KinematicTable::Limits(), uint32_t timeout_us = 250000) {
+		profile.clear();
+		profile.set_name("kinematic table");
+		if (table.validate(limits) || !table.to_profile(profile)) {
+			invalid = true;
+			return false;
+		}
+		invalid = false;
+		return upload.apply(profile, timeout_us);
+	}
+
+	/// @see ActuatorProfileUpload::run()
+	bool run() { return invalid || upload.run(); }
+
+	/// @see ActuatorProfileUpload::update()
+	bool update() { return invalid || upload.update(); }
+
+	/// @brief true if start() rejected the table
+	bool is_invalid() { return invalid; }
+
+	ActuatorProfileUpload::Status get_status() { return upload.get_status(); }
+
+	/// @brief time from start() until the table verified, differed or timed out
+	uint32_t get_elapsed_us() { return upload.get_elapsed_us(); }
+
+	/// @brief the underlying upload, for its frame counts and differences; KinematicTable::get_motion_id() maps a difference to its motion
+	ActuatorProfileUpload& get_profile_upload() { return upload; }
+
+private:
+
+	RegisterProfile profile;
+	ActuatorProfileUpload upload;
+	bool invalid = false;
+};
+
+#endif
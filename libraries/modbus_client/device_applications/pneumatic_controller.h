@@ -35,6 +35,8 @@
 #include "windows_modbus_client.h"
 #elif defined(QT_WINDOWS)
 #include "qt_modbus_client.h"
+#elif defined(TRANSPORT_CLIENT)
+#include "../device_drivers/transport/transport_modbus_client.h"
 #endif
 
 #define OPEN_VALVE_VOLTAGE  24000  	//mV
@@ -58,6 +60,8 @@ class PneumaticController : public IrisClientApplication {
    windows_ModbusClient modbus_client;
 #elif defined(QT_WINDOWS)
    qt_ModbusClient modbus_client;
+#elif defined(TRANSPORT_CLIENT)
+   transport_ModbusClient modbus_client;
 #endif
 
    const uint32_t my_cycle_per_us;
@@ -299,12 +303,13 @@ class PneumaticController : public IrisClientApplication {
 
 			response = modbus_client.dequeue_transaction();
 			new_data_flag = true;		// communicate to other layers that new data was received
+			track_link_quality(response);
 
 			if ( !response->is_reception_valid() ) {
 				cur_consec_failed_msgs++;
 				failed_msg_counter++;
 				if(connection_state == connected && cur_consec_failed_msgs >= connection_config.max_consec_failed_msgs){
-					disconnect();
+					lose_connection();
 				}
 			}
 
@@ -160,12 +160,13 @@ public:
 			//digitalWrite(LED_BUILTIN, HIGH);
 			response = modbus_client.dequeue_transaction();
 			new_data_flag = true;		// communicate to other layers that new data was received
+			track_link_quality(response);
 
 			if ( !response->is_reception_valid() ) {
 				cur_consec_failed_msgs++;
 				failed_msg_counter++;
 				if(connection_state == connected && cur_consec_failed_msgs >= connection_config.max_consec_failed_msgs){
-					disconnect();
+					lose_connection();
 				}
 			}
 
@@ -0,0 +1,266 @@
+/**
+ * @file simulated_orca_server.h
+ *
+ * @brief  A minimal Orca server answering an Actuator through a ByteTransport, for exercising clients without hardware
+ *
+ * @version 2.2.0
+
+    @copyright Copyright 2022 Iris Dynamics Ltd
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+    For questions or feedback on this file, please email <support@irisdynamics.com>.
+ */
+
+#ifndef SIMULATED_ORCA_SERVER_H_
+#define SIMULATED_ORCA_SERVER_H_
+
+#include <string.h>
+#include "../device_drivers/transport/byte_transport.h"
+#include "../mb_crc.h"
+#include "../function_code_parameters.h"
+#include "actuator_config.h"
+
+/**
+ * @class SimulatedOrcaServer
+ * @brief Answers the requests an Actuator sends with a register array standing in for the motor's memory map.
+ *
+ * Handles read holding registers (3), write single and multiple registers (6, 16), the return query data ping (8),
+ * the change connection status request (65) and the motor command, read and write stream frames (100, 104, 105).
+ * Requests for other server addresses are ignored, so several servers can share one line as on a multidrop bus.
+ * Control register writes behave as on an Orca for mode changes, clearing errors and zeroing the position; force and
+ * position commands are taken as the measured force and position. Nothing else of the motor is modelled.
+ *
+ * Open a transport on the other end of the client's link, eg. a TtyTransport on PtyTransport::get_peer_path(), and call
+ * poll() regularly:
+ *  TtyTransport line(client_port.get_peer_path());
+ *  line.open(UART_BAUD_RATE);
+ *  SimulatedOrcaServer server(&line, 1, 1234);
+ *  while (running) server.poll();
+ */
+class SimulatedOrcaServer {
+
+public:
+
+	/**
+	 * @param _transport open transport the requests arrive on
+	 * @param _address server address answered
+	 * @param serial_number stored in SERIAL_NUMBER_LOW and SERIAL_NUMBER_HIGH
+	 */
+	SimulatedOrcaServer(ByteTransport* _transport, uint8_t _address, uint32_t serial_number) :
+		transport(_transport),
+		address(_address)
+	{
+		memset(registers, 0, sizeof(registers));
+		registers[SERIAL_NUMBER_LOW] = uint16_t(serial_number);
+		registers[SERIAL_NUMBER_HIGH] = uint16_t(serial_number >> 16);
+		registers[MAJOR_VERSION] = 6;
+		registers[VOLTAGE_REG_OFFSET] = 24000;
+		registers[TEMP_REG_OFFSET] = 30;
+	}
+
+	/**
+	 * @brief Answer every complete request received so far
+	 * @return the number of requests answered
+	 */
+	int poll() {
+		int received = transport->read(buffer + length, sizeof(buffer) - length);
+		if (received > 0) length += received;
+
+		int answered = 0;
+		int frame;
+		while ((frame = get_request_length(buffer, length)) > 0 && frame <= length) {
+			if (ModbusCRC::generate(buffer, frame - 2) == ((buffer[frame - 2] << 8) | buffer[frame - 1])) {
+				if (handle(buffer)) answered++;
+			}
+			else {
+				crc_errors++;
+			}
+			length -= frame;
+			memmove(buffer, buffer + frame, length);
+		}
+		if (frame < 0 || length == sizeof(buffer)) length = 0;		// unknown function code or overrun; resynchronize on the next request
+		return answered;
+	}
+
+	/// @brief the simulated memory map, for setting up and checking registers
+	uint16_t& operator[](uint16_t reg) { return registers[reg < ORCA_REG_SIZE ? reg : 0]; }
+
+	/**
+	 * @brief Stop or resume answering, as if the server were unplugged
+	 */
+	void set_responding(bool _responding) { responding = _responding; }
+
+	uint8_t get_address() { return address; }
+
+	/// @brief requests answered since construction
+	uint32_t get_request_count() { return requests; }
+
+	/// @brief requests addressed to this server which failed their CRC
+	uint32_t get_crc_error_count() { return crc_errors; }
+
+private:
+
+	ByteTransport* transport;
+	const uint8_t address;
+	uint16_t registers[ORCA_REG_SIZE];
+	bool responding = true;
+	uint32_t requests = 0;
+	uint32_t crc_errors = 0;
+
+	uint8_t buffer[256];
+	int length = 0;
+
+	/**
+	 * @return the length of the request at the start of the buffer, 0 if not enough of it has arrived to tell, or -1 if its
+	 * function code isn't handled
+	 */
+	static int get_request_length(const uint8_t* request, int available) {
+		if (available < 2) return 0;
+		switch (request[1]) {
+		case 3:
+		case 6:		return 8;
+		case 8:		return 6;
+		case 16:	return available < 7 ? 0 : 9 + request[6];
+		case 65:	return 12;
+		case 100:	return 9;
+		case 104:	return 7;
+		case 105:	return 11;
+		default:	return -1;
+		}
+	}
+
+	bool handle(const uint8_t* request) {
+		if (request[0] != address || !responding) return false;
+		requests++;
+
+		uint8_t response[256];
+		response[0] = address;
+		response[1] = request[1];
+		int response_length = 2;
+		uint16_t start = (request[2] << 8) | request[3];
+
+		switch (request[1]) {
+		case 3: {
+			uint16_t count = (request[4] << 8) | request[5];
+			if (count > MAX_NUM_READ_REG || start + count > ORCA_REG_SIZE) return send_exception(request[1], 2);
+			response[response_length++] = uint8_t(count * 2);
+			for (int i = 0; i < count; i++) response_length = put16(response, response_length, registers[start + i]);
+			break;
+		}
+		case 6:
+			if (start >= ORCA_REG_SIZE) return send_exception(request[1], 2);
+			write(start, (request[4] << 8) | request[5]);
+			memcpy(response, request, 6);
+			response_length = 6;
+			break;
+		case 16: {
+			uint16_t count = (request[4] << 8) | request[5];
+			if (start + count > ORCA_REG_SIZE) return send_exception(request[1], 2);
+			for (int i = 0; i < count; i++) write(start + i, (request[7 + i * 2] << 8) | request[8 + i * 2]);
+			memcpy(response, request, 6);
+			response_length = 6;
+			break;
+		}
+		case 8:
+			memcpy(response, request, 4);
+			response_length = 4;
+			break;
+		case 65:
+			// a simulated line realizes whatever baud rate and delay is asked for
+			memcpy(response + 2, request + 2, 8);
+			response_length = 10;
+			break;
+		case 100: {
+			int32_t value = int32_t((uint32_t(request[3]) << 24) | (uint32_t(request[4]) << 16) | (request[5] << 8) | request[6]);
+			command(request[2], value);
+			response_length = put_feedback(response, response_length);
+			break;
+		}
+		case 104: {
+			uint8_t width = request[4];
+			response_length = put16(response, response_length, width > 1 ? registers[(start + 1) % ORCA_REG_SIZE] : 0);
+			response_length = put16(response, response_length, registers[start % ORCA_REG_SIZE]);
+			response[response_length++] = uint8_t(registers[MODE_OF_OPERATION]);
+			response_length = put_feedback(response, response_length);
+			break;
+		}
+		case 105: {
+			uint8_t width = request[4];
+			uint32_t value = (uint32_t(request[5]) << 24) | (uint32_t(request[6]) << 16) | (request[7] << 8) | request[8];
+			write(start % ORCA_REG_SIZE, uint16_t(value));
+			if (width > 1) write((start + 1) % ORCA_REG_SIZE, uint16_t(value >> 16));
+			response[response_length++] = uint8_t(registers[MODE_OF_OPERATION]);
+			response_length = put_feedback(response, response_length);
+			break;
+		}
+		}
+		send(response, response_length);
+		return true;
+	}
+
+	/**
+	 * @brief Store a written register, acting on the control registers
+	 */
+	void write(uint16_t reg, uint16_t value) {
+		registers[reg] = value;
+		if (reg == CTRL_REG_3) registers[MODE_OF_OPERATION] = value;
+		if (reg == CLEAR_ERROR_REG_OFFSET && (value & (CLEAR_ERROR_MASK))) registers[ERROR_REG_OFFSET] = 0;
+		if (reg == ZERO_POS_REG_OFFSET && (value & (ZERO_POS_MASK))) set32(POS_REG_OFFSET, 0);
+		if (reg == CTRL_REG_0) registers[CTRL_REG_0] = 0;		// commands clear themselves once acted on
+	}
+
+	void command(uint8_t code, int32_t value) {
+		if (code == FORCE_CMD) set32(FORCE_REG_OFFSET, uint32_t(value));
+		else if (code == POS_CMD) set32(POS_REG_OFFSET, uint32_t(value));
+		if (code == 0) registers[MODE_OF_OPERATION] = 1;		// sleep
+	}
+
+	void set32(uint16_t reg, uint32_t value) {
+		registers[reg] = uint16_t(value);
+		registers[reg + 1] = uint16_t(value >> 16);
+	}
+
+	/// @brief the feedback common to every stream response, laid out as Actuator::get_response_layouts() reads it
+	int put_feedback(uint8_t* response, int offset) {
+		offset = put16(response, offset, registers[POS_REG_H_OFFSET]);
+		offset = put16(response, offset, registers[POS_REG_OFFSET]);
+		offset = put16(response, offset, registers[FORCE_REG_H_OFFSET]);
+		offset = put16(response, offset, registers[FORCE_REG_OFFSET]);
+		offset = put16(response, offset, registers[POWER_REG_OFFSET]);
+		response[offset++] = uint8_t(registers[TEMP_REG_OFFSET]);
+		offset = put16(response, offset, registers[VOLTAGE_REG_OFFSET]);
+		offset = put16(response, offset, registers[ERROR_REG_OFFSET]);
+		return offset;
+	}
+
+	static int put16(uint8_t* data, int offset, uint16_t value) {
+		data[offset] = uint8_t(value >> 8);
+		data[offset + 1] = uint8_t(value);
+		return offset + 2;
+	}
+
+	bool send_exception(uint8_t function_code, uint8_t exception_code) {
+		uint8_t response[5] = { address, uint8_t(function_code | 0x80), exception_code };
+		send(response, 3);
+		return true;
+	}
+
+	void send(uint8_t* response, int response_length) {
+		uint16_t crc = ModbusCRC::generate(response, response_length);
+		response[response_length] = uint8_t(crc >> 8);
+		response[response_length + 1] = uint8_t(crc);
+		transport->write(response, response_length + 2);
+	}
+};
+
+#endif
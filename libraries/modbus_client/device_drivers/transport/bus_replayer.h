@@ -0,0 +1,200 @@
+/**
+ * @file bus_replayer.h
+ *
+ * @brief  Plays a BusRecorder recording back to a transport_ModbusClient under simulated time
+ *
+ * @version 2.2.0
+
+    @copyright Copyright 2022 Iris Dynamics Ltd
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+    For questions or feedback on this file, please email <support@irisdynamics.com>.
+ */
+
+#pragma once
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "../../bus_recorder.h"
+#include "byte_transport.h"
+#include "cycle_clock.h"
+
+/**
+ * @class BusReplayer
+ * @brief Stands in for the server in a recording. It is both the client's transport and its clock.
+ *
+ * Time only moves when advance() is called, so a replay is deterministic and runs as fast as the host allows.
+ * Each frame the client writes is matched to the next recorded request. The recorded response bytes are then released
+ * to read() at the same delays after that request as they had in the recording. Bytes that differ from the recorded
+ * request are counted but the replay continues, since streamed setpoints will usually differ.
+ *
+ * The recording should start before the client's handshake (ie the recorder was attached before Actuator::init()),
+ * otherwise the client's first requests won't match.
+ *
+ * Usage:
+ *  replayer.load("incident.irbr");
+ *  actuator.modbus_client.set_clock(&replayer);
+ *  actuator.set_transport(&replayer);
+ *  actuator.init(); actuator.enable();
+ *  while (!replayer.is_finished()) { replayer.advance(step); actuator.run_in(); actuator.run_out(); }
+ */
+class BusReplayer : public ByteTransport, public CycleClock {
+
+public:
+
+	/**
+	 * @brief Read a recording into memory and rewind
+	 * @return false if the file is missing or isn't a recording
+	 */
+	bool load(const char* path) {
+		events.clear();
+		FILE* file = fopen(path, "rb");
+		if (!file) return false;
+
+		uint8_t header[BUS_RECORDING_HEADER_SIZE];
+		bool valid = fread(header, 1, sizeof(header), file) == sizeof(header)
+			&& memcmp(header, BUS_RECORDING_MAGIC, 4) == 0
+			&& BusRecorder::get_u16(header + 4) == BUS_RECORDING_VERSION
+			&& BusRecorder::get_u16(header + 6) == BUS_RECORDING_EVENT_SIZE;
+		if (valid) {
+			cycles_per_us = BusRecorder::get_u32(header + 8);
+			uint8_t in[BUS_RECORDING_EVENT_SIZE];
+			while (fread(in, 1, sizeof(in), file) == sizeof(in)) {
+				BusEvent event;
+				event.cycles = BusRecorder::get_u32(in);
+				event.data = in[4];
+				event.flags = in[5];
+				events.push_back(event);
+			}
+		}
+		fclose(file);
+		rewind();
+		return valid;
+	}
+
+	/**
+	 * @brief Restart the replay from the first event with the clock at 0
+	 */
+	void rewind() {
+		next = 0;
+		now = 0;
+		anchor = 0;
+		mismatched_bytes = 0;
+		unread_bytes = 0;
+		frames_replayed = 0;
+	}
+
+	/**
+	 * @brief Move simulated time forward
+	 */
+	void advance(uint32_t cycles) {
+		now += cycles;
+	}
+
+	/// @brief true once every recorded event has been matched or released
+	bool is_finished() { return next >= events.size(); }
+
+	/// @brief Client system cycles per microsecond when the recording was made
+	uint32_t get_recorded_cycles_per_us() { return cycles_per_us; }
+
+	size_t get_event_count() { return events.size(); }
+
+	/// @brief Bytes written by the client which differed from the recorded request
+	uint32_t get_mismatched_bytes() { return mismatched_bytes; }
+
+	/// @brief Recorded response bytes skipped because the client sent its next request before reading them
+	uint32_t get_unread_bytes() { return unread_bytes; }
+
+	/// @brief Recorded requests matched so far
+	uint32_t get_frames_replayed() { return frames_replayed; }
+
+//////////// CycleClock ////////////
+
+	uint32_t get_cycles() override {
+		return now;
+	}
+
+//////////// ByteTransport ////////////
+
+	bool open(uint32_t baud_rate_bps) override {
+		opened = true;
+		return true;
+	}
+
+	void close() override {
+		opened = false;
+	}
+
+	bool is_open() override {
+		return opened;
+	}
+
+	bool set_baud(uint32_t baud_rate_bps) override {
+		return true;
+	}
+
+	void flush() override {
+	}
+
+	/**
+	 * @brief Releases the recorded response bytes which are due at the current simulated time
+	 */
+	int read(uint8_t* data, int max_bytes) override {
+		int n = 0;
+		while (n < max_bytes && next < events.size()) {
+			BusEvent& event = events[next];
+			if (!(event.flags & BusTap::RX)) break;						// next request; wait for the client
+			if ((int32_t)(now - (event.cycles + anchor)) < 0) break;	// not due yet
+			next++;
+			if (event.flags & (BusTap::RESPONSE_TIMEOUT | BusTap::INTERCHAR_TIMEOUT)) continue;	// markers carry no data
+			data[n++] = event.data;
+		}
+		return n;
+	}
+
+	/**
+	 * @brief Matches the client's bytes against the next recorded request.
+	 * The end of the request re-anchors the recording's time to the simulated time.
+	 */
+	int write(const uint8_t* data, int num_bytes) override {
+		for (int i = 0; i < num_bytes; i++) {
+			while (next < events.size() && (events[next].flags & BusTap::RX)) {	// response bytes the client never read
+				if (!(events[next].flags & (BusTap::RESPONSE_TIMEOUT | BusTap::INTERCHAR_TIMEOUT))) unread_bytes++;
+				next++;
+			}
+			if (next >= events.size()) return num_bytes;
+
+			BusEvent& event = events[next++];
+			if (event.data != data[i]) mismatched_bytes++;
+			if (event.flags & BusTap::FRAME_END) {
+				anchor = now - event.cycles;
+				frames_replayed++;
+			}
+		}
+		return num_bytes;
+	}
+
+private:
+
+	std::vector<BusEvent> events;
+	size_t next = 0;				// index of the next event to match or release
+	uint32_t now = 0;				// simulated client system cycles
+	uint32_t anchor = 0;			// added to a recorded time to give the simulated time
+	uint32_t cycles_per_us = 1;
+	bool opened = false;
+
+	uint32_t mismatched_bytes = 0;
+	uint32_t unread_bytes = 0;
+	uint32_t frames_replayed = 0;
+};
@@ -0,0 +1,80 @@
+/**
+ * @file byte_transport.h
+ *
+ * @brief  Interface to a bidirectional byte stream that a transport_ModbusClient sends and receives frames over
+ *
+ * @version 2.2.0
+
+    @copyright Copyright 2022 Iris Dynamics Ltd
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+    For questions or feedback on this file, please email <support@irisdynamics.com>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * @class ByteTransport
+ * @brief A byte stream with no knowledge of Modbus framing.
+ *
+ * Implementations must never block in read() or write(). Timing of frames (interframe, interchar and response timeouts)
+ * remains the job of the ModbusClient, so a transport only moves bytes.
+ */
+class ByteTransport {
+public:
+	virtual ~ByteTransport() {}
+
+	/**
+	 * @brief Open the underlying device at the given baud rate
+	 * @return true if the transport is ready to read and write
+	 */
+	virtual bool open(uint32_t baud_rate_bps) = 0;
+
+	/**
+	 * @brief Release the underlying device. Safe to call when not open.
+	 */
+	virtual void close() = 0;
+
+	virtual bool is_open() = 0;
+
+	/**
+	 * @brief Change the line rate. Transports without a line rate should accept any value.
+	 * @return false if the rate could not be applied
+	 */
+	virtual bool set_baud(uint32_t baud_rate_bps) = 0;
+
+	/**
+	 * @brief Copy up to max_bytes already received bytes into data without waiting
+	 * @return the number of bytes copied, 0 if none were available, or -1 if the transport failed
+	 */
+	virtual int read(uint8_t* data, int max_bytes) = 0;
+
+	/**
+	 * @brief Accept up to num_bytes bytes for transmission without waiting
+	 * @return the number of bytes accepted, which may be less than num_bytes, or -1 if the transport failed
+	 */
+	virtual int write(const uint8_t* data, int num_bytes) = 0;
+
+	/**
+	 * @brief Discard any received bytes not yet read and any written bytes not yet sent
+	 */
+	virtual void flush() = 0;
+
+	/**
+	 * @brief A descriptor which becomes readable when bytes arrive, for use with poll() or select()
+	 * @return the descriptor, or -1 if the transport can only be polled by calling read()
+	 */
+	virtual int get_ready_fd() { return -1; }
+};
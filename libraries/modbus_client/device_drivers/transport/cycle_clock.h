@@ -0,0 +1,37 @@
+/**
+ * @file cycle_clock.h
+ *
+ * @brief  Interface for replacing the system time seen by a transport_ModbusClient
+ *
+ * @version 2.2.0
+
+    @copyright Copyright 2022 Iris Dynamics Ltd
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+    For questions or feedback on this file, please email <support@irisdynamics.com>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * @class CycleClock
+ * @brief A source of system time in client cycles, eg. a simulated clock that only advances when told to
+ */
+class CycleClock {
+public:
+	virtual ~CycleClock() {}
+
+	virtual uint32_t get_cycles() = 0;
+};
@@ -0,0 +1,146 @@
+/**
+ * @file memory_transport.h
+ *
+ * @brief  In-process ByteTransport pair for running a client against a simulated server without system calls
+ *
+ * @version 2.2.0
+
+    @copyright Copyright 2022 Iris Dynamics Ltd
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+    For questions or feedback on this file, please email <support@irisdynamics.com>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include "byte_transport.h"
+
+/**
+ * @class MemoryByteRing
+ * @brief Fixed size byte ring with one writer and one reader, which may be on different threads.
+ */
+class MemoryByteRing {
+public:
+	static const uint32_t SIZE = 4096;		// must be a power of 2
+
+	/// @brief Copies up to num_bytes into the ring, returning the number copied
+	int push(const uint8_t* data, int num_bytes) {
+		uint32_t head = write_index.load(std::memory_order_relaxed);
+		uint32_t tail = read_index.load(std::memory_order_acquire);
+		uint32_t space = SIZE - (head - tail);
+		uint32_t n = (uint32_t)num_bytes < space ? (uint32_t)num_bytes : space;
+		for (uint32_t i = 0; i < n; i++) buffer[(head + i) & (SIZE - 1)] = data[i];
+		write_index.store(head + n, std::memory_order_release);
+		return (int)n;
+	}
+
+	/// @brief Copies up to max_bytes out of the ring, returning the number copied
+	int pop(uint8_t* data, int max_bytes) {
+		uint32_t tail = read_index.load(std::memory_order_relaxed);
+		uint32_t head = write_index.load(std::memory_order_acquire);
+		uint32_t count = head - tail;
+		uint32_t n = (uint32_t)max_bytes < count ? (uint32_t)max_bytes : count;
+		for (uint32_t i = 0; i < n; i++) data[i] = buffer[(tail + i) & (SIZE - 1)];
+		read_index.store(tail + n, std::memory_order_release);
+		return (int)n;
+	}
+
+	/// @brief Discards all unread bytes. Must only be called by the reader.
+	void clear() {
+		read_index.store(write_index.load(std::memory_order_acquire), std::memory_order_release);
+	}
+
+private:
+	uint8_t buffer[SIZE];
+	std::atomic<uint32_t> write_index{ 0 };
+	std::atomic<uint32_t> read_index{ 0 };
+};
+
+/**
+ * @class MemoryTransport
+ * @brief One end of a MemoryTransportPair. Writes go to the peer's receive ring.
+ * There is no line rate; set_baud() records the rate so a simulated peer can check it was negotiated.
+ */
+class MemoryTransport : public ByteTransport {
+public:
+	MemoryTransport(MemoryByteRing& _rx, MemoryByteRing& _tx) :
+		rx(_rx),
+		tx(_tx)
+	{}
+
+	bool open(uint32_t baud_rate_bps) override {
+		baud = baud_rate_bps;
+		opened = true;
+		return true;
+	}
+
+	void close() override {
+		opened = false;
+	}
+
+	bool is_open() override {
+		return opened;
+	}
+
+	bool set_baud(uint32_t baud_rate_bps) override {
+		baud = baud_rate_bps;
+		return true;
+	}
+
+	uint32_t get_baud() {
+		return baud;
+	}
+
+	int read(uint8_t* data, int max_bytes) override {
+		if (!opened) return -1;
+		return rx.pop(data, max_bytes);
+	}
+
+	int write(const uint8_t* data, int num_bytes) override {
+		if (!opened) return -1;
+		return tx.push(data, num_bytes);
+	}
+
+	/**
+	 * @brief Discards received bytes not yet read. Bytes already written belong to the peer.
+	 */
+	void flush() override {
+		rx.clear();
+	}
+
+private:
+	MemoryByteRing& rx;
+	MemoryByteRing& tx;
+	bool opened = false;
+	uint32_t baud = 0;
+};
+
+/**
+ * @class MemoryTransportPair
+ * @brief Two connected MemoryTransports; bytes written to one are read from the other.
+ * Typically the client uses client_end and a simulated server uses server_end.
+ */
+class MemoryTransportPair {
+	MemoryByteRing to_server;
+	MemoryByteRing to_client;
+
+public:
+	MemoryTransport client_end;
+	MemoryTransport server_end;
+
+	MemoryTransportPair() :
+		client_end(to_client, to_server),
+		server_end(to_server, to_client)
+	{}
+};
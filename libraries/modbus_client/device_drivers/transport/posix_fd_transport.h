@@ -0,0 +1,88 @@
+/**
+ * @file posix_fd_transport.h
+ *
+ * @brief  Common read, write and close handling for transports built on a POSIX file descriptor
+ *
+ * @version 2.2.0
+
+    @copyright Copyright 2022 Iris Dynamics Ltd
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+    For questions or feedback on this file, please email <support@irisdynamics.com>.
+ */
+
+#pragma once
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "byte_transport.h"
+
+/**
+ * @class PosixFdTransport
+ * @brief Implements the byte moving half of ByteTransport over a nonblocking file descriptor.
+ * Derived classes open the descriptor and handle the line rate.
+ */
+class PosixFdTransport : public ByteTransport {
+public:
+	~PosixFdTransport() {
+		close_fd();
+	}
+
+	void close() override {
+		close_fd();
+	}
+
+	bool is_open() override {
+		return fd >= 0;
+	}
+
+	int read(uint8_t* data, int max_bytes) override {
+		if (fd < 0) return -1;
+		ssize_t n = ::read(fd, data, max_bytes);
+		if (n >= 0) return (int)n;
+		return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ? 0 : -1;
+	}
+
+	int write(const uint8_t* data, int num_bytes) override {
+		if (fd < 0) return -1;
+		ssize_t n = ::write(fd, data, num_bytes);
+		if (n >= 0) return (int)n;
+		return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ? 0 : -1;
+	}
+
+	int get_ready_fd() override {
+		return fd;
+	}
+
+protected:
+	int fd = -1;
+
+	/**
+	 * @brief Put the descriptor in nonblocking mode
+	 * @return false if the mode could not be set
+	 */
+	bool set_nonblocking() {
+		int flags = fcntl(fd, F_GETFL, 0);
+		return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+	}
+
+	void close_fd() {
+		if (fd >= 0) ::close(fd);
+		fd = -1;
+	}
+};
+
+#endif
@@ -0,0 +1,98 @@
+/**
+ * @file pty_transport.h
+ *
+ * @brief  ByteTransport over the master side of a pseudo terminal
+ *
+ * @version 2.2.0
+
+    @copyright Copyright 2022 Iris Dynamics Ltd
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+    For questions or feedback on this file, please email <support@irisdynamics.com>.
+ */
+
+#pragma once
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <stdlib.h>
+#include <string.h>
+#include "tty_transport.h"
+
+/**
+ * @class PtyTransport
+ * @brief Creates a pseudo terminal and talks through its master side.
+ *
+ * A simulated server, or any tool expecting a serial port, opens the path returned by get_peer_path().
+ * The transport keeps its own handle on that peer side so reads don't fail while no other process has it open.
+ * A pseudo terminal has no line rate, so set_baud() always succeeds.
+ */
+class PtyTransport : public PosixFdTransport {
+public:
+	~PtyTransport() {
+		close_peer();
+	}
+
+	bool open(uint32_t baud_rate_bps) override {
+		close();
+		fd = posix_openpt(O_RDWR | O_NOCTTY);
+		if (fd < 0) return false;
+
+		const char* name = 0;
+		if (grantpt(fd) != 0 || unlockpt(fd) != 0 || (name = ptsname(fd)) == 0) {
+			close();
+			return false;
+		}
+		strncpy(peer_path, name, sizeof(peer_path) - 1);
+		peer_path[sizeof(peer_path) - 1] = 0;
+
+		peer_fd = ::open(peer_path, O_RDWR | O_NOCTTY | O_NONBLOCK);
+		if (peer_fd < 0 || !TtyTransport::configure_raw(peer_fd) || !set_nonblocking()) {
+			close();
+			return false;
+		}
+		return true;
+	}
+
+	void close() override {
+		close_peer();
+		close_fd();
+		peer_path[0] = 0;
+	}
+
+	bool set_baud(uint32_t baud_rate_bps) override {
+		return true;
+	}
+
+	void flush() override {
+		if (fd >= 0) tcflush(fd, TCIOFLUSH);
+	}
+
+	/**
+	 * @brief Path of the peer side (eg. /dev/pts/3), or an empty string when not open
+	 */
+	const char* get_peer_path() {
+		return peer_path;
+	}
+
+private:
+	int peer_fd = -1;
+	char peer_path[64] = { 0 };
+
+	void close_peer() {
+		if (peer_fd >= 0) ::close(peer_fd);
+		peer_fd = -1;
+	}
+};
+
+#endif
@@ -0,0 +1,115 @@
+/**
+ * @file tcp_transport.h
+ *
+ * @brief  ByteTransport over a TCP connection, eg. to a serial device server or a simulated Modbus server
+ *
+ * @version 2.2.0
+
+    @copyright Copyright 2022 Iris Dynamics Ltd
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+    For questions or feedback on this file, please email <support@irisdynamics.com>.
+ */
+
+#pragma once
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <stdio.h>
+#include <string.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include "posix_fd_transport.h"
+
+/**
+ * @class TcpTransport
+ * @brief Carries the RTU byte stream unchanged over a TCP connection.
+ *
+ * The connection is made with a blocking connect() in open() and is nonblocking afterwards.
+ * Nagle's algorithm is disabled so each frame is sent as soon as it is written.
+ * There is no line rate; set_baud() always succeeds.
+ */
+class TcpTransport : public PosixFdTransport {
+public:
+	/**
+	 * @param _host host name or address of the server. The string must outlive the transport.
+	 * @param _port TCP port of the server
+	 */
+	TcpTransport(const char* _host, uint16_t _port) :
+		host(_host),
+		port(_port)
+	{}
+
+	bool open(uint32_t baud_rate_bps) override {
+		close_fd();
+
+		char port_string[8];
+		snprintf(port_string, sizeof(port_string), "%u", (unsigned)port);
+
+		struct addrinfo hints;
+		memset(&hints, 0, sizeof(hints));
+		hints.ai_family = AF_UNSPEC;
+		hints.ai_socktype = SOCK_STREAM;
+
+		struct addrinfo* results = 0;
+		if (getaddrinfo(host, port_string, &hints, &results) != 0) return false;
+
+		for (struct addrinfo* addr = results; addr; addr = addr->ai_next) {
+			fd = socket(addr->ai_family, addr->ai_socktype, addr->ai_protocol);
+			if (fd < 0) continue;
+			if (connect(fd, addr->ai_addr, addr->ai_addrlen) == 0) break;
+			close_fd();
+		}
+		freeaddrinfo(results);
+		if (fd < 0) return false;
+
+		int one = 1;
+		setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+		if (!set_nonblocking()) {
+			close_fd();
+			return false;
+		}
+		return true;
+	}
+
+	bool set_baud(uint32_t baud_rate_bps) override {
+		return true;
+	}
+
+	/**
+	 * @brief Discards received bytes not yet read. Bytes already handed to the socket cannot be recalled.
+	 */
+	void flush() override {
+		uint8_t discard[64];
+		while (read(discard, sizeof(discard)) > 0) {}
+	}
+
+	/**
+	 * @brief A closed connection reads as end of file rather than no data; report it as a failure
+	 */
+	int read(uint8_t* data, int max_bytes) override {
+		if (fd < 0) return -1;
+		ssize_t n = ::read(fd, data, max_bytes);
+		if (n > 0) return (int)n;
+		if (n == 0) return -1;
+		return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ? 0 : -1;
+	}
+
+private:
+	const char* host;
+	uint16_t port;
+};
+
+#endif
@@ -0,0 +1,207 @@
+/**
+ * @file transport_modbus_client.h
+ *
+ * @brief  Device driver for Modbus client communication over any ByteTransport
+ *
+ * This class extends the virtual ModbusClient base class
+ *
+ * @version 2.2.0
+
+    @copyright Copyright 2022 Iris Dynamics Ltd
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+    For questions or feedback on this file, please email <support@irisdynamics.com>.
+ */
+
+#pragma once
+
+#include <chrono>
+#include "../../modbus_client.h"
+#include "../../transaction.h"
+#include "byte_transport.h"
+#include "cycle_clock.h"
+
+/**
+ * @class transport_ModbusClient
+ * @brief Extension of the ModbusClient virtual class which moves bytes through a ByteTransport.
+ *
+ * There are no interrupts; uart_isr() polls the transport and must be called regularly (the Actuator does so from run_in()).
+ * Each frame is handed to the transport with a single write. System cycles are derived from the steady clock unless a CycleClock is set.
+ */
+class transport_ModbusClient : public ModbusClient {
+
+protected:
+
+    int channel_number;
+    uint32_t cycles_per_us;
+
+public:
+
+    transport_ModbusClient(int _channel_number, uint32_t _cycles_per_us) : ModbusClient(_channel_number, _cycles_per_us)
+    {
+        channel_number = _channel_number;
+        cycles_per_us = _cycles_per_us;
+    }
+
+    /**
+     * @brief Set the transport used by init() and all following communication
+     * @param _transport the transport, which must outlive the client. Any previous transport is left open.
+     */
+    void set_transport(ByteTransport* _transport) {
+        transport = _transport;
+        rx_head = rx_count = 0;
+        tx_sent = tx_count = 0;
+    }
+
+    ByteTransport* get_transport() {
+        return transport;
+    }
+
+    /**
+     * @brief Replace the steady clock, eg. with a simulated clock for replaying a recording
+     * @param _clock the clock, or 0 to return to the steady clock
+     */
+    void set_clock(CycleClock* _clock) {
+        clock = _clock;
+    }
+
+    /** @brief true if the transport reported a failure since the last init() */
+    bool has_transport_error() {
+        return transport_error;
+    }
+
+    /**
+     * @brief Opens the transport if it isn't already open and sets its baud rate
+     * @param baud The baud rate as defined in the mb_config.h file
+    */
+    void init(int baud) override {
+        transport_error = false;
+        rx_head = rx_count = 0;
+        tx_sent = tx_count = 0;
+        if (transport) {
+            if (!transport->is_open() && !transport->open(baud)) transport_error = true;
+            else if (!transport->set_baud(baud)) transport_error = true;
+            else transport->flush();
+        }
+        reset_state();
+    }
+
+    //////////// Virtual function implementations ////////////
+
+    /**
+     * @brief Writes out any bytes the transport didn't accept earlier, then receives every byte available while a response is expected
+     */
+    void uart_isr() override {
+        write_pending();
+        if (my_state == reception) {
+            while (byte_ready_to_receive()) {
+                receive();
+            }
+        }
+    }
+
+    /**
+     * @brief Collects the whole active transaction and hands it to the transport at once
+    */
+    void tx_enable() override {
+        tx_sent = tx_count = 0;
+        while (my_state == emission && messages.get_active_transaction()->bytes_left_to_send()) {
+            send();
+        }
+        write_pending();
+    }
+
+    /**
+     * @brief Not using interupts, so no implementation needed.
+    */
+    void tx_disable() override {
+
+    }
+
+    /**
+     * @brief Loads the send buffer with the next byte
+     * @param byte		The byte to be transmitted.
+     */
+    void send_byte(uint8_t data) override {
+        if (tx_count < sizeof(tx_buf)) tx_buf[tx_count++] = data;
+    }
+
+    /**
+     * @brief Return the next byte received by the transport. Only valid after byte_ready_to_receive() returns true.
+     */
+    uint8_t receive_byte() override {
+        return rx_buf[rx_head++];
+    }
+
+    /**
+    * @brief true if a received byte is buffered, reading a block from the transport when the buffer is empty
+    */
+    bool byte_ready_to_receive() override {
+        if (rx_head < rx_count) return true;
+        rx_head = rx_count = 0;
+        if (!transport) return false;
+        int n = transport->read(rx_buf, sizeof(rx_buf));
+        if (n < 0) {
+            transport_error = true;
+            return false;
+        }
+        rx_count = n;
+        return n > 0;
+    }
+
+    /**
+     * @brief Adjust the baud rate
+     * @param baud_rate the new baud rate in bps
+     * this method overrides the modbus default delay
+    */
+    void adjust_baud_rate(uint32_t baud_rate_bps) override {
+        if (transport && !transport->set_baud(baud_rate_bps)) transport_error = true;
+    }
+
+    /**
+    * @brief Get the device's current system time in cycles, derived from the steady clock
+    */
+    uint32_t get_system_cycles() override {
+        if (clock) return clock->get_cycles();
+        uint64_t us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        return (uint32_t)(us * cycles_per_us);
+    }
+
+private:
+
+    ByteTransport* transport = 0;
+    CycleClock* clock = 0;
+    bool transport_error = false;
+
+    uint8_t rx_buf[256];
+    uint32_t rx_head = 0;
+    uint32_t rx_count = 0;
+
+    uint8_t tx_buf[256];
+    uint32_t tx_sent = 0;
+    uint32_t tx_count = 0;
+
+    /**
+     * @brief Hands as much of the unsent frame to the transport as it will accept
+     */
+    void write_pending() {
+        if (!transport || tx_sent >= tx_count) return;
+        int n = transport->write(tx_buf + tx_sent, tx_count - tx_sent);
+        if (n < 0) {
+            transport_error = true;
+            tx_sent = tx_count;
+            return;
+        }
+        tx_sent += n;
+    }
+};
@@ -0,0 +1,155 @@
+/**
+ * @file tty_transport.h
+ *
+ * @brief  ByteTransport over a POSIX serial device using termios
+ *
+ * @version 2.2.0
+
+    @copyright Copyright 2022 Iris Dynamics Ltd
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+    For questions or feedback on this file, please email <support@irisdynamics.com>.
+ */
+
+#pragma once
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <termios.h>
+#include <sys/ioctl.h>
+#include "posix_fd_transport.h"
+
+/**
+ * @class TtyTransport
+ * @brief Serial device (eg. /dev/ttyUSB0) configured for raw 8 data bits, even parity, one stop bit like the other drivers.
+ *
+ * Rates without a termios constant (such as the default negotiated 625000 bps) are set with the Linux
+ * termios2 interface. On other systems they are passed to cfsetspeed(), which accepts arbitrary rates on BSD and macOS.
+ */
+class TtyTransport : public PosixFdTransport {
+public:
+	/**
+	 * @param _device_path path of the serial device. The string must outlive the transport.
+	 */
+	TtyTransport(const char* _device_path) :
+		device_path(_device_path)
+	{}
+
+	bool open(uint32_t baud_rate_bps) override {
+		close_fd();
+		fd = ::open(device_path, O_RDWR | O_NOCTTY | O_NONBLOCK);
+		if (fd < 0) return false;
+
+		if (!configure_raw(fd) || !set_baud(baud_rate_bps)) {
+			close_fd();
+			return false;
+		}
+		flush();
+		return true;
+	}
+
+	bool set_baud(uint32_t baud_rate_bps) override {
+		if (fd < 0) return false;
+		return apply_baud(fd, baud_rate_bps);
+	}
+
+	void flush() override {
+		if (fd >= 0) tcflush(fd, TCIOFLUSH);
+	}
+
+	/**
+	 * @brief Put a terminal in raw 8E1 mode with reads that never wait
+	 * @return false if the attributes could not be read or applied
+	 */
+	static bool configure_raw(int tty_fd) {
+		struct termios tty;
+		if (tcgetattr(tty_fd, &tty) != 0) return false;
+		cfmakeraw(&tty);
+		tty.c_cflag |= CLOCAL | CREAD | PARENB;
+		tty.c_cflag &= ~(PARODD | CSTOPB | CRTSCTS);
+		tty.c_cc[VMIN]  = 0;
+		tty.c_cc[VTIME] = 0;
+		return tcsetattr(tty_fd, TCSANOW, &tty) == 0;
+	}
+
+	/**
+	 * @brief Set the input and output rate of a terminal
+	 * @return false if the rate is not supported by the device
+	 */
+	static bool apply_baud(int tty_fd, uint32_t baud_rate_bps) {
+		speed_t speed = standard_speed(baud_rate_bps);
+		if (speed != 0) {
+			struct termios tty;
+			if (tcgetattr(tty_fd, &tty) != 0) return false;
+			cfsetispeed(&tty, speed);
+			cfsetospeed(&tty, speed);
+			return tcsetattr(tty_fd, TCSANOW, &tty) == 0;
+		}
+#if defined(__linux__) && defined(TCGETS2)
+		// Layout of the kernel's struct termios2. Declared here since <asm/termbits.h> conflicts with <termios.h>.
+		struct kernel_termios2 {
+			tcflag_t c_iflag, c_oflag, c_cflag, c_lflag;
+			cc_t c_line;
+			cc_t c_cc[19];
+			speed_t c_ispeed, c_ospeed;
+		} tty2;
+		const tcflag_t KERNEL_CBAUD = 0010017;
+		const tcflag_t KERNEL_BOTHER = 0010000;
+		if (ioctl(tty_fd, _IOR('T', 0x2A, struct kernel_termios2), &tty2) != 0) return false;
+		tty2.c_cflag &= ~(KERNEL_CBAUD | (KERNEL_CBAUD << 16));
+		tty2.c_cflag |= KERNEL_BOTHER | (KERNEL_BOTHER << 16);
+		tty2.c_ispeed = baud_rate_bps;
+		tty2.c_ospeed = baud_rate_bps;
+		return ioctl(tty_fd, _IOW('T', 0x2B, struct kernel_termios2), &tty2) == 0;
+#elif defined(__linux__)
+		return false;
+#else
+		struct termios tty;
+		if (tcgetattr(tty_fd, &tty) != 0) return false;
+		cfsetspeed(&tty, (speed_t)baud_rate_bps);
+		return tcsetattr(tty_fd, TCSANOW, &tty) == 0;
+#endif
+	}
+
+private:
+	const char* device_path;
+
+	/**
+	 * @brief termios constant for a rate, or 0 if the rate has none
+	 */
+	static speed_t standard_speed(uint32_t baud_rate_bps) {
+		switch (baud_rate_bps) {
+		case 9600:    return B9600;
+		case 19200:   return B19200;
+		case 38400:   return B38400;
+		case 57600:   return B57600;
+		case 115200:  return B115200;
+		case 230400:  return B230400;
+#ifdef B460800
+		case 460800:  return B460800;
+#endif
+#ifdef B500000
+		case 500000:  return B500000;
+#endif
+#ifdef B921600
+		case 921600:  return B921600;
+#endif
+#ifdef B1000000
+		case 1000000: return B1000000;
+#endif
+		default:      return 0;
+		}
+	}
+};
+
+#endif
@@ -55,4 +55,12 @@
 //function_code 0x17
 #define MAX_NUM_WRITE_REG_RW 0x0079
 
+//function code 65 (0x41) - change connection status, IrisClientApplication
+#define CHANGE_CONNECTION_STATUS_RESPONSE_LEN 12
+
+//function codes 100, 104, 105 (0x64, 0x68, 0x69) - motor command, motor read and motor write stream frames, Actuator
+#define MOTOR_COMMAND_RESPONSE_LEN 19
+#define MOTOR_READ_RESPONSE_LEN 24
+#define MOTOR_WRITE_RESPONSE_LEN 20
+
 #endif
\ No newline at end of file
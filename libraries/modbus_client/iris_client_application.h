@@ -28,6 +28,8 @@
 #include "modbus_client_application.h"
 //#include "../../orca600_api/types.h"
 #include "types.h"
+#include "recovery_stats.h"
+#include "link_rate_selector.h"
 
  /**
   * @class IrisClientApplication
@@ -44,6 +46,15 @@
   *
   *      The state machine will reset to the disconnected state if a number of consecutive failed messages are detected.
   *      The number of failed messages which constitutes a disconnection can be modified by adjusting the max_consec_failed_msgs variable from the ConnectionConfig struct before calling set_connection_config().
+  *
+  *      When fast_resume is enabled and the application can identify its server, a lost link first tries to resume:
+  *      the client keeps the negotiated baud rate and delay and asks the server for its identity. If the same server answers,
+  *      the connection is restored as it was, without the pause, discovery, synchronization and negotiation steps.
+  *      Otherwise the full handshake is run. The time taken by each recovery is kept in get_recovery_stats().
+  *
+  *      Instead of the single target baud rate and delay, a ladder of them can be given with set_link_rate_ladder().
+  *      The connection then starts at the fastest, and moves down or up the ladder as the error rate measured while connected
+  *      requires, renegotiating with the server each time; see LinkRateSelector.
  */
 class IrisClientApplication : public ModbusClientApplication {
 
@@ -72,6 +83,8 @@ public:
         uint32_t target_baud_rate_bps = 625000;
         uint16_t target_delay_us      = 80;
         uint32_t response_timeout_us  = 8000;  /// this timeout will be used to override the default response timeout after a handshake succeeds and a new baud rate is negotiated.
+        bool fast_resume              = true;    //on link loss, try to resume at the negotiated baud rate before falling back to the full handshake
+        uint32_t resume_timeout_us    = 250000;  //time after the link is lost that identity requests are retried before falling back to the full handshake
     };
 
 	ConnectionConfig connection_config;
@@ -112,6 +125,20 @@ public:
         return connection_state == connected;
     }
 
+    /**
+     * @brief The baud rate the client is using, which changes when a handshake completes or the connection is lost
+    */
+    uint32_t get_baud_rate_bps(){
+        return baud_rate_bps;
+    }
+
+    /**
+     * @brief Client system cycles per microsecond, for converting times such as ModbusClient::get_system_cycles()
+    */
+    uint32_t get_cycles_per_us(){
+        return cycles_per_us;
+    }
+
     /**
      * @brief Determine if communication with a server is enabled or not
 	 * 
@@ -133,7 +160,8 @@ public:
     */
     void disable(){
         enabled = false;
-        if(is_connected()){
+        recovering = false;
+        if(is_connected() || connection_state == resuming){
             enqueue_change_connection_status_fn(connection_config.server_address, false, 0, 0);
 
         }
@@ -148,6 +176,7 @@ public:
         connection_state 		= disconnected;
         cur_consec_failed_msgs 	= 0;
 		UART.adjust_baud_rate(UART_BAUD_RATE);
+		baud_rate_bps = UART_BAUD_RATE;
 		UART.adjust_interframe_delay_us();
 		UART.adjust_response_timeout(DEFAULT_RESPONSE_uS);
 		is_paused = true;// pause to allow server to reset to disconnected state
@@ -155,12 +184,55 @@ public:
 		start_pause_timer();
 		desynchronize_memory_map();
 	}
+
+	/**
+	 * @brief Should be called when the connection is lost, ie. when too many consecutive messages have failed while connected
+	 *
+	 * Tries a fast resume when it is enabled and the server's identity is known, and otherwise disconnects.
+	 */
+	void lose_connection() {
+		link_lost_cycles = UART.get_system_cycles();
+		recovering = true;
+		cur_consec_failed_msgs = 0;
+		bool rate_abandoned = link_rate.link_lost();		// the link couldn't sustain a faster rate on trial; don't resume at it
+		if (connection_config.fast_resume && !rate_abandoned && get_server_identity(resume_identity)) {
+			connection_state = resuming;
+			resume_request_pending = false;
+		}
+		else {
+			disconnect();
+		}
+	}
+
+	/**
+	 * @brief Negotiate connection settings from a ladder instead of target_baud_rate_bps and target_delay_us
+	 * @param steps baud rates and delays ordered from fastest to slowest; copied. A count of 0 returns to the targets.
+	 */
+	void set_link_rate_ladder(const LinkRateSelector::Step* steps, int count) {
+		link_rate.set_ladder(steps, count);
+	}
+
+	/**
+	 * @brief The selector choosing from the link rate ladder, for its configuration and error statistics
+	 */
+	LinkRateSelector& get_link_rate_selector() {
+		return link_rate;
+	}
+
+	/**
+	 * @brief Durations of the recoveries from lost connections, by fast resume or full handshake
+	 */
+	const RecoveryStats& get_recovery_stats() {
+		return recovery_stats;
+	}
 	typedef enum {
 		disconnected = 50,	// reset state
 		discovery = 51, 	// sending discovery pings, negotiating baud rate and delay
 		synchronization = 52,
 		negotiation = 53,
 		connected = 54,	// streaming commands to the server
+		resuming = 55,	// link lost; checking the server still answers at the negotiated baud rate
+		renegotiating = 56,	// waiting for the queue to empty before changing the baud rate and delay while connected
 	} ConnectionStatus;
 
 	volatile ConnectionStatus connection_state = disconnected;
@@ -168,6 +240,7 @@ protected:
 
 
 	ModbusClient& UART;
+	uint32_t baud_rate_bps = UART_BAUD_RATE;		// tracks the rate set on UART
 	/**
 	 * @brief Description of the possible connection states between the client and a server
 	 *        Main state machine can be found in IrisClientApplication.
@@ -194,7 +267,7 @@ protected:
 	int get_app_reception_length(uint8_t fn_code) {
 		switch (fn_code) {
 		case IrisClientApplication::change_connection_status:
-			return 12;
+			return CHANGE_CONNECTION_STATUS_RESPONSE_LEN;
 		default:
 			return -1;
 		}
@@ -265,11 +338,7 @@ protected:
 			else {
 				
 				if (UART.get_queue_size() == 0) {
-					enqueue_change_connection_status_fn(
-									connection_config.server_address,
-									true,
-									connection_config.target_baud_rate_bps,
-									connection_config.target_delay_us);
+					enqueue_negotiation();
 					connection_state = negotiation;
 				}
 			}
@@ -283,11 +352,11 @@ protected:
 				// Server responded to our change connection request with its realized baud and delay
 				if (response->get_rx_function_code() == change_connection_status && response->is_reception_valid()) {
 					uint8_t* rx_data = response->get_rx_data();
-					UART.adjust_baud_rate(
-											(uint32_t(rx_data[2]) << 24)
+					baud_rate_bps =			(uint32_t(rx_data[2]) << 24)
 											| (uint32_t(rx_data[3]) << 16)
 											| (uint32_t(rx_data[4]) << 8)
-											| (uint32_t(rx_data[5]) << 0)); //set baud
+											| (uint32_t(rx_data[5]) << 0);
+					UART.adjust_baud_rate(baud_rate_bps); //set baud
 
 					UART.adjust_interframe_delay_us(
 
@@ -297,6 +366,7 @@ protected:
 					UART.adjust_response_timeout(connection_config.response_timeout_us);
 
 					connection_state = connected;
+					complete_recovery(RecoveryStats::full_handshake);
 
 				}
 				// Server failed to respond to our change connection request
@@ -307,6 +377,51 @@ protected:
 		case connected:
 			// connection successful
 			break;
+
+		case renegotiating:
+
+			// let the frames already queued at the old rate finish first
+			if (UART.get_queue_size() == 0) {
+				new_data();	// clear new data flag
+				enqueue_negotiation();
+				connection_state = negotiation;
+			}
+			break;
+
+		case resuming:
+
+			if (!resume_request_pending) {
+				// let the requests queued before the link was lost be received or time out first
+				if (UART.get_queue_size() == 0) {
+					new_data();	// clear new data flag
+					if (enqueue_identity_request()) {
+						resume_request_pending = true;
+					}
+					else {
+						recovery_stats.record_fallback();
+						disconnect();
+					}
+				}
+			}
+			else if (new_data()) {
+				resume_request_pending = false;
+				uint64_t identity;
+				if (response->is_reception_valid()
+					&& response->get_rx_function_code() == response->get_tx_function_code()
+					&& get_server_identity(identity) && identity == resume_identity) {
+					// the same server still answers at the negotiated baud rate; carry on streaming
+					cur_consec_failed_msgs = 0;
+					connection_state = connected;
+					complete_recovery(RecoveryStats::fast_resume);
+				}
+				else if (response->is_reception_valid()
+					|| (uint32_t)(UART.get_system_cycles() - link_lost_cycles) >= connection_config.resume_timeout_us * cycles_per_us) {
+					// no answer, or a different server
+					recovery_stats.record_fallback();
+					disconnect();
+				}
+			}
+			break;
 		}
 	}
 
@@ -321,12 +436,60 @@ protected:
 	 */
 	virtual void desynchronize_memory_map() {};
 
+	/**
+	 * @brief Should be called with each transaction claimed from the queue, to measure the link's error rate
+	 * Starts a renegotiation when the link rate ladder calls for a different step.
+	 */
+	void track_link_quality(Transaction* transaction) {
+		if (connection_state == connected && link_rate.record(transaction)) {
+			connection_state = renegotiating;
+		}
+	}
+
+	/**
+	 * @brief Can be overridden to allow fast resumes; queues a request whose response updates the server's identity
+	 * @return 1 if the request was added to the queue, 0 if it wasn't or fast resumes aren't supported
+	 */
+	virtual int enqueue_identity_request() { return 0; }
+
+	/**
+	 * @brief Can be overridden to allow fast resumes; the identity of the server as last received, eg. its serial number and firmware
+	 * @return false if the identity isn't known
+	 */
+	virtual bool get_server_identity(uint64_t&) { return false; }
+
 	bool enabled = false;
 
 private:
 
 	int num_discovery_pings_received = 0;
 
+	LinkRateSelector link_rate;
+
+	/**
+	 * @brief Request the baud rate and delay of the current link rate step, or the configured targets when there is no ladder
+	 */
+	int enqueue_negotiation() {
+		if (link_rate.has_ladder()) {
+			LinkRateSelector::Step step = link_rate.get_step();
+			return enqueue_change_connection_status_fn(connection_config.server_address, true, step.baud_rate_bps, step.delay_us);
+		}
+		return enqueue_change_connection_status_fn(connection_config.server_address, true, connection_config.target_baud_rate_bps, connection_config.target_delay_us);
+	}
+
+	// fast resume and recovery timing
+	RecoveryStats recovery_stats;
+	bool recovering = false;			// the link was lost and the connection has not been recovered yet
+	uint32_t link_lost_cycles = 0;
+	uint64_t resume_identity = 0;		// server identity when the link was lost
+	bool resume_request_pending = false;
+
+	void complete_recovery(RecoveryStats::Path path) {
+		if (!recovering) return;
+		recovering = false;
+		recovery_stats.record(path, (UART.get_system_cycles() - link_lost_cycles) / cycles_per_us);
+	}
+
 /////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////  Pause Timer  ///
 ///////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,239 @@
+/**
+ * @file link_rate_selector.h
+ *
+ * @brief  Chooses the fastest baud rate and interframe delay from a ladder that a link sustains at an acceptable error rate
+ *
+ * @version 2.2.0
+
+    @copyright Copyright 2022 Iris Dynamics Ltd
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+    For questions or feedback on this file, please email <support@irisdynamics.com>.
+ */
+
+#ifndef LINK_RATE_SELECTOR_H_
+#define LINK_RATE_SELECTOR_H_
+
+#include "transaction.h"
+
+/**
+ * @class LinkRateSelector
+ * @brief Walks a ladder of connection settings, ordered fastest first, by the error rate measured at each.
+ *
+ * Every response received at the current step is recorded, and its CRC errors, timeouts and other reception errors are
+ * counted. Frames are grouped into windows; a window fails when its error rate exceeds max_error_rate.
+ *
+ * The selector starts at the fastest step, on trial. A step on trial which fails its first window is abandoned for the
+ * next slower step, which is then on trial itself; one which passes is kept. So the first steps taken after connecting
+ * probe down the ladder to the fastest step that meets the target.
+ * Afterwards, degrade_windows consecutive failed windows step down, and upgrade_windows consecutive passing windows try
+ * the next faster step on trial. Each failed trial doubles the passing windows needed before trying again, up to
+ * MAX_BACKOFF times, so a rate the link can't sustain isn't retried constantly.
+ *
+ * The owner applies each new step, eg. by renegotiating through the change connection status function code.
+ */
+class LinkRateSelector {
+
+public:
+
+	/**
+	 * @brief One rung of the ladder
+	 */
+	struct Step {
+		uint32_t baud_rate_bps;
+		uint16_t delay_us;
+	};
+
+	/**
+	 * @brief Tuning parameters for the selector
+	 */
+	struct Config {
+		float   max_error_rate  = 0.005;	//!< errors per frame a step may have in a window and still pass
+		uint16_t window_frames  = 200;		//!< frames in each evaluation window
+		uint8_t degrade_windows = 1;		//!< consecutive failed windows before stepping down
+		uint8_t upgrade_windows = 50;		//!< consecutive passing windows before trying a faster step
+	};
+
+	/**
+	 * @brief Error counts of one step since the ladder was set
+	 */
+	struct StepStats {
+		uint32_t frames;
+		uint32_t crc_errors;
+		uint32_t timeouts;
+		uint32_t other_errors;		//!< framing, overrun, unexpected responder and intercharacter timeout errors
+		uint32_t failed_windows;
+		uint32_t passed_windows;
+	};
+
+	static const int MAX_STEPS = 8;
+	static const int MAX_BACKOFF = 64;
+
+	/**
+	 * @brief Set the ladder and start again from its fastest step, on trial
+	 * @param steps connection settings ordered from fastest to slowest; copied. At most MAX_STEPS are used.
+	 * @param count number of steps; 0 clears the ladder
+	 */
+	void set_ladder(const Step* steps, int count) {
+		step_count = count > MAX_STEPS ? MAX_STEPS : count;
+		for (int i = 0; i < step_count; i++) {
+			ladder[i] = steps[i];
+			stats[i] = StepStats();
+		}
+		step_changes = 0;
+		reset();
+	}
+
+	void set_config(Config _config) {
+		if (_config.window_frames < 1) _config.window_frames = 1;
+		if (_config.degrade_windows < 1) _config.degrade_windows = 1;
+		if (_config.upgrade_windows < 1) _config.upgrade_windows = 1;
+		config = _config;
+	}
+
+	Config get_config() { return config; }
+
+	/// @brief true if a ladder has been set
+	bool has_ladder() { return step_count > 0; }
+
+	/**
+	 * @brief Return to the fastest step, on trial, forgetting the current window and backoff. Statistics are kept.
+	 */
+	void reset() {
+		current = 0;
+		on_trial = true;
+		trial_from_below = false;
+		backoff = 1;
+		clear_window();
+		passing_windows = 0;
+		failing_windows = 0;
+	}
+
+	/// @brief the step currently in use; only valid when has_ladder()
+	Step get_step() { return ladder[current]; }
+	int get_step_index() { return current; }
+	int get_step_count() { return step_count; }
+
+	/// @brief true while the current step hasn't yet passed a window
+	bool is_on_trial() { return on_trial; }
+
+	/// @brief times the step has changed since the ladder was set
+	uint32_t get_step_change_count() { return step_changes; }
+
+	/// @brief error counts of a step
+	StepStats get_step_stats(int index) { return index >= 0 && index < step_count ? stats[index] : StepStats(); }
+
+	/**
+	 * @brief Count a claimed transaction against the current step
+	 * @return true if the step changed and should be applied
+	 */
+	bool record(Transaction* transaction) {
+		if (!has_ladder()) return false;
+
+		StepStats& step_stats = stats[current];
+		step_stats.frames++;
+		window_count++;
+		int validity = transaction->get_reception_validity();
+		if (validity) {
+			window_errors++;
+			if (validity & (1 << Transaction::CRC_ERROR)) step_stats.crc_errors++;
+			else if (validity & (1 << Transaction::RESPONSE_TIMEOUT_ERROR)) step_stats.timeouts++;
+			else step_stats.other_errors++;
+		}
+		if (window_count < config.window_frames) return false;
+
+		bool passed = window_errors <= config.max_error_rate * window_count;
+		clear_window();
+
+		if (passed) {
+			step_stats.passed_windows++;
+			failing_windows = 0;
+			if (on_trial) {
+				on_trial = false;
+				backoff = 1;
+				passing_windows = 0;
+				return false;
+			}
+			if (++passing_windows >= uint32_t(config.upgrade_windows) * backoff && current > 0) {
+				change_step(current - 1, true);
+				return true;
+			}
+			return false;
+		}
+
+		step_stats.failed_windows++;
+		passing_windows = 0;
+		if (on_trial || ++failing_windows >= config.degrade_windows) {
+			return step_down();
+		}
+		return false;
+	}
+
+	/**
+	 * @brief Should be called when the link is lost at the current step
+	 * A step on trial is abandoned, as the link is a likely casualty of the faster rate.
+	 * @return true if the step changed
+	 */
+	bool link_lost() {
+		if (!has_ladder() || !on_trial) return false;
+		return step_down();
+	}
+
+private:
+
+	Config config;
+	Step ladder[MAX_STEPS];
+	StepStats stats[MAX_STEPS];
+	int step_count = 0;
+
+	int current = 0;
+	bool on_trial = true;
+	bool trial_from_below = false;		// the current trial is an upgrade from the next slower step
+	uint32_t backoff = 1;				// multiplies the passing windows needed before trying a faster step
+	uint32_t step_changes = 0;
+
+	uint16_t window_count = 0;
+	uint16_t window_errors = 0;
+	uint32_t passing_windows = 0;
+	uint8_t failing_windows = 0;
+
+	void clear_window() {
+		window_count = 0;
+		window_errors = 0;
+	}
+
+	bool step_down() {
+		failing_windows = 0;
+		bool failed_upgrade = on_trial && trial_from_below;
+		if (failed_upgrade && backoff < MAX_BACKOFF) backoff *= 2;
+		if (current + 1 >= step_count) {
+			on_trial = false;		// nothing slower to try; keep going at the slowest step
+			return false;
+		}
+		// the step below passed before if this was an upgrade trial, so it needn't be on trial again
+		change_step(current + 1, !failed_upgrade);
+		return true;
+	}
+
+	void change_step(int next, bool trial) {
+		trial_from_below = next < current;
+		current = next;
+		on_trial = trial;
+		step_changes++;
+		clear_window();
+		passing_windows = 0;
+		failing_windows = 0;
+	}
+};
+
+#endif
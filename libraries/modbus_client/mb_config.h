@@ -25,9 +25,10 @@
 //#define WINDOWS
 //#define QT_WINDOWS
 //#define ATTINY1617
+//#define TRANSPORT_CLIENT	// generic host driver over a ByteTransport (tty, pty, TCP or in-memory)
 
 
-#if defined(CPU_MKV31F256VLH12) || defined(__MK20DX256__) || defined(ATMEGA328) || defined(IRIS_ZYNQ_7000) || defined(WINDOWS) || defined(QT_WINDOWS) || defined(ATTINY1617)
+#if defined(CPU_MKV31F256VLH12) || defined(__MK20DX256__) || defined(ATMEGA328) || defined(IRIS_ZYNQ_7000) || defined(WINDOWS) || defined(QT_WINDOWS) || defined(ATTINY1617) || defined(TRANSPORT_CLIENT)
 #else 
 #error Must uncomment one of the platform types in mb_config.h
 #endif
@@ -41,7 +42,7 @@
 //
 
 #define DEFAULT_INTERFRAME_uS	2000	//2000 
-#ifdef WINDOWS
+#if defined(WINDOWS) || defined(TRANSPORT_CLIENT)
 #define DEFAULT_INTERCHAR_uS	16000//8000 	//8000	// 700
 #else
 #define DEFAULT_INTERCHAR_uS	8000
@@ -63,6 +64,16 @@
 #else
 #define NUM_MESSAGES        64  //8  //4  //32  //64
 #endif
+// Keep each register's receive time, change order and staged write in the client's copy of the server's memory map, and
+// let applications subscribe to register changes. About 16 bytes per register rather than 2, so only hosts keep them.
+#ifndef REGISTER_TRACKING
+#if defined(WINDOWS) || defined(QT_WINDOWS) || defined(TRANSPORT_CLIENT)
+#define REGISTER_TRACKING	1
+#else
+#define REGISTER_TRACKING	0
+#endif
+#endif
+
 //uncomment one of the following baud rate options
 #define UART_BAUD_RATE      19200  //9600  //1000000  //625000  //500000   //Modbus specified default is 19200bps
 
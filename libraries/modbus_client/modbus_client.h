@@ -26,6 +26,9 @@
 #define MODBUS_CLIENT_H_
 
 #include "message_queue.h"
+#include "transmit_binder.h"
+#include "bus_tap.h"
+#include "modbus_trace.h"
 #ifdef __MK20DX256__
 #include <Arduino.h>
 #endif
@@ -165,12 +168,16 @@ public:
 				enable_interframe_delay();			// will allow run_out to send the next message once this expires (note this disables the current timer)
 				increment_diag_counter(return_server_no_response_count);
 				active_transaction->invalidate(Transaction::RESPONSE_TIMEOUT_ERROR);
+				if (bus_tap) bus_tap->on_bus_event(0, BusTap::RX | BusTap::FRAME_END | BusTap::RESPONSE_TIMEOUT, get_system_cycles());
+				active_transaction->stamp_finished(get_system_cycles());
 				active_transaction->mark_finished();
+				MB_TRACE(trace_track, finished, active_transaction->get_ID(), active_transaction->get_reception_validity());
 				break;
 
 			case TIMER_ID::interchar_timeout:
 
 				enable_interframe_delay();			// will allow run_out to send the next message once this expires (note this disables the current timer)
+				if (bus_tap) bus_tap->on_bus_event(0, BusTap::RX | BusTap::FRAME_END | BusTap::INTERCHAR_TIMEOUT, get_system_cycles());
 
 				// If the length was unknown assume this was the expected termination of the response until it is validated
 				if( !active_transaction->is_expected_length_known() ){
@@ -184,7 +191,9 @@ public:
 					my_state = ignoring;
 				}
 
+				active_transaction->stamp_finished(get_system_cycles());
 				active_transaction->mark_finished();
+				MB_TRACE(trace_track, finished, active_transaction->get_ID(), active_transaction->get_reception_validity());
 
 				break;
 
@@ -215,6 +224,13 @@ public:
     	if ( my_enabled_timer == TIMER_ID::none	||  has_timer_expired() == TIMER_ID::interframe_delay) {
     		disable_timer();
     		if ( messages.available_to_send() ) {
+                Transaction * active_transaction = messages.get_active_transaction();
+                uint32_t now = get_system_cycles();
+                active_transaction->stamp_sent(now);
+                MB_TRACE(trace_track, tx_start, active_transaction->get_ID(), 0);
+                if ( active_transaction->is_late_bound() && transmit_binder ) {
+                	transmit_binder->bind_transmission(active_transaction, now);	// refresh the payload with the latest setpoint
+                }
                 my_state = emission;
     			enable_response_timeout();
     			tx_enable();		// enabling the transmitter interrupts results in the send() function being called until the active message is fully sent to hardware
@@ -239,7 +255,10 @@ public:
      * @return 1 if succeeded in adding the message to the buffer, 0 if messages buffer was full
     */
     bool enqueue_transaction(Transaction message) {       
-        return messages.enqueue(message);
+        message.stamp_enqueued(get_system_cycles());
+        if (!messages.enqueue(message)) return false;
+        MB_TRACE(trace_track, enqueued, message.get_ID(), message.get_tx_function_code());
+        return true;
     }
 
     /**
@@ -301,6 +320,29 @@ public:
 	/// @brief Change the period of time observed between broadcast messages
 	void adjust_turnaround_delay	(u32 time_in_us) { 	turnaround_delay_cycles = my_cycle_per_us * time_in_us; };
 
+    /**
+     * @brief Set the object which rebuilds late bound transactions at the moment their transmission starts
+     * @param binder the binder, or 0 to send late bound transactions as they were enqueued
+     */
+    void set_transmit_binder(TransmitBinder* binder) {
+    	transmit_binder = binder;
+    }
+
+    /**
+     * @brief Set the object which is shown every byte sent and received, eg. a BusRecorder
+     * @param tap the tap, or 0 to stop observing
+     */
+    void set_bus_tap(BusTap* tap) {
+    	bus_tap = tap;
+    }
+
+    /**
+     * @brief The track this client's trace points are recorded on when MODBUS_TRACE is defined
+     */
+    uint16_t get_trace_track() {
+    	return trace_track;
+    }
+
     /**
      * @brief Get the device's current system time in cycles
     */
@@ -354,11 +396,18 @@ protected:
 		Transaction * active_transaction = messages.get_active_transaction();
 
 		//send the current data byte
+		bool frame_start = active_transaction->bytes_left_to_send() == active_transaction->get_tx_buffer_size();
 		uint8_t data = active_transaction->pop_tx_buffer();
 		send_byte(data);
 		increment_diag_counter(bytes_out_count);
 
+		if (bus_tap) {
+			bus_tap->on_bus_event(data, (frame_start ? BusTap::FRAME_START : 0) | (active_transaction->is_fully_sent() ? BusTap::FRAME_END : 0), get_system_cycles());
+		}
+
 		if ( active_transaction->is_fully_sent() ) {
+			active_transaction->stamp_tx_end(get_system_cycles());
+			MB_TRACE(trace_track, tx_end, active_transaction->get_ID(), 0);
 
 			if ( active_transaction->is_broadcast_message() ){ //is it a broadcast message?
 				enable_turnaround_delay();
@@ -384,12 +433,25 @@ protected:
 		active_transaction->load_reception(byte); //read the next byte from the receiver buffer. This clears the byte received interrupt    ??TODO: should we be loading here? it seems that in the overrun case we've already walked off the end of the array??
 		increment_diag_counter(bytes_in_count);
 
+		if (bus_tap) {
+			bus_tap->on_bus_event(byte, BusTap::RX | (active_transaction->get_rx_buffer_size() == 1 ? BusTap::FRAME_START : 0) | (active_transaction->is_fully_received() ? BusTap::FRAME_END : 0), get_system_cycles());
+		}
+
+		if (active_transaction->get_rx_buffer_size() == 1) {
+			active_transaction->stamp_rx_first(get_system_cycles());
+			MB_TRACE(trace_track, rx_first, active_transaction->get_ID(), 0);
+		}
+
 		// If this was the last character for this message
 		if (active_transaction->is_fully_received() )
 		{
+			active_transaction->stamp_rx_last(get_system_cycles());
+			MB_TRACE(trace_track, rx_last, active_transaction->get_ID(), 0);
 			enable_interframe_delay();// used to signal the earliest start time of the next message
 			validate_response(active_transaction);// might transition to resting from connected
+			active_transaction->stamp_finished(get_system_cycles());
 			active_transaction->mark_finished();
+			MB_TRACE(trace_track, finished, active_transaction->get_ID(), active_transaction->get_reception_validity());
 		}
 		else {
 			enable_interchar_timeout();
@@ -416,6 +478,10 @@ private:
 
 	u32 interframe_delay_cycles  = 0;
 
+	TransmitBinder* transmit_binder = 0;
+	BusTap* bus_tap = 0;
+	uint16_t trace_track = MB_TRACE_NEW_TRACK();
+
 	/// Time that the enabled timer was started
 
 
@@ -0,0 +1,296 @@
+/**
+ * @file modbus_trace.h
+ *
+ * @brief  Compile time removable trace points for the stages of each Modbus frame, with a Chrome trace exporter
+ *
+ * @version 2.2.0
+
+    @copyright Copyright 2022 Iris Dynamics Ltd
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+    For questions or feedback on this file, please email <support@irisdynamics.com>.
+ */
+
+#ifndef MODBUS_TRACE_H_
+#define MODBUS_TRACE_H_
+
+/*
+ * Define MODBUS_TRACE before including any library header to compile the trace points in.
+ * Without it every MB_TRACE macro expands to nothing.
+ */
+#ifdef MODBUS_TRACE
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <stdio.h>
+#include <vector>
+#include "transaction.h"
+
+#define MB_TRACE(track, point, frame, arg)	ModbusTrace::record(track, ModbusTrace::point, frame, arg)
+#define MB_TRACE_NEW_TRACK()				ModbusTrace::new_track()
+#define MB_TRACE_NAME_TRACK(track, name)	ModbusTrace::name_track(track, name)
+
+/**
+ * @class ModbusTrace
+ * @brief Collects timestamped trace points into one lock-free ring per thread and exports them as Chrome trace events.
+ *
+ * Each ModbusClient is a track (shown as a thread on the timeline). Trace points mark the moments in a frame's life;
+ * the exporter turns consecutive points of the same frame into spans:
+ *  enqueue (the application building the frame), queue wait (enqueued to transmission start), emission,
+ *  turnaround (end of request to first response byte), receive, validate, claim wait (finished to dequeued by the application) and decode.
+ *
+ * The resulting file loads in chrome://tracing or ui.perfetto.dev.
+ */
+class ModbusTrace {
+
+public:
+
+	enum TRACE_POINT {
+		enqueued,			// arg: function code
+		tx_start,
+		tx_end,
+		rx_first,
+		rx_last,
+		finished,			// arg: the transaction's reception validity, 0 for a valid response, otherwise a bit per Transaction::error_id
+		dequeued,
+		decoded,
+		enqueue_begin,		// the application started building a frame; frame is NO_FRAME since it has no ID yet
+	};
+
+	static const uint32_t NO_FRAME = 0xFFFFFFFF;
+	static const int MAX_THREADS = 32;
+	static const int MAX_TRACKS = 64;
+	static const uint32_t RING_SIZE = 16384;	// events per thread; must be a power of 2
+
+	/**
+	 * @brief Record a trace point from any thread. Lock-free; allocates only on the first call from each thread.
+	 */
+	static void record(uint16_t track, uint8_t point, uint32_t frame, uint8_t arg) {
+		Ring* ring = local_ring();
+		if (!ring) return;
+
+		uint32_t head = ring->write_index.load(std::memory_order_relaxed);
+		if (head - ring->read_index.load(std::memory_order_acquire) >= RING_SIZE) {
+			registry().dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		Event& event = ring->events[head & (RING_SIZE - 1)];
+		event.ns = now_ns();
+		event.frame = frame;
+		event.track = track;
+		event.point = point;
+		event.arg = arg;
+		ring->write_index.store(head + 1, std::memory_order_release);
+	}
+
+	/**
+	 * @brief Allocate a track number, eg. for a new ModbusClient
+	 */
+	static uint16_t new_track() {
+		return registry().next_track.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	/**
+	 * @brief Set the name shown for a track. The string must outlive the trace.
+	 */
+	static void name_track(uint16_t track, const char* name) {
+		if (track < MAX_TRACKS) registry().track_names[track].store(name, std::memory_order_release);
+	}
+
+	/// @brief Number of trace points lost because a ring was full
+	static uint32_t get_dropped_count() {
+		return registry().dropped.load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * @brief Drain every ring and write the trace points recorded since the last call to a Chrome trace event JSON file.
+	 * Should only be called from one thread at a time.
+	 * @return false if the file couldn't be written
+	 */
+	static bool write_chrome_trace(const char* path) {
+
+		std::vector<Event> events;
+		Registry& reg = registry();
+		int num_rings = std::min(reg.ring_count.load(std::memory_order_acquire), MAX_THREADS);
+		for (int i = 0; i < num_rings; i++) {
+			Ring* ring = reg.rings[i].load(std::memory_order_acquire);
+			if (!ring) continue;
+			uint32_t tail = ring->read_index.load(std::memory_order_relaxed);
+			uint32_t head = ring->write_index.load(std::memory_order_acquire);
+			for (; tail != head; tail++) events.push_back(ring->events[tail & (RING_SIZE - 1)]);
+			ring->read_index.store(tail, std::memory_order_release);
+		}
+		std::stable_sort(events.begin(), events.end(), [](const Event& a, const Event& b) { return a.ns < b.ns; });
+
+		FILE* file = fopen(path, "w");
+		if (!file) return false;
+
+		fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+		bool first = true;
+		for (int track = 0; track < MAX_TRACKS && track < reg.next_track.load(); track++) {
+			const char* name = reg.track_names[track].load(std::memory_order_acquire);
+			separator(file, first);
+			fprintf(file, "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}", track, name ? name : "modbus client");
+		}
+
+		uint64_t origin = events.empty() ? 0 : events.front().ns;
+		std::map<uint64_t, Event> last_point;		// the previous point of each frame
+		std::map<uint16_t, Event> enqueue_start;	// an enqueue_begin on each track not yet followed by an enqueued
+		for (size_t i = 0; i < events.size(); i++) {
+			Event& event = events[i];
+
+			if (event.point == enqueue_begin) {
+				enqueue_start[event.track] = event;
+				continue;
+			}
+			if (event.point == enqueued) {
+				std::map<uint16_t, Event>::iterator start = enqueue_start.find(event.track);
+				if (start != enqueue_start.end()) {
+					write_span(file, first, start->second, event, origin);
+					enqueue_start.erase(start);
+				}
+			}
+
+			uint64_t key = (uint64_t(event.track) << 32) | event.frame;
+			std::map<uint64_t, Event>::iterator previous = last_point.find(key);
+			if (previous != last_point.end()) {
+				write_span(file, first, previous->second, event, origin);
+			}
+			if (event.point == decoded) {
+				if (previous != last_point.end()) last_point.erase(previous);
+			}
+			else {
+				last_point[key] = event;
+			}
+		}
+		fprintf(file, "\n]}\n");
+		fclose(file);
+		return true;
+	}
+
+private:
+
+	struct Event {
+		uint64_t ns;
+		uint32_t frame;
+		uint16_t track;
+		uint8_t point;
+		uint8_t arg;
+	};
+
+	struct Ring {
+		Event events[RING_SIZE];
+		std::atomic<uint32_t> write_index{ 0 };
+		std::atomic<uint32_t> read_index{ 0 };
+	};
+
+	struct Registry {
+		std::atomic<Ring*> rings[MAX_THREADS];
+		std::atomic<int> ring_count{ 0 };
+		std::atomic<uint16_t> next_track{ 0 };
+		std::atomic<const char*> track_names[MAX_TRACKS];
+		std::atomic<uint32_t> dropped{ 0 };
+
+		Registry() {
+			for (int i = 0; i < MAX_THREADS; i++) rings[i].store(0);
+			for (int i = 0; i < MAX_TRACKS; i++) track_names[i].store(0);
+		}
+	};
+
+	static Registry& registry() {
+		static Registry reg;
+		return reg;
+	}
+
+	/**
+	 * @brief The calling thread's ring, created on first use. Rings are never freed so the exporter can always read them.
+	 */
+	static Ring* local_ring() {
+		thread_local Ring* ring = claim_ring();
+		return ring;
+	}
+
+	static Ring* claim_ring() {
+		Registry& reg = registry();
+		int index = reg.ring_count.fetch_add(1, std::memory_order_relaxed);
+		if (index >= MAX_THREADS) return 0;
+		Ring* ring = new Ring();
+		reg.rings[index].store(ring, std::memory_order_release);
+		return ring;
+	}
+
+	static uint64_t now_ns() {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	static void separator(FILE* file, bool& first) {
+		if (!first) fprintf(file, ",\n");
+		first = false;
+	}
+
+	/**
+	 * @brief Write the span between two consecutive points of a frame. Spans which may overlap the next frame are written as async events.
+	 */
+	static void write_span(FILE* file, bool& first, const Event& from, const Event& to, uint64_t origin) {
+		const char* name = 0;
+		bool async = false;
+		switch (to.point) {
+		case tx_start:		name = "queue wait"; async = true; break;
+		case tx_end:		name = "emission"; break;
+		case rx_first:		name = "turnaround"; break;
+		case rx_last:		name = "receive"; break;
+		case finished:
+			if (to.arg & (1 << Transaction::RESPONSE_TIMEOUT_ERROR))		name = "response timeout";
+			else if (to.arg & (1 << Transaction::INTERCHAR_TIMEOUT_ERROR))	name = "interchar timeout";
+			else if (to.arg & (1 << Transaction::CRC_ERROR))				name = "CRC error";
+			else if (to.arg & (1 << Transaction::UNEXPECTED_RESPONDER))		name = "unexpected responder";
+			else if (from.point == rx_last)									name = "validate";
+			else															name = "receive";		// length unknown, ended by the interchar timeout
+			break;
+		case dequeued:		name = "claim wait"; async = true; break;
+		case enqueued:		name = "enqueue"; break;
+		case decoded:		name = "decode"; break;
+		default:			return;
+		}
+
+		double start_us = (from.ns - origin) / 1000.0;
+		double duration_us = (to.ns - from.ns) / 1000.0;
+		separator(file, first);
+		if (async) {
+			fprintf(file, "{\"ph\":\"b\",\"cat\":\"frame\",\"name\":\"%s\",\"id\":%u,\"pid\":1,\"tid\":%u,\"ts\":%.3f},\n",
+				name, (unsigned)from.frame, (unsigned)from.track, start_us);
+			fprintf(file, "{\"ph\":\"e\",\"cat\":\"frame\",\"name\":\"%s\",\"id\":%u,\"pid\":1,\"tid\":%u,\"ts\":%.3f}",
+				name, (unsigned)from.frame, (unsigned)from.track, start_us + duration_us);
+		}
+		else if (from.frame == NO_FRAME) {
+			fprintf(file, "{\"ph\":\"X\",\"cat\":\"app\",\"name\":\"%s\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"frame\":%u}}",
+				name, (unsigned)from.track, start_us, duration_us, (unsigned)to.frame);
+		}
+		else {
+			fprintf(file, "{\"ph\":\"X\",\"cat\":\"frame\",\"name\":\"%s\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"frame\":%u}}",
+				name, (unsigned)from.track, start_us, duration_us, (unsigned)from.frame);
+		}
+	}
+};
+
+#else
+
+#define MB_TRACE(track, point, frame, arg)	((void)0)
+#define MB_TRACE_NEW_TRACK()				0
+#define MB_TRACE_NAME_TRACK(track, name)	((void)0)
+
+#endif
+
+#endif
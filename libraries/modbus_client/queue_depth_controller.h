@@ -0,0 +1,322 @@
+/**
+ * @file queue_depth_controller.h
+ *
+ * @brief  Runtime selection of the number of stream frames allowed in flight on a ModbusClient queue
+ *
+ * @version 2.2.0
+
+    @copyright Copyright 2022 Iris Dynamics Ltd
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+    For questions or feedback on this file, please email <support@irisdynamics.com>.
+ */
+
+#ifndef QUEUE_DEPTH_CONTROLLER_H_
+#define QUEUE_DEPTH_CONTROLLER_H_
+
+#include "transaction.h"
+#include "mb_config.h"
+
+/**
+ * @class QueueDepthController
+ * @brief Chooses how many stream frames an application may keep on the message queue at once.
+ *
+ * A shallow queue leaves the bus idle while the host loop comes around to enqueue the next frame.
+ * A deep queue keeps the bus busy, but every waiting frame carries a command that ages while it waits.
+ * Which one is cheaper depends on the host loop period, the adapter latency and the baud rate, so it is measured rather than fixed.
+ *
+ * The controller is fed the host loop ticks and every completed stream transaction. Over each evaluation window it measures
+ *  - the round trip time of frames (start of transmission until the response is received or abandoned),
+ *  - the idle time on the bus between frames beyond the smallest gap observed since reset (ie the unavoidable interframe delay),
+ *  - the age of the commands carried by frames; the time they waited in the queue, or for late bound frames the age of their setpoint when sent,
+ *  - the host loop period.
+ * It then scores the current depth with
+ *      cost = (1 - age_weight) * idle_fraction + age_weight * (command_age / frame_period)
+ * and occasionally probes the neighbouring depths to compare their cost. No probing is done when the host loop
+ * is slower than a frame, since the queue can never fill in that case; the depth is walked down instead.
+ */
+class QueueDepthController {
+
+public:
+
+	/**
+	 * @brief Tuning parameters for the controller
+	 */
+	struct Config {
+		uint8_t  min_depth         = 1;		//!< smallest number of frames allowed on the queue
+		uint8_t  max_depth         = 4;		//!< largest number of frames allowed on the queue
+		float    age_weight        = 0.5;	//!< 0 favours bus utilisation only, 1 favours command freshness only
+		uint16_t window_frames     = 64;	//!< number of completed frames in each evaluation window
+		uint16_t probe_interval    = 16;	//!< number of windows between probes of a neighbouring depth
+		float    filter_alpha      = 0.2;	//!< weight of the newest window in the filtered cost of each depth
+	};
+
+	/**
+	 * @param cycles_per_us client system cycles per microsecond
+	 * @param initial_depth depth used until the first evaluation window completes
+	 */
+	QueueDepthController(uint32_t cycles_per_us, uint8_t initial_depth = 2) :
+		my_cycles_per_us(cycles_per_us),
+		depth(initial_depth),
+		home_depth(initial_depth)
+	{
+		reset();
+	}
+
+	/**
+	 * @brief Apply a new configuration. The current depth is clamped to the new limits.
+	 */
+	void set_config(Config _config) {
+		if (_config.min_depth < 1) _config.min_depth = 1;
+		if (_config.max_depth > MAX_QUEUE_DEPTH) _config.max_depth = MAX_QUEUE_DEPTH;
+		if (_config.max_depth < _config.min_depth) _config.max_depth = _config.min_depth;
+		if (_config.window_frames < 1) _config.window_frames = 1;
+		config = _config;
+		depth = clamp(depth);
+		home_depth = depth;
+		reset();
+	}
+
+	Config get_config() { return config; }
+
+	/**
+	 * @brief When disabled, the depth stays at the given value
+	 */
+	void set_adaptive(bool enable, uint8_t fixed_depth = 2) {
+		adaptive = enable;
+		if (!adaptive) {
+			depth = clamp(fixed_depth);
+			home_depth = depth;
+			probing = false;
+		}
+	}
+
+	bool is_adaptive() { return adaptive; }
+
+	/**
+	 * @brief Forget all measurements. Should be called when the link is renegotiated.
+	 */
+	void reset() {
+		for (int i = 0; i <= MAX_QUEUE_DEPTH; i++) {
+			cost[i] = 0;
+			cost_known[i] = false;
+		}
+		probing = false;
+		windows_since_probe = 0;
+		have_last_finish = false;
+		have_last_tick = false;
+		loop_period_cycles = 0;
+		min_gap_cycles = UINT32_MAX;
+		start_window(0);
+	}
+
+	/**
+	 * @brief Number of frames that may be on the message queue before another stream frame is held back
+	 */
+	uint8_t get_depth() { return depth; }
+
+	/**
+	 * @brief true when another stream frame may be enqueued on a queue holding queue_size transactions
+	 */
+	bool may_enqueue(uint32_t queue_size) { return queue_size < depth; }
+
+	/**
+	 * @brief Should be called once per host loop iteration (ie each time the application run_out() is called)
+	 */
+	void loop_tick(uint32_t now_cycles) {
+		if (have_last_tick) {
+			uint32_t period = now_cycles - last_tick_cycles;
+			// lightly filtered so a single slow iteration doesn't dominate
+			loop_period_cycles = loop_period_cycles ? (loop_period_cycles * 7 + period) / 8 : period;
+		}
+		last_tick_cycles = now_cycles;
+		have_last_tick = true;
+	}
+
+	/**
+	 * @brief Should be called with each stream transaction claimed from the queue, valid or not
+	 * @param transaction the dequeued transaction. Its enqueued, sent and finished stamps must be populated.
+	 * The command age of a late bound transaction is the age of the setpoint it carried when sent, otherwise it is the time spent waiting in the queue.
+	 */
+	void frame_completed(Transaction* transaction) {
+
+		uint32_t sent = transaction->get_sent_cycles();
+		uint32_t finished = transaction->get_finished_cycles();
+
+		if (!have_last_finish) {
+			window_start_cycles = sent;		// first frame since a reset
+		}
+		else {
+			uint32_t gap = sent - last_finish_cycles;
+			if ((int32_t)gap < 0) gap = 0;		// overlapping stamps, eg. after a queue reset
+			window_gap_cycles += gap;
+			window_gaps++;
+			if (gap < min_gap_cycles) min_gap_cycles = gap;
+		}
+		last_finish_cycles = finished;
+		have_last_finish = true;
+
+		window_rtt_cycles += transaction->get_round_trip_cycles();
+		window_age_cycles += transaction->is_late_bound() ? transaction->get_setpoint_age_cycles() : transaction->get_queue_wait_cycles();
+		window_frames++;
+
+		if (window_frames >= config.window_frames) {
+			end_window(finished);
+		}
+	}
+
+/////////////////////////////////////////////////////////////
+///////////////////////////////////////////// Reporting ////
+///////////////////////////////////////////////////////////
+
+	/// @brief Stream frames completed per second over the last evaluation window
+	float get_frame_rate_hz() { return frame_rate_hz; }
+
+	/// @brief Average age of the commands carried by stream frames over the last evaluation window, in microseconds
+	uint32_t get_command_age_us() { return command_age_us; }
+
+	/// @brief Average round trip time over the last evaluation window, in microseconds
+	uint32_t get_round_trip_us() { return round_trip_us; }
+
+	/// @brief Filtered host loop period, in microseconds
+	uint32_t get_loop_period_us() { return loop_period_cycles / my_cycles_per_us; }
+
+	/// @brief Fraction of the last evaluation window the bus spent idle beyond the minimum gap between frames
+	float get_idle_fraction() { return idle_fraction; }
+
+	/// @brief Number of times the depth has changed
+	uint32_t get_depth_changes() { return depth_changes; }
+
+private:
+
+	static const int MAX_QUEUE_DEPTH = (NUM_MESSAGES - 1) < 8 ? (NUM_MESSAGES - 1) : 8;
+
+	Config config;
+	const uint32_t my_cycles_per_us;
+
+	bool adaptive = true;
+	uint8_t depth;
+	uint8_t home_depth;			// depth to return to after a probe
+	bool probing = false;
+	uint16_t windows_since_probe = 0;
+	bool probe_up_next = true;
+
+	float cost[MAX_QUEUE_DEPTH + 1];
+	bool cost_known[MAX_QUEUE_DEPTH + 1];
+
+	// host loop
+	bool have_last_tick = false;
+	uint32_t last_tick_cycles = 0;
+	uint32_t loop_period_cycles = 0;
+
+	// current window
+	bool have_last_finish = false;
+	uint32_t last_finish_cycles = 0;
+	uint32_t window_start_cycles = 0;
+	uint32_t window_frames = 0;
+	uint32_t window_gaps = 0;
+	uint64_t window_gap_cycles = 0;
+	uint32_t min_gap_cycles = UINT32_MAX;	// smallest gap seen since reset, taken as the unavoidable part of each gap
+	uint64_t window_rtt_cycles = 0;
+	uint64_t window_age_cycles = 0;
+
+	// last window results
+	float frame_rate_hz = 0;
+	uint32_t command_age_us = 0;
+	uint32_t round_trip_us = 0;
+	float idle_fraction = 0;
+	uint32_t depth_changes = 0;
+
+	uint8_t clamp(int d) {
+		if (d < config.min_depth) return config.min_depth;
+		if (d > config.max_depth) return config.max_depth;
+		return (uint8_t)d;
+	}
+
+	void start_window(uint32_t now_cycles) {
+		window_start_cycles = now_cycles;
+		window_frames = 0;
+		window_gaps = 0;
+		window_gap_cycles = 0;
+		window_rtt_cycles = 0;
+		window_age_cycles = 0;
+	}
+
+	void end_window(uint32_t now_cycles) {
+
+		uint32_t elapsed = now_cycles - window_start_cycles;
+		if (elapsed == 0) elapsed = 1;
+
+		float frame_period = (float)elapsed / window_frames;
+		uint32_t min_gap = (min_gap_cycles == UINT32_MAX) ? 0 : min_gap_cycles;
+		uint64_t excess_gap = window_gap_cycles - (uint64_t)min_gap * window_gaps;
+		float age = (float)window_age_cycles / window_frames;
+
+		frame_rate_hz  = 1000000.f * my_cycles_per_us / frame_period;
+		command_age_us = (uint32_t)(age / my_cycles_per_us);
+		round_trip_us  = (uint32_t)(window_rtt_cycles / window_frames / my_cycles_per_us);
+		idle_fraction  = (float)excess_gap / elapsed;
+		if (idle_fraction > 1) idle_fraction = 1;
+
+		float window_cost = (1 - config.age_weight) * idle_fraction + config.age_weight * (age / frame_period);
+
+		if (cost_known[depth]) cost[depth] += config.filter_alpha * (window_cost - cost[depth]);
+		else                   cost[depth] = window_cost;
+		cost_known[depth] = true;
+
+		if (adaptive) choose_depth(frame_period);
+
+		start_window(now_cycles);
+	}
+
+	/**
+	 * @brief After a probe window, settle on the cheaper of the probed and home depths.
+	 * Otherwise stay at the cheapest known neighbour, probing an unknown or stale neighbour every probe_interval windows.
+	 */
+	void choose_depth(float frame_period) {
+
+		uint8_t next = depth;
+
+		if (probing) {
+			probing = false;
+			next = (cost[depth] < cost[home_depth]) ? depth : home_depth;
+		}
+		else {
+			// A host loop slower than a frame can never fill the queue; a deeper queue can only add age
+			bool host_limited = loop_period_cycles > frame_period;
+
+			if (host_limited && depth > config.min_depth) {
+				next = depth - 1;
+			}
+			else if (!host_limited && ++windows_since_probe >= config.probe_interval) {
+				windows_since_probe = 0;
+				int candidate = probe_up_next ? depth + 1 : depth - 1;
+				if (clamp(candidate) == depth) candidate = probe_up_next ? depth - 1 : depth + 1;
+				probe_up_next = !probe_up_next;
+				if (clamp(candidate) != depth) {
+					home_depth = depth;
+					probing = true;
+					next = clamp(candidate);
+				}
+			}
+		}
+
+		if (next != depth) {
+			depth = next;
+			depth_changes++;
+		}
+		if (!probing) home_depth = depth;
+	}
+};
+
+#endif
@@ -0,0 +1,115 @@
+/**
+ * @file recovery_stats.h
+ *
+ * @brief  Distribution of the time taken to recover a connection after the link to a server is lost
+ *
+ * @version 2.2.0
+
+    @copyright Copyright 2022 Iris Dynamics Ltd
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+    For questions or feedback on this file, please email <support@irisdynamics.com>.
+ */
+
+#ifndef RECOVERY_STATS_H_
+#define RECOVERY_STATS_H_
+
+#include <stdint.h>
+
+/**
+ * @class RecoveryStats
+ * @brief Counts recoveries by how they completed and keeps a power of two histogram of their durations.
+ *
+ * A recovery is either a fast resume, where the server still answered at the negotiated baud rate, or a full handshake.
+ * Bucket 0 holds recoveries shorter than 2 microseconds, and bucket i holds those from 2^i up to 2^(i+1) microseconds;
+ * the last bucket also holds anything longer.
+ */
+class RecoveryStats {
+
+public:
+
+	enum Path {
+		fast_resume = 0,
+		full_handshake = 1
+	};
+
+	static const int BUCKETS = 24;		// the last bucket starts at about 8 seconds
+
+	/**
+	 * @brief Add a completed recovery
+	 */
+	void record(Path path, uint32_t duration_us) {
+		int bucket = 0;
+		while (bucket < BUCKETS - 1 && (duration_us >> (bucket + 1))) bucket++;
+		histogram[path][bucket]++;
+		count[path]++;
+		total_us[path] += duration_us;
+		if (count[path] == 1 || duration_us < min_us[path]) min_us[path] = duration_us;
+		if (duration_us > max_us[path]) max_us[path] = duration_us;
+	}
+
+	/**
+	 * @brief Count a fast resume which failed and fell back to the full handshake
+	 */
+	void record_fallback() { fallbacks++; }
+
+	uint32_t get_count(Path path) const { return count[path]; }
+	uint32_t get_fallback_count() const { return fallbacks; }
+	uint32_t get_min_us(Path path) const { return min_us[path]; }
+	uint32_t get_max_us(Path path) const { return max_us[path]; }
+	uint32_t get_mean_us(Path path) const { return count[path] ? uint32_t(total_us[path] / count[path]) : 0; }
+
+	/// @brief recoveries in a histogram bucket
+	uint32_t get_bucket_count(Path path, int bucket) const { return bucket >= 0 && bucket < BUCKETS ? histogram[path][bucket] : 0; }
+
+	/// @brief shortest duration held by a histogram bucket
+	static uint32_t get_bucket_start_us(int bucket) { return bucket <= 0 ? 0 : uint32_t(1) << bucket; }
+
+	/**
+	 * @brief Upper bound of the shortest duration which the given fraction of recoveries took no longer than, eg. 0.99
+	 * @return the end of the bucket holding that recovery, or 0 if there are none
+	 */
+	uint32_t get_percentile_us(Path path, float fraction) const {
+		if (!count[path]) return 0;
+		uint32_t target = uint32_t(fraction * count[path] + 0.5f);
+		if (target < 1) target = 1;
+		uint32_t seen = 0;
+		for (int i = 0; i < BUCKETS - 1; i++) {
+			seen += histogram[path][i];
+			if (seen >= target) return uint32_t(1) << (i + 1);
+		}
+		return max_us[path];
+	}
+
+	void reset() {
+		for (int p = 0; p < 2; p++) {
+			for (int i = 0; i < BUCKETS; i++) histogram[p][i] = 0;
+			count[p] = 0;
+			total_us[p] = 0;
+			min_us[p] = 0;
+			max_us[p] = 0;
+		}
+		fallbacks = 0;
+	}
+
+private:
+
+	uint32_t histogram[2][BUCKETS] = {};
+	uint32_t count[2] = {};
+	uint64_t total_us[2] = {};
+	uint32_t min_us[2] = {};
+	uint32_t max_us[2] = {};
+	uint32_t fallbacks = 0;
+};
+
+#endif
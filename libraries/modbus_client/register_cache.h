@@ -0,0 +1,308 @@
+/**
+ * @file register_cache.h
+ *
+ * @brief  Local copy of a server's holding registers which knows when and in what order each register last changed
+ *
+ * @version 2.2.0
+
+    @copyright Copyright 2022 Iris Dynamics Ltd
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+    For questions or feedback on this file, please email <support@irisdynamics.com>.
+ */
+
+#ifndef REGISTER_CACHE_H_
+#define REGISTER_CACHE_H_
+
+#include <stdint.h>
+
+/**
+ * @class RegisterCache
+ * @brief Holding register values as last received from the server, with per register freshness and locally staged writes.
+ *
+ * Each register keeps
+ *  - its value,
+ *  - the client system time it was last received, whether or not the value changed,
+ *  - the sequence number of its last change. The cache's sequence counts up by one every time a received value
+ *    differs from the cached one (or the register is received for the first time); 0 means never received,
+ *  - a dirty bit and a staged value for a write the application wants sent on the next flush.
+ *
+ * Registers are also kept in a list ordered by sequence number, so that a change only moves one entry to the end of the list.
+ * Receiving a register is constant time, and finding the registers changed since a sequence number only visits those registers.
+ * Staged values are kept apart from received values; a register reads as its received value until the server confirms a write.
+ *
+ * This bookkeeping takes about 16 bytes per register rather than the value's 2. RegisterCache<SIZE, false> keeps only
+ * the values and whether each has been received, for clients short of memory; see REGISTER_TRACKING in mb_config.h.
+ *
+ * @tparam SIZE number of registers in the server's memory map
+ * @tparam TRACKING keep receive times, change order and staged writes
+ */
+template <uint16_t SIZE, bool TRACKING = true>
+class RegisterCache {
+
+public:
+
+	static const uint16_t NONE = 0xFFFF;
+
+	/**
+	 * @param _cycles_per_us client system cycles per microsecond
+	 */
+	RegisterCache(uint32_t _cycles_per_us) :
+		cycles_per_us(_cycles_per_us)
+	{
+		clear();
+	}
+
+	/**
+	 * @brief Forget all values, times, sequence numbers and staged writes
+	 */
+	void clear() {
+		for (int i = 0; i < SIZE; i++) {
+			values[i] = 0;
+			updated_cycles[i] = 0;
+			sequences[i] = 0;
+			staged[i] = 0;
+			older[i] = NONE;
+			newer[i] = NONE;
+		}
+		for (int i = 0; i < DIRTY_WORDS; i++) dirty[i] = 0;
+		oldest = NONE;
+		newest = NONE;
+		sequence = 0;
+		dirty_count = 0;
+	}
+
+	/**
+	 * @brief Record a value received from the server. Addresses outside the map are ignored.
+	 * @param cycles client system time the value was received
+	 */
+	void set(uint16_t address, uint16_t value, uint32_t cycles) {
+		if (address >= SIZE) return;
+		updated_cycles[address] = cycles;
+		if (sequences[address] && values[address] == value) return;
+
+		values[address] = value;
+		sequences[address] = ++sequence;
+
+		// move to the newest end of the change list
+		if (newest == address) return;
+		unlink(address);
+		older[address] = newest;
+		newer[address] = NONE;
+		if (newest != NONE) newer[newest] = address;
+		newest = address;
+		if (oldest == NONE) oldest = address;
+	}
+
+	/**
+	 * @brief Record a value known from elsewhere than a response, eg. a saved image of the server's registers.
+	 * It counts as a change like a received value, but the register keeps the time it was last received, so it doesn't
+	 * look fresh.
+	 */
+	void restore(uint16_t address, uint16_t value) {
+		if (address < SIZE) set(address, value, updated_cycles[address]);
+	}
+
+	/// @brief the last value received for the register, or 0 if none has been
+	uint16_t get(uint16_t address) const { return address < SIZE ? values[address] : 0; }
+	uint16_t operator[](uint16_t address) const { return get(address); }
+
+	/// @brief true once a value has been received for the register
+	bool has_value(uint16_t address) const { return address < SIZE && sequences[address] != 0; }
+
+	/// @brief client system time the register was last received
+	uint32_t get_updated_cycles(uint16_t address) const { return address < SIZE ? updated_cycles[address] : 0; }
+
+	/// @brief sequence number of the register's last change, or 0 if it has never been received
+	uint32_t get_sequence(uint16_t address) const { return address < SIZE ? sequences[address] : 0; }
+
+	/// @brief sequence number of the most recent change to any register
+	uint32_t get_sequence() const { return sequence; }
+
+	/// @brief time since the register was last received
+	uint32_t get_age_us(uint16_t address, uint32_t now_cycles) const {
+		return (now_cycles - get_updated_cycles(address)) / cycles_per_us;
+	}
+
+	/**
+	 * @brief A register is stale if it has never been received or was last received more than max_age_us ago
+	 */
+	bool is_stale(uint16_t address, uint32_t max_age_us, uint32_t now_cycles) const {
+		return !has_value(address) || get_age_us(address, now_cycles) > max_age_us;
+	}
+
+	/**
+	 * @brief Find the registers which changed after the given sequence number, newest first
+	 * @param since a sequence number from get_sequence(); 0 finds every register received so far
+	 * @param addresses filled with up to max_count register addresses
+	 * @return the number of addresses written
+	 */
+	int get_changed_since(uint32_t since, uint16_t* addresses, int max_count) const {
+		int count = 0;
+		for (uint16_t address = newest; address != NONE && count < max_count; address = older[address]) {
+			if (sequences[address] <= since) break;
+			addresses[count++] = address;
+		}
+		return count;
+	}
+
+	/**
+	 * @brief Stage a value to be written to the server by the next flush. Staging a register again replaces the staged value.
+	 */
+	void stage(uint16_t address, uint16_t value) {
+		if (address >= SIZE) return;
+		staged[address] = value;
+		if (!is_dirty(address)) {
+			dirty[address / 32] |= 1UL << (address % 32);
+			dirty_count++;
+		}
+	}
+
+	/// @brief true if the register has a staged value which has not been flushed
+	bool is_dirty(uint16_t address) const { return address < SIZE && (dirty[address / 32] >> (address % 32)) & 1; }
+
+	/// @brief the value staged for the register
+	uint16_t get_staged(uint16_t address) const { return address < SIZE ? staged[address] : 0; }
+
+	/// @brief number of registers with staged values
+	int get_dirty_count() const { return dirty_count; }
+
+	/**
+	 * @brief Find the next run of consecutive dirty registers, for writing in a single request
+	 * @param start lowest address to consider
+	 * @param max_length longest run to return
+	 * @param run_start set to the first address of the run
+	 * @return the length of the run, or 0 if there are no dirty registers at or above start
+	 */
+	uint16_t next_dirty_run(uint16_t start, uint16_t max_length, uint16_t& run_start) const {
+		uint16_t address = start;
+		// skip clean registers a word at a time
+		while (address < SIZE && !is_dirty(address)) {
+			if (address % 32 == 0 && dirty[address / 32] == 0) address += 32;
+			else address++;
+		}
+		if (address >= SIZE) return 0;
+
+		run_start = address;
+		uint16_t length = 0;
+		while (address < SIZE && length < max_length && is_dirty(address)) {
+			address++;
+			length++;
+		}
+		return length;
+	}
+
+	/**
+	 * @brief Clear the dirty bits of a run once it has been handed to the client for writing
+	 */
+	void clear_dirty(uint16_t run_start, uint16_t length) {
+		for (uint16_t address = run_start; address < SIZE && address < run_start + length; address++) {
+			if (is_dirty(address)) {
+				dirty[address / 32] &= ~(1UL << (address % 32));
+				dirty_count--;
+			}
+		}
+	}
+
+private:
+
+	static const int DIRTY_WORDS = (SIZE + 31) / 32;
+
+	const uint32_t cycles_per_us;
+
+	uint16_t values[SIZE];
+	uint32_t updated_cycles[SIZE];
+	uint32_t sequences[SIZE];
+	uint16_t staged[SIZE];
+	uint32_t dirty[DIRTY_WORDS];
+	int dirty_count;
+
+	// doubly linked list of received registers from the least to the most recently changed
+	uint16_t older[SIZE];
+	uint16_t newer[SIZE];
+	uint16_t oldest;
+	uint16_t newest;
+	uint32_t sequence;
+
+	void unlink(uint16_t address) {
+		if (older[address] != NONE) newer[older[address]] = newer[address];
+		else if (oldest == address) oldest = newer[address];
+		if (newer[address] != NONE) older[newer[address]] = older[address];
+		else if (newest == address) newest = older[address];
+		older[address] = NONE;
+		newer[address] = NONE;
+	}
+};
+
+/**
+ * @class RegisterCache<SIZE, false>
+ * @brief Holding register values as last received from the server, and whether each has been received, without the
+ * receive times, change order or staged writes of the tracking cache.
+ *
+ * get_sequence() still counts changes, so a caller can tell whether a response changed anything.
+ */
+template <uint16_t SIZE>
+class RegisterCache<SIZE, false> {
+
+public:
+
+	RegisterCache(uint32_t) {
+		clear();
+	}
+
+	/**
+	 * @brief Forget all values
+	 */
+	void clear() {
+		for (int i = 0; i < SIZE; i++) values[i] = 0;
+		for (int i = 0; i < RECEIVED_WORDS; i++) received[i] = 0;
+		sequence = 0;
+	}
+
+	/**
+	 * @brief Record a value received from the server. Addresses outside the map are ignored.
+	 * @param cycles not kept
+	 */
+	void set(uint16_t address, uint16_t value, uint32_t cycles) {
+		if (address >= SIZE) return;
+		if (has_value(address) && values[address] == value) return;
+		values[address] = value;
+		received[address / 32] |= 1UL << (address % 32);
+		sequence++;
+	}
+
+	/// @brief Record a value known from elsewhere than a response, eg. a saved image of the server's registers
+	void restore(uint16_t address, uint16_t value) {
+		set(address, value, 0);
+	}
+
+	/// @brief the last value received for the register, or 0 if none has been
+	uint16_t get(uint16_t address) const { return address < SIZE ? values[address] : 0; }
+	uint16_t operator[](uint16_t address) const { return get(address); }
+
+	/// @brief true once a value has been received for the register
+	bool has_value(uint16_t address) const { return address < SIZE && (received[address / 32] >> (address % 32)) & 1; }
+
+	/// @brief number of changes to any register
+	uint32_t get_sequence() const { return sequence; }
+
+private:
+
+	static const int RECEIVED_WORDS = (SIZE + 31) / 32;
+
+	uint16_t values[SIZE];
+	uint32_t received[RECEIVED_WORDS];
+	uint32_t sequence;
+};
+
+#endif
@@ -0,0 +1,157 @@
+/**
+ * @file register_image_file.h
+ *
+ * @brief  Stores register images as small checksummed binary files, one per server identity
+ *
+ * @version 2.2.0
+
+    @copyright Copyright 2022 Iris Dynamics Ltd
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+    For questions or feedback on this file, please email <support@irisdynamics.com>.
+ */
+
+#ifndef REGISTER_IMAGE_FILE_H_
+#define REGISTER_IMAGE_FILE_H_
+
+#include <stdio.h>
+#include <string.h>
+#include "register_image_store.h"
+#include "mb_crc.h"
+
+/**
+ * Image file layout, all values little endian:
+ *  header (16 bytes): "IRMM", u16 version, u16 range count, u64 identity
+ *  ranges (4 bytes each): u16 start, u16 count
+ *  values (2 bytes each): u16, for every register of every range in order
+ *  trailer (2 bytes): Modbus CRC of everything before it
+ */
+#define REGISTER_IMAGE_MAGIC		"IRMM"
+#define REGISTER_IMAGE_VERSION		1
+#define REGISTER_IMAGE_HEADER_SIZE	16
+
+/**
+ * @class RegisterImageFileStore
+ * @brief A RegisterImageStore keeping each identity's image in <directory>/<identity as 16 hex digits>.irmm
+ *
+ * Files are written under a temporary name and renamed, so a crash while saving leaves the previous image or none.
+ */
+class RegisterImageFileStore : public RegisterImageStore {
+
+public:
+
+	static const int MAX_REGISTERS = 1024;		// registers in an image, over all of its ranges
+	static const int MAX_RANGES = 32;
+
+	/**
+	 * @param _directory existing directory for the image files, without a trailing separator; "." for the working directory
+	 */
+	RegisterImageFileStore(const char* _directory) {
+		strncpy(directory, _directory, sizeof(directory) - 1);
+		directory[sizeof(directory) - 1] = 0;
+	}
+
+	bool load(uint64_t identity, const RegisterRange* ranges, int range_count, uint16_t* values) override {
+		int register_count = count_registers(ranges, range_count);
+		if (register_count < 0) return false;
+
+		char path[PATH_SIZE];
+		make_path(path, identity, "");
+		FILE* file = fopen(path, "rb");
+		if (!file) return false;
+		int size = REGISTER_IMAGE_HEADER_SIZE + range_count * 4 + register_count * 2 + 2;
+		int read = (int)fread(buffer, 1, size + 1, file);		// one more than expected, to reject longer files
+		fclose(file);
+		if (read != size) return false;
+
+		uint8_t expected[REGISTER_IMAGE_HEADER_SIZE + MAX_RANGES * 4];
+		int expected_size = put_header(expected, identity, ranges, range_count);
+		if (memcmp(buffer, expected, expected_size)) return false;
+		if (ModbusCRC::generate(buffer, size - 2) != get_u16(buffer + size - 2)) return false;
+
+		for (int i = 0; i < register_count; i++) values[i] = get_u16(buffer + expected_size + i * 2);
+		return true;
+	}
+
+	bool save(uint64_t identity, const RegisterRange* ranges, int range_count, const uint16_t* values) override {
+		int register_count = count_registers(ranges, range_count);
+		if (register_count < 0) return false;
+
+		int size = put_header(buffer, identity, ranges, range_count);
+		for (int i = 0; i < register_count; i++, size += 2) put_u16(buffer + size, values[i]);
+		put_u16(buffer + size, ModbusCRC::generate(buffer, size));
+		size += 2;
+
+		char path[PATH_SIZE], temp_path[PATH_SIZE];
+		make_path(path, identity, "");
+		make_path(temp_path, identity, ".tmp");
+		FILE* file = fopen(temp_path, "wb");
+		if (!file) return false;
+		bool written = fwrite(buffer, 1, size, file) == (size_t)size;
+		written = (fclose(file) == 0) && written;
+		if (!written) {
+			remove(temp_path);
+			return false;
+		}
+#ifdef _WIN32
+		remove(path);		// rename doesn't replace an existing file on Windows
+#endif
+		return rename(temp_path, path) == 0;
+	}
+
+	void erase(uint64_t identity) override {
+		char path[PATH_SIZE];
+		make_path(path, identity, "");
+		remove(path);
+	}
+
+private:
+
+	static const int PATH_SIZE = 512;
+
+	char directory[PATH_SIZE - 32];
+	uint8_t buffer[REGISTER_IMAGE_HEADER_SIZE + MAX_RANGES * 4 + MAX_REGISTERS * 2 + 2 + 1];
+
+	void make_path(char* path, uint64_t identity, const char* suffix) {
+		snprintf(path, PATH_SIZE, "%s/%08lx%08lx.irmm%s", directory,
+			(unsigned long)(identity >> 32), (unsigned long)(identity & 0xFFFFFFFF), suffix);
+	}
+
+	/// @return the registers in the ranges, or -1 if there are too many ranges or registers
+	static int count_registers(const RegisterRange* ranges, int range_count) {
+		if (range_count < 0 || range_count > MAX_RANGES) return -1;
+		int count = 0;
+		for (int i = 0; i < range_count; i++) count += ranges[i].count;
+		return count > MAX_REGISTERS ? -1 : count;
+	}
+
+	static int put_header(uint8_t* out, uint64_t identity, const RegisterRange* ranges, int range_count) {
+		memcpy(out, REGISTER_IMAGE_MAGIC, 4);
+		put_u16(out + 4, REGISTER_IMAGE_VERSION);
+		put_u16(out + 6, range_count);
+		put_u32(out + 8, uint32_t(identity));
+		put_u32(out + 12, uint32_t(identity >> 32));
+		int size = REGISTER_IMAGE_HEADER_SIZE;
+		for (int i = 0; i < range_count; i++, size += 4) {
+			put_u16(out + size, ranges[i].start);
+			put_u16(out + size + 2, ranges[i].count);
+		}
+		return size;
+	}
+
+	static void put_u16(uint8_t* p, uint16_t v) { p[0] = uint8_t(v); p[1] = uint8_t(v >> 8); }
+	static void put_u32(uint8_t* p, uint32_t v) { put_u16(p, uint16_t(v)); put_u16(p + 2, uint16_t(v >> 16)); }
+	static uint16_t get_u16(const uint8_t* p) { return uint16_t(p[0] | (p[1] << 8)); }
+};
+
+#endif
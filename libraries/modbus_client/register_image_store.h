@@ -0,0 +1,63 @@
+/**
+ * @file register_image_store.h
+ *
+ * @brief  Interface to a persistent store of a server's mostly static registers, keyed by the server's identity
+ *
+ * @version 2.2.0
+
+    @copyright Copyright 2022 Iris Dynamics Ltd
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+    For questions or feedback on this file, please email <support@irisdynamics.com>.
+ */
+
+#ifndef REGISTER_IMAGE_STORE_H_
+#define REGISTER_IMAGE_STORE_H_
+
+#include <stdint.h>
+
+/**
+ * @brief A run of consecutive registers
+ */
+struct RegisterRange {
+	uint16_t start;
+	uint16_t count;
+};
+
+/**
+ * @class RegisterImageStore
+ * @brief Saves and restores the values of a set of register ranges for a server identified by eg. its serial number and firmware.
+ * The values of all ranges are passed as one array, in range order.
+ */
+class RegisterImageStore {
+public:
+	virtual ~RegisterImageStore() {}
+
+	/**
+	 * @brief Restore the image saved for the identity
+	 * @return false if there is none, or it doesn't hold exactly the given ranges, or it is corrupt
+	 */
+	virtual bool load(uint64_t identity, const RegisterRange* ranges, int range_count, uint16_t* values) = 0;
+
+	/**
+	 * @return false if the image couldn't be saved
+	 */
+	virtual bool save(uint64_t identity, const RegisterRange* ranges, int range_count, const uint16_t* values) = 0;
+
+	/**
+	 * @brief Forget the image saved for the identity, eg. because one of its registers was written
+	 */
+	virtual void erase(uint64_t identity) = 0;
+};
+
+#endif
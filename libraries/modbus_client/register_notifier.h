@@ -0,0 +1,217 @@
+/**
+ * @file register_notifier.h
+ *
+ * @brief  Tells any number of consumers about each decoded response, without one consumer hiding an update from another
+ *
+ * @version 2.2.0
+
+    @copyright Copyright 2022 Iris Dynamics Ltd
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+    For questions or feedback on this file, please email <support@irisdynamics.com>.
+ */
+
+#ifndef REGISTER_NOTIFIER_H_
+#define REGISTER_NOTIFIER_H_
+
+#include <stdint.h>
+
+/**
+ * @class RegisterListener
+ * @brief Receives the registers changed by each decoded response, from the thread running the client.
+ * Implementations must be quick, as they are called from run_in().
+ */
+class RegisterListener {
+public:
+	virtual ~RegisterListener() {}
+
+	/**
+	 * @param registers every register whose value changed in the response, newest first; not only those the listener subscribed to
+	 * @param count number of registers; 0 for a response which changed nothing, given only to listeners of all registers
+	 * @param update the notifier's update count, including this update
+	 */
+	virtual void on_registers_changed(const uint16_t* registers, int count, uint32_t update) = 0;
+};
+
+/**
+ * @class RegisterNotifier
+ * @brief Counts decoded responses for polling consumers and calls back listeners subscribed to the registers that changed.
+ *
+ * Polling consumers keep their own cursor, an update count, and pass it to poll(). Unlike a shared flag, one consumer
+ * reading an update doesn't hide it from the others, and a consumer which polls late learns how many updates it missed.
+ *
+ * Listeners subscribe to a set of registers, or to all of them. Subscriptions are indexed by register, so an update visits
+ * only the registers it changed and the listeners subscribed to them; listeners of other registers cost nothing.
+ * Each listener interested in an update is called once, however many of its registers changed.
+ *
+ * @tparam SIZE number of registers in the server's memory map
+ */
+template <uint16_t SIZE>
+class RegisterNotifier {
+
+public:
+
+	static const int MAX_LISTENERS = 8;
+	static const int MAX_SUBSCRIPTIONS = 64;		// listener and register pairs, over all listeners
+	static const int MAX_CHANGED = 144;				// changed registers reported per update; more than a single response can carry
+
+	RegisterNotifier() {
+		for (int i = 0; i < SIZE; i++) heads[i] = NONE;
+		for (int i = 0; i < MAX_SUBSCRIPTIONS; i++) subscriptions[i].listener = NONE;
+		for (int i = 0; i < MAX_LISTENERS; i++) {
+			listeners[i] = 0;
+			all_registers[i] = false;
+			notified_update[i] = 0;
+		}
+	}
+
+/////////////////////////////////////////////////////////////
+///////////////////////////////////////////////// Polling //
+///////////////////////////////////////////////////////////
+
+	/// @brief number of responses decoded
+	uint32_t get_update_count() const { return update_count; }
+
+	/**
+	 * @brief Check a consumer's cursor for updates and bring it up to date
+	 * @param cursor update count the consumer has seen; start it at 0
+	 * @return the number of updates since the cursor, or 0 if there are none
+	 */
+	uint32_t poll(uint32_t& cursor) const {
+		uint32_t missed = update_count - cursor;
+		cursor = update_count;
+		return missed;
+	}
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////// Listeners //
+///////////////////////////////////////////////////////////
+
+	/**
+	 * @brief Call the listener whenever any of the given registers changes
+	 * @param registers registers of interest, or 0 to be called for every update whether or not anything changed
+	 * @param count number of registers
+	 * @return false if there is no room for the listener or its registers, in which case nothing is subscribed
+	 */
+	bool subscribe(RegisterListener* listener, const uint16_t* registers = 0, int count = 0) {
+		if (!listener) return false;
+		int index = find(listener);
+		if (index == NONE) index = find(0);
+		if (index == NONE) return false;
+
+		if (!registers) {
+			listeners[index] = listener;
+			all_registers[index] = true;
+			return true;
+		}
+
+		int free_subscriptions = 0;
+		for (int i = 0; i < MAX_SUBSCRIPTIONS; i++) if (subscriptions[i].listener == NONE) free_subscriptions++;
+		for (int i = 0; i < count; i++) if (registers[i] >= SIZE) return false;
+		if (count > free_subscriptions) return false;
+
+		listeners[index] = listener;
+		int next_free = 0;
+		for (int i = 0; i < count; i++) {
+			while (subscriptions[next_free].listener != NONE) next_free++;
+			subscriptions[next_free].listener = index;
+			subscriptions[next_free].next = heads[registers[i]];
+			heads[registers[i]] = next_free;
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Stop calling the listener, and free its subscriptions
+	 */
+	void unsubscribe(RegisterListener* listener) {
+		int index = find(listener);
+		if (index == NONE || !listener) return;
+
+		for (int address = 0; address < SIZE; address++) {
+			uint8_t* link = &heads[address];
+			while (*link != NONE) {
+				Subscription& subscription = subscriptions[*link];
+				if (subscription.listener == index) {
+					subscription.listener = NONE;
+					*link = subscription.next;
+				}
+				else link = &subscription.next;
+			}
+		}
+		listeners[index] = 0;
+		all_registers[index] = false;
+	}
+
+/////////////////////////////////////////////////////////////
+////////////////////////////////////// Owner of the cache //
+///////////////////////////////////////////////////////////
+
+	/**
+	 * @brief Record an update and call the listeners interested in it. Should be called once per decoded response.
+	 * @param cache register store with a get_changed_since() method, eg. RegisterCache
+	 * @param since the cache's sequence number before the response was decoded
+	 */
+	template <class Cache>
+	void notify(const Cache& cache, uint32_t since) {
+		update_count++;
+		int changed_count = cache.get_changed_since(since, changed, MAX_CHANGED);
+
+		int called_count = 0;
+		uint8_t called[MAX_LISTENERS];
+		for (int i = 0; i < MAX_LISTENERS; i++) {
+			if (all_registers[i]) {
+				notified_update[i] = update_count;
+				called[called_count++] = i;
+			}
+		}
+		for (int i = 0; i < changed_count; i++) {
+			for (uint8_t s = heads[changed[i]]; s != NONE; s = subscriptions[s].next) {
+				uint8_t index = subscriptions[s].listener;
+				if (notified_update[index] != update_count) {
+					notified_update[index] = update_count;
+					called[called_count++] = index;
+				}
+			}
+		}
+		for (int i = 0; i < called_count; i++) {
+			listeners[called[i]]->on_registers_changed(changed, changed_count, update_count);
+		}
+	}
+
+private:
+
+	static const uint8_t NONE = 0xFF;
+
+	struct Subscription {
+		uint8_t listener;		// index into listeners, or NONE if free
+		uint8_t next;			// next subscription to the same register
+	};
+
+	uint32_t update_count = 0;
+
+	RegisterListener* listeners[MAX_LISTENERS];
+	bool all_registers[MAX_LISTENERS];
+	uint32_t notified_update[MAX_LISTENERS];	// last update each listener was called for
+
+	uint8_t heads[SIZE];						// first subscription to each register
+	Subscription subscriptions[MAX_SUBSCRIPTIONS];
+	uint16_t changed[MAX_CHANGED];
+
+	int find(RegisterListener* listener) const {
+		for (int i = 0; i < MAX_LISTENERS; i++) if (listeners[i] == listener) return i;
+		return NONE;
+	}
+};
+
+#endif
@@ -0,0 +1,200 @@
+/**
+ * @file register_profile.h
+ *
+ * @brief  A named set of register values to be written to a server together, with the requests that write and read it back
+ *
+ * @version 2.2.0
+
+    @copyright Copyright 2022 Iris Dynamics Ltd
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+    For questions or feedback on this file, please email <support@irisdynamics.com>.
+ */
+
+#ifndef REGISTER_PROFILE_H_
+#define REGISTER_PROFILE_H_
+
+#include <stdint.h>
+#include <string.h>
+#include "function_code_parameters.h"
+#include "register_image_store.h"
+
+/**
+ * @class RegisterProfile
+ * @brief Register values kept in address order, so that they can be written with the fewest write_multiple_registers
+ * requests and read back with the fewest read_holding_registers requests.
+ *
+ * Only the registers in the profile are written: a write request covers one run of consecutive profile registers,
+ * split where the run is longer than a request allows. Reads may also cover the registers between two runs, when
+ * reading them costs fewer bytes than another request would.
+ *
+ * Registers which don't read back as written, such as command registers which clear themselves, can be added without
+ * verification; they are written but left out of the read back.
+ */
+class RegisterProfile {
+
+public:
+
+	static const int MAX_ENTRIES = 256;
+	static const int NAME_SIZE = 32;
+
+	/**
+	 * Largest number of registers between two runs which are read by the same request. Each register costs 2 bytes on the
+	 * wire, while another request costs an 8 byte request, a 5 byte response header and CRC, and a turnaround.
+	 */
+	static const uint16_t DEFAULT_READ_GAP = 6;
+
+	RegisterProfile(const char* _name = "") {
+		set_name(_name);
+	}
+
+	void set_name(const char* _name) {
+		strncpy(name, _name, NAME_SIZE - 1);
+		name[NAME_SIZE - 1] = 0;
+	}
+
+	const char* get_name() const { return name; }
+
+	/**
+	 * @brief Remove every register
+	 */
+	void clear() { count = 0; }
+
+	/**
+	 * @brief Add a register, or replace its value if it is already in the profile
+	 * @param verify false to write the register without reading it back
+	 * @return false if the profile is full
+	 */
+	bool set(uint16_t address, uint16_t value, bool verify = true) {
+		int i = lower_bound(address);
+		if (i == count || addresses[i] != address) {
+			if (count >= MAX_ENTRIES) return false;
+			memmove(&addresses[i + 1], &addresses[i], (count - i) * sizeof(addresses[0]));
+			memmove(&values[i + 1], &values[i], (count - i) * sizeof(values[0]));
+			memmove(&verified[i + 1], &verified[i], (count - i) * sizeof(verified[0]));
+			count++;
+		}
+		addresses[i] = address;
+		values[i] = value;
+		verified[i] = verify;
+		return true;
+	}
+
+	/**
+	 * @brief Add a 32 bit value held low half first in the register at address and the one above it
+	 */
+	bool set32(uint16_t address, uint32_t value, bool verify = true) {
+		if (count > MAX_ENTRIES - 2) return false;
+		return set(address, uint16_t(value), verify) && set(address + 1, uint16_t(value >> 16), verify);
+	}
+
+	/**
+	 * @brief Remove a register from the profile
+	 */
+	void remove(uint16_t address) {
+		int i = lower_bound(address);
+		if (i == count || addresses[i] != address) return;
+		count--;
+		memmove(&addresses[i], &addresses[i + 1], (count - i) * sizeof(addresses[0]));
+		memmove(&values[i], &values[i + 1], (count - i) * sizeof(values[0]));
+		memmove(&verified[i], &verified[i + 1], (count - i) * sizeof(verified[0]));
+	}
+
+	/**
+	 * @brief The value the profile gives a register
+	 * @return false if the register isn't in the profile
+	 */
+	bool find(uint16_t address, uint16_t& value) const {
+		int i = lower_bound(address);
+		if (i == count || addresses[i] != address) return false;
+		value = values[i];
+		return true;
+	}
+
+	int get_count() const { return count; }
+
+	/// @brief address of the index'th register in address order
+	uint16_t get_address(int index) const { return addresses[index]; }
+	uint16_t get_value(int index) const { return values[index]; }
+	bool is_verified(int index) const { return verified[index]; }
+
+	/**
+	 * @brief Split the profile into the runs of consecutive registers each write request covers
+	 * @param runs filled with up to max_runs runs, in address order
+	 * @return the number of runs needed, which may be more than max_runs
+	 */
+	int plan_writes(RegisterRange* runs, int max_runs) const {
+		int run_count = 0;
+		for (int i = 0; i < count; ) {
+			int length = 1;
+			while (i + length < count && length < MAX_NUM_WRITE_REG && addresses[i + length] == addresses[i] + length) length++;
+			if (run_count < max_runs) runs[run_count] = { addresses[i], uint16_t(length) };
+			run_count++;
+			i += length;
+		}
+		return run_count;
+	}
+
+	/**
+	 * @brief Merge the verified registers into the spans each read request covers
+	 * @param max_gap largest number of registers outside the profile a span may cover between two verified registers
+	 * @param spans filled with up to max_spans spans, in address order
+	 * @return the number of spans needed, which may be more than max_spans
+	 */
+	int plan_reads(RegisterRange* spans, int max_spans, uint16_t max_gap = DEFAULT_READ_GAP) const {
+		int span_count = 0;
+		uint16_t start = 0, end = 0;		// the open span covers start up to but not including end
+		bool open = false;
+		for (int i = 0; i < count; i++) {
+			if (!verified[i]) continue;
+			uint16_t address = addresses[i];
+			if (open && address - end <= max_gap && address + 1 - start <= MAX_NUM_READ_REG) {
+				end = address + 1;
+				continue;
+			}
+			if (open) {
+				if (span_count < max_spans) spans[span_count] = { start, uint16_t(end - start) };
+				span_count++;
+			}
+			start = address;
+			end = address + 1;
+			open = true;
+		}
+		if (open) {
+			if (span_count < max_spans) spans[span_count] = { start, uint16_t(end - start) };
+			span_count++;
+		}
+		return span_count;
+	}
+
+private:
+
+	char name[NAME_SIZE];
+	int count = 0;
+	uint16_t addresses[MAX_ENTRIES];
+	uint16_t values[MAX_ENTRIES];
+	bool verified[MAX_ENTRIES];
+
+	/// @brief index of the first register at or above address
+	int lower_bound(uint16_t address) const {
+		int low = 0, high = count;
+		while (low < high) {
+			int middle = (low + high) / 2;
+			if (addresses[middle] < address) low = middle + 1;
+			else high = middle;
+		}
+		return low;
+	}
+};
+
+#endif
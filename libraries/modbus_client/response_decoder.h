@@ -0,0 +1,235 @@
+/**
+ * @file response_decoder.h
+ *
+ * @brief  Copies the fields of a response into a register store following a per function code layout, given as a table
+ * or fixed at compile time
+ *
+ * @version 2.2.0
+
+    @copyright Copyright 2022 Iris Dynamics Ltd
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+    For questions or feedback on this file, please email <support@irisdynamics.com>.
+ */
+
+#ifndef RESPONSE_DECODER_H_
+#define RESPONSE_DECODER_H_
+
+#include <type_traits>
+#include "transaction.h"
+
+/**
+ * @brief One field of a response's data: a big endian value of one or two bytes destined for a register
+ */
+struct ResponseField {
+	uint8_t  offset;			//!< byte offset of the field from the start of the response data, ie. after the function code
+	uint8_t  width;				//!< 1 or 2 bytes
+	uint16_t destination;		//!< register the value is stored in
+};
+
+/**
+ * @brief The fixed fields of the response to a function code
+ */
+struct ResponseLayout {
+	uint8_t function_code;
+	uint8_t data_length;		//!< bytes of data the fields span; shorter responses are rejected
+	const ResponseField* fields;
+	uint8_t field_count;
+};
+
+/**
+ * @class ResponseDecoder
+ * @brief Finds the layout for a response's function code in constant time and copies its fields into a register store.
+ *
+ * The store needs a set(uint16_t address, uint16_t value, uint32_t cycles) method, eg. RegisterCache.
+ * Parts of a response whose destination depends on the request, such as the registers returned by read_holding_registers,
+ * are not described by a layout; decode_registers() and decode_fields() copy them with the same bounds checks.
+ *
+ * A response is only decoded when it answers the request's function code and holds at least the data the layout spans,
+ * so a corrupted frame which passed its CRC can't index past the data it carries.
+ * Layouts known at compile time are decoded faster by StaticResponseDecoder.
+ */
+class ResponseDecoder {
+
+public:
+
+	/**
+	 * @param _layouts layouts for each decoded function code; must outlive the decoder. Layouts with fields beyond their data length are ignored.
+	 * @param count number of layouts, at most 255
+	 */
+	ResponseDecoder(const ResponseLayout* _layouts, int count) :
+		layouts(_layouts)
+	{
+		for (int i = 0; i < 256; i++) layout_index[i] = 0;
+		for (int i = 0; i < count && i < 255; i++) {
+			// a layout whose fields run past its data length would let decode() read past a short response
+			bool consistent = true;
+			for (int j = 0; j < layouts[i].field_count; j++) {
+				if (layouts[i].fields[j].offset + layouts[i].fields[j].width > layouts[i].data_length) consistent = false;
+			}
+			if (consistent) layout_index[layouts[i].function_code] = i + 1;
+		}
+	}
+
+	/// @brief the layout for a function code, or 0 if it has none
+	const ResponseLayout* get_layout(uint8_t function_code) const {
+		return layout_index[function_code] ? &layouts[layout_index[function_code] - 1] : 0;
+	}
+
+	/// @brief bytes of data in a response, excluding its address, function code and CRC
+	static int get_rx_data_length(Transaction* response) {
+		int length = response->get_rx_buffer_size() - 4;
+		return length < 0 ? 0 : length;
+	}
+
+	/**
+	 * @brief Copy the fixed fields of a response into the store
+	 * @param cycles time stamp given to every stored register
+	 * @return false if the response has no layout, doesn't answer its request's function code, or is too short for its layout
+	 */
+	template <class Store>
+	bool decode(Transaction* response, Store& store, uint32_t cycles) const {
+		uint8_t function_code = response->get_rx_function_code();
+		const ResponseLayout* layout = get_layout(function_code);
+		if (!layout || function_code != response->get_tx_function_code()) return false;
+		if (get_rx_data_length(response) < layout->data_length) return false;
+
+		// the layout's fields all lie within data_length, so no per field check is needed
+		const uint8_t* data = response->get_rx_data();
+		const ResponseField* field = layout->fields;
+		const ResponseField* end = field + layout->field_count;
+		for (; field < end; field++) {
+			const uint8_t* bytes = data + field->offset;
+			store.set(field->destination, field->width == 2 ? (bytes[0] << 8) | bytes[1] : bytes[0], cycles);
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Copy fields from response data into the store, eg. fields whose destination depends on the request
+	 * @param available bytes available at data; fields which don't fit are not stored
+	 * @return false if any field didn't fit
+	 */
+	template <class Store>
+	static bool decode_fields(const uint8_t* data, int available, const ResponseField* fields, int field_count, Store& store, uint32_t cycles) {
+		bool complete = true;
+		for (int i = 0; i < field_count; i++) {
+			const ResponseField& field = fields[i];
+			if (field.offset + field.width > available) {
+				complete = false;
+				continue;
+			}
+			uint16_t value = field.width == 2 ? (data[field.offset] << 8) | data[field.offset + 1] : data[field.offset];
+			store.set(field.destination, value, cycles);
+		}
+		return complete;
+	}
+
+	/**
+	 * @brief Copy a run of consecutive big endian registers into the store
+	 * @param data first byte of the run
+	 * @param available bytes available at data; registers beyond it are not stored
+	 * @return false if the run was truncated
+	 */
+	template <class Store>
+	static bool decode_registers(const uint8_t* data, int available, uint16_t first_register, int count, Store& store, uint32_t cycles) {
+		bool complete = available >= count * 2;
+		if (!complete) count = available / 2;
+		for (int i = 0; i < count; i++) {
+			store.set(first_register + i, (data[i * 2] << 8) | data[i * 2 + 1], cycles);
+		}
+		return complete;
+	}
+
+private:
+
+	const ResponseLayout* layouts;
+	uint8_t layout_index[256];		// function code to 1 + index into layouts, or 0 for none
+};
+
+/**
+ * @brief A response layout fixed at compile time, for StaticResponseDecoder
+ * @tparam Fields a constexpr array with external linkage, eg. a static member of a class template, so its offsets and
+ * destinations are constants wherever the layout is used and the copy of each field is unrolled
+ */
+template <uint8_t FunctionCode, uint8_t DataLength, const ResponseField* Fields, int FieldCount>
+struct StaticResponseLayout {
+
+	static const uint8_t function_code = FunctionCode;
+	static const uint8_t data_length = DataLength;
+
+	/// @brief Copy every field from data, which must hold at least data_length bytes
+	template <class Store>
+	static void copy(const uint8_t* data, Store& store, uint32_t cycles) {
+		copy_field<0>(data, store, cycles, std::integral_constant<bool, (FieldCount > 0)>());
+	}
+
+private:
+
+	template <int Index, class Store>
+	static void copy_field(const uint8_t*, Store&, uint32_t, std::false_type) {}
+
+	template <int Index, class Store>
+	static void copy_field(const uint8_t* data, Store& store, uint32_t cycles, std::true_type) {
+		static_assert(Fields[Index].offset + Fields[Index].width <= DataLength, "a response field lies beyond its layout's data length");
+		const uint8_t* bytes = data + Fields[Index].offset;
+		store.set(Fields[Index].destination, Fields[Index].width == 2 ? (bytes[0] << 8) | bytes[1] : bytes[0], cycles);
+		copy_field<Index + 1>(data, store, cycles, std::integral_constant<bool, (Index + 1 < FieldCount)>());
+	}
+};
+
+/**
+ * @class StaticResponseDecoder
+ * @brief ResponseDecoder for a set of StaticResponseLayouts known at compile time.
+ *
+ * decode() accepts the same responses as ResponseDecoder::decode() and stores the same registers, but the function code
+ * is matched against constants and each layout's fields are copied without a loop or a table lookup. The function code
+ * and length are checked once per response; a layout whose fields run past its data length doesn't compile.
+ */
+template <class... Layouts>
+struct StaticResponseDecoder;
+
+template <>
+struct StaticResponseDecoder<> {
+	template <class Store>
+	static bool decode(uint8_t, const uint8_t*, int, Store&, uint32_t) {
+		return false;
+	}
+};
+
+template <class Layout, class... Others>
+struct StaticResponseDecoder<Layout, Others...> {
+
+	/**
+	 * @brief Copy the fixed fields of a response into the store
+	 * @param cycles time stamp given to every stored register
+	 * @return false if the response has no layout, doesn't answer its request's function code, or is too short for its layout
+	 */
+	template <class Store>
+	static bool decode(Transaction* response, Store& store, uint32_t cycles) {
+		uint8_t function_code = response->get_rx_function_code();
+		if (function_code != response->get_tx_function_code()) return false;
+		return decode(function_code, response->get_rx_data(), ResponseDecoder::get_rx_data_length(response), store, cycles);
+	}
+
+	/// @brief Copy the fields of the layout for function_code from the available bytes of response data
+	template <class Store>
+	static bool decode(uint8_t function_code, const uint8_t* data, int available, Store& store, uint32_t cycles) {
+		if (function_code != Layout::function_code) return StaticResponseDecoder<Others...>::decode(function_code, data, available, store, cycles);
+		if (available < Layout::data_length) return false;
+		Layout::copy(data, store, cycles);
+		return true;
+	}
+};
+
+#endif
@@ -0,0 +1,143 @@
+/**
+ * @file sample_clock.h
+ *
+ * @brief  Estimates when, in client system time, a server sampled the data carried by its response
+ *
+ * @version 2.2.0
+
+    @copyright Copyright 2022 Iris Dynamics Ltd
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+    For questions or feedback on this file, please email <support@irisdynamics.com>.
+ */
+
+#ifndef SAMPLE_CLOCK_H_
+#define SAMPLE_CLOCK_H_
+
+#include "transaction.h"
+
+/**
+ * @class SampleClock
+ * @brief Places each response's sample instant on the client's clock, with an uncertainty.
+ *
+ * The server samples its data after the last request byte arrives and before the first response byte leaves.
+ * Both ends of that window are estimated from the transaction's timestamps and the character time at the current baud:
+ *  request end    = the later of the last byte being handed to the driver and the first byte's send time plus the frame's wire time
+ *  response start = the earlier of the first byte's read time less one character and the last byte's read time less the frame's wire time
+ * The window also contains the client's receive latency (polling, FIFO thresholds, USB frames), which varies from frame to frame.
+ * The smallest window seen recently bounds the server's own turnaround, so the sample is placed in the middle of that
+ * bound after the request end, and half the bound is reported as the uncertainty.
+ */
+class SampleClock {
+
+public:
+
+	static const int WINDOW = 64;		// frames over which the minimum turnaround is remembered
+	static const uint32_t NO_TURNAROUND = 0xFFFFFFFF;
+
+	SampleClock(uint32_t _cycles_per_us) :
+		cycles_per_us(_cycles_per_us)
+	{}
+
+	/**
+	 * @brief Estimate the sample instant of a fully received response
+	 * @param baud_rate_bps baud rate the transaction was exchanged at
+	 * @return false if the transaction has no complete response, in which case the previous estimate is kept
+	 */
+	bool update(Transaction* transaction, uint32_t baud_rate_bps) {
+		if (!baud_rate_bps || !transaction->get_rx_buffer_size() || !transaction->is_fully_received()) return false;
+
+		if (baud_rate_bps != last_baud_rate_bps) reset();		// turnarounds seen at another baud rate don't apply
+		last_baud_rate_bps = baud_rate_bps;
+
+		uint32_t char_cycles = uint32_t(11ULL * 1000000 * cycles_per_us / baud_rate_bps);		// 8 data, parity, start and stop bits
+
+		uint32_t request_end = transaction->get_sent_cycles() + char_cycles * transaction->get_tx_buffer_size();
+		if (int32_t(transaction->get_tx_end_cycles() - request_end) > 0) request_end = transaction->get_tx_end_cycles();
+
+		uint32_t response_start = transaction->get_rx_first_cycles() - char_cycles;
+		uint32_t from_last = transaction->get_rx_last_cycles() - char_cycles * transaction->get_rx_buffer_size();
+		if (int32_t(from_last - response_start) < 0) response_start = from_last;
+
+		if (int32_t(response_start - request_end) < 0) {
+			// the bytes didn't take their wire time, eg. a coarse client clock or a virtual port; fall back to the raw stamps
+			request_end = transaction->get_tx_end_cycles();
+			response_start = transaction->get_rx_first_cycles();
+		}
+		int32_t turnaround = int32_t(response_start - request_end);
+		if (turnaround < 0) turnaround = 0;
+
+		// minimum over the current and previous windows, so a slow drift upwards is eventually followed
+		if (uint32_t(turnaround) < window_min) window_min = turnaround;
+		if (++window_count >= WINDOW) {
+			previous_window_min = window_min;
+			window_min = NO_TURNAROUND;
+			window_count = 0;
+		}
+		uint32_t bound = min_turnaround_cycles();
+
+		sample_cycles = request_end + bound / 2;
+		uncertainty_cycles = bound / 2;
+		arrival_cycles = transaction->get_rx_last_cycles();
+		valid = true;
+		return true;
+	}
+
+	/// @brief true once a sample instant has been estimated
+	bool has_sample() { return valid; }
+
+	/// @brief client system time at which the latest response's data was sampled
+	uint32_t get_sample_cycles() { return sample_cycles; }
+
+	/// @brief half width of the window the sample instant lies in
+	uint32_t get_uncertainty_cycles() { return uncertainty_cycles; }
+	uint32_t get_uncertainty_us() { return uncertainty_cycles / cycles_per_us; }
+
+	/// @brief time from the latest sample instant until its response was read; the offset between a sample and its arrival
+	uint32_t get_arrival_offset_cycles() { return arrival_cycles - sample_cycles; }
+
+	/// @brief time since the latest sample instant
+	uint32_t get_sample_age_us(uint32_t now_cycles) { return (now_cycles - sample_cycles) / cycles_per_us; }
+
+	/// @brief smallest request end to response start time seen recently
+	uint32_t min_turnaround_cycles() {
+		uint32_t bound = window_min < previous_window_min ? window_min : previous_window_min;
+		return bound == NO_TURNAROUND ? 0 : bound;
+	}
+
+	/**
+	 * @brief Forget the turnaround history, eg. after the baud rate or server changes
+	 */
+	void reset() {
+		window_min = NO_TURNAROUND;
+		previous_window_min = NO_TURNAROUND;
+		window_count = 0;
+		valid = false;
+	}
+
+private:
+
+	const uint32_t cycles_per_us;
+
+	uint32_t window_min = NO_TURNAROUND;
+	uint32_t previous_window_min = NO_TURNAROUND;
+	int window_count = 0;
+	uint32_t last_baud_rate_bps = 0;
+
+	uint32_t sample_cycles = 0;
+	uint32_t uncertainty_cycles = 0;
+	uint32_t arrival_cycles = 0;
+	bool valid = false;
+};
+
+#endif
@@ -0,0 +1,171 @@
+/**
+ * @file sample_ring.h
+ *
+ * @brief  Fixed capacity ring of samples written by one thread and read at their own pace by any number of others
+ *
+ * @version 2.2.0
+
+    @copyright Copyright 2022 Iris Dynamics Ltd
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+    For questions or feedback on this file, please email <support@irisdynamics.com>.
+ */
+
+#ifndef SAMPLE_RING_H_
+#define SAMPLE_RING_H_
+
+#include <atomic>
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+
+/**
+ * @class SampleRing
+ * @brief Keeps the most recent CAPACITY samples, each numbered by a sequence starting at 1.
+ *
+ * The writer never waits: once the ring is full each new sample replaces the oldest, whether or not it has been read.
+ * Readers don't register with the writer. Each keeps a Cursor holding the sequence it will read next, and
+ * counts the samples which were replaced before it got to them as overruns.
+ *
+ * Each slot works like a Seqlock: its sequence is 0 while the writer fills it and the sample's sequence once filled,
+ * so a reader which finds a different sequence before or after copying the slot knows the sample was replaced.
+ *
+ * @tparam T a trivially copyable sample
+ * @tparam CAPACITY samples kept; must be a power of 2
+ */
+template <class T, uint32_t CAPACITY>
+class SampleRing {
+
+	static_assert(std::is_trivially_copyable<T>::value, "SampleRing samples are copied word by word");
+	static_assert(CAPACITY && !(CAPACITY & (CAPACITY - 1)), "SampleRing capacity must be a power of 2");
+
+public:
+
+	/**
+	 * @brief A reader's position in the ring. Each reading thread should have its own.
+	 */
+	struct Cursor {
+		uint32_t next = 1;			//!< sequence of the next sample to read
+		uint32_t overruns = 0;		//!< samples replaced before this reader read them
+	};
+
+	SampleRing() {
+		for (uint32_t i = 0; i < CAPACITY; i++) {
+			slots[i].sequence.store(0, std::memory_order_relaxed);
+			for (int j = 0; j < WORDS; j++) slots[i].words[j].store(0, std::memory_order_relaxed);
+		}
+	}
+
+/////////////////////////////////////////////////////////////
+////////////////////////////////////////// Writer only /////
+///////////////////////////////////////////////////////////
+
+	/**
+	 * @brief Add a sample, replacing the oldest if the ring is full
+	 * @return the sample's sequence
+	 */
+	uint32_t push(const T& sample) {
+		uint32_t buffer[WORDS] = { 0 };
+		memcpy(buffer, &sample, sizeof(T));
+
+		uint32_t sequence = newest.load(std::memory_order_relaxed) + 1;
+		if (!sequence) sequence = 1;		// 0 marks a slot being filled
+		Slot& slot = slots[sequence & (CAPACITY - 1)];
+		slot.sequence.store(0, std::memory_order_relaxed);
+		for (int i = 0; i < WORDS; i++) slot.words[i].store(buffer[i], std::memory_order_release);
+		slot.sequence.store(sequence, std::memory_order_release);
+		newest.store(sequence, std::memory_order_release);
+		return sequence;
+	}
+
+/////////////////////////////////////////////////////////////
+///////////////////////////////////////////// Any thread ///
+///////////////////////////////////////////////////////////
+
+	/// @brief sequence of the most recent sample, or 0 if none has been pushed
+	uint32_t get_newest_sequence() const {
+		return newest.load(std::memory_order_acquire);
+	}
+
+	/// @brief sequence of the oldest sample still held, or 1 before the ring has filled
+	uint32_t get_oldest_sequence() const {
+		uint32_t n = get_newest_sequence();
+		return n > CAPACITY ? n - CAPACITY + 1 : 1;
+	}
+
+	/**
+	 * @brief Copy a sample by sequence
+	 * @return false if the sample hasn't been pushed yet or has already been replaced
+	 */
+	bool get(uint32_t sequence, T& sample) const {
+		if (!sequence) return false;
+		const Slot& slot = slots[sequence & (CAPACITY - 1)];
+		if (slot.sequence.load(std::memory_order_acquire) != sequence) return false;
+
+		uint32_t buffer[WORDS];
+		for (int i = 0; i < WORDS; i++) buffer[i] = slot.words[i].load(std::memory_order_acquire);
+		if (slot.sequence.load(std::memory_order_relaxed) != sequence) return false;
+
+		memcpy(&sample, buffer, sizeof(T));
+		return true;
+	}
+
+	/**
+	 * @brief Copy the samples from the cursor onwards, oldest first, and advance the cursor past them
+	 * Samples which were replaced before they could be copied are skipped and added to the cursor's overruns.
+	 * @param samples filled with up to max_count samples
+	 * @param sequences if not 0, filled with the sequence of each sample copied
+	 * @return the number of samples copied
+	 */
+	int read(Cursor& cursor, T* samples, int max_count, uint32_t* sequences = 0) const {
+		uint32_t last = get_newest_sequence();
+		int count = 0;
+		while (count < max_count && int32_t(last - cursor.next) >= 0) {
+			// skip what the writer has already lapped
+			uint32_t oldest = last > CAPACITY ? last - CAPACITY + 1 : 1;
+			if (int32_t(oldest - cursor.next) > 0) {
+				cursor.overruns += oldest - cursor.next;
+				cursor.next = oldest;
+			}
+			if (get(cursor.next, samples[count])) {
+				if (sequences) sequences[count] = cursor.next;
+				count++;
+			}
+			else {
+				cursor.overruns++;		// replaced while being copied
+			}
+			cursor.next++;
+		}
+		return count;
+	}
+
+	/**
+	 * @brief Position a cursor at the oldest sample still held, or after the newest to read only samples pushed from now on
+	 */
+	void rewind(Cursor& cursor) const { cursor.next = get_oldest_sequence(); }
+	void skip_to_end(Cursor& cursor) const { cursor.next = get_newest_sequence() + 1; }
+
+private:
+
+	static const int WORDS = (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+	struct Slot {
+		std::atomic<uint32_t> sequence;
+		std::atomic<uint32_t> words[WORDS];
+	};
+
+	Slot slots[CAPACITY];
+	std::atomic<uint32_t> newest{ 0 };
+};
+
+#endif
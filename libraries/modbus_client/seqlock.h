@@ -0,0 +1,110 @@
+/**
+ * @file seqlock.h
+ *
+ * @brief  Single writer sequence lock which publishes a value to readers on other threads without blocking the writer
+ *
+ * @version 2.2.0
+
+    @copyright Copyright 2022 Iris Dynamics Ltd
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+    For questions or feedback on this file, please email <support@irisdynamics.com>.
+ */
+
+#ifndef SEQLOCK_H_
+#define SEQLOCK_H_
+
+#include <atomic>
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+
+/**
+ * @class Seqlock
+ * @brief Holds a value written by one thread and read whole by any number of others.
+ *
+ * The writer makes the sequence odd, stores the value, then makes the sequence even again; it never waits.
+ * A reader copies the value between two loads of the sequence and keeps the copy only if the sequence was even
+ * and unchanged, so it never returns a value mixed from two writes.
+ * The value is held in atomic words, so a copy racing a write is well defined and is not reported by ThreadSanitizer.
+ * Words are stored with release and loaded with acquire ordering: a reader which sees any word of a write also sees
+ * that write's odd sequence when it checks again. This costs nothing on x86 and avoids fences, which ThreadSanitizer can't model.
+ *
+ * @tparam T a trivially copyable value
+ */
+template <class T>
+class Seqlock {
+
+	static_assert(std::is_trivially_copyable<T>::value, "Seqlock values are copied word by word");
+
+public:
+
+	Seqlock() {
+		for (int i = 0; i < WORDS; i++) words[i].store(0, std::memory_order_relaxed);
+	}
+
+	/**
+	 * @brief Publish a new value. Only one thread may write.
+	 */
+	void write(const T& value) {
+		uint32_t buffer[WORDS] = { 0 };
+		memcpy(buffer, &value, sizeof(T));
+
+		uint32_t next = sequence.load(std::memory_order_relaxed);
+		sequence.store(next + 1, std::memory_order_relaxed);
+		for (int i = 0; i < WORDS; i++) words[i].store(buffer[i], std::memory_order_release);
+		sequence.store(next + 2, std::memory_order_release);
+	}
+
+	/**
+	 * @brief Copy the latest value if no write overlaps the copy
+	 * @return false if a write was in progress or completed during the copy, in which case value may be torn
+	 */
+	bool try_read(T& value) const {
+		uint32_t before = sequence.load(std::memory_order_acquire);
+		if (before & 1) return false;
+
+		uint32_t buffer[WORDS];
+		for (int i = 0; i < WORDS; i++) buffer[i] = words[i].load(std::memory_order_acquire);
+		if (sequence.load(std::memory_order_relaxed) != before) return false;
+
+		memcpy(&value, buffer, sizeof(T));
+		return true;
+	}
+
+	/**
+	 * @brief Copy the latest value, retrying while writes overlap the copy
+	 * @param max_attempts attempts before giving up; a writer publishing continuously can't starve a reader forever
+	 * @return false if every attempt overlapped a write, in which case value is unchanged
+	 */
+	bool read(T& value, int max_attempts = 1000) const {
+		for (int i = 0; i < max_attempts; i++) {
+			if (try_read(value)) return true;
+		}
+		return false;
+	}
+
+	/// @brief number of completed writes
+	uint32_t get_write_count() const {
+		return sequence.load(std::memory_order_acquire) / 2;
+	}
+
+private:
+
+	static const int WORDS = (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+	std::atomic<uint32_t> sequence{ 0 };
+	std::atomic<uint32_t> words[WORDS];
+};
+
+#endif
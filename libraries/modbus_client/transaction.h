@@ -89,6 +89,17 @@ class Transaction {
     uint32_t ID = -1;
     static uint32_t id_assigner;
 
+    // System times (in the owning client's cycles) at which this transaction reached each stage of its lifecycle
+    uint32_t enqueued_cycles = 0;
+    uint32_t sent_cycles = 0;
+    uint32_t finished_cycles = 0;
+    uint32_t tx_end_cycles = 0;			// last request byte handed to the driver
+    uint32_t rx_first_cycles = 0;		// first response byte read from the driver
+    uint32_t rx_last_cycles = 0;		// last response byte read from the driver
+
+    bool late_bound = false;				// payload is refreshed by the client's TransmitBinder when transmission starts
+    uint32_t setpoint_age_cycles = 0;		// age of the setpoint carried by the payload when transmission started
+
 public:
 	uint8_t rx_buffer_index = 0;              //Index of the next byte from response to pop() and examine/process
 
@@ -136,6 +147,14 @@ public:
         rx_buffer_index = 0;
         tx_buffer_size = 0;
         rx_buffer_size = 0;
+        enqueued_cycles = 0;
+        sent_cycles = 0;
+        finished_cycles = 0;
+        tx_end_cycles = 0;
+        rx_first_cycles = 0;
+        rx_last_cycles = 0;
+        late_bound = false;
+        setpoint_age_cycles = 0;
     }
 
     /**
@@ -174,6 +193,39 @@ public:
 		reception_length = num_expected_rx;
     }
 
+    /**
+     * @brief Overwrites the payload of an already loaded transmission and regenerates its CRC
+     * The address, function code and length of the frame are unchanged. Used to refresh late bound transactions.
+     * @return false if num_data doesn't match the loaded payload length, in which case nothing is changed
+    */
+    bool rebind_transmission_data(uint8_t *data, int num_data){
+    	if (num_data != tx_buffer_size - 4 || tx_buffer_index != 0) return false;
+    	for (int i = 0; i < num_data; i++) tx_buffer[i + 2] = data[i];
+    	uint16_t crc = ModbusCRC::generate(tx_buffer, tx_buffer_size - 2);
+    	tx_buffer[tx_buffer_size - 2] = uint8_t(crc >> 8);
+    	tx_buffer[tx_buffer_size - 1] = uint8_t(crc);
+    	return true;
+    }
+
+    /**
+     * @brief flag this transaction as a placeholder whose payload should be rebuilt when its transmission starts
+     */
+    void mark_late_bound() {
+    	late_bound = true;
+    }
+    bool is_late_bound() {
+    	return late_bound;
+    }
+
+    /**
+     * @brief record how old the setpoint carried by this transaction was when its transmission started
+     */
+    void set_setpoint_age_cycles(uint32_t cycles) {
+    	setpoint_age_cycles = cycles;
+    }
+    uint32_t get_setpoint_age_cycles() {
+    	return setpoint_age_cycles;
+    }
 
     /**
      * @brief should be called when this is placed in a queue
@@ -201,6 +253,65 @@ public:
 	}
 
 
+    /**
+     * @brief record the system time at which this was placed in a queue
+     */
+    void stamp_enqueued(uint32_t cycles) {
+    	enqueued_cycles = cycles;
+    }
+    /**
+     * @brief record the system time at which transmission of this started
+     */
+    void stamp_sent(uint32_t cycles) {
+    	sent_cycles = cycles;
+    }
+    /**
+     * @brief record the system time at which this was received in full or abandoned
+     */
+    void stamp_finished(uint32_t cycles) {
+    	finished_cycles = cycles;
+    }
+
+    /**
+     * @brief record the system time at which the last byte of this was handed to the driver
+     */
+    void stamp_tx_end(uint32_t cycles) {
+    	tx_end_cycles = cycles;
+    }
+    /**
+     * @brief record the system time at which the first byte of the response was read
+     */
+    void stamp_rx_first(uint32_t cycles) {
+    	rx_first_cycles = cycles;
+    }
+    /**
+     * @brief record the system time at which the last byte of the response was read
+     */
+    void stamp_rx_last(uint32_t cycles) {
+    	rx_last_cycles = cycles;
+    }
+
+    uint32_t get_enqueued_cycles() { return enqueued_cycles; }
+    uint32_t get_sent_cycles() { return sent_cycles; }
+    uint32_t get_finished_cycles() { return finished_cycles; }
+    uint32_t get_tx_end_cycles() { return tx_end_cycles; }
+    uint32_t get_rx_first_cycles() { return rx_first_cycles; }
+    uint32_t get_rx_last_cycles() { return rx_last_cycles; }
+
+    /**
+     * @brief time this spent waiting in the queue before its transmission started
+     */
+    uint32_t get_queue_wait_cycles() {
+    	return sent_cycles - enqueued_cycles;
+    }
+    /**
+     * @brief time from the start of transmission until the response was received in full or abandoned
+     */
+    uint32_t get_round_trip_cycles() {
+    	return finished_cycles - sent_cycles;
+    }
+
+
     /**
      * @brief
      */
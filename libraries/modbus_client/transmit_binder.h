@@ -0,0 +1,50 @@
+/**
+ * @file transmit_binder.h
+ *
+ * @brief  Interface for rebuilding late bound transactions when their transmission starts
+ *
+ * @version 2.2.0
+
+    @copyright Copyright 2022 Iris Dynamics Ltd
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+    For questions or feedback on this file, please email <support@irisdynamics.com>.
+ */
+
+#ifndef TRANSMIT_BINDER_H_
+#define TRANSMIT_BINDER_H_
+
+#include "transaction.h"
+
+/**
+ * @class TransmitBinder
+ * @brief Implemented by applications which enqueue late bound transactions.
+ *
+ * A late bound transaction is enqueued with a complete, valid payload built from the values current at the time,
+ * so it can be sent as is if no binder is present. When its transmission is about to start, the ModbusClient
+ * hands it to the binder which may overwrite the payload with the latest values using Transaction::rebind_transmission_data().
+ * The payload length, function code and address must not change.
+ */
+class TransmitBinder {
+public:
+	virtual ~TransmitBinder() {}
+
+	/**
+	 * @brief Called from ModbusClient::run_out() immediately before the first byte of a late bound transaction is sent
+	 * @param transaction the transaction about to be transmitted
+	 * @param now_cycles the client's system time, in cycles, at which transmission starts
+	 */
+	virtual void bind_transmission(Transaction* transaction, uint32_t now_cycles) = 0;
+};
+
+#endif
@@ -0,0 +1,152 @@
+#!/usr/bin/env python3
+"""
+Regenerates the lookup tables of orca600_reg_descriptors.h from its descriptor table and orca600_memory_map.h.
+
+orca600_reg_descriptors is edited by hand when registers are added, removed or renamed in the memory map. This script then
+rewrites everything derived from it:
+ - ORCA600_REG_DESCRIPTOR_COUNT,
+ - orca600_reg_index, the descriptor of each address,
+ - orca600_reg_hash_seeds and orca600_reg_hash_slots, the perfect hash of the register names.
+
+The hash must match orca600_reg_hash() in the header. The static_asserts at the end of the header check that every
+descriptor is found by its name and address, so a header out of step with its tables doesn't compile.
+
+    python3 generate_reg_lookup.py            rewrite orca600_reg_descriptors.h
+    python3 generate_reg_lookup.py --check    exit with 1 if orca600_reg_descriptors.h isn't up to date
+"""
+
+import os
+import re
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+MEMORY_MAP = os.path.join(HERE, "orca600_memory_map.h")
+DESCRIPTORS = os.path.join(HERE, "orca600_reg_descriptors.h")
+
+HASH_BUCKETS = 128
+HASH_SLOTS = 512
+MAX_SEED = 255          # seeds are stored as u8
+
+MASK = 0xFFFFFFFF
+
+
+def reg_hash(name, seed):
+    """FNV-1a hash of a register name, perturbed by a seed; orca600_reg_hash() in the header"""
+    h = 2166136261 ^ ((seed * 0x9E3779B9) & MASK)
+    for c in name.encode("ascii"):
+        h = ((h ^ c) * 16777619) & MASK
+    return h
+
+
+def read_memory_map():
+    addresses = {}
+    for match in re.finditer(r"^#define\s+(\w+)\s+(\d+)", open(MEMORY_MAP).read(), re.M):
+        addresses[match.group(1)] = int(match.group(2))
+    return addresses
+
+
+def read_descriptors(text, addresses):
+    table = re.search(r"orca600_reg_descriptors\[ORCA600_REG_DESCRIPTOR_COUNT\] = \{\n(.*?)\n\};", text, re.S)
+    if not table:
+        sys.exit("orca600_reg_descriptors table not found")
+    descriptors = []
+    for line in table.group(1).splitlines():
+        match = re.match(r'\s*\{\s*(\w+),\s*"(\w+)",\s*(\d+),', line)
+        if not match:
+            sys.exit("can't read descriptor: " + line.strip())
+        macro, name, length = match.group(1), match.group(2), int(match.group(3))
+        if macro not in addresses:
+            sys.exit(macro + " is not in orca600_memory_map.h")
+        descriptors.append((addresses[macro], name, length))
+    return descriptors
+
+
+def build_index(descriptors, size):
+    index = [-1] * size
+    for i, (address, name, length) in enumerate(descriptors):
+        # both halves of a 32 bit value have descriptors of their own; every address in a block indexes the block
+        for a in range(address, address + (length if length > 2 else 1)):
+            if a >= size:
+                sys.exit(name + " extends past ORCA_REG_SIZE")
+            if index[a] >= 0:
+                sys.exit(name + " overlaps " + descriptors[index[a]][1])
+            index[a] = i
+    return index
+
+
+def build_hash(descriptors):
+    """Hash and displace: fill the fullest buckets first, each with the first seed which gives its names free slots"""
+    buckets = [[] for _ in range(HASH_BUCKETS)]
+    names = set()
+    for i, (address, name, length) in enumerate(descriptors):
+        if name in names:
+            sys.exit(name + " is described twice")
+        names.add(name)
+        buckets[reg_hash(name, 0) % HASH_BUCKETS].append(i)
+
+    seeds = [0] * HASH_BUCKETS
+    slots = [-1] * HASH_SLOTS
+    for bucket in sorted(range(HASH_BUCKETS), key=lambda b: (-len(buckets[b]), b)):
+        members = buckets[bucket]
+        if not members:
+            break
+        for seed in range(MAX_SEED + 1):
+            placed = [reg_hash(descriptors[i][1], seed) % HASH_SLOTS for i in members]
+            if len(set(placed)) == len(placed) and all(slots[s] < 0 for s in placed):
+                break
+        else:
+            sys.exit("no seed places bucket %d; raise ORCA600_REG_HASH_SLOTS" % bucket)
+        seeds[bucket] = seed
+        for i, s in zip(members, placed):
+            slots[s] = i
+    return seeds, slots
+
+
+def format_values(values, per_line):
+    lines = []
+    for start in range(0, len(values), per_line):
+        lines.append("\t" + ", ".join(str(v) for v in values[start:start + per_line]))
+    return ",\n".join(lines)
+
+
+def replace_table(text, declaration, values, per_line):
+    pattern = re.compile(re.escape(declaration) + r" = \{\n.*?\n\};", re.S)
+    if not pattern.search(text):
+        sys.exit(declaration + " not found")
+    return pattern.sub(lambda m: declaration + " = {\n" + format_values(values, per_line) + "\n};", text, count=1)
+
+
+def replace_define(text, name, value):
+    pattern = re.compile(r"^(#define " + name + r"\s+)\d+", re.M)
+    if not pattern.search(text):
+        sys.exit(name + " not found")
+    return pattern.sub(lambda m: m.group(1) + str(value), text, count=1)
+
+
+def main():
+    addresses = read_memory_map()
+    original = open(DESCRIPTORS).read()
+    descriptors = read_descriptors(original, addresses)
+    index = build_index(descriptors, addresses["ORCA_REG_SIZE"])
+    seeds, slots = build_hash(descriptors)
+
+    text = replace_define(original, "ORCA600_REG_DESCRIPTOR_COUNT", len(descriptors))
+    text = replace_define(text, "ORCA600_REG_HASH_BUCKETS", HASH_BUCKETS)
+    text = replace_define(text, "ORCA600_REG_HASH_SLOTS", HASH_SLOTS)
+    text = replace_table(text, "static constexpr s16 orca600_reg_index[ORCA_REG_SIZE]", index, 20)
+    text = replace_table(text, "static constexpr u8 orca600_reg_hash_seeds[ORCA600_REG_HASH_BUCKETS]", seeds, 16)
+    text = replace_table(text, "static constexpr s16 orca600_reg_hash_slots[ORCA600_REG_HASH_SLOTS]", slots, 16)
+
+    if "--check" in sys.argv[1:]:
+        if text != original:
+            print("orca600_reg_descriptors.h is out of date; run generate_reg_lookup.py")
+            return 1
+        return 0
+    if text != original:
+        with open(DESCRIPTORS, "w", newline="") as f:
+            f.write(text)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -9,5 +9,6 @@
 
 #include "orca600_memory_map.h"
 #include "orca600_registers.h"
+#include "orca600_reg_descriptors.h"
 
 #endif
@@ -0,0 +1,553 @@
+/**
+* @file orca600_reg_descriptors.h
+*
+* @brief Width, signedness, units and access of each named Orca600 register, with constant time lookup by address and by name
+*/
+
+/* This file derived from orca600_memory_map.h generated 2023-06-12 9:58:15 AM. When the memory map changes, edit orca600_reg_descriptors
+ * to match, then run generate_reg_lookup.py to rewrite the descriptor count, the address index and the name hash below. */
+
+/* Widths come from the register pairs the memory map describes as lower and upper 2 bytes; the lower half is at the lower address.
+ * Signedness, units and access are taken from the register descriptions and sections. */
+
+#ifndef ORCA600_REG_DESCRIPTORS_H_
+#define ORCA600_REG_DESCRIPTORS_H_
+
+#include "orca600_memory_map.h"
+#include "types.h"
+
+/**
+ * @struct Orca600RegDescriptor
+ * @brief What a register holds and how to assemble its value
+ */
+struct Orca600RegDescriptor {
+	typedef enum {
+		RO,		// read only; written by the motor
+		RW		// may be written by a client
+	} Access;
+
+	u16			address;
+	const char*	name;
+	u8			length;			// registers spanned; 2 for a 32 bit value, more for blocks such as KIN_MOTION_n
+	u8			bits;			// 16, or 32 for both halves of a 32 bit value
+	bool		upper_half;		// the upper 16 bits of a 32 bit value whose lower half is at address - 1
+	bool		is_signed;
+	float		scale;			// multiply the value by this to get units
+	const char*	units;
+	Access		access;
+};
+
+#define ORCA600_REG_DESCRIPTOR_COUNT	335
+
+static constexpr Orca600RegDescriptor orca600_reg_descriptors[ORCA600_REG_DESCRIPTOR_COUNT] = {
+	{ CTRL_REG_0,            "CTRL_REG_0",            1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ CTRL_REG_1,            "CTRL_REG_1",            1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ CTRL_REG_2,            "CTRL_REG_2",            1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ CTRL_REG_3,            "CTRL_REG_3",            1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ CTRL_REG_4,            "CTRL_REG_4",            1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ CTRL_REG_5,            "CTRL_REG_5",            1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ CTRL_REG_6,            "CTRL_REG_6",            1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ CTRL_REG_7,            "CTRL_REG_7",            1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ GUI_PERIOD_CMD,        "GUI_PERIOD_CMD",        1,   16, false, false, 1.0f,            "ms",      Orca600RegDescriptor::RW },
+	{ KIN_SW_TRIGGER,        "KIN_SW_TRIGGER",        1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ HBA_DUTY_CMD,          "HBA_DUTY_CMD",          1,   16, false, true,  1.0f,            "",        Orca600RegDescriptor::RW },
+	{ HBB_DUTY_CMD,          "HBB_DUTY_CMD",          1,   16, false, true,  1.0f,            "",        Orca600RegDescriptor::RW },
+	{ HBC_DUTY_CMD,          "HBC_DUTY_CMD",          1,   16, false, true,  1.0f,            "",        Orca600RegDescriptor::RW },
+	{ HBD_DUTY_CMD,          "HBD_DUTY_CMD",          1,   16, false, true,  1.0f,            "",        Orca600RegDescriptor::RW },
+	{ HBA_CURRENT_CMD,       "HBA_CURRENT_CMD",       1,   16, false, true,  1.0f,            "mA",      Orca600RegDescriptor::RW },
+	{ HBB_CURRENT_CMD,       "HBB_CURRENT_CMD",       1,   16, false, true,  1.0f,            "mA",      Orca600RegDescriptor::RW },
+	{ HBC_CURRENT_CMD,       "HBC_CURRENT_CMD",       1,   16, false, true,  1.0f,            "mA",      Orca600RegDescriptor::RW },
+	{ HBD_CURRENT_CMD,       "HBD_CURRENT_CMD",       1,   16, false, true,  1.0f,            "mA",      Orca600RegDescriptor::RW },
+	{ FORCE_CMD,             "FORCE_CMD",             2,   32, false, true,  1.0f,            "mN",      Orca600RegDescriptor::RW },
+	{ FORCE_CMD_H,           "FORCE_CMD_H",           1,   32, true,  true,  1.0f,            "mN",      Orca600RegDescriptor::RW },
+	{ POS_CMD,               "POS_CMD",               2,   32, false, true,  1.0f,            "um",      Orca600RegDescriptor::RW },
+	{ POS_CMD_H,             "POS_CMD_H",             1,   32, true,  true,  1.0f,            "um",      Orca600RegDescriptor::RW },
+	{ STATOR_CAL_VERSION,    "STATOR_CAL_VERSION",    1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ BS_GAIN_CMD,           "BS_GAIN_CMD",           1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ CS_GAIN_CMD,           "CS_GAIN_CMD",           1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ H0Z,                   "H0Z",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ H1Z,                   "H1Z",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ H2Z,                   "H2Z",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ H3Z,                   "H3Z",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ H4Z,                   "H4Z",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ H5Z,                   "H5Z",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ H6Z,                   "H6Z",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ H7Z,                   "H7Z",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ C0Z,                   "C0Z",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ C1Z,                   "C1Z",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ C2Z,                   "C2Z",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ C3Z,                   "C3Z",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ C4Z,                   "C4Z",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ C5Z,                   "C5Z",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ C6Z,                   "C6Z",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ C7Z,                   "C7Z",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ CTFN,                  "CTFN",                  1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ R0,                    "R0",                    1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ R1,                    "R1",                    1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ R2,                    "R2",                    1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ R3,                    "R3",                    1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ I0A,                   "I0A",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ I1A,                   "I1A",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ I2A,                   "I2A",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ I3A,                   "I3A",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ I4A,                   "I4A",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ I5A,                   "I5A",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ I6A,                   "I6A",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ I7A,                   "I7A",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ I0B,                   "I0B",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ I1B,                   "I1B",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ I2B,                   "I2B",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ I3B,                   "I3B",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ I4B,                   "I4B",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ I5B,                   "I5B",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ I6B,                   "I6B",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ I7B,                   "I7B",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ I0C,                   "I0C",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ I1C,                   "I1C",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ I2C,                   "I2C",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ I3C,                   "I3C",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ I4C,                   "I4C",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ I5C,                   "I5C",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ I6C,                   "I6C",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ I7C,                   "I7C",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ I0D,                   "I0D",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ I1D,                   "I1D",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ I2D,                   "I2D",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ I3D,                   "I3D",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ I4D,                   "I4D",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ I5D,                   "I5D",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ I6D,                   "I6D",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ I7D,                   "I7D",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ SHAFT_CAL_VERSION,     "SHAFT_CAL_VERSION",     1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ H0M,                   "H0M",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ H1M,                   "H1M",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ H2M,                   "H2M",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ H3M,                   "H3M",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ H4M,                   "H4M",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ H5M,                   "H5M",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ H6M,                   "H6M",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ H7M,                   "H7M",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ S45,                   "S45",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ S90,                   "S90",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ FORCE_CAL_VERSION,     "FORCE_CAL_VERSION",     1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ AAL,                   "AAL",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ BAL,                   "BAL",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ CAL,                   "CAL",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ DAL,                   "DAL",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ F30,                   "F30",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ F60,                   "F60",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ F90,                   "F90",                   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ TUNING_VERSION,        "TUNING_VERSION",        1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ CC_PGAIN,              "CC_PGAIN",              1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ CC_IGAIN,              "CC_IGAIN",              1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ CC_FGAIN,              "CC_FGAIN",              1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ CC_MAX_DUTY,           "CC_MAX_DUTY",           1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ PC_PGAIN,              "PC_PGAIN",              1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ PC_IGAIN,              "PC_IGAIN",              1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ PC_DVGAIN,             "PC_DVGAIN",             1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ PC_DEGAIN,             "PC_DEGAIN",             1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ PC_FSATU,              "PC_FSATU",              2,   32, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ PC_FSATU_H,            "PC_FSATU_H",            1,   32, true,  false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ USER_MAX_TEMP,         "USER_MAX_TEMP",         1,   16, false, false, 1.0f,            "C",       Orca600RegDescriptor::RW },
+	{ USER_MAX_FORCE,        "USER_MAX_FORCE",        2,   32, false, false, 1.0f,            "mN",      Orca600RegDescriptor::RW },
+	{ USER_MAX_FORCE_H,      "USER_MAX_FORCE_H",      1,   32, true,  false, 1.0f,            "mN",      Orca600RegDescriptor::RW },
+	{ USER_MAX_POWER,        "USER_MAX_POWER",        1,   16, false, false, 1.0f,            "W",       Orca600RegDescriptor::RW },
+	{ SAFETY_DGAIN,          "SAFETY_DGAIN",          1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ PC_SOFTSTART_PERIOD,   "PC_SOFTSTART_PERIOD",   1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ FORCE_UNITS,           "FORCE_UNITS",           1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ USR_OPT_VERSION,       "USR_OPT_VERSION",       1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ LOG_PERIOD,            "LOG_PERIOD",            1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ USER_COMMS_TIMEOUT,    "USER_COMMS_TIMEOUT",    1,   16, false, false, 1.0f,            "ms",      Orca600RegDescriptor::RW },
+	{ USR_MB_BAUD_LO,        "USR_MB_BAUD_LO",        2,   32, false, false, 1.0f,            "bps",     Orca600RegDescriptor::RW },
+	{ USR_MB_BAUD_HI,        "USR_MB_BAUD_HI",        1,   32, true,  false, 1.0f,            "bps",     Orca600RegDescriptor::RW },
+	{ FORCE_FILT,            "FORCE_FILT",            1,   16, false, false, 1.0f / 65535,    "",        Orca600RegDescriptor::RW },
+	{ POS_FILT,              "POS_FILT",              1,   16, false, false, 1.0f / 65535,    "",        Orca600RegDescriptor::RW },
+	{ USR_MB_DELAY,          "USR_MB_DELAY",          1,   16, false, false, 1.0f,            "us",      Orca600RegDescriptor::RW },
+	{ USR_MB_ADDR,           "USR_MB_ADDR",           1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ MB_RS485_MODE,         "MB_RS485_MODE",         1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ UART0_UP_RATE,         "UART0_UP_RATE",         1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ UART1_UP_RATE,         "UART1_UP_RATE",         1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ UART0_DOWN_RATE,       "UART0_DOWN_RATE",       1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ UART1_DOWN_RATE,       "UART1_DOWN_RATE",       1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ GUI_DROPPED_FRAMES,    "GUI_DROPPED_FRAMES",    1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ GUI_DROPPED_FPS,       "GUI_DROPPED_FPS",       1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ LOOP_FREQ,             "LOOP_FREQ",             1,   16, false, false, 1.0f,            "kHz",     Orca600RegDescriptor::RO },
+	{ SHAFT_CAL_COUNT,       "SHAFT_CAL_COUNT",       1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ STATOR_CAL_COUNT,      "STATOR_CAL_COUNT",      1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ MOTOR_FRAME_COUNT,     "MOTOR_FRAME_COUNT",     1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ MB_FREQ,               "MB_FREQ",               1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ GUI_PERIOD,            "GUI_PERIOD",            1,   16, false, false, 1.0f,            "ms",      Orca600RegDescriptor::RO },
+	{ SHAFT_SIGNAL_STR,      "SHAFT_SIGNAL_STR",      1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ BS_GAIN_ACT,           "BS_GAIN_ACT",           1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ CS_GAIN_ACT,           "CS_GAIN_ACT",           1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ MODE_OF_OPERATION,     "MODE_OF_OPERATION",     1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ CALIBRATION_STATUS,    "CALIBRATION_STATUS",    1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ KINEMATIC_STATUS,      "KINEMATIC_STATUS",      1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ HBA_TARGET,            "HBA_TARGET",            1,   16, false, true,  1.0f,            "",        Orca600RegDescriptor::RO },
+	{ HBB_TARGET,            "HBB_TARGET",            1,   16, false, true,  1.0f,            "",        Orca600RegDescriptor::RO },
+	{ HBC_TARGET,            "HBC_TARGET",            1,   16, false, true,  1.0f,            "",        Orca600RegDescriptor::RO },
+	{ HBD_TARGET,            "HBD_TARGET",            1,   16, false, true,  1.0f,            "",        Orca600RegDescriptor::RO },
+	{ CCA_TARGET,            "CCA_TARGET",            1,   16, false, true,  1.0f,            "mA",      Orca600RegDescriptor::RO },
+	{ CCB_TARGET,            "CCB_TARGET",            1,   16, false, true,  1.0f,            "mA",      Orca600RegDescriptor::RO },
+	{ CCC_TARGET,            "CCC_TARGET",            1,   16, false, true,  1.0f,            "mA",      Orca600RegDescriptor::RO },
+	{ CCD_TARGET,            "CCD_TARGET",            1,   16, false, true,  1.0f,            "mA",      Orca600RegDescriptor::RO },
+	{ FC_TARGET,             "FC_TARGET",             2,   32, false, true,  1.0f,            "mN",      Orca600RegDescriptor::RO },
+	{ FC_TARGET_H,           "FC_TARGET_H",           1,   32, true,  true,  1.0f,            "mN",      Orca600RegDescriptor::RO },
+	{ PC_TARGET,             "PC_TARGET",             2,   32, false, true,  1.0f,            "um",      Orca600RegDescriptor::RO },
+	{ PC_TARGET_H,           "PC_TARGET_H",           1,   32, true,  true,  1.0f,            "um",      Orca600RegDescriptor::RO },
+	{ STATOR_TEMP,           "STATOR_TEMP",           1,   16, false, false, 1.0f,            "C",       Orca600RegDescriptor::RO },
+	{ DRIVER_TEMP,           "DRIVER_TEMP",           1,   16, false, false, 1.0f,            "C",       Orca600RegDescriptor::RO },
+	{ VDD_FINAL,             "VDD_FINAL",             1,   16, false, false, 1.0f,            "V",       Orca600RegDescriptor::RO },
+	{ SHAFT_PHASE_FINAL,     "SHAFT_PHASE_FINAL",     1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ SHAFT_PIXEL,           "SHAFT_PIXEL",           2,   32, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ SHAFT_PIXEL_H,         "SHAFT_PIXEL_H",         1,   32, true,  false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ SHAFT_POS_UM,          "SHAFT_POS_UM",          2,   32, false, true,  1.0f,            "um",      Orca600RegDescriptor::RO },
+	{ SHAFT_POSITION_H,      "SHAFT_POSITION_H",      1,   32, true,  true,  1.0f,            "um",      Orca600RegDescriptor::RO },
+	{ SHAFT_SPEED_MMPS,      "SHAFT_SPEED_MMPS",      2,   32, false, true,  1.0f,            "mm/s",    Orca600RegDescriptor::RO },
+	{ SHAFT_SHEED_H,         "SHAFT_SHEED_H",         1,   32, true,  true,  1.0f,            "mm/s",    Orca600RegDescriptor::RO },
+	{ SHAFT_ACCEL_MMPSS,     "SHAFT_ACCEL_MMPSS",     2,   32, false, true,  1.0f,            "mm/s^2",  Orca600RegDescriptor::RO },
+	{ SHAFT_ACCEL_H,         "SHAFT_ACCEL_H",         1,   32, true,  true,  1.0f,            "mm/s^2",  Orca600RegDescriptor::RO },
+	{ FORCE,                 "FORCE",                 2,   32, false, true,  1.0f,            "mN",      Orca600RegDescriptor::RO },
+	{ FORCE_H,               "FORCE_H",               1,   32, true,  true,  1.0f,            "mN",      Orca600RegDescriptor::RO },
+	{ POWER,                 "POWER",                 1,   16, false, false, 1.0f,            "W",       Orca600RegDescriptor::RO },
+	{ HBA_CURRENT,           "HBA_CURRENT",           1,   16, false, true,  1.0f,            "mA",      Orca600RegDescriptor::RO },
+	{ HBB_CURRENT,           "HBB_CURRENT",           1,   16, false, true,  1.0f,            "mA",      Orca600RegDescriptor::RO },
+	{ HBC_CURRENT,           "HBC_CURRENT",           1,   16, false, true,  1.0f,            "mA",      Orca600RegDescriptor::RO },
+	{ HBD_CURRENT,           "HBD_CURRENT",           1,   16, false, true,  1.0f,            "mA",      Orca600RegDescriptor::RO },
+	{ AVG_POWER,             "AVG_POWER",             1,   16, false, false, 1.0f,            "W",       Orca600RegDescriptor::RO },
+	{ COIL_TEMP,             "COIL_TEMP",             1,   16, false, false, 1.0f,            "C",       Orca600RegDescriptor::RO },
+	{ RAW_LOCK,              "RAW_LOCK",              1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ H0_RAW,                "H0_RAW",                1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ H1_RAW,                "H1_RAW",                1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ H2_RAW,                "H2_RAW",                1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ H3_RAW,                "H3_RAW",                1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ H4_RAW,                "H4_RAW",                1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ H5_RAW,                "H5_RAW",                1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ H6_RAW,                "H6_RAW",                1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ H7_RAW,                "H7_RAW",                1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ C0_RAW,                "C0_RAW",                1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ C1_RAW,                "C1_RAW",                1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ C2_RAW,                "C2_RAW",                1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ C3_RAW,                "C3_RAW",                1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ C4_RAW,                "C4_RAW",                1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ C5_RAW,                "C5_RAW",                1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ C6_RAW,                "C6_RAW",                1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ C7_RAW,                "C7_RAW",                1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ VDD_RAW,               "VDD_RAW",               1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ T0_RAW,                "T0_RAW",                1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ T1_RAW,                "T1_RAW",                1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ T2_RAW,                "T2_RAW",                1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ T3_RAW,                "T3_RAW",                1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ PARAM_VERSION,         "PARAM_VERSION",         1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ MAX_TEMP,              "MAX_TEMP",              1,   16, false, false, 1.0f,            "C",       Orca600RegDescriptor::RO },
+	{ MIN_VOLTAGE,           "MIN_VOLTAGE",           1,   16, false, false, 1.0f,            "V",       Orca600RegDescriptor::RO },
+	{ MAX_VOLTAGE,           "MAX_VOLTAGE",           1,   16, false, false, 1.0f,            "V",       Orca600RegDescriptor::RO },
+	{ MAX_CURRENT,           "MAX_CURRENT",           1,   16, false, false, 1.0f,            "mA",      Orca600RegDescriptor::RO },
+	{ MAX_POWER,             "MAX_POWER",             1,   16, false, false, 1.0f,            "W",       Orca600RegDescriptor::RO },
+	{ SERIAL_NUMBER_LOW,     "SERIAL_NUMBER_LOW",     2,   32, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ SERIAL_NUMBER_HIGH,    "SERIAL_NUMBER_HIGH",    1,   32, true,  false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ MAJOR_VERSION,         "MAJOR_VERSION",         1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ RELEASE_STATE,         "RELEASE_STATE",         1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ REVISION_NUMBER,       "REVISION_NUMBER",       1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ COMMIT_ID_LO,          "COMMIT_ID_LO",          2,   32, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ COMMIT_ID_HI,          "COMMIT_ID_HI",          1,   32, true,  false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ CC_MIN_CURRENT,        "CC_MIN_CURRENT",        1,   16, false, false, 1.0f,            "mA",      Orca600RegDescriptor::RO },
+	{ HW_VERSION,            "HW_VERSION",            1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ PWM_FREQ,              "PWM_FREQ",              1,   16, false, false, 1.0f,            "Hz",      Orca600RegDescriptor::RO },
+	{ ADC_FREQ,              "ADC_FREQ",              1,   16, false, false, 1.0f,            "Hz",      Orca600RegDescriptor::RO },
+	{ COMMS_TIMEOUT,         "COMMS_TIMEOUT",         1,   16, false, false, 1.0f,            "ms",      Orca600RegDescriptor::RO },
+	{ STATOR_CONFIG,         "STATOR_CONFIG",         1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ ERROR_0,               "ERROR_0",               1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ ERROR_1,               "ERROR_1",               1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ RX_TDRE_ERROR,         "RX_TDRE_ERROR",         1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ RX_TC_ERROR,           "RX_TC_ERROR",           1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ TX_RDRF_ERROR,         "TX_RDRF_ERROR",         1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ ADC_DATA_COLLISION,    "ADC_DATA_COLLISION",    1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ MB_CNT0,               "MB_CNT0",               1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ MB_CNT1,               "MB_CNT1",               1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ MB_CNT2,               "MB_CNT2",               1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ MB_CNT3,               "MB_CNT3",               1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ MB_CNT4,               "MB_CNT4",               1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ MB_CNT5,               "MB_CNT5",               1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ MB_CNT6,               "MB_CNT6",               1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ MB_CNT7,               "MB_CNT7",               1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ MB_CNT8,               "MB_CNT8",               1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ MB_CNT9,               "MB_CNT9",               1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ MB_CNT10,              "MB_CNT10",              1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ MB_CNT11,              "MB_CNT11",              1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ MB_CNT12,              "MB_CNT12",              1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ MB_CNT13,              "MB_CNT13",              1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ MB_CNT14,              "MB_CNT14",              1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ MB_CNT15,              "MB_CNT15",              1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ MB_CNT16,              "MB_CNT16",              1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ MB_CNT17,              "MB_CNT17",              1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ MB_BAUD,               "MB_BAUD",               2,   32, false, false, 1.0f,            "bps",     Orca600RegDescriptor::RW },
+	{ MB_BAUD_H,             "MB_BAUD_H",             1,   32, true,  false, 1.0f,            "bps",     Orca600RegDescriptor::RW },
+	{ MB_IF_DELAY,           "MB_IF_DELAY",           1,   16, false, false, 1.0f,            "us",      Orca600RegDescriptor::RW },
+	{ MB_ADDRESS,            "MB_ADDRESS",            1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ MESSAGE_0_SIZE,        "MESSAGE_0_SIZE",        1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ MESSAGE_0,             "MESSAGE_0",             128, 16, false, false, 1.0f,            "",        Orca600RegDescriptor::RO },
+	{ HAPTIC_VERSION,        "HAPTIC_VERSION",        1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ HAPTIC_STATUS,         "HAPTIC_STATUS",         1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ CONSTANT_FORCE_MN,     "CONSTANT_FORCE_MN",     2,   32, false, true,  1.0f,            "mN",      Orca600RegDescriptor::RW },
+	{ CONSTANT_FORCE_MN_H,   "CONSTANT_FORCE_MN_H",   1,   32, true,  true,  1.0f,            "mN",      Orca600RegDescriptor::RW },
+	{ S0_GAIN_N_MM,          "S0_GAIN_N_MM",          1,   16, false, false, 1.0f,            "N/mm",    Orca600RegDescriptor::RW },
+	{ S0_CENTER_UM,          "S0_CENTER_UM",          2,   32, false, true,  1.0f,            "um",      Orca600RegDescriptor::RW },
+	{ S0_CENTER_UM_H,        "S0_CENTER_UM_H",        1,   32, true,  true,  1.0f,            "um",      Orca600RegDescriptor::RW },
+	{ S0_COUPLING,           "S0_COUPLING",           1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ S0_DEAD_ZONE_MM,       "S0_DEAD_ZONE_MM",       1,   16, false, false, 1.0f,            "mm",      Orca600RegDescriptor::RW },
+	{ S0_FORCE_SAT_N,        "S0_FORCE_SAT_N",        1,   16, false, false, 1.0f,            "N",       Orca600RegDescriptor::RW },
+	{ S1_GAIN_N_MM,          "S1_GAIN_N_MM",          1,   16, false, false, 1.0f,            "N/mm",    Orca600RegDescriptor::RW },
+	{ S1_CENTER_UM,          "S1_CENTER_UM",          2,   32, false, true,  1.0f,            "um",      Orca600RegDescriptor::RW },
+	{ S1_CENTER_UM_H,        "S1_CENTER_UM_H",        1,   32, true,  true,  1.0f,            "um",      Orca600RegDescriptor::RW },
+	{ S1_COUPLING,           "S1_COUPLING",           1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ S1_DEAD_ZONE_MM,       "S1_DEAD_ZONE_MM",       1,   16, false, false, 1.0f,            "mm",      Orca600RegDescriptor::RW },
+	{ S1_FORCE_SAT_N,        "S1_FORCE_SAT_N",        1,   16, false, false, 1.0f,            "N",       Orca600RegDescriptor::RW },
+	{ S2_GAIN_N_MM,          "S2_GAIN_N_MM",          1,   16, false, false, 1.0f,            "N/mm",    Orca600RegDescriptor::RW },
+	{ S2_CENTER_UM,          "S2_CENTER_UM",          2,   32, false, true,  1.0f,            "um",      Orca600RegDescriptor::RW },
+	{ S2_CENTER_UM_H,        "S2_CENTER_UM_H",        1,   32, true,  true,  1.0f,            "um",      Orca600RegDescriptor::RW },
+	{ S2_COUPLING,           "S2_COUPLING",           1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ S2_DEAD_ZONE_MM,       "S2_DEAD_ZONE_MM",       1,   16, false, false, 1.0f,            "mm",      Orca600RegDescriptor::RW },
+	{ S2_FORCE_SAT_N,        "S2_FORCE_SAT_N",        1,   16, false, false, 1.0f,            "N",       Orca600RegDescriptor::RW },
+	{ D0_GAIN_NS_MM,         "D0_GAIN_NS_MM",         1,   16, false, false, 1.0f,            "Ns/mm",   Orca600RegDescriptor::RW },
+	{ I0_GAIN_NS2_MM,        "I0_GAIN_NS2_MM",        1,   16, false, false, 1.0f,            "Ns^2/mm", Orca600RegDescriptor::RW },
+	{ O0_GAIN_N,             "O0_GAIN_N",             1,   16, false, false, 1.0f,            "N",       Orca600RegDescriptor::RW },
+	{ O0_TYPE,               "O0_TYPE",               1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ O0_FREQ_DHZ,           "O0_FREQ_DHZ",           1,   16, false, false, 1.0f,            "dHz",     Orca600RegDescriptor::RW },
+	{ O0_DUTY,               "O0_DUTY",               1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ O1_GAIN_N,             "O1_GAIN_N",             1,   16, false, false, 1.0f,            "N",       Orca600RegDescriptor::RW },
+	{ O1_TYPE,               "O1_TYPE",               1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ O1_FREQ_DHZ,           "O1_FREQ_DHZ",           1,   16, false, false, 1.0f,            "dHz",     Orca600RegDescriptor::RW },
+	{ O1_DUTY,               "O1_DUTY",               1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ CONST_FORCE_FILTER,    "CONST_FORCE_FILTER",    1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ ILOOP_MSG_FLAG,        "ILOOP_MSG_FLAG",        1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ ILOOP_DIN,             "ILOOP_DIN",             1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ ILOOP_OUT_CH1,         "ILOOP_OUT_CH1",         1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ ILOOP_OUT_CH2,         "ILOOP_OUT_CH2",         1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ ILOOP_IN,              "ILOOP_IN",              1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ ILOOP_SECTION_VERSION, "ILOOP_SECTION_VERSION", 1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ ILOOP_CONFIG,          "ILOOP_CONFIG",          1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ ILOOP_FORCE_MIN,       "ILOOP_FORCE_MIN",       2,   32, false, true,  1.0f,            "mN",      Orca600RegDescriptor::RW },
+	{ ILOOP_FORCE_MIN_HI,    "ILOOP_FORCE_MIN_HI",    1,   32, true,  true,  1.0f,            "mN",      Orca600RegDescriptor::RW },
+	{ ILOOP_FORCE_MAX,       "ILOOP_FORCE_MAX",       2,   32, false, true,  1.0f,            "mN",      Orca600RegDescriptor::RW },
+	{ ILOOP_FORCE_MAX_HI,    "ILOOP_FORCE_MAX_HI",    1,   32, true,  true,  1.0f,            "mN",      Orca600RegDescriptor::RW },
+	{ ILOOP_POS_MIN,         "ILOOP_POS_MIN",         2,   32, false, true,  1.0f,            "um",      Orca600RegDescriptor::RW },
+	{ ILOOP_POS_MIN_HI,      "ILOOP_POS_MIN_HI",      1,   32, true,  true,  1.0f,            "um",      Orca600RegDescriptor::RW },
+	{ ILOOP_POS_MAX,         "ILOOP_POS_MAX",         2,   32, false, true,  1.0f,            "um",      Orca600RegDescriptor::RW },
+	{ ILOOP_POS_MAX_HI,      "ILOOP_POS_MAX_HI",      1,   32, true,  true,  1.0f,            "um",      Orca600RegDescriptor::RW },
+	{ ILOOP_KIN_TYPE,        "ILOOP_KIN_TYPE",        1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ ILOOP_D0_HIGH,         "ILOOP_D0_HIGH",         1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ ILOOP_D0_LOW,          "ILOOP_D0_LOW",          1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ ILOOP_D2_HIGH,         "ILOOP_D2_HIGH",         1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ ILOOP_D2_LOW,          "ILOOP_D2_LOW",          1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ KINEMATIC_SECTION_VERSION, "KINEMATIC_SECTION_VERSION", 1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ KIN_CONFIG,            "KIN_CONFIG",            1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ KIN_MOTION_0,          "KIN_MOTION_0",          6,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ KIN_MOTION_1,          "KIN_MOTION_1",          6,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ KIN_MOTION_2,          "KIN_MOTION_2",          6,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ KIN_MOTION_3,          "KIN_MOTION_3",          6,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ KIN_MOTION_4,          "KIN_MOTION_4",          6,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ KIN_MOTION_5,          "KIN_MOTION_5",          6,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ KIN_MOTION_6,          "KIN_MOTION_6",          6,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ KIN_MOTION_7,          "KIN_MOTION_7",          6,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ KIN_MOTION_8,          "KIN_MOTION_8",          6,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ KIN_MOTION_9,          "KIN_MOTION_9",          6,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ KIN_MOTION_10,         "KIN_MOTION_10",         6,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ KIN_MOTION_11,         "KIN_MOTION_11",         6,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ KIN_MOTION_12,         "KIN_MOTION_12",         6,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ KIN_MOTION_13,         "KIN_MOTION_13",         6,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ KIN_MOTION_14,         "KIN_MOTION_14",         6,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ KIN_MOTION_15,         "KIN_MOTION_15",         6,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ KIN_MOTION_16,         "KIN_MOTION_16",         6,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ KIN_MOTION_17,         "KIN_MOTION_17",         6,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ KIN_MOTION_18,         "KIN_MOTION_18",         6,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ KIN_MOTION_19,         "KIN_MOTION_19",         6,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ KIN_MOTION_20,         "KIN_MOTION_20",         6,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ KIN_MOTION_21,         "KIN_MOTION_21",         6,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ KIN_MOTION_22,         "KIN_MOTION_22",         6,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ KIN_MOTION_23,         "KIN_MOTION_23",         6,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ KIN_MOTION_24,         "KIN_MOTION_24",         6,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ KIN_MOTION_25,         "KIN_MOTION_25",         6,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ KIN_MOTION_26,         "KIN_MOTION_26",         6,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ KIN_MOTION_27,         "KIN_MOTION_27",         6,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ KIN_MOTION_28,         "KIN_MOTION_28",         6,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ KIN_MOTION_29,         "KIN_MOTION_29",         6,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ KIN_MOTION_30,         "KIN_MOTION_30",         6,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ KIN_MOTION_31,         "KIN_MOTION_31",         6,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+	{ KIN_HOME_ID,           "KIN_HOME_ID",           1,   16, false, false, 1.0f,            "",        Orca600RegDescriptor::RW },
+};
+
+/* Index into orca600_reg_descriptors of the register at each address, or -1 for unnamed addresses.
+ * Every address within a block such as KIN_MOTION_n indexes the block. */
+static constexpr s16 orca600_reg_index[ORCA_REG_SIZE] = {
+	0, 1, 2, 3, 4, 5, 6, 7, 8, 9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, -1, 22, 23, 24, 25, 26, 27, 28,
+	29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 48,
+	49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 62, 63, 64, 65, 66, 67, 68,
+	69, 70, 71, 72, 73, 74, 75, 76, 77, -1, -1, -1, -1, -1, -1, -1, 78, 79, 80, 81,
+	82, 83, 84, 85, 86, 87, 88, -1, -1, -1, -1, -1, 89, 90, 91, 92, 93, 94, 95, 96,
+	-1, -1, -1, -1, -1, -1, -1, -1, 97, 98, 99, 100, 101, 102, 103, 104, 105, 106, 107, 108,
+	109, 110, 111, 112, -1, -1, -1, -1, -1, -1, 113, 114, -1, -1, -1, -1, -1, -1, -1, -1,
+	115, -1, 116, 117, 118, 119, 120, 121, 122, 123, 124, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, 125, 126, 127, 128, 129, 130, 131, 132, 133, 134, 135, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 136, 137, 138, 139, 140, 141, 142,
+	143, 144, 145, 146, 147, 148, 149, 150, 151, 152, 153, 154, -1, -1, -1, -1, 155, 156, 157, 158,
+	159, 160, 161, 162, 163, 164, 165, 166, 167, 168, 169, 170, 171, 172, 173, 174, 175, -1, -1, -1,
+	-1, -1, -1, -1, 176, 177, 178, 179, 180, 181, 182, 183, 184, 185, 186, 187, 188, 189, 190, 191,
+	192, 193, 194, 195, 196, 197, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	198, 199, 200, 201, 202, 203, 204, 205, 206, 207, 208, 209, 210, 211, 212, 213, 214, 215, 216, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 217, 218, 219, 220, 221, 222, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, 223, 224, 225, 226, 227, 228, 229, 230, 231, 232, 233, 234, 235, 236, 237, 238,
+	239, 240, 241, 242, 243, 244, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 245, 246, 246, 246,
+	246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246,
+	246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246,
+	246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246,
+	246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246,
+	246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246,
+	246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246,
+	246, 246, 246, 246, 246, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	247, 248, 249, 250, 251, 252, 253, 254, 255, 256, 257, 258, 259, 260, 261, 262, 263, 264, 265, 266,
+	267, 268, 269, 270, 271, 272, 273, 274, 275, 276, 277, 278, 279, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 280, 281, 282, 283, 284,
+	285, 286, 287, 288, 289, 290, 291, 292, 293, 294, 295, 296, 297, 298, 299, -1, -1, -1, 300, 301,
+	302, 302, 302, 302, 302, 302, 303, 303, 303, 303, 303, 303, 304, 304, 304, 304, 304, 304, 305, 305,
+	305, 305, 305, 305, 306, 306, 306, 306, 306, 306, 307, 307, 307, 307, 307, 307, 308, 308, 308, 308,
+	308, 308, 309, 309, 309, 309, 309, 309, 310, 310, 310, 310, 310, 310, 311, 311, 311, 311, 311, 311,
+	312, 312, 312, 312, 312, 312, 313, 313, 313, 313, 313, 313, 314, 314, 314, 314, 314, 314, 315, 315,
+	315, 315, 315, 315, 316, 316, 316, 316, 316, 316, 317, 317, 317, 317, 317, 317, 318, 318, 318, 318,
+	318, 318, 319, 319, 319, 319, 319, 319, 320, 320, 320, 320, 320, 320, 321, 321, 321, 321, 321, 321,
+	322, 322, 322, 322, 322, 322, 323, 323, 323, 323, 323, 323, 324, 324, 324, 324, 324, 324, 325, 325,
+	325, 325, 325, 325, 326, 326, 326, 326, 326, 326, 327, 327, 327, 327, 327, 327, 328, 328, 328, 328,
+	328, 328, 329, 329, 329, 329, 329, 329, 330, 330, 330, 330, 330, 330, 331, 331, 331, 331, 331, 331,
+	332, 332, 332, 332, 332, 332, 333, 333, 333, 333, 333, 333, 334
+};
+
+/* Perfect hash of register names: a name's bucket chooses the seed which places it in a slot of its own */
+#define ORCA600_REG_HASH_BUCKETS	128
+#define ORCA600_REG_HASH_SLOTS		512
+
+static constexpr u8 orca600_reg_hash_seeds[ORCA600_REG_HASH_BUCKETS] = {
+	0, 1, 0, 1, 3, 1, 6, 2, 9, 1, 1, 0, 3, 4, 0, 14,
+	0, 0, 2, 4, 2, 0, 1, 5, 1, 1, 1, 2, 1, 0, 2, 4,
+	4, 9, 0, 1, 8, 0, 5, 2, 2, 5, 1, 4, 2, 2, 2, 2,
+	11, 2, 7, 6, 7, 1, 3, 1, 3, 0, 9, 4, 2, 0, 2, 1,
+	1, 3, 1, 0, 1, 1, 0, 1, 6, 3, 0, 1, 2, 2, 0, 3,
+	1, 2, 0, 1, 3, 10, 0, 2, 3, 0, 3, 0, 3, 7, 3, 6,
+	1, 5, 0, 0, 12, 5, 3, 0, 2, 1, 4, 18, 2, 7, 2, 0,
+	0, 0, 3, 10, 2, 5, 2, 6, 13, 0, 0, 1, 0, 14, 4, 0
+};
+
+static constexpr s16 orca600_reg_hash_slots[ORCA600_REG_HASH_SLOTS] = {
+	50, 209, 181, 6, -1, -1, -1, 97, -1, -1, -1, 226, 138, 83, 324, 103,
+	-1, 297, 194, -1, -1, 23, -1, 102, 122, 41, 304, 213, 32, 300, 183, 141,
+	-1, 153, 281, 51, -1, 249, 184, -1, 334, -1, 301, -1, 104, 24, -1, 158,
+	120, 199, -1, 284, 111, 289, -1, 159, -1, 26, 33, 307, 270, 78, -1, -1,
+	63, 275, -1, -1, -1, 45, 29, 208, 168, 280, 315, -1, -1, -1, 140, -1,
+	330, -1, 121, -1, 201, 127, -1, -1, 231, -1, 273, -1, 10, 326, 75, 252,
+	144, 47, -1, -1, 247, -1, 291, 306, 80, 230, -1, 79, 108, 210, -1, 154,
+	-1, 189, 137, -1, -1, 53, 9, 148, -1, -1, 216, 323, -1, 14, -1, 149,
+	176, 98, 146, -1, -1, -1, -1, 266, 44, 126, -1, -1, 107, 76, 263, 22,
+	96, -1, -1, 118, 239, 99, 21, 290, -1, 49, -1, -1, 269, 143, -1, -1,
+	166, -1, 152, -1, 288, 81, -1, -1, 131, 286, 52, -1, 287, 296, 271, 254,
+	203, -1, 195, 283, 5, 106, 227, 250, 62, 16, 260, 150, -1, -1, 177, -1,
+	258, 85, 145, -1, -1, 74, 192, 327, 217, 278, 43, -1, -1, 257, 314, 164,
+	161, 308, 48, -1, 246, -1, 310, 282, -1, -1, 262, -1, 123, -1, 68, -1,
+	100, 317, 28, 322, -1, -1, 265, 134, 305, 303, -1, 255, -1, -1, -1, 71,
+	115, 61, 264, -1, 88, -1, 294, 91, -1, 197, 87, 113, 93, -1, -1, 277,
+	234, 18, 19, 38, -1, 160, 90, 25, 200, -1, 163, 101, -1, 112, 186, -1,
+	320, 165, 232, 193, 128, 57, -1, 67, -1, 299, 248, 295, 204, 55, -1, 84,
+	-1, 2, 147, -1, 46, 237, 187, 31, 321, 89, -1, -1, 167, -1, -1, 36,
+	172, 169, 125, 7, 293, -1, 136, 132, -1, 37, -1, 40, -1, 276, 135, 56,
+	292, 298, 130, -1, -1, 240, 261, -1, -1, -1, -1, 191, 267, -1, 316, 69,
+	82, -1, 190, 58, 13, -1, 156, 162, 325, 42, 17, -1, -1, -1, 206, 20,
+	171, 114, 251, 225, -1, 220, -1, 142, -1, 202, 119, 139, 157, 95, 214, 328,
+	117, -1, -1, -1, 151, 0, 188, 54, -1, 1, 218, 170, -1, -1, 243, 124,
+	-1, -1, 65, 211, 59, -1, 256, 236, 77, 332, 198, -1, -1, -1, 3, 224,
+	35, 279, 182, -1, 12, 318, 30, -1, -1, -1, 312, 333, -1, 86, -1, 207,
+	-1, 302, -1, 245, 272, 8, -1, 205, -1, 64, -1, -1, 222, 178, 109, 242,
+	73, 110, 60, 196, -1, 219, 285, -1, -1, 235, -1, 319, -1, 92, 155, 233,
+	66, -1, -1, 274, -1, -1, 179, -1, -1, 116, 34, 229, -1, -1, 238, 313,
+	215, -1, 72, -1, -1, 94, 212, -1, 15, 241, -1, 175, -1, -1, -1, 244,
+	-1, 268, 39, -1, -1, -1, 331, 228, 259, -1, 174, -1, -1, 329, 70, 253,
+	311, 11, 105, 27, -1, -1, -1, 180, 133, 129, 309, 221, 223, 4, 185, 173
+};
+
+constexpr u32 orca600_reg_fnv(const char* name, u32 hash) {
+	return *name == 0 ? hash : orca600_reg_fnv(name + 1, (hash ^ u8(*name)) * 16777619u);
+}
+
+/**
+ * @brief FNV-1a hash of a register name, perturbed by a seed
+ */
+constexpr u32 orca600_reg_hash(const char* name, u32 seed) {
+	return orca600_reg_fnv(name, 2166136261u ^ (seed * 0x9E3779B9u));
+}
+
+constexpr bool orca600_reg_name_equal(const char* a, const char* b) {
+	return *a == *b && (*a == 0 || orca600_reg_name_equal(a + 1, b + 1));
+}
+
+constexpr s16 orca600_reg_slot(const char* name) {
+	return orca600_reg_hash_slots[orca600_reg_hash(name, orca600_reg_hash_seeds[orca600_reg_hash(name, 0) % ORCA600_REG_HASH_BUCKETS]) % ORCA600_REG_HASH_SLOTS];
+}
+
+/**
+ * @brief Descriptor of the register at the given address, or 0 if the address is unnamed
+ */
+constexpr const Orca600RegDescriptor* orca600_reg_descriptor(u16 address) {
+	return address < ORCA_REG_SIZE && orca600_reg_index[address] >= 0 ? &orca600_reg_descriptors[orca600_reg_index[address]] : 0;
+}
+
+/**
+ * @brief Descriptor of the register with the given name, or 0 if there is none. Usable at compile time.
+ */
+constexpr const Orca600RegDescriptor* orca600_reg_descriptor(const char* name) {
+	return orca600_reg_slot(name) >= 0 && orca600_reg_name_equal(orca600_reg_descriptors[orca600_reg_slot(name)].name, name)
+		? &orca600_reg_descriptors[orca600_reg_slot(name)] : 0;
+}
+
+/**
+ * @brief Address of the register with the given name, or -1 if there is none. Usable at compile time.
+ */
+constexpr int orca600_reg_address(const char* name) {
+	return orca600_reg_descriptor(name) ? orca600_reg_descriptor(name)->address : -1;
+}
+
+/**
+ * @brief Assemble a register's value from the register contents at its address and the address above it
+ * @param descriptor the register; for the upper half of a 32 bit value, pass the lower half's descriptor
+ * @param low contents of the register at descriptor->address
+ * @param high contents of the register at descriptor->address + 1, used for 32 bit values only
+ * @return the value, sign extended if the register is signed. Unsigned 32 bit values should be cast back to u32.
+ */
+constexpr s32 orca600_reg_value(const Orca600RegDescriptor* descriptor, u16 low, u16 high) {
+	return descriptor->bits == 32
+		? s32(u32(high) << 16 | low)
+		: (descriptor->is_signed ? s32(s16(low)) : s32(low));
+}
+
+/**
+ * @brief True if every descriptor from first, for count descriptors, is found by its name and by its address.
+ * Halves the range at each step to stay well within the compilers' constexpr recursion limits.
+ */
+constexpr bool orca600_reg_lookups_match(int first, int count) {
+	return count > 1
+		? orca600_reg_lookups_match(first, count / 2) && orca600_reg_lookups_match(first + count / 2, count - count / 2)
+		: count == 0 || (orca600_reg_descriptor(orca600_reg_descriptors[first].name) == &orca600_reg_descriptors[first]
+			&& orca600_reg_descriptor(orca600_reg_descriptors[first].address) == &orca600_reg_descriptors[first]);
+}
+
+static_assert(orca600_reg_lookups_match(0, ORCA600_REG_DESCRIPTOR_COUNT), "a register isn't found by its name or address; run generate_reg_lookup.py");
+static_assert(orca600_reg_address("FORCE") == FORCE, "register name hash doesn't find FORCE");
+static_assert(orca600_reg_address("NOT_A_REGISTER") == -1, "register name hash finds a name which isn't in the table");
+
+#endif
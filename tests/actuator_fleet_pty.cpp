@@ -0,0 +1,192 @@
+/*
+ * Checks ActuatorFleet discovery and group operations across 24 pseudo terminals, each with its own SimulatedOrcaServer.
+ *
+ * Usage: actuator_fleet_pty [--timeout-ms <handshake time allowed per candidate address>]
+ *
+ * Every port is a PtyTransport whose peer side is opened by the port's server, so the actuators talk through real terminal
+ * devices. Most servers answer at address 1, every third one at address 3, and the last port has nothing connected.
+ * 1. Discovery tries addresses 1 and 3. The servers at address 3 can only be found in the second round, and the
+ *    unplugged port must be left out after both. Every other port must be registered under its server's serial number.
+ * 2. A profile applied to a group picked by serial number must be written to and verified on exactly those servers.
+ * 3. Mode changes, clearing errors and zeroing must report one queued request per connected member whose message queue
+ *    had room, so none for a member with a full queue, nor for the unplugged port even when it is selected.
+ *
+ * Returns 0 if every check passed.
+ */
+#include "modbus_client/device_applications/actuator_fleet.h"
+#include "modbus_client/device_applications/simulated_orca_server.h"
+#include "modbus_client/device_drivers/transport/pty_transport.h"
+#include <chrono>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const int PORTS = 24;
+static const int UNPLUGGED = PORTS - 1;
+static const uint32_t FIRST_SERIAL = 7000;
+static const uint16_t PROFILE_START = 200;		// unused by the Orca's memory map
+static const int PROFILE_REGISTERS = 6;
+
+static uint8_t server_address(int port) {
+	return port % 3 == 2 ? 3 : 1;
+}
+
+/**
+ * @brief The peer side of a PtyTransport, opened as it is. PtyTransport has already made it raw, and a TtyTransport
+ * can't be used: Linux pseudo terminals drop the parity bit, and some kernels then refuse to have it set again.
+ */
+class PeerTransport : public PosixFdTransport {
+public:
+	PeerTransport(const char* _path) : path(_path) {}
+
+	bool open(uint32_t) override {
+		close_fd();
+		fd = ::open(path, O_RDWR | O_NOCTTY | O_NONBLOCK);
+		return fd >= 0;
+	}
+
+	bool set_baud(uint32_t) override { return true; }
+	void flush() override {}
+
+private:
+	const char* path;
+};
+
+struct Bench {
+	PtyTransport ports[PORTS];
+	PeerTransport* lines[PORTS];
+	SimulatedOrcaServer* servers[PORTS];
+	Actuator* actuators;
+	alignas(Actuator) unsigned char storage[PORTS * sizeof(Actuator)];		// ActuatorFleet takes a contiguous array
+	char names[PORTS][16];
+	bool opened = true;
+
+	Bench() {
+		actuators = reinterpret_cast<Actuator*>(storage);
+		for (int p = 0; p < PORTS; p++) {
+			lines[p] = 0;
+			servers[p] = 0;
+			snprintf(names[p], sizeof(names[p]), "port %d", p);
+			new (&actuators[p]) Actuator(p, names[p], 1);
+			if (!ports[p].open(UART_BAUD_RATE)) opened = false;
+			actuators[p].set_transport(&ports[p]);
+			if (p == UNPLUGGED) continue;
+			lines[p] = new PeerTransport(ports[p].get_peer_path());
+			if (!lines[p]->open(UART_BAUD_RATE)) opened = false;
+			servers[p] = new SimulatedOrcaServer(lines[p], server_address(p), FIRST_SERIAL + p);
+		}
+	}
+
+	~Bench() {
+		for (int p = 0; p < PORTS; p++) {
+			actuators[p].~Actuator();
+			delete servers[p];
+			delete lines[p];
+		}
+	}
+
+	/// @brief run the fleet and every server until the fleet is done or the time is up
+	bool run(ActuatorFleet& fleet, int timeout_ms) {
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		while (std::chrono::steady_clock::now() - start < std::chrono::milliseconds(timeout_ms)) {
+			bool done = fleet.run();
+			for (int p = 0; p < PORTS; p++) if (servers[p]) servers[p]->poll();
+			if (done) return true;
+		}
+		return false;
+	}
+};
+
+static long check_discovery(Bench& bench, ActuatorFleet& fleet, int timeout_ms) {
+	const uint8_t candidates[] = { 1, 3 };
+	fleet.set_candidate_addresses(candidates, 2);
+	fleet.start_discovery(uint32_t(timeout_ms) * 1000);
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	bool finished = bench.run(fleet, 3 * timeout_ms);
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	long failures = !finished;
+	int at_address_3 = 0;
+	for (int p = 0; p < PORTS; p++) {
+		if (p == UNPLUGGED) {
+			failures += fleet.is_member(p) || fleet.get_serial_number(p) != 0 || fleet.get_server_address(p) != 0;
+			continue;
+		}
+		bool registered = fleet.is_member(p) && fleet.get_serial_number(p) == FIRST_SERIAL + p
+			&& fleet.get_server_address(p) == server_address(p) && fleet.find(FIRST_SERIAL + p) == &fleet.get_actuator(p);
+		if (!registered) {
+			printf("  port %d: member %d, serial %u, address %u\n", p, fleet.is_member(p), fleet.get_serial_number(p), (unsigned)fleet.get_server_address(p));
+			failures++;
+		}
+		at_address_3 += registered && server_address(p) == 3;
+	}
+	failures += fleet.get_member_count() != PORTS - 1 || fleet.find(FIRST_SERIAL + UNPLUGGED) != 0;
+
+	printf("discovery:  %d of %d ports registered in %.1f s, %d of them at address 3, unplugged port %s\n", fleet.get_member_count(),
+		PORTS, seconds, at_address_3, fleet.is_member(UNPLUGGED) ? "REGISTERED" : "left out");
+	return failures;
+}
+
+static long check_group_profile(Bench& bench, ActuatorFleet& fleet) {
+	// every fourth port, including ports at both addresses
+	uint32_t serials[PORTS];
+	int serial_count = 0;
+	for (int p = 0; p < PORTS; p += 4) serials[serial_count++] = FIRST_SERIAL + p;
+	ActuatorFleet::Group members = fleet.group(serials, serial_count);
+
+	RegisterProfile profile("fleet");
+	for (int r = 0; r < PROFILE_REGISTERS; r++) profile.set(uint16_t(PROFILE_START + r), uint16_t(0x5A00 + r));
+	int started = fleet.apply_profile(members, profile);
+	bool finished = bench.run(fleet, 2000);
+
+	int verified = 0, wrong = 0;
+	for (int p = 0; p < PORTS; p++) {
+		bool selected = (members >> p) & 1;
+		ActuatorProfileUpload* upload = fleet.get_upload(p);
+		if (selected != (upload != 0)) wrong++;
+		if (upload && upload->get_status() == ActuatorProfileUpload::verified) verified++;
+		if (!bench.servers[p]) continue;
+		for (int r = 0; r < PROFILE_REGISTERS; r++) {
+			uint16_t value = (*bench.servers[p])[uint16_t(PROFILE_START + r)];
+			if (value != (selected ? 0x5A00 + r : 0)) wrong++;
+		}
+	}
+	printf("profile:    %d selected, %d uploads started, %d verified, %s\n", serial_count, started, verified,
+		wrong ? "WRONG SERVERS WRITTEN" : "only the group's servers written");
+	return (started != serial_count) + !finished + (verified != serial_count) + wrong;
+}
+
+static long check_group_requests(Bench& bench, ActuatorFleet& fleet) {
+	ActuatorFleet::Group everyone = ~ActuatorFleet::Group(0);		// selects the unplugged port too
+	while (fleet.get_actuator(0).read_registers(0, 1));				// nothing more can be queued for port 0
+	int expected = fleet.get_member_count() - 1;
+	int modes = fleet.set_mode(everyone, Actuator::SleepMode);
+	int cleared = fleet.clear_errors(everyone);
+	int zeroed = fleet.zero_position(fleet.all());
+	bench.run(fleet, 200);
+
+	ActuatorFleet::Health health = fleet.get_health();
+	printf("requests:   set_mode %d, clear_errors %d, zero_position %d queued for %d members with room; %d connected\n",
+		modes, cleared, zeroed, expected, health.connected);
+	return (modes != expected) + (cleared != expected) + (zeroed != expected) + (health.connected != fleet.get_member_count());
+}
+
+int main(int argc, char* argv[]) {
+	int timeout_ms = 4000;
+	for (int i = 1; i + 1 < argc; i += 2) {
+		if (strcmp(argv[i], "--timeout-ms") == 0) timeout_ms = atoi(argv[i + 1]);
+	}
+
+	static Bench bench;
+	if (!bench.opened) {
+		printf("could not open %d pseudo terminals\nFAILED\n", PORTS);
+		return 1;
+	}
+	ActuatorFleet fleet(bench.actuators, PORTS);
+	long failures = check_discovery(bench, fleet, timeout_ms);
+	failures += check_group_profile(bench, fleet);
+	failures += check_group_requests(bench, fleet);
+	printf(failures ? "FAILED\n" : "passed\n");
+	return failures ? 1 : 0;
+}
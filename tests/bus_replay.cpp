@@ -0,0 +1,138 @@
+/*
+ * Checks that an Actuator session recorded with BusRecorder replays through BusReplayer without a single mismatch.
+ *
+ * Usage: bus_replay [--ms <simulated session length>]
+ *
+ * 1. An Actuator connects to a SimulatedOrcaServer over a MemoryTransportPair, with a BusRecorder attached before
+ *    init(). Once connected it streams force setpoints and writes and reads registers at scripted times. Its clock is
+ *    simulated and advances by a fixed step per cycle, so the session is reproducible.
+ * 2. A second Actuator replays the recording, with BusReplayer as its transport and clock, running the same script on
+ *    the same steps. Every request must match the recording byte for byte, every recorded response must be read, and
+ *    the replayed Actuator must end with the registers the recorded one received.
+ * 3. Replaying with a different force setpoint must report the bytes that differ, so the replay does compare.
+ *
+ * Returns 0 if the replay matched the recording and the altered replay didn't.
+ */
+#include "modbus_client/bus_recorder.h"
+#include "modbus_client/device_applications/actuator.h"
+#include "modbus_client/device_applications/simulated_orca_server.h"
+#include "modbus_client/device_drivers/transport/bus_replayer.h"
+#include "modbus_client/device_drivers/transport/memory_transport.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static const uint32_t STEP_US = 20;		// simulated time per cycle; the actuators count 1 cycle per microsecond
+static const uint16_t SCRATCH = 200;	// unused by the Orca's memory map
+
+/// @brief a clock advanced by the test
+class SteppedClock : public CycleClock {
+public:
+	uint32_t now = 0;
+	uint32_t get_cycles() override { return now; }
+};
+
+/**
+ * @brief What the application does on each cycle once connected, the same for the recording and the replays
+ * @param force_offset added to every force setpoint, to alter a replay
+ */
+static void script(Actuator& actuator, uint32_t cycle, int32_t force_offset) {
+	if (cycle == 0) actuator.set_mode(Actuator::ForceMode);
+	actuator.set_force_mN(int32_t(cycle % 5000) + force_offset);
+	if (cycle % 2000 == 1000) actuator.write_register(SCRATCH, uint16_t(cycle));
+	if (cycle % 2000 == 1500) actuator.read_register(SCRATCH);
+}
+
+/**
+ * @brief Run an actuator through the session: connect, then follow the script until the session ends
+ * @param advance moves the actuator's clock on by a step
+ * @param poll answers the actuator's requests, if anything has to
+ * @return false if the actuator didn't connect within the session
+ */
+template<class Advance, class Poll>
+static bool run_session(Actuator& actuator, uint32_t session_us, int32_t force_offset, Advance advance, Poll poll) {
+	actuator.init();
+	actuator.enable();
+	uint32_t connected_cycle = 0;
+	bool connected = false;
+	for (uint32_t elapsed = 0; elapsed < session_us; elapsed += STEP_US) {
+		advance();
+		actuator.run_in();
+		actuator.run_out();
+		poll();
+		if (!connected && actuator.is_connected()) {
+			connected = true;
+			connected_cycle = elapsed / STEP_US;
+		}
+		if (connected) script(actuator, elapsed / STEP_US - connected_cycle, force_offset);
+	}
+	return connected;
+}
+
+int main(int argc, char* argv[]) {
+	uint32_t session_ms = 3000;
+	for (int i = 1; i + 1 < argc; i += 2) {
+		if (strcmp(argv[i], "--ms") == 0) session_ms = strtoul(argv[i + 1], 0, 10);
+	}
+
+	char path[] = "/tmp/bus_replay_XXXXXX";
+	int fd = mkstemp(path);
+	if (fd < 0) {
+		printf("could not create a recording file\nFAILED\n");
+		return 1;
+	}
+	close(fd);
+
+	// 1. record
+	MemoryTransportPair links;
+	links.server_end.open(0);
+	SimulatedOrcaServer server(&links.server_end, 1, 4242);
+	server[POS_REG_OFFSET] = 12345;
+	server[TEMP_REG_OFFSET] = 41;
+	static Actuator recorded(0, "recorded", 1);
+	SteppedClock clock;
+	BusRecorder recorder(1);
+	recorded.set_transport(&links.client_end);
+	recorded.modbus_client.set_clock(&clock);
+	recorded.modbus_client.set_bus_tap(&recorder);
+	bool opened = recorder.open(path);
+	bool connected = run_session(recorded, session_ms * 1000, 0, [&]() { clock.now += STEP_US; recorder.flush(); }, [&]() { server.poll(); });
+	recorder.close();
+	printf("recording: %s, %u requests answered, %u events dropped\n", connected ? "connected" : "NEVER CONNECTED",
+		server.get_request_count(), recorder.get_dropped_count());
+
+	// 2. replay
+	BusReplayer replayer;
+	bool loaded = replayer.load(path);
+	static Actuator replayed(0, "replayed", 1);
+	replayed.set_transport(&replayer);
+	replayed.modbus_client.set_clock(&replayer);
+	bool replay_connected = run_session(replayed, session_ms * 1000, 0, [&]() { replayer.advance(STEP_US); }, []() {});
+	bool same_registers = true;
+	const uint16_t compared[] = { POS_REG_OFFSET, FORCE_REG_OFFSET, TEMP_REG_OFFSET, SERIAL_NUMBER_LOW, SCRATCH };
+	for (unsigned i = 0; i < sizeof(compared) / sizeof(compared[0]); i++) {
+		if (replayed.get_orca_reg_content(compared[i]) != recorded.get_orca_reg_content(compared[i])) same_registers = false;
+	}
+	uint32_t frames = replayer.get_frames_replayed(), mismatched = replayer.get_mismatched_bytes(), unread = replayer.get_unread_bytes();
+	bool finished = replayer.is_finished();
+	printf("replay:    %zu events loaded, %u of %u requests replayed, %u mismatched bytes, %u unread response bytes, %s, registers %s\n",
+		replayer.get_event_count(), frames, server.get_request_count(), mismatched, unread, finished ? "finished" : "NOT FINISHED",
+		same_registers ? "match" : "DIFFER");
+
+	// 3. an altered replay
+	replayer.rewind();
+	static Actuator altered(0, "altered", 1);
+	altered.set_transport(&replayer);
+	altered.modbus_client.set_clock(&replayer);
+	run_session(altered, session_ms * 1000, 1, [&]() { replayer.advance(STEP_US); }, []() {});
+	uint32_t altered_mismatched = replayer.get_mismatched_bytes();
+	printf("altered:   %u mismatched bytes with the force setpoints changed\n", altered_mismatched);
+	unlink(path);
+
+	long failures = !opened + !connected + (recorder.get_dropped_count() != 0) + !loaded + !replay_connected
+		+ (frames != server.get_request_count()) + (mismatched != 0) + (unread != 0) + !finished + !same_registers
+		+ (altered_mismatched == 0);
+	printf(failures ? "FAILED\n" : "passed\n");
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,171 @@
+/*
+ * Checks that ActuatorCommandQueue hands every accepted operation to the Actuator once, whole and in order, while
+ * several threads post to it and the communication thread drains it.
+ *
+ * Usage: command_queue_stress [--posts <write operations per producer>]
+ *
+ * Four producers each write a block of three registers of a SimulatedOrcaServer with a count, so the server's copy of
+ * every block must always hold three equal values which never decrease. Between writes they post setpoints, stream
+ * targets, mode changes and reads. The communication thread drains the queue into an Actuator streaming over a
+ * MemoryTransportPair, so the Actuator's message queue fills and drain() has to keep operations for later.
+ * Once the producers are done the last force and position posted must reach the server.
+ *
+ * Before that, a register write is posted while the Actuator's message queue is full, followed by a stream mode. The
+ * stream mode must not reach the Actuator before the write does.
+ *
+ * Build with -fsanitize=thread (make tsan) to also check the queue is free of data races.
+ * Returns 0 if nothing was lost, duplicated, torn or reordered.
+ */
+#include "modbus_client/device_applications/actuator_command_queue.h"
+#include "modbus_client/device_applications/simulated_orca_server.h"
+#include "modbus_client/device_drivers/transport/memory_transport.h"
+#include <atomic>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+
+static const int PRODUCERS = 4;
+static const int BLOCK_SIZE = 3;
+static const uint16_t FIRST_BLOCK = 200;		// unused by the Orca's memory map
+
+static uint16_t block_address(int producer) {
+	return uint16_t(FIRST_BLOCK + producer * (BLOCK_SIZE + 1));
+}
+
+/**
+ * @return 1 if a setpoint posted after an operation the Actuator had no room for was applied before it
+ */
+static long check_setpoints_wait_for_operations() {
+	MemoryTransportPair links;
+	links.server_end.open(0);
+	SimulatedOrcaServer server(&links.server_end, 1, 1234);
+	Actuator actuator(0, "ordering", 1);
+	actuator.set_transport(&links.client_end);
+	ActuatorCommandQueue queue;
+	actuator.init();
+	actuator.enable();
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	while (!actuator.is_connected() && std::chrono::steady_clock::now() - start < std::chrono::seconds(3)) {
+		actuator.run_in();
+		actuator.run_out();
+		server.poll();
+	}
+
+	while (actuator.read_registers(0, 1));		// fill the actuator's message queue
+	const uint16_t written = 1234;
+	queue.post_write_register(FIRST_BLOCK, written);
+	queue.post_stream_mode(Actuator::MotorRead);
+
+	// the stream mode may change in the drain that applies the write, but not before
+	long overtaken = 0, applied = 0, drains = 0;
+	start = std::chrono::steady_clock::now();
+	while (actuator.get_stream_mode() != Actuator::MotorRead && std::chrono::steady_clock::now() - start < std::chrono::seconds(1)) {
+		applied += queue.drain(actuator);
+		drains++;
+		if (actuator.get_stream_mode() == Actuator::MotorRead && !applied) overtaken++;
+		actuator.run_in();
+		actuator.run_out();
+		server.poll();
+	}
+	bool completed = actuator.get_stream_mode() == Actuator::MotorRead && applied == 1;
+	printf("ordering:      write posted to a full actuator queue applied after %ld drains, stream mode %s\n",
+		drains, overtaken ? "applied FIRST" : completed ? "applied with it" : "NEVER applied");
+	return overtaken + !completed + (drains < 2);
+}
+
+int main(int argc, char* argv[]) {
+	int posts = 3000;
+	for (int i = 1; i + 1 < argc; i += 2) {
+		if (strcmp(argv[i], "--posts") == 0) posts = atoi(argv[i + 1]);
+	}
+
+	long failures = check_setpoints_wait_for_operations();
+
+	MemoryTransportPair links;
+	links.server_end.open(0);
+	SimulatedOrcaServer server(&links.server_end, 1, 1234);
+	Actuator actuator(0, "stress", 1);
+	actuator.set_transport(&links.client_end);
+	ActuatorCommandQueue queue;
+
+	std::atomic<bool> connected(false), producing(true);
+	std::atomic<long> accepted(0);
+	long applied = 0, torn = 0, reordered = 0;
+
+	std::thread communication([&]() {
+		uint16_t last[PRODUCERS] = { 0 };
+		actuator.init();
+		actuator.enable();
+		std::chrono::steady_clock::time_point settled = std::chrono::steady_clock::now();
+		for (;;) {
+			applied += queue.drain(actuator);
+			actuator.run_in();
+			actuator.run_out();
+			server.poll();
+
+			for (int p = 0; p < PRODUCERS; p++) {
+				uint16_t count = server[block_address(p)];
+				for (int r = 1; r < BLOCK_SIZE; r++) {
+					if (server[block_address(p) + r] != count) torn++;
+				}
+				if (count < last[p]) reordered++;
+				last[p] = count;
+			}
+
+			if (!connected.load()) connected = actuator.is_connected();
+			if (producing.load()) settled = std::chrono::steady_clock::now();
+			else if (std::chrono::steady_clock::now() - settled > std::chrono::milliseconds(500)) break;
+		}
+	});
+
+	while (!connected.load()) std::this_thread::yield();
+
+	std::thread producers[PRODUCERS];
+	for (int p = 0; p < PRODUCERS; p++) {
+		producers[p] = std::thread([&, p]() {
+			for (int i = 1; i <= posts; i++) {
+				uint16_t block[BLOCK_SIZE];
+				for (int r = 0; r < BLOCK_SIZE; r++) block[r] = uint16_t(i);
+				while (!queue.post_write_registers(block_address(p), BLOCK_SIZE, block)) std::this_thread::yield();
+				accepted++;
+
+				queue.post_force_mN(i);
+				queue.post_position_um(-i);
+				queue.post_write_stream(1, block_address(p) + BLOCK_SIZE, uint32_t(i));
+				if (i % 50 == 0 && queue.post_set_mode(Actuator::SleepMode)) accepted++;
+				if (i % 70 == p && queue.post_read_registers(block_address(p), BLOCK_SIZE)) accepted++;
+			}
+		});
+	}
+	for (int p = 0; p < PRODUCERS; p++) producers[p].join();
+
+	// the last setpoints posted must be the ones applied, whatever was still waiting in the mailboxes
+	const int32_t final_force = 4321, final_position = 98765;
+	while (!queue.post_set_mode(Actuator::ForceMode)) std::this_thread::yield();
+	accepted++;
+	queue.post_force_mN(final_force);
+	std::this_thread::sleep_for(std::chrono::milliseconds(200));
+	while (!queue.post_set_mode(Actuator::PositionMode)) std::this_thread::yield();
+	accepted++;
+	queue.post_position_um(final_position);
+	std::this_thread::sleep_for(std::chrono::milliseconds(200));
+	producing = false;
+	communication.join();
+	uint32_t server_force = (uint32_t(server[FORCE_REG_H_OFFSET]) << 16) | server[FORCE_REG_OFFSET];
+	uint32_t server_position = (uint32_t(server[POS_REG_H_OFFSET]) << 16) | server[POS_REG_OFFSET];
+
+	failures += torn + reordered + (applied != accepted.load())
+		+ (int32_t(server_force) != final_force) + (int32_t(server_position) != final_position);
+	bool blocks_complete = true;
+	for (int p = 0; p < PRODUCERS; p++) blocks_complete = blocks_complete && server[block_address(p)] == uint16_t(posts);
+	failures += !blocks_complete;
+
+	printf("command queue: %ld accepted, %ld applied, %u rejected while full, %ld torn, %ld reordered, last blocks %s\n",
+		accepted.load(), applied, queue.get_dropped_count(), torn, reordered, blocks_complete ? "complete" : "INCOMPLETE");
+	printf("               server force %d (posted %d), position %d (posted %d)\n",
+		int32_t(server_force), final_force, int32_t(server_position), final_position);
+	printf(failures ? "FAILED\n" : "passed\n");
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,135 @@
+/*
+ * Checks how an Actuator recovers a lost link: by fast resume when the same server still answers, and by the full
+ * handshake when a different server answers or none does before the resume times out.
+ *
+ * Usage: fast_resume [--timeout-ms <time allowed for each recovery>]
+ *
+ * The Actuator talks to a SimulatedOrcaServer over a MemoryTransportPair. Each case stops the server answering until
+ * the Actuator gives the link up and starts resuming, then:
+ * 1. the same server answers again: the connection must be restored as a fast resume, with no fallback;
+ * 2. a server with another serial number answers on the same link: the resume must fall back, and the full handshake
+ *    must connect to the new server;
+ * 3. nothing answers for longer than resume_timeout_us: the resume must fall back, and the full handshake must connect
+ *    once the server answers again.
+ *
+ * Returns 0 if every recovery took the expected path.
+ */
+#include "modbus_client/device_applications/actuator.h"
+#include "modbus_client/device_applications/simulated_orca_server.h"
+#include "modbus_client/device_drivers/transport/memory_transport.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const uint32_t FIRST_SERIAL = 1111;
+static const uint32_t SECOND_SERIAL = 2222;
+
+struct Link {
+	MemoryTransportPair links;
+	SimulatedOrcaServer* server;
+	Actuator actuator;
+
+	Link() : actuator(0, "resume", 1) {
+		links.server_end.open(0);
+		server = new SimulatedOrcaServer(&links.server_end, 1, FIRST_SERIAL);
+		actuator.set_transport(&links.client_end);
+	}
+
+	~Link() {
+		delete server;
+	}
+
+	/// @brief run the actuator and server until the actuator reaches the state or the time is up
+	bool run_until(IrisClientApplication::ConnectionStatus state, int timeout_ms) {
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		while (std::chrono::steady_clock::now() - start < std::chrono::milliseconds(timeout_ms)) {
+			actuator.run_in();
+			actuator.run_out();
+			server->poll();
+			if (actuator.connection_state == state) return true;
+		}
+		return false;
+	}
+
+	/// @brief run the actuator and server for a while whatever the actuator's state
+	void run_for(int ms) {
+		run_until(IrisClientApplication::ConnectionStatus(0), ms);
+	}
+
+	/// @brief stop the server answering until the actuator gives the link up
+	bool lose_link(int timeout_ms) {
+		server->set_responding(false);
+		return run_until(IrisClientApplication::resuming, timeout_ms);
+	}
+
+	uint32_t get_serial_number() {
+		return (uint32_t(actuator.get_orca_reg_content(SERIAL_NUMBER_HIGH)) << 16) | actuator.get_orca_reg_content(SERIAL_NUMBER_LOW);
+	}
+};
+
+/**
+ * @return the failures among the recovery counts expected so far
+ */
+static long check_counts(Link& link, uint32_t fast, uint32_t full, uint32_t fallbacks) {
+	const RecoveryStats& stats = link.actuator.get_recovery_stats();
+	printf("            %u fast resumes, %u full handshakes, %u fallbacks; connected to serial %u\n",
+		stats.get_count(RecoveryStats::fast_resume), stats.get_count(RecoveryStats::full_handshake), stats.get_fallback_count(), link.get_serial_number());
+	return (stats.get_count(RecoveryStats::fast_resume) != fast) + (stats.get_count(RecoveryStats::full_handshake) != full)
+		+ (stats.get_fallback_count() != fallbacks);
+}
+
+static long check_same_server(Link& link, int timeout_ms) {
+	bool lost = link.lose_link(timeout_ms);
+	link.server->set_responding(true);
+	bool resumed = link.run_until(IrisClientApplication::connected, timeout_ms);
+	printf("same:       link %s, %s\n", lost ? "lost" : "NEVER LOST", resumed ? "reconnected" : "NOT RECONNECTED");
+	return !lost + !resumed + check_counts(link, 1, 0, 0) + (link.get_serial_number() != FIRST_SERIAL);
+}
+
+static long check_different_server(Link& link, int timeout_ms) {
+	bool lost = link.lose_link(timeout_ms);
+	delete link.server;
+	link.server = new SimulatedOrcaServer(&link.links.server_end, 1, SECOND_SERIAL);
+	bool fell_back = link.run_until(IrisClientApplication::disconnected, timeout_ms);
+	bool reconnected = link.run_until(IrisClientApplication::connected, timeout_ms);
+	printf("different:  link %s, resume %s, %s\n", lost ? "lost" : "NEVER LOST", fell_back ? "abandoned" : "NOT ABANDONED",
+		reconnected ? "reconnected" : "NOT RECONNECTED");
+	return !lost + !fell_back + !reconnected + check_counts(link, 1, 1, 1) + (link.get_serial_number() != SECOND_SERIAL);
+}
+
+static long check_timeout(Link& link, int timeout_ms) {
+	bool lost = link.lose_link(timeout_ms);
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	bool fell_back = link.run_until(IrisClientApplication::disconnected, timeout_ms);
+	double waited_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	link.run_for(50);
+	link.server->set_responding(true);
+	bool reconnected = link.run_until(IrisClientApplication::connected, timeout_ms);
+	uint32_t resume_timeout_ms = link.actuator.connection_config.resume_timeout_us / 1000;
+	printf("timeout:    link %s, resume %s after %.0f ms (timeout %u ms), %s\n", lost ? "lost" : "NEVER LOST",
+		fell_back ? "abandoned" : "NOT ABANDONED", waited_ms, resume_timeout_ms, reconnected ? "reconnected" : "NOT RECONNECTED");
+	return !lost + !fell_back + (waited_ms < resume_timeout_ms / 2) + !reconnected + check_counts(link, 1, 2, 2);
+}
+
+int main(int argc, char* argv[]) {
+	int timeout_ms = 3000;
+	for (int i = 1; i + 1 < argc; i += 2) {
+		if (strcmp(argv[i], "--timeout-ms") == 0) timeout_ms = atoi(argv[i + 1]);
+	}
+
+	static Link link;
+	link.actuator.init();
+	link.actuator.enable();
+	bool connected = link.run_until(IrisClientApplication::connected, timeout_ms);
+	printf("connect:    %s to serial %u\n", connected ? "connected" : "NOT CONNECTED", link.get_serial_number());
+	if (!connected) {
+		printf("FAILED\n");
+		return 1;
+	}
+	long failures = check_same_server(link, timeout_ms);
+	failures += check_different_server(link, timeout_ms);
+	failures += check_timeout(link, timeout_ms);
+	printf(failures ? "FAILED\n" : "passed\n");
+	return failures ? 1 : 0;
+}
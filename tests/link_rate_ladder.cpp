@@ -0,0 +1,190 @@
+/*
+ * Checks the steps LinkRateSelector takes down and up a ladder of link rates for scripted error rates.
+ *
+ * Usage: link_rate_ladder
+ *
+ * Each step of the ladder is given an error rate, and frames recorded at a step fail evenly spaced at that rate, so
+ * every window of frames has a known number of errors.
+ * 1. With 5%, 1%, 0.1% and 0% CRC errors on four steps and a 0.5% target, the trials must probe down to the third
+ *    step and keep it. Trying the second step again must fail and return to the third, each time after twice as many
+ *    passing windows as the last, up to MAX_BACKOFF times the configured count.
+ * 2. A kept step must only be left after degrade_windows consecutive failed windows, for a slower step on trial.
+ * 3. link_lost() must abandon a step on trial, doubling the backoff when that step was an upgrade, and leave a kept
+ *    step or the slowest step alone.
+ * 4. CRC errors, timeouts and other reception errors must be counted apart.
+ *
+ * Returns 0 if every step change came when expected.
+ */
+#include "modbus_client/link_rate_selector.h"
+#include <stdio.h>
+
+static const LinkRateSelector::Step LADDER[] = {
+	{ 2000000, 40 },
+	{ 1250000, 60 },
+	{ 625000, 80 },
+	{ 115200, 150 },
+};
+static const int STEPS = sizeof(LADDER) / sizeof(LADDER[0]);
+
+static LinkRateSelector::Config test_config() {
+	LinkRateSelector::Config config;
+	config.max_error_rate = 0.005;
+	config.window_frames = 1000;
+	config.degrade_windows = 2;
+	config.upgrade_windows = 3;
+	return config;
+}
+
+/**
+ * @brief Record a window of frames at the selector's current step, failing frames with the error at that step's rate
+ * @return true if the step changed
+ */
+static bool send_window(LinkRateSelector& selector, const double* error_rates, Transaction::error_id error = Transaction::CRC_ERROR) {
+	static Transaction transaction;
+	bool changed = false;
+	for (int i = 0; i < selector.get_config().window_frames; i++) {
+		int step = selector.get_step_index();
+		uint32_t sent = selector.get_step_stats(step).frames;
+		transaction.reset_transaction();
+		if (uint32_t((sent + 1) * error_rates[step]) != uint32_t(sent * error_rates[step])) transaction.invalidate(error);
+		changed = selector.record(&transaction) || changed;
+	}
+	return changed;
+}
+
+/// @return the windows sent until one changed the step, that one included, or 0 if none did within the limit
+static int windows_until_change(LinkRateSelector& selector, const double* error_rates, int limit = 1000) {
+	for (int windows = 1; windows <= limit; windows++) {
+		if (send_window(selector, error_rates)) return windows;
+	}
+	return 0;
+}
+
+static long check_probe_and_backoff() {
+	const double error_rates[STEPS] = { 0.05, 0.01, 0.001, 0 };
+	LinkRateSelector selector;
+	selector.set_config(test_config());
+	selector.set_ladder(LADDER, STEPS);
+
+	long failures = 0;
+	for (int window = 0; window < 3; window++) send_window(selector, error_rates);
+	bool probed = selector.get_step_index() == 2 && !selector.is_on_trial() && selector.get_step_change_count() == 2
+		&& selector.get_step().baud_rate_bps == LADDER[2].baud_rate_bps;
+	failures += !probed;
+	for (int step = 0; step < 3; step++) {
+		LinkRateSelector::StepStats stats = selector.get_step_stats(step);
+		uint32_t expected_errors = uint32_t(1000 * error_rates[step] + 0.5);
+		if (stats.frames != 1000 || stats.crc_errors != expected_errors || stats.failed_windows != (step < 2)
+			|| stats.passed_windows != (step == 2)) {
+			printf("  step %d: %u frames, %u crc errors, %u failed and %u passed windows\n", step, stats.frames, stats.crc_errors,
+				stats.failed_windows, stats.passed_windows);
+			failures++;
+		}
+	}
+	printf("probe:      5%%, 1%%, 0.1%%, 0%% errors: %s step %d after %u changes\n", probed ? "kept" : "WRONG STEP,",
+		selector.get_step_index(), selector.get_step_change_count());
+
+	// each upgrade trial fails; the passing windows before the next one double until capped
+	const int ATTEMPTS = 9;
+	uint32_t expected = test_config().upgrade_windows;
+	printf("backoff:    passing windows before each upgrade trial:");
+	for (int attempt = 0; attempt < ATTEMPTS; attempt++) {
+		uint32_t windows = windows_until_change(selector, error_rates);
+		bool upgraded = selector.get_step_index() == 1 && selector.is_on_trial();
+		bool returned = send_window(selector, error_rates) && selector.get_step_index() == 2 && !selector.is_on_trial();
+		printf(" %u", windows);
+		failures += (windows != expected) + !upgraded + !returned;
+		if (expected < uint32_t(test_config().upgrade_windows) * LinkRateSelector::MAX_BACKOFF) expected *= 2;
+	}
+	printf("%s\n", failures ? " WRONG" : "");
+	return failures;
+}
+
+static long check_step_down() {
+	double error_rates[STEPS] = { 0, 0, 0, 0 };
+	LinkRateSelector selector;
+	selector.set_config(test_config());
+	selector.set_ladder(LADDER, STEPS);
+	send_window(selector, error_rates);
+	long failures = selector.get_step_index() != 0 || selector.is_on_trial();
+
+	// a failed window between passing ones doesn't add up to a step down
+	error_rates[0] = 0.01;
+	failures += send_window(selector, error_rates);
+	error_rates[0] = 0;
+	failures += send_window(selector, error_rates);
+	error_rates[0] = 0.01;
+	failures += send_window(selector, error_rates);
+	bool held = selector.get_step_index() == 0;
+
+	// the second consecutive one does
+	bool stepped = send_window(selector, error_rates) && selector.get_step_index() == 1 && selector.is_on_trial();
+	bool kept = !send_window(selector, error_rates) && selector.get_step_index() == 1 && !selector.is_on_trial();
+
+	// a step down isn't a failed upgrade, so the next upgrade isn't backed off
+	error_rates[0] = 0;
+	int windows = windows_until_change(selector, error_rates);
+	bool upgraded = selector.get_step_index() == 0 && windows == test_config().upgrade_windows;
+	printf("step down:  %s a single failed window, %s after %d, %s; upgrade after %d passing windows\n", held ? "held after" : "LEFT AFTER",
+		stepped ? "stepped down" : "DIDN'T STEP DOWN", test_config().degrade_windows, kept ? "slower step kept" : "SLOWER STEP NOT KEPT", windows);
+	return failures + !held + !stepped + !kept + !upgraded;
+}
+
+static long check_link_lost() {
+	const double error_rates[STEPS] = { 0, 0, 0, 0 };
+	LinkRateSelector selector;
+	selector.set_config(test_config());
+	selector.set_ladder(LADDER, STEPS);
+
+	// a lost link abandons the step on trial
+	bool abandoned = selector.link_lost() && selector.get_step_index() == 1 && selector.is_on_trial();
+	send_window(selector, error_rates);
+	bool kept = !selector.link_lost() && selector.get_step_index() == 1;
+
+	// and an upgrade on trial, backing off the next one
+	int windows = windows_until_change(selector, error_rates);
+	bool upgrade_abandoned = selector.get_step_index() == 0 && selector.link_lost() && selector.get_step_index() == 1 && !selector.is_on_trial();
+	windows = windows_until_change(selector, error_rates);
+	bool backed_off = selector.get_step_index() == 0 && windows == 2 * test_config().upgrade_windows;
+
+	// nothing is slower than the last step
+	LinkRateSelector single;
+	single.set_ladder(LADDER, 1);
+	bool slowest_kept = !single.link_lost() && single.get_step_index() == 0 && !single.is_on_trial();
+
+	LinkRateSelector none;
+	bool no_ladder = !none.link_lost();
+
+	printf("link lost:  trial step %s, kept step %s, upgrade trial %s, next upgrade after %d windows, slowest step %s\n",
+		abandoned ? "abandoned" : "NOT ABANDONED", kept ? "kept" : "ABANDONED", upgrade_abandoned ? "abandoned" : "NOT ABANDONED",
+		windows, slowest_kept ? "kept" : "ABANDONED");
+	return !abandoned + !kept + !upgrade_abandoned + !backed_off + !slowest_kept + !no_ladder;
+}
+
+static long check_error_kinds() {
+	LinkRateSelector selector;
+	selector.set_ladder(LADDER, STEPS);
+	const Transaction::error_id errors[] = { Transaction::CRC_ERROR, Transaction::RESPONSE_TIMEOUT_ERROR, Transaction::RESPONSE_TIMEOUT_ERROR,
+		Transaction::R_OVERRUN_ERROR, Transaction::INTERCHAR_TIMEOUT_ERROR, Transaction::UNEXPECTED_RESPONDER };
+	Transaction transaction;
+	for (unsigned i = 0; i < sizeof(errors) / sizeof(errors[0]); i++) {
+		transaction.reset_transaction();
+		transaction.invalidate(errors[i]);
+		selector.record(&transaction);
+	}
+	transaction.reset_transaction();
+	selector.record(&transaction);
+
+	LinkRateSelector::StepStats stats = selector.get_step_stats(0);
+	printf("errors:     %u frames: %u crc errors, %u timeouts, %u other errors\n", stats.frames, stats.crc_errors, stats.timeouts, stats.other_errors);
+	return (stats.frames != 7) + (stats.crc_errors != 1) + (stats.timeouts != 2) + (stats.other_errors != 3);
+}
+
+int main() {
+	long failures = check_probe_and_backoff();
+	failures += check_step_down();
+	failures += check_link_lost();
+	failures += check_error_kinds();
+	printf(failures ? "FAILED\n" : "passed\n");
+	return failures ? 1 : 0;
+}
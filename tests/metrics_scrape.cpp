@@ -0,0 +1,150 @@
+/*
+ * Checks that Metrics_Http_Server and write_metrics_file() expose exactly what Metrics_Registry renders.
+ *
+ * Usage: metrics_scrape [--scrapes <n>]
+ *
+ * 1. A thread keeps updating a counter, a labelled gauge and a histogram while /metrics is scraped over loopback
+ *    HTTP. Every scrape must be a 200 response whose Content-Length matches its body, in the text format, with the
+ *    counter never going backwards between scrapes.
+ * 2. Other paths get a 404.
+ * 3. Once the updates stop, a scrape and the file written by write_metrics_file() must both equal render(), and no
+ *    temporary file may be left behind.
+ * 4. After stop() the port no longer accepts connections.
+ *
+ * POSIX only, like the rest of these checks. Build with -fsanitize=thread (make tsan) to also check that rendering
+ * from the server thread while the metrics are updated is free of data races.
+ * Returns 0 if every check passed.
+ */
+#include "irisSDK_libraries/Metrics_Exporter.h"
+#include <arpa/inet.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/**
+ * @brief Send a GET request to the loopback port and read the response until the server closes the connection
+ * @return false if the connection was refused
+ */
+static bool http_get(uint16_t port, const char* path, std::string& response) {
+	response.clear();
+	int fd = socket(AF_INET, SOCK_STREAM, 0);
+	if (fd < 0) return false;
+	sockaddr_in addr = {};
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	addr.sin_port = htons(port);
+	if (connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+		close(fd);
+		return false;
+	}
+	std::string request = std::string("GET ") + path + " HTTP/1.1\r\nHost: localhost\r\nUser-Agent: metrics_scrape\r\n\r\n";
+	send(fd, request.data(), request.size(), 0);
+	char buffer[4096];
+	ssize_t n;
+	while ((n = recv(fd, buffer, sizeof(buffer), 0)) > 0) response.append(buffer, n);
+	close(fd);
+	return true;
+}
+
+/**
+ * @brief Split a response into its status line and body, checking the Content-Length header against the body
+ */
+static bool parse_response(const std::string& response, std::string& status, std::string& body) {
+	size_t line_end = response.find("\r\n");
+	size_t headers_end = response.find("\r\n\r\n");
+	if (line_end == std::string::npos || headers_end == std::string::npos) return false;
+	status = response.substr(0, line_end);
+	body = response.substr(headers_end + 4);
+	size_t length = response.find("Content-Length: ");
+	return length != std::string::npos && length < headers_end && strtoul(response.c_str() + length + 16, 0, 10) == body.size();
+}
+
+/// @brief the value of the sample line starting with the given series, or -1 if there is none
+static double sample_value(const std::string& body, const std::string& series) {
+	size_t at = body.find("\n" + series + " ");
+	return at == std::string::npos ? -1 : atof(body.c_str() + at + series.size() + 2);
+}
+
+int main(int argc, char* argv[]) {
+	int scrapes = 200;
+	for (int i = 1; i + 1 < argc; i += 2) {
+		if (strcmp(argv[i], "--scrapes") == 0) scrapes = atoi(argv[i + 1]);
+	}
+
+	Metrics_Registry registry;
+	Metric_Counter& frames = registry.counter("frames_total", "Frames exchanged");
+	Metric_Gauge& force = registry.gauge("force_newtons", "Measured force", { { "actuator", "Orca \"A\"" } });
+	Metric_Histogram& round_trip = registry.histogram("round_trip_seconds", "Round trip time", { 0.001, 0.002, 0.005 });
+
+	Metrics_Http_Server server(registry);
+	if (!server.start(0)) {
+		printf("could not bind a loopback port\nFAILED\n");
+		return 1;
+	}
+
+	std::atomic<bool> updating(true);
+	std::thread producer([&]() {
+		for (uint64_t i = 0; updating.load(); i++) {
+			frames.inc();
+			force.set(double(i % 1000) / 10);
+			round_trip.observe(double(i % 7) / 1000);
+		}
+	});
+
+	// 1. scrapes while the metrics change
+	long bad_responses = 0, backwards = 0;
+	double last_frames = 0;
+	for (int i = 0; i < scrapes; i++) {
+		std::string response, status, body;
+		if (!http_get(server.get_port(), "/metrics", response) || !parse_response(response, status, body)
+			|| status != "HTTP/1.1 200 OK" || body.find("# TYPE frames_total counter\n") == std::string::npos
+			|| body.find("force_newtons{actuator=\"Orca \\\"A\\\"\"} ") == std::string::npos
+			|| body.find("round_trip_seconds_bucket{le=\"+Inf\"} ") == std::string::npos) {
+			bad_responses++;
+			continue;
+		}
+		double value = sample_value(body, "frames_total");
+		if (value < last_frames) backwards++;
+		last_frames = value;
+	}
+	updating = false;
+	producer.join();
+	printf("scrapes:    %d while updating, %ld malformed, %ld with the counter going backwards, last count %.0f\n",
+		scrapes, bad_responses, backwards, last_frames);
+
+	// 2. anything but /metrics
+	std::string response, status, body;
+	bool not_found = http_get(server.get_port(), "/", response) && parse_response(response, status, body) && status == "HTTP/1.1 404 Not Found";
+
+	// 3. a quiet registry is served and written exactly as rendered
+	std::string rendered = registry.render();
+	bool served = http_get(server.get_port(), "/metrics?x=1", response) && parse_response(response, status, body) && body == rendered;
+
+	char path[] = "/tmp/metrics_scrape_XXXXXX";
+	int fd = mkstemp(path);
+	if (fd >= 0) close(fd);
+	std::string file_text;
+	bool written = fd >= 0 && write_metrics_file(registry, path);
+	if (FILE* file = fopen(path, "rb")) {
+		char buffer[4096];
+		size_t n;
+		while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0) file_text.append(buffer, n);
+		fclose(file);
+	}
+	bool temp_left = access((std::string(path) + ".tmp").c_str(), F_OK) == 0;
+	unlink(path);
+	written = written && file_text == rendered && !temp_left;
+	printf("exposition: 404 elsewhere %s, scrape %s render(), file %s render()\n", not_found ? "yes" : "NO",
+		served ? "equals" : "DIFFERS FROM", written ? "equals" : "DIFFERS FROM");
+
+	// 4. nothing listens after stop()
+	uint16_t port = server.get_port();
+	server.stop();
+	bool stopped = !http_get(port, "/metrics", response);
+	printf("stop:       port %u %s\n", port, stopped ? "closed" : "STILL ACCEPTING");
+
+	long failures = bad_responses + backwards + (last_frames <= 0) + !not_found + !served + !written + !stopped;
+	printf(failures ? "FAILED\n" : "passed\n");
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,73 @@
+/*
+ * Times decoding stream responses with the Actuator's layouts against the switch run_in() used before them.
+ *
+ * Usage: response_decoder_bench [--passes <n>]
+ *
+ * Motor command, read and write responses are decoded in turn, into a bare register array and into the Actuator's
+ * register cache, by the switch, by the compile time layouts run_in() uses (StaticResponseDecoder) and by the same
+ * layouts read from a table (ResponseDecoder). Build with optimisation (the Makefile uses -O2); the figures are per frame.
+ */
+#include "modbus_client/device_applications/actuator.h"
+#include "stream_responses.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief A register store doing no more than storing the value
+ */
+struct RegisterArray {
+	uint16_t values[ORCA_REG_SIZE];
+	void set(uint16_t address, uint16_t value, uint32_t) {
+		if (address < ORCA_REG_SIZE) values[address] = value;
+	}
+};
+
+static const int FRAMES = 3000;
+static Transaction frames[FRAMES];
+
+template <class Store, class Decode>
+static double time_decoding(Store& store, int passes, Decode decode) {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (int pass = 0; pass < passes; pass++) {
+		for (int i = 0; i < FRAMES; i++) decode(&frames[i], store, uint32_t(pass));
+	}
+	double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+	return ns / (double(passes) * FRAMES);
+}
+
+int main(int argc, char* argv[]) {
+	int passes = 1000;
+	for (int i = 1; i + 1 < argc; i += 2) {
+		if (strcmp(argv[i], "--passes") == 0) passes = atoi(argv[i + 1]);
+	}
+
+	static const uint8_t function_codes[] = { 100, 104, 105 };
+	std::mt19937 random(1);
+	for (int i = 0; i < FRAMES; i++) {
+		uint8_t function_code = function_codes[i % 3];
+		load_frame(frames[i], function_code, function_code, get_response_length(function_code), random);
+	}
+
+	const ResponseDecoder decoder(Actuator::get_response_layouts(), Actuator::RESPONSE_LAYOUT_COUNT);
+	static RegisterArray array;
+	static Actuator::OrcaRegisterCache cache(1);
+	long decoded = 0;
+
+	// twice, so the first round warms the caches
+	for (int round = 0; round < 2; round++) {
+		double array_switch = time_decoding(array, passes, [](Transaction* t, RegisterArray& s, uint32_t c) { decode_by_hand(t, s, c); });
+		double array_static = time_decoding(array, passes, [&](Transaction* t, RegisterArray& s, uint32_t c) { decoded += Actuator::decode_stream_response(t, s, c); });
+		double array_table = time_decoding(array, passes, [&](Transaction* t, RegisterArray& s, uint32_t c) { decoded += decoder.decode(t, s, c); });
+		double cache_switch = time_decoding(cache, passes, [](Transaction* t, Actuator::OrcaRegisterCache& s, uint32_t c) { decode_by_hand(t, s, c); });
+		double cache_static = time_decoding(cache, passes, [&](Transaction* t, Actuator::OrcaRegisterCache& s, uint32_t c) { decoded += Actuator::decode_stream_response(t, s, c); });
+		double cache_table = time_decoding(cache, passes, [&](Transaction* t, Actuator::OrcaRegisterCache& s, uint32_t c) { decoded += decoder.decode(t, s, c); });
+		if (!round) continue;
+		printf("register array:  switch %6.1f ns/frame, compile time layouts %6.1f ns/frame, layout table %6.1f ns/frame\n", array_switch, array_static, array_table);
+		printf("register cache:  switch %6.1f ns/frame, compile time layouts %6.1f ns/frame, layout table %6.1f ns/frame\n", cache_switch, cache_static, cache_table);
+	}
+
+	// every frame is well formed, so every decode must have succeeded
+	return decoded == 2L * 2 * 2 * passes * FRAMES ? 0 : 1;
+}
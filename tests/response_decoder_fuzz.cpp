@@ -0,0 +1,258 @@
+/*
+ * Checks that ResponseDecoder, StaticResponseDecoder and Actuator::run_in() store exactly what the hand written decoding they replaced stored
+ * for well formed responses, and never store anything from beyond the bytes a malformed response carries.
+ *
+ * Usage: response_decoder_fuzz [--frames <n>] [--reads <n>] [--seed <n>]
+ *
+ * 1. Well formed motor command, read and write stream responses are decoded with the Actuator's layouts, both at compile
+ *    time and from a table, and with the switch run_in() used before the layouts; the registers stored must be identical.
+ * 2. Random frames, decoded both ways, with lengths from 0 to 39 bytes, random function codes and requests for other function codes, must
+ *    be decoded exactly as the switch decodes a well formed response when they answer their request and are long enough,
+ *    and must store nothing otherwise. The Transaction is reused, so a decoder reading past a short frame finds the
+ *    bytes of an earlier one.
+ * 3. decode_registers() and decode_fields() must store only what fits in the bytes available.
+ * 4. An Actuator is sent read holding registers responses, with valid CRCs, whose byte counts and lengths disagree with
+ *    each other and with the request. Only the registers whose bytes are present in the frame may change.
+ *
+ * Returns 0 if every check passed.
+ */
+#include "modbus_client/device_applications/actuator.h"
+#include "modbus_client/device_drivers/transport/memory_transport.h"
+#include "stream_responses.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+
+/**
+ * @brief A register store recording which registers were set, and any set outside the memory map
+ */
+struct RecordingStore {
+	uint16_t values[ORCA_REG_SIZE];
+	bool written[ORCA_REG_SIZE];
+	int outside;
+
+	RecordingStore() { clear(); }
+
+	void clear() {
+		memset(values, 0, sizeof(values));
+		memset(written, 0, sizeof(written));
+		outside = 0;
+	}
+
+	void set(uint16_t address, uint16_t value, uint32_t) {
+		if (address >= ORCA_REG_SIZE) {
+			outside++;
+			return;
+		}
+		values[address] = value;
+		written[address] = true;
+	}
+
+	bool operator==(const RecordingStore& other) const {
+		return outside == other.outside && !memcmp(values, other.values, sizeof(values)) && !memcmp(written, other.written, sizeof(written));
+	}
+};
+
+static long check_well_formed(const ResponseDecoder& decoder, int frames, std::mt19937& random) {
+	static const uint8_t function_codes[] = { 100, 104, 105 };
+	Transaction transaction;
+	RecordingStore by_hand, by_table, by_static;
+	long mismatches = 0;
+	for (int i = 0; i < frames; i++) {
+		uint8_t function_code = function_codes[i % 3];
+		load_frame(transaction, function_code, function_code, get_response_length(function_code), random);
+		by_hand.clear();
+		by_table.clear();
+		by_static.clear();
+		decode_by_hand(&transaction, by_hand, 0);
+		if (!decoder.decode(&transaction, by_table, 0) || !(by_hand == by_table)) mismatches++;
+		else if (!Actuator::decode_stream_response(&transaction, by_static, 0) || !(by_hand == by_static)) mismatches++;
+	}
+	printf("well formed:     %d frames, %ld decoded differently\n", frames, mismatches);
+	return mismatches;
+}
+
+static long check_malformed(const ResponseDecoder& decoder, int frames, std::mt19937& random) {
+	Transaction transaction;
+	RecordingStore expected, by_table, by_static;
+	long mismatches = 0, accepted = 0;
+	for (int i = 0; i < frames; i++) {
+		uint8_t codes[] = { 100, 104, 105, 3, uint8_t(random()) };
+		uint8_t tx_function_code = codes[random() % 3];
+		uint8_t rx_function_code = random() % 4 ? tx_function_code : codes[random() % 5];
+		int rx_length = random() % 40;
+		load_frame(transaction, tx_function_code, rx_function_code, rx_length, random);
+
+		// a layout is used only for a response to its own function code which spans all of its fields
+		bool answers = rx_length >= 2 && rx_function_code == tx_function_code;
+		bool acceptable = answers && rx_length >= get_response_length(rx_function_code);
+		expected.clear();
+		by_table.clear();
+		by_static.clear();
+		if (acceptable) decode_by_hand(&transaction, expected, 0);
+		bool decoded = decoder.decode(&transaction, by_table, 0);
+		bool decoded_static = Actuator::decode_stream_response(&transaction, by_static, 0);
+		if (decoded != acceptable || !(expected == by_table)) mismatches++;
+		else if (decoded_static != acceptable || !(expected == by_static)) mismatches++;
+		accepted += decoded;
+	}
+	printf("malformed:       %d frames, %ld accepted, %ld decoded wrongly\n", frames, accepted, mismatches);
+	return mismatches;
+}
+
+static long check_bounded_copies(int runs, std::mt19937& random) {
+	RecordingStore store;
+	long mismatches = 0;
+	for (int i = 0; i < runs; i++) {
+		int available = random() % 24;
+		uint8_t* data = new uint8_t[available];		// exactly the bytes available, so a sanitizer catches over reads
+		for (int j = 0; j < available; j++) data[j] = uint8_t(random());
+
+		// a run of registers, some of which may not have arrived
+		int count = random() % 16;
+		uint16_t first = uint16_t(random() % (ORCA_REG_SIZE - 16));
+		store.clear();
+		bool complete = ResponseDecoder::decode_registers(data, available, first, count, store, 0);
+		int stored = available >= count * 2 ? count : available / 2;
+		bool correct = complete == (available >= count * 2) && !store.outside;
+		for (int r = 0; r < ORCA_REG_SIZE; r++) {
+			bool in_run = r >= first && r < first + stored;
+			if (store.written[r] != in_run) correct = false;
+			if (in_run && store.values[r] != ((data[(r - first) * 2] << 8) | data[(r - first) * 2 + 1])) correct = false;
+		}
+
+		// fields at arbitrary offsets, some of which lie past the data
+		ResponseField fields[4];
+		bool fit = true;
+		for (int f = 0; f < 4; f++) {
+			fields[f].offset = uint8_t(random() % 24);
+			fields[f].width = uint8_t(1 + random() % 2);
+			fields[f].destination = uint16_t(f);
+			fit = fit && fields[f].offset + fields[f].width <= available;
+		}
+		store.clear();
+		complete = ResponseDecoder::decode_fields(data, available, fields, 4, store, 0);
+		correct = correct && complete == fit;
+		for (int f = 0; f < 4; f++) {
+			const ResponseField& field = fields[f];
+			bool fits = field.offset + field.width <= available;
+			if (store.written[f] != fits) correct = false;
+			else if (fits && store.values[f] != (field.width == 2 ? (data[field.offset] << 8) | data[field.offset + 1] : data[field.offset])) correct = false;
+		}
+
+		mismatches += !correct;
+		delete[] data;
+	}
+	printf("bounded copies:  %d runs, %ld copied wrongly\n", runs, mismatches);
+	return mismatches;
+}
+
+/**
+ * @brief Answer each read holding registers request from an Actuator with a frame whose byte count and length are chosen at random
+ */
+static long check_actuator_reads(int reads, std::mt19937& random) {
+	static const uint16_t REGION_START = 196, REGION_END = 263;		// unused by the Orca's memory map; reads are made within it
+	MemoryTransportPair links;
+	links.server_end.open(0);
+	Actuator actuator(0, "fuzz", 1);
+	actuator.set_transport(&links.client_end);
+	actuator.init();
+
+	uint16_t expected[ORCA_REG_SIZE] = { 0 };
+	long mismatches = 0, lost = 0, delivered_count = 0, miscounted = 0;
+	for (int i = 0; i < reads; i++) {
+		uint16_t num_registers = uint16_t(1 + random() % 16);
+		uint16_t first = uint16_t(REGION_START + random() % (REGION_END - REGION_START - num_registers));
+		actuator.read_registers(first, num_registers);
+
+		uint8_t request[8];
+		int received = 0;
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		while (received < 8 && std::chrono::steady_clock::now() - start < std::chrono::milliseconds(100)) {
+			actuator.run_out();
+			actuator.run_in();
+			int n = links.server_end.read(request + received, 8 - received);
+			if (n > 0) received += n;
+		}
+		if (received < 8) {
+			lost++;
+			continue;
+		}
+
+		// the byte count is correct half of the time and the data sent three quarters of the time; otherwise they're random,
+		// mostly near the correct length
+		int byte_count = random() % 2 ? num_registers * 2 : int(random() % (random() % 3 ? num_registers * 2 + 8 : 256));
+		int data_length = random() % 4 ? num_registers * 2 : int(random() % (num_registers * 2 + 8));
+		bool has_byte_count = random() % 8 != 0;
+		uint8_t frame[300];
+		int length = 0;
+		frame[length++] = 1;
+		frame[length++] = ModbusClientApplication::read_holding_registers;
+		if (has_byte_count) frame[length++] = uint8_t(byte_count);
+		else data_length = 0;
+		uint16_t value = uint16_t(random());
+		for (int j = 0; j < data_length; j++) frame[length++] = uint8_t(value + j);
+		uint16_t crc = ModbusCRC::generate(frame, length);
+		frame[length++] = uint8_t(crc >> 8);
+		frame[length++] = uint8_t(crc);
+
+		uint32_t responses = actuator.get_num_successful_msgs() + actuator.get_num_failed_msgs();
+		links.server_end.write(frame, length);
+		start = std::chrono::steady_clock::now();
+		while (actuator.get_num_successful_msgs() + actuator.get_num_failed_msgs() == responses
+			&& std::chrono::steady_clock::now() - start < std::chrono::milliseconds(100)) {
+			actuator.run_in();
+			actuator.run_out();
+		}
+
+		// the client ends a read response at the length its request expects, so only frames of that length reach run_in();
+		// from those, registers are stored only from the bytes both counted and present
+		bool delivered = length == 5 + num_registers * 2;
+		int usable = has_byte_count ? (byte_count < data_length ? byte_count : data_length) : 0;
+		int stored = !delivered ? 0 : usable >= num_registers * 2 ? num_registers : usable / 2;
+		delivered_count += delivered;
+		miscounted += delivered && (!has_byte_count || byte_count != num_registers * 2);
+		for (int r = 0; r < stored; r++) {
+			expected[first + r] = uint16_t((uint8_t(value + r * 2) << 8) | uint8_t(value + r * 2 + 1));
+		}
+		bool correct = true;
+		for (int r = 0; r < ORCA_REG_SIZE; r++) {
+			if (actuator.get_orca_reg_content(r) != expected[r]) {
+				correct = false;
+				expected[r] = actuator.get_orca_reg_content(r);		// so one failure isn't counted again by every later read
+			}
+		}
+		mismatches += !correct;
+
+		// let the rest of a frame longer than expected arrive and be discarded before the next request
+		start = std::chrono::steady_clock::now();
+		while (std::chrono::steady_clock::now() - start < std::chrono::milliseconds(5)) {
+			actuator.run_in();
+			actuator.run_out();
+		}
+	}
+	printf("actuator reads:  %d responses, %ld of the expected length, %ld of those with a wrong byte count, %ld stored wrongly, %ld requests not sent\n",
+		reads, delivered_count, miscounted, mismatches, lost);
+	return mismatches + lost;
+}
+
+int main(int argc, char* argv[]) {
+	int frames = 2000000, reads = 300;
+	unsigned seed = 1;
+	for (int i = 1; i + 1 < argc; i += 2) {
+		if (strcmp(argv[i], "--frames") == 0) frames = atoi(argv[i + 1]);
+		else if (strcmp(argv[i], "--reads") == 0) reads = atoi(argv[i + 1]);
+		else if (strcmp(argv[i], "--seed") == 0) seed = strtoul(argv[i + 1], 0, 10);
+	}
+
+	std::mt19937 random(seed);
+	ResponseDecoder decoder(Actuator::get_response_layouts(), Actuator::RESPONSE_LAYOUT_COUNT);
+	long failures = check_well_formed(decoder, 30000, random);
+	failures += check_malformed(decoder, frames, random);
+	failures += check_bounded_copies(frames / 10, random);
+	failures += check_actuator_reads(reads, random);
+	printf(failures ? "FAILED\n" : "passed\n");
+	return failures ? 1 : 0;
+}
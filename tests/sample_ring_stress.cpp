@@ -0,0 +1,109 @@
+/*
+ * Checks that SampleRing gives each reader every sample once, whole and in order, or counts it as an overrun.
+ *
+ * Usage: sample_ring_stress [--pushes <n>]
+ *
+ * One thread pushes samples continuously into a small ring while four threads read it, each with its own Cursor. Every
+ * field of a sample is derived from its sequence, so a copy with fields from two pushes is detected. Three readers keep
+ * up as best they can and one pauses between reads so the writer laps it. Once the writer is done, every reader's samples
+ * read plus its overruns must account for every sequence pushed.
+ *
+ * Build with -fsanitize=thread (make tsan) to also check the per slot seqlocks are free of data races.
+ * Returns 0 if every sample read was whole, in order, and every sequence was either read or counted as an overrun.
+ */
+#include "modbus_client/sample_ring.h"
+#include <atomic>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+
+static const int READERS = 4;
+static const uint32_t CAPACITY = 64;
+static const int BATCH = 16;
+
+struct Counted {
+	int32_t  value;
+	int32_t  negated;
+	uint16_t words[9];
+	uint32_t count;
+};
+
+static void fill(Counted& counted, uint32_t count) {
+	memset(&counted, 0, sizeof(Counted));
+	counted.value = int32_t(count * 65536u + count);
+	counted.negated = -counted.value;
+	for (int i = 0; i < 9; i++) counted.words[i] = uint16_t(count + i);
+	counted.count = count;
+}
+
+static bool is_whole(const Counted& counted) {
+	Counted expected;
+	fill(expected, counted.count);
+	return memcmp(&counted, &expected, sizeof(Counted)) == 0;
+}
+
+struct ReaderResult {
+	long read = 0;
+	long failures = 0;		// torn, out of order, or labelled with the wrong sequence
+	SampleRing<Counted, CAPACITY>::Cursor cursor;
+};
+
+int main(int argc, char* argv[]) {
+	uint32_t pushes = 1000000;
+	for (int i = 1; i + 1 < argc; i += 2) {
+		if (strcmp(argv[i], "--pushes") == 0) pushes = strtoul(argv[i + 1], 0, 10);
+	}
+
+	static SampleRing<Counted, CAPACITY> ring;
+	std::atomic<bool> done(false);
+	ReaderResult results[READERS];
+
+	std::thread readers[READERS];
+	for (int r = 0; r < READERS; r++) {
+		readers[r] = std::thread([&, r]() {
+			ReaderResult& result = results[r];
+			bool slow = r == READERS - 1;
+			uint32_t last = 0;
+			for (;;) {
+				// read what is left once more after the writer finishes
+				bool finished = done.load();
+				Counted samples[BATCH];
+				uint32_t sequences[BATCH];
+				int count;
+				while ((count = ring.read(result.cursor, samples, BATCH, sequences)) > 0) {
+					for (int i = 0; i < count; i++) {
+						if (!is_whole(samples[i]) || samples[i].count != sequences[i] || sequences[i] <= last) result.failures++;
+						last = sequences[i];
+					}
+					result.read += count;
+					if (slow) std::this_thread::sleep_for(std::chrono::microseconds(200));
+				}
+				if (finished) break;
+				std::this_thread::yield();
+			}
+		});
+	}
+
+	for (uint32_t count = 1; count <= pushes; count++) {
+		Counted counted;
+		fill(counted, count);
+		if (ring.push(counted) != count) results[0].failures++;
+		if (count % (CAPACITY / 4) == 0) std::this_thread::yield();		// give the readers a chance to keep up
+	}
+	done = true;
+	for (int r = 0; r < READERS; r++) readers[r].join();
+
+	long failures = 0;
+	for (int r = 0; r < READERS; r++) {
+		const ReaderResult& result = results[r];
+		bool accounted = result.read + result.cursor.overruns == long(pushes) && result.cursor.next == pushes + 1;
+		printf("reader %d%s: %ld read, %u overruns, %ld torn or out of order, %s\n", r, r == READERS - 1 ? " (slow)" : "       ",
+			result.read, result.cursor.overruns, result.failures, accounted ? "every sequence accounted for" : "SEQUENCES MISSING OR COUNTED TWICE");
+		failures += result.failures + !accounted;
+	}
+	printf("%u pushes into %u slots\n", pushes, CAPACITY);
+	printf(failures ? "FAILED\n" : "passed\n");
+	return failures ? 1 : 0;
+}
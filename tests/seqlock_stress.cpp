@@ -0,0 +1,153 @@
+/*
+ * Checks that Seqlock and ActuatorSnapshot never hand a reader a value mixed from two writes.
+ *
+ * Usage: seqlock_stress [--writes <n>] [--ms <duration of the snapshot check>]
+ *
+ * 1. One thread writes a Seqlock continuously while three threads read it. Every field of a written value is derived
+ *    from a counter, so a copy with fields from two writes is detected.
+ * 2. An Actuator streams with a SimulatedOrcaServer over a MemoryTransportPair and publishes an ActuatorSnapshot after
+ *    each run_in() while three threads read it. The server's position is kept at 3 times its force, with values crossing
+ *    16 bit boundaries, so a snapshot of the position from one response and the force from another is detected.
+ *
+ * Build with -fsanitize=thread (make tsan) to also check that these copies are free of data races.
+ * Returns 0 if every read was coherent.
+ */
+#include "modbus_client/seqlock.h"
+#include "modbus_client/device_applications/actuator_snapshot.h"
+#include "modbus_client/device_applications/simulated_orca_server.h"
+#include "modbus_client/device_drivers/transport/memory_transport.h"
+#include <atomic>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+
+static const int READERS = 3;
+
+struct Counted {
+	int32_t  value;
+	int32_t  negated;
+	uint16_t words[8];
+	uint32_t count;
+};
+
+static void fill(Counted& counted, uint32_t count) {
+	counted.value = int32_t(count * 65536u + count);
+	counted.negated = -counted.value;
+	for (int i = 0; i < 8; i++) counted.words[i] = uint16_t(count + i);
+	counted.count = count;
+}
+
+static bool is_whole(const Counted& counted) {
+	Counted expected;
+	fill(expected, counted.count);
+	return memcmp(&counted, &expected, sizeof(Counted)) == 0;
+}
+
+/**
+ * @return the number of torn or out of order reads
+ */
+static long check_seqlock(uint32_t writes) {
+	Seqlock<Counted> seqlock;
+	std::atomic<bool> done(false);
+	std::atomic<long> reads(0), failures(0);
+
+	std::thread readers[READERS];
+	for (int r = 0; r < READERS; r++) {
+		readers[r] = std::thread([&]() {
+			uint32_t last = 0;
+			while (!done.load()) {
+				Counted counted;
+				if (!seqlock.read(counted) || !counted.count) continue;
+				reads++;
+				if (!is_whole(counted) || counted.count < last) failures++;
+				last = counted.count;
+			}
+		});
+	}
+
+	for (uint32_t count = 1; count <= writes; count++) {
+		Counted counted;
+		fill(counted, count);
+		seqlock.write(counted);
+	}
+	done = true;
+	for (int r = 0; r < READERS; r++) readers[r].join();
+
+	printf("seqlock:  %u writes, %ld reads, %ld torn or out of order\n", seqlock.get_write_count(), reads.load(), failures.load());
+	return failures.load() + (seqlock.get_write_count() != writes);
+}
+
+/**
+ * @return the number of incoherent or out of order snapshots, or 1 if the actuator never connected
+ */
+static long check_snapshot(int duration_ms) {
+	MemoryTransportPair links;
+	links.server_end.open(0);
+	SimulatedOrcaServer server(&links.server_end, 1, 1234);
+	Actuator actuator(0, "stress", 1);
+	actuator.set_transport(&links.client_end);
+	ActuatorSnapshot snapshot;
+	int watched_position = snapshot.watch(POS_REG_OFFSET);
+
+	std::atomic<bool> done(false);
+	std::atomic<long> reads(0), failures(0);
+
+	std::thread readers[READERS];
+	for (int r = 0; r < READERS; r++) {
+		readers[r] = std::thread([&]() {
+			uint32_t last = 0;
+			while (!done.load()) {
+				ActuatorFeedback feedback;
+				if (!snapshot.read(feedback)) continue;
+				reads++;
+				if (uint32_t(feedback.position_um) != 3 * uint32_t(feedback.force_mN)
+					|| feedback.watched_values[watched_position] != uint16_t(feedback.position_um)
+					|| feedback.response_count < last) {
+					failures++;
+				}
+				last = feedback.response_count;
+			}
+		});
+	}
+
+	actuator.init();
+	actuator.enable();
+	uint32_t force = 0;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	while (std::chrono::steady_clock::now() - start < std::chrono::milliseconds(duration_ms)) {
+		actuator.run_in();
+		snapshot.publish(actuator);
+		actuator.run_out();
+
+		// both halves of both values change on most steps
+		force += 69905;
+		uint32_t position = 3 * force;
+		server[FORCE_REG_OFFSET] = uint16_t(force);
+		server[FORCE_REG_H_OFFSET] = uint16_t(force >> 16);
+		server[POS_REG_OFFSET] = uint16_t(position);
+		server[POS_REG_H_OFFSET] = uint16_t(position >> 16);
+		server.poll();
+	}
+	done = true;
+	for (int r = 0; r < READERS; r++) readers[r].join();
+
+	printf("snapshot: %u published, %ld reads, %ld incoherent or out of order, connected %d\n",
+		snapshot.get_publish_count(), reads.load(), failures.load(), actuator.is_connected());
+	return failures.load() + !actuator.is_connected();
+}
+
+int main(int argc, char* argv[]) {
+	uint32_t writes = 2000000;
+	int duration_ms = 3000;
+	for (int i = 1; i + 1 < argc; i += 2) {
+		if (strcmp(argv[i], "--writes") == 0) writes = strtoul(argv[i + 1], 0, 10);
+		else if (strcmp(argv[i], "--ms") == 0) duration_ms = atoi(argv[i + 1]);
+	}
+
+	long failures = check_seqlock(writes);
+	failures += check_snapshot(duration_ms);
+	printf(failures ? "FAILED\n" : "passed\n");
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,75 @@
+/*
+ * Stream responses for the response decoder checks, and the decoding run_in() used for them before ResponseDecoder.
+ */
+#ifndef STREAM_RESPONSES_H_
+#define STREAM_RESPONSES_H_
+
+#include "modbus_client/device_applications/actuator.h"
+#include <random>
+
+/**
+ * @brief The fixed fields of stream responses as run_in() stored them before ResponseDecoder, without checking the
+ * function code of the request or the length of the response
+ */
+template <class Store>
+inline void decode_by_hand(Transaction* response, Store& store, uint32_t cycles) {
+	const uint8_t* d = response->get_rx_data();
+	switch (response->get_rx_function_code()) {
+	case 100:
+		store.set(POS_REG_H_OFFSET, (d[ 0] << 8) | d[ 1], cycles);
+		store.set(POS_REG_OFFSET, (d[ 2] << 8) | d[ 3], cycles);
+		store.set(FORCE_REG_H_OFFSET, (d[ 4] << 8) | d[ 5], cycles);
+		store.set(FORCE_REG_OFFSET, (d[ 6] << 8) | d[ 7], cycles);
+		store.set(POWER_REG_OFFSET, (d[ 8] << 8) | d[ 9], cycles);
+		store.set(TEMP_REG_OFFSET, (d[10]), cycles);
+		store.set(VOLTAGE_REG_OFFSET, (d[11] << 8) | d[12], cycles);
+		store.set(ERROR_REG_OFFSET, (d[13] << 8) | d[14], cycles);
+		break;
+	case 104:
+		store.set(MODE_OF_OPERATION, d[4], cycles);
+		store.set(POS_REG_H_OFFSET, (d[ 5] << 8) | d[ 6], cycles);
+		store.set(POS_REG_OFFSET, (d[ 7] << 8) | d[ 8], cycles);
+		store.set(FORCE_REG_H_OFFSET, (d[ 9] << 8) | d[10], cycles);
+		store.set(FORCE_REG_OFFSET, (d[11] << 8) | d[12], cycles);
+		store.set(POWER_REG_OFFSET, (d[13] << 8) | d[14], cycles);
+		store.set(TEMP_REG_OFFSET, (d[15]), cycles);
+		store.set(VOLTAGE_REG_OFFSET, (d[16] << 8) | d[17], cycles);
+		store.set(ERROR_REG_OFFSET, (d[18] << 8) | d[19], cycles);
+		break;
+	case 105:
+		store.set(MODE_OF_OPERATION, d[0], cycles);
+		store.set(POS_REG_H_OFFSET, (d[ 1] << 8) | d[ 2], cycles);
+		store.set(POS_REG_OFFSET, (d[ 3] << 8) | d[ 4], cycles);
+		store.set(FORCE_REG_H_OFFSET, (d[ 5] << 8) | d[ 6], cycles);
+		store.set(FORCE_REG_OFFSET, (d[ 7] << 8) | d[ 8], cycles);
+		store.set(POWER_REG_OFFSET, (d[ 9] << 8) | d[10], cycles);
+		store.set(TEMP_REG_OFFSET, (d[11]), cycles);
+		store.set(VOLTAGE_REG_OFFSET, (d[12] << 8) | d[13], cycles);
+		store.set(ERROR_REG_OFFSET, (d[14] << 8) | d[15], cycles);
+		break;
+	}
+}
+
+inline int get_response_length(uint8_t function_code) {
+	switch (function_code) {
+	case 100:	return MOTOR_COMMAND_RESPONSE_LEN;
+	case 104:	return MOTOR_READ_RESPONSE_LEN;
+	case 105:	return MOTOR_WRITE_RESPONSE_LEN;
+	default:	return -1;
+	}
+}
+
+/**
+ * @brief Load a request for tx_function_code and a received frame of rx_length bytes answering it with rx_function_code
+ */
+inline void load_frame(Transaction& transaction, uint8_t tx_function_code, uint8_t rx_function_code, int rx_length, std::mt19937& random) {
+	uint8_t request[7] = { 0x01, 0x5E, 2, 0, 0, 0, 0 };
+	transaction.reset_transaction();
+	transaction.load_transmission_data(1, tx_function_code, request, tx_function_code == 100 ? 5 : tx_function_code == 104 ? 3 : 7,
+		get_response_length(tx_function_code));
+	for (int i = 0; i < rx_length; i++) {
+		transaction.load_reception(i == 0 ? 1 : i == 1 ? rx_function_code : uint8_t(random()));
+	}
+}
+
+#endif